@@ -0,0 +1,25 @@
+#ifndef BINDLESS_GLSL
+#define BINDLESS_GLSL
+
+// Bindless table of VulkanBackend, bindings must match the bindless*Binding constants in VulkanBackend.cpp.
+// Buffer arrays are indexed by the id of the handle owning the resource. Streamed textures have a descriptor per frame
+// in flight, their current one is StreamedTextureInfo::descriptorIndex in TextureStreaming.glsl. Shaders including
+// this need #extension GL_EXT_nonuniform_qualifier : require before any declaration.
+
+#ifndef BINDLESS_SET
+#define BINDLESS_SET 0
+#endif
+
+#define BINDLESS_TEXTURES_BINDING 0
+#define BINDLESS_MESHLETS_BINDING 1 // PackedMeshlet buffers
+#define BINDLESS_MESHLET_DRAW_COMMANDS_BINDING 2 // DrawIndexedIndirectCommand buffers
+
+// Textures without resident mips are a white fallback texture
+layout(set = BINDLESS_SET, binding = BINDLESS_TEXTURES_BINDING) uniform sampler2D bindlessTextures[];
+
+vec4 sampleBindlessTexture(uint descriptorIndex, vec2 uv)
+{
+    return texture(bindlessTextures[nonuniformEXT(descriptorIndex)], uv);
+}
+
+#endif // BINDLESS_GLSL
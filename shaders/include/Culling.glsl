@@ -0,0 +1,17 @@
+#ifndef CULLING_GLSL
+#define CULLING_GLSL
+
+// Planes as in Renderer/Frustum.h, xyz is the inward normal
+bool isSphereInFrustum(vec3 center, float radius, vec4 frustumPlanes[6])
+{
+    for (int i = 0; i < 6; ++i)
+    {
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // CULLING_GLSL
@@ -0,0 +1,31 @@
+#ifndef MESHLETS_GLSL
+#define MESHLETS_GLSL
+
+#include <Culling.glsl>
+
+// Must match PackedMeshlet in Assets/MeshletBuilder.h
+
+struct PackedMeshlet
+{
+    vec3 center;
+    float radius;
+    uint cone; // Axis xyz and cutoff as snorm8
+    uint firstIndex;
+    uint triangleCount;
+    int vertexOffset;
+};
+
+// True when no triangle of the meshlet can face the camera
+bool isMeshletBackFacing(PackedMeshlet meshlet, vec3 cameraPosition)
+{
+    vec4 cone = unpackSnorm4x8(meshlet.cone);
+    if (cone.w >= 1.0)
+    {
+        return false;
+    }
+    vec3 axis = normalize(cone.xyz);
+    vec3 toCenter = meshlet.center - cameraPosition;
+    return dot(toCenter, axis) >= cone.w * length(toCenter) + meshlet.radius * (1.0 + cone.w);
+}
+
+#endif // MESHLETS_GLSL
@@ -0,0 +1,85 @@
+#ifndef SCENE_DATA_GLSL
+#define SCENE_DATA_GLSL
+
+// Must match GpuMeshLod, GpuMesh, GpuInstance, GpuInstanceUpdate and GpuView in VulkanBackend.h
+
+#define MAX_MESH_LODS 8
+
+struct GpuMeshLod
+{
+    uint firstIndex; // Into the shared index buffer
+    uint indexCount;
+    float error; // Mesh space distance from the full detail mesh
+    uint padding;
+};
+
+struct GpuMesh
+{
+    vec3 center; // Mesh space bounding sphere
+    float radius;
+    int vertexOffset; // Into the shared vertex buffer
+    uint lodCount; // 0 for destroyed meshes
+    uint padding0;
+    uint padding1;
+    GpuMeshLod lods[MAX_MESH_LODS];
+};
+
+#define INSTANCE_VISIBLE 1u
+#define NO_TEXTURE 0xFFFFFFFFu
+
+struct GpuInstance
+{
+    mat4 model;
+    uint meshIndex;
+    uint batchIndex; // One batch per graphics pipeline
+    uint flags; // INSTANCE_VISIBLE
+    uint textureIndex; // Streamed texture handle id or NO_TEXTURE
+};
+
+struct GpuInstanceUpdate
+{
+    uint instanceIndex;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+    GpuInstance instance;
+};
+
+// Camera of the frame, read from a dynamic uniform buffer
+struct GpuView
+{
+    mat4 viewProjection;
+    vec4 frustumPlanes[6]; // World space, xyz is the inward normal
+    vec4 cameraPosition; // World space
+    float lodProjectionScale; // Pixels per world unit at distance 1
+    float maxLodPixelError;
+    uint padding0;
+    uint padding1;
+};
+
+struct DrawIndexedIndirectCommand
+{
+    uint indexCount;
+    uint instanceCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint firstInstance;
+};
+
+// Same as selectLod() in Renderer/LodSelection.cpp
+uint selectMeshLod(GpuMesh mesh, float distance, float scale, float projectionScale, float maxPixelError)
+{
+    if (distance <= 0.0)
+    {
+        return 0u;
+    }
+    float maxWorldError = maxPixelError * distance / (projectionScale * scale);
+    uint lod = 0u;
+    while (lod + 1u < mesh.lodCount && mesh.lods[lod + 1u].error <= maxWorldError)
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+#endif // SCENE_DATA_GLSL
@@ -0,0 +1,59 @@
+#ifndef TEXTURE_STREAMING_GLSL
+#define TEXTURE_STREAMING_GLSL
+
+// Residency feedback for streamed textures. Must match StreamedTextureShaderInfo in VulkanBackend.h and the texture
+// streaming set of the draw pipeline layout. Textures are sampled from the bindless table, so shaders including this
+// need #extension GL_EXT_nonuniform_qualifier : require and BINDLESS_SET defined like for Bindless.glsl.
+
+#include <Bindless.glsl>
+
+#ifndef TEXTURE_STREAMING_SET
+#define TEXTURE_STREAMING_SET 3
+#endif
+
+struct StreamedTextureInfo
+{
+    uint residentMip;
+    uint width;
+    uint height;
+    uint mipCount;
+    uint descriptorIndex; // Into bindlessTextures, changes when new mips are swapped in
+};
+
+layout(std430, set = TEXTURE_STREAMING_SET, binding = 0) readonly buffer StreamedTextureInfos
+{
+    StreamedTextureInfo streamedTextures[];
+};
+
+// Finest mip each texture was sampled at, reset to 0xFFFFFFFF by the CPU after reading
+layout(std430, set = TEXTURE_STREAMING_SET, binding = 1) buffer TextureFeedback
+{
+    uint textureFeedback[];
+};
+
+float computeStreamedTextureLod(StreamedTextureInfo info, vec2 uv)
+{
+    const vec2 texelCoordinate = uv * vec2(info.width, info.height);
+    const vec2 dx = dFdx(texelCoordinate);
+    const vec2 dy = dFdy(texelCoordinate);
+    const float maxLengthSquared = max(dot(dx, dx), dot(dy, dy));
+    return clamp(0.5 * log2(max(maxLengthSquared, 1e-8)), 0.0, float(info.mipCount - 1));
+}
+
+vec4 sampleStreamedTexture(uint textureId, vec2 uv)
+{
+    const StreamedTextureInfo info = streamedTextures[textureId];
+    const float lod = computeStreamedTextureLod(info, uv);
+
+    // Only one pixel in each 4x4 tile writes feedback to keep atomic traffic low
+    const uvec2 pixel = uvec2(gl_FragCoord.xy);
+    if ((pixel.x & 3u) == 0u && (pixel.y & 3u) == 0u)
+    {
+        atomicMin(textureFeedback[textureId], uint(lod));
+    }
+
+    // The image only holds mips from residentMip onward, so its first level is the resident mip
+    return textureLod(bindlessTextures[nonuniformEXT(info.descriptorIndex)], uv, max(lod - float(info.residentMip), 0.0));
+}
+
+#endif // TEXTURE_STREAMING_GLSL
@@ -1,8 +1,27 @@
-layout(location = 0) in vec3 fragColor;
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+#define BINDLESS_SET 1
+#define TEXTURE_STREAMING_SET 3
+
+#include <SceneData.glsl>
+#include <TextureStreaming.glsl>
+
+layout(location = 0) in vec3 fragNormal;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
+const vec3 lightDirection = vec3(0.267, 0.802, 0.535);
+
 void main()
 {
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    float diffuse = max(dot(normalize(fragNormal), lightDirection), 0.0);
+    vec3 albedo = vec3(1.0);
+    if (fragTextureIndex != NO_TEXTURE)
+    {
+        albedo = sampleStreamedTexture(fragTextureIndex, fragTexCoord).rgb;
+    }
+    outColor = vec4(albedo * (0.1 + 0.9 * diffuse), 1.0);
+}
@@ -1,19 +1,44 @@
-layout(location = 0) out vec3 fragColor;
+#version 450
 
-vec2 positions[3] = vec2[](
-    vec2(0.0, -0.5),
-    vec2(0.5, 0.5),
-    vec2(-0.5, 0.5)
-);
+#include <SceneData.glsl>
 
-vec3 colors[3] = vec3[](
-    vec3(1.0, 0.0, 0.0),
-    vec3(0.0, 1.0, 0.0),
-    vec3(0.0, 0.0, 1.0)
-);
+// QuantizedMeshVertex in Assets/Mesh.h
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal; // Octahedral
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTextureIndex;
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances
+{
+    GpuInstance instances[];
+};
+
+// Set 1 is the bindless table, set 3 texture streaming
+layout(std140, set = 2, binding = 0) uniform View
+{
+    GpuView view;
+};
+
+// Same as MeshOptimization::decodeOctahedral()
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (normal.z < 0.0)
+    {
+        normal.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(normal);
+}
 
 void main()
 {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-    fragColor = colors[gl_VertexIndex];
+    // firstInstance of each indirect command is the instance index
+    mat4 model = instances[gl_InstanceIndex].model;
+    gl_Position = view.viewProjection * model * vec4(inPosition.xyz, 1.0);
+    fragNormal = mat3(model) * decodeOctahedral(inNormal);
+    fragTexCoord = inTexCoord;
+    fragTextureIndex = instances[gl_InstanceIndex].textureIndex;
 }
@@ -0,0 +1,408 @@
+#include "AssetPackage.h"
+
+#include "../Utilities/Hash.h"
+#include "../Utilities/Parallel.h"
+
+#include <lz4.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr std::array<char, 4> packageMagic = {'V', 'P', 'A', 'K'};
+constexpr uint32_t packageVersion = 1u;
+
+struct ZstdDecompressionContextDeleter
+{
+    void operator()(ZSTD_DCtx* context) const { ZSTD_freeDCtx(context); }
+};
+
+// Creating a context per call is expensive, keep one per worker thread
+ZSTD_DCtx* getThreadZstdDecompressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, ZstdDecompressionContextDeleter> context(ZSTD_createDCtx());
+    return context.get();
+}
+
+std::vector<std::byte> compressChunk(std::span<const std::byte> source, AssetCompression compression, int zstdLevel)
+{
+    std::vector<std::byte> compressed;
+
+    if (compression == AssetCompression::LZ4)
+    {
+        compressed.resize(LZ4_compressBound(static_cast<int>(source.size())));
+        const int size = LZ4_compress_default(reinterpret_cast<const char*>(source.data()),
+                                              reinterpret_cast<char*>(compressed.data()),
+                                              static_cast<int>(source.size()),
+                                              static_cast<int>(compressed.size()));
+        if (size <= 0)
+        {
+            throw std::runtime_error("Failed to compress a chunk with LZ4!");
+        }
+        compressed.resize(size);
+    }
+    else if (compression == AssetCompression::Zstd)
+    {
+        compressed.resize(ZSTD_compressBound(source.size()));
+        const size_t size = ZSTD_compress(compressed.data(), compressed.size(), source.data(), source.size(), zstdLevel);
+        if (ZSTD_isError(size))
+        {
+            throw std::runtime_error(std::string("Failed to compress a chunk with zstd: ") + ZSTD_getErrorName(size));
+        }
+        compressed.resize(size);
+    }
+
+    // Store incompressible chunks as is
+    if (compression == AssetCompression::None || compressed.size() >= source.size())
+    {
+        compressed.assign(source.begin(), source.end());
+    }
+    return compressed;
+}
+
+void decompressChunk(std::span<const std::byte> source, std::span<std::byte> destination, AssetCompression compression)
+{
+    if (source.size() == destination.size())
+    {
+        std::memcpy(destination.data(), source.data(), source.size());
+        return;
+    }
+
+    if (compression == AssetCompression::LZ4)
+    {
+        const int size = LZ4_decompress_safe(reinterpret_cast<const char*>(source.data()),
+                                             reinterpret_cast<char*>(destination.data()),
+                                             static_cast<int>(source.size()),
+                                             static_cast<int>(destination.size()));
+        if (size != static_cast<int>(destination.size()))
+        {
+            throw std::runtime_error("Failed to decompress a LZ4 chunk!");
+        }
+    }
+    else if (compression == AssetCompression::Zstd)
+    {
+        const size_t size = ZSTD_decompressDCtx(getThreadZstdDecompressionContext(), destination.data(), destination.size(), source.data(), source.size());
+        if (ZSTD_isError(size) || size != destination.size())
+        {
+            throw std::runtime_error("Failed to decompress a zstd chunk!");
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Uncompressed chunk has a mismatching size!");
+    }
+}
+
+template<typename T>
+void writeValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T readValue(std::ifstream& file)
+{
+    T value{};
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+}
+
+double PackageCodecStatistics::compressionRatio() const
+{
+    return compressedBytes > 0 ? static_cast<double>(uncompressedBytes) / static_cast<double>(compressedBytes) : 0.0;
+}
+
+double PackageCodecStatistics::decodeThroughputMBps() const
+{
+    return decodeSeconds > 0.0 ? static_cast<double>(uncompressedBytes) / (1024.0 * 1024.0) / decodeSeconds : 0.0;
+}
+
+PackageCodecStatistics PackageStatistics::total() const
+{
+    PackageCodecStatistics total{};
+    for (const PackageCodecStatistics& codec : codecs)
+    {
+        total.compressedBytes += codec.compressedBytes;
+        total.uncompressedBytes += codec.uncompressedBytes;
+        total.chunkCount += codec.chunkCount;
+        total.decodeSeconds += codec.decodeSeconds;
+    }
+    return total;
+}
+
+AssetPackageWriter::AssetPackageWriter(uint32_t chunkSize, int zstdLevel) :
+    m_chunkSize(chunkSize),
+    m_zstdLevel(zstdLevel)
+{
+    if (m_chunkSize == 0)
+    {
+        throw std::runtime_error("Package chunk size can not be zero!");
+    }
+}
+
+void AssetPackageWriter::addAsset(std::string_view name, std::span<const std::byte> data, AssetCompression compression)
+{
+    if (name.size() > std::numeric_limits<uint16_t>::max())
+    {
+        throw std::runtime_error("Asset name is too long!");
+    }
+    if (std::any_of(m_entries.begin(), m_entries.end(), [name](const PackageEntry& entry) { return entry.name == name; }))
+    {
+        throw std::runtime_error("Asset " + std::string(name) + " is already in the package!");
+    }
+
+    const size_t chunkCount = (data.size() + m_chunkSize - 1) / m_chunkSize;
+    std::vector<std::vector<std::byte>> compressedChunks(chunkCount);
+
+    Parallel::forEach(chunkCount, [&](size_t chunkIndex)
+                    {
+                        const size_t offset = chunkIndex * m_chunkSize;
+                        const size_t size = std::min<size_t>(m_chunkSize, data.size() - offset);
+                        compressedChunks[chunkIndex] = compressChunk(data.subspan(offset, size), compression, m_zstdLevel);
+                    });
+
+    PackageEntry entry{
+        .name = std::string(name),
+        .compression = compression,
+        .uncompressedSize = data.size(),
+        .firstChunk = static_cast<uint32_t>(m_chunks.size()),
+        .chunkCount = static_cast<uint32_t>(chunkCount)};
+
+    PackageCodecStatistics& statistics = m_statistics.codecs[static_cast<size_t>(compression)];
+
+    for (size_t chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        const std::vector<std::byte>& compressed = compressedChunks[chunkIndex];
+        const size_t uncompressedOffset = chunkIndex * m_chunkSize;
+
+        PackageChunk chunk{};
+        chunk.dataOffset = m_chunkData.size();
+        chunk.uncompressedOffset = uncompressedOffset;
+        chunk.compressedSize = static_cast<uint32_t>(compressed.size());
+        chunk.uncompressedSize = static_cast<uint32_t>(std::min<size_t>(m_chunkSize, data.size() - uncompressedOffset));
+        chunk.checksum = Hash::crc32(compressed);
+        m_chunks.push_back(chunk);
+
+        m_chunkData.insert(m_chunkData.end(), compressed.begin(), compressed.end());
+
+        statistics.compressedBytes += chunk.compressedSize;
+        statistics.uncompressedBytes += chunk.uncompressedSize;
+        ++statistics.chunkCount;
+    }
+    m_entries.push_back(std::move(entry));
+}
+
+void AssetPackageWriter::write(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open " + path + " for writing!");
+    }
+
+    PackageHeader header{};
+    header.magic = packageMagic;
+    header.version = packageVersion;
+    header.entryCount = static_cast<uint32_t>(m_entries.size());
+    header.chunkCount = static_cast<uint32_t>(m_chunks.size());
+    header.entryTableOffset = sizeof(PackageHeader) + m_chunkData.size();
+
+    uint64_t entryTableSize = 0u;
+    for (const PackageEntry& entry : m_entries)
+    {
+        entryTableSize += sizeof(uint16_t) + entry.name.size() + sizeof(uint8_t) + sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    }
+    header.chunkTableOffset = header.entryTableOffset + entryTableSize;
+
+    writeValue(file, header);
+    file.write(reinterpret_cast<const char*>(m_chunkData.data()), m_chunkData.size());
+
+    for (const PackageEntry& entry : m_entries)
+    {
+        writeValue(file, static_cast<uint16_t>(entry.name.size()));
+        file.write(entry.name.data(), entry.name.size());
+        writeValue(file, static_cast<uint8_t>(entry.compression));
+        writeValue(file, entry.uncompressedSize);
+        writeValue(file, entry.firstChunk);
+        writeValue(file, entry.chunkCount);
+    }
+    file.write(reinterpret_cast<const char*>(m_chunks.data()), m_chunks.size() * sizeof(PackageChunk));
+
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write package " + path + "!");
+    }
+}
+
+AssetPackage::AssetPackage(const std::string& path) :
+    m_path(path),
+    m_file(path, std::ios::in | std::ios::binary)
+{
+    if (!m_file)
+    {
+        throw std::runtime_error("Failed to open package " + path + "!");
+    }
+
+    const PackageHeader header = readValue<PackageHeader>(m_file);
+    if (!m_file || header.magic != packageMagic)
+    {
+        throw std::runtime_error(path + " is not an asset package!");
+    }
+    if (header.version != packageVersion)
+    {
+        throw std::runtime_error(path + " has an unsupported package version!");
+    }
+
+    m_file.seekg(header.entryTableOffset);
+    m_entries.reserve(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        PackageEntry entry{};
+        entry.name.resize(readValue<uint16_t>(m_file));
+        m_file.read(entry.name.data(), entry.name.size());
+        entry.compression = static_cast<AssetCompression>(readValue<uint8_t>(m_file));
+        entry.uncompressedSize = readValue<uint64_t>(m_file);
+        entry.firstChunk = readValue<uint32_t>(m_file);
+        entry.chunkCount = readValue<uint32_t>(m_file);
+
+        if (static_cast<size_t>(entry.compression) >= assetCompressionCount || uint64_t(entry.firstChunk) + entry.chunkCount > header.chunkCount)
+        {
+            throw std::runtime_error(path + " has a corrupted entry table!");
+        }
+        m_entryIndices.emplace(entry.name, m_entries.size());
+        m_entries.push_back(std::move(entry));
+    }
+
+    m_file.seekg(header.chunkTableOffset);
+    m_chunks.resize(header.chunkCount);
+    m_file.read(reinterpret_cast<char*>(m_chunks.data()), m_chunks.size() * sizeof(PackageChunk));
+
+    if (!m_file)
+    {
+        throw std::runtime_error("Failed to read the tables of package " + path + "!");
+    }
+
+    // Chunks of an entry have to lie back to back inside the data section, readChunkRange() relies on it. Their decoded
+    // ranges have to follow each other from the beginning to the end of the asset, so that read() writes every byte
+    // exactly once.
+    if (header.entryTableOffset < sizeof(PackageHeader))
+    {
+        throw std::runtime_error(path + " has a corrupted chunk table!");
+    }
+    const uint64_t dataSectionSize = header.entryTableOffset - sizeof(PackageHeader);
+    for (const PackageEntry& entry : m_entries)
+    {
+        uint64_t coveredSize = 0u;
+        for (uint32_t i = 0; i < entry.chunkCount; ++i)
+        {
+            const PackageChunk& chunk = m_chunks[entry.firstChunk + i];
+            const bool isInDataSection = chunk.dataOffset <= dataSectionSize && chunk.compressedSize <= dataSectionSize - chunk.dataOffset;
+            const bool isInAsset = chunk.uncompressedOffset == coveredSize && chunk.uncompressedSize <= entry.uncompressedSize - coveredSize;
+            const bool isContiguous = i == 0 || chunk.dataOffset == m_chunks[entry.firstChunk + i - 1].dataOffset + m_chunks[entry.firstChunk + i - 1].compressedSize;
+            if (!isInDataSection || !isInAsset || !isContiguous)
+            {
+                throw std::runtime_error(path + " has a corrupted chunk table!");
+            }
+            coveredSize += chunk.uncompressedSize;
+        }
+        if (coveredSize != entry.uncompressedSize)
+        {
+            throw std::runtime_error(path + " has a corrupted chunk table!");
+        }
+    }
+}
+
+bool AssetPackage::contains(std::string_view name) const
+{
+    return m_entryIndices.find(std::string(name)) != m_entryIndices.end();
+}
+
+const PackageEntry& AssetPackage::getEntry(std::string_view name) const
+{
+    const auto it = m_entryIndices.find(std::string(name));
+    if (it == m_entryIndices.end())
+    {
+        throw std::runtime_error("Asset " + std::string(name) + " is not in package " + m_path + "!");
+    }
+    return m_entries[it->second];
+}
+
+std::vector<std::byte> AssetPackage::readChunkRange(const PackageEntry& entry)
+{
+    if (entry.chunkCount == 0)
+    {
+        return {};
+    }
+
+    // Chunks of an asset are stored back to back so they can be read with one sequential read
+    const PackageChunk& first = m_chunks[entry.firstChunk];
+    const PackageChunk& last = m_chunks[entry.firstChunk + entry.chunkCount - 1];
+    std::vector<std::byte> compressedData(last.dataOffset + last.compressedSize - first.dataOffset);
+
+    std::lock_guard lock(m_fileMutex);
+    m_file.seekg(sizeof(PackageHeader) + first.dataOffset);
+    m_file.read(reinterpret_cast<char*>(compressedData.data()), compressedData.size());
+    if (!m_file)
+    {
+        m_file.clear();
+        throw std::runtime_error("Failed to read asset " + entry.name + " from package " + m_path + "!");
+    }
+    return compressedData;
+}
+
+void AssetPackage::decompressAsset(std::string_view name, std::span<std::byte> destination)
+{
+    const PackageEntry& entry = getEntry(name);
+    if (destination.size() < entry.uncompressedSize)
+    {
+        throw std::runtime_error("Destination is too small for asset " + entry.name + "!");
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const std::vector<std::byte> compressedData = readChunkRange(entry);
+    const uint64_t baseOffset = entry.chunkCount > 0 ? m_chunks[entry.firstChunk].dataOffset : 0u;
+
+    Parallel::forEach(entry.chunkCount, [&](size_t i)
+                    {
+                        const PackageChunk& chunk = m_chunks[entry.firstChunk + i];
+                        const std::span<const std::byte> source(compressedData.data() + (chunk.dataOffset - baseOffset), chunk.compressedSize);
+
+                        if (Hash::crc32(source) != chunk.checksum)
+                        {
+                            throw std::runtime_error("Checksum mismatch in asset " + entry.name + " chunk " + std::to_string(i) + "!");
+                        }
+                        decompressChunk(source, destination.subspan(chunk.uncompressedOffset, chunk.uncompressedSize), entry.compression);
+                    });
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::lock_guard lock(m_statisticsMutex);
+    PackageCodecStatistics& statistics = m_statistics.codecs[static_cast<size_t>(entry.compression)];
+    statistics.compressedBytes += compressedData.size();
+    statistics.uncompressedBytes += entry.uncompressedSize;
+    statistics.chunkCount += entry.chunkCount;
+    statistics.decodeSeconds += seconds;
+}
+
+std::vector<std::byte> AssetPackage::loadAsset(std::string_view name)
+{
+    std::vector<std::byte> data(getEntry(name).uncompressedSize);
+    decompressAsset(name, data);
+    return data;
+}
+
+PackageStatistics AssetPackage::getStatistics() const
+{
+    std::lock_guard lock(m_statisticsMutex);
+    return m_statistics;
+}
@@ -0,0 +1,144 @@
+#ifndef VULKANPROJECT_ASSETPACKAGE_H
+#define VULKANPROJECT_ASSETPACKAGE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+enum class AssetCompression : uint8_t
+{
+    None = 0,
+    LZ4, // Fast to decode, use for data that is loaded often
+    Zstd // Better ratio, use for large rarely loaded data
+};
+
+constexpr size_t assetCompressionCount = 3;
+
+/**
+ * Package file layout:
+ *   PackageHeader
+ *   Compressed chunk data
+ *   Entry table (name, compression, sizes and chunk range of each asset)
+ *   Chunk table (PackageChunk for each chunk)
+ * Every chunk is compressed independently so that chunks can be decoded in parallel.
+ */
+struct PackageHeader
+{
+    std::array<char, 4> magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t chunkCount;
+    uint64_t entryTableOffset;
+    uint64_t chunkTableOffset;
+};
+
+struct PackageChunk
+{
+    uint64_t dataOffset; // Offset from the beginning of the chunk data section
+    uint64_t uncompressedOffset; // Offset of the decoded data from the beginning of the asset
+    uint32_t compressedSize; // Equal to uncompressedSize when the chunk did not compress and is stored as is
+    uint32_t uncompressedSize;
+    uint32_t checksum; // CRC-32 of the compressed bytes
+    uint32_t padding;
+};
+
+struct PackageEntry
+{
+    std::string name;
+    AssetCompression compression;
+    uint64_t uncompressedSize;
+    uint32_t firstChunk;
+    uint32_t chunkCount;
+};
+
+struct PackageCodecStatistics
+{
+    uint64_t compressedBytes{0u};
+    uint64_t uncompressedBytes{0u};
+    uint64_t chunkCount{0u};
+    double decodeSeconds{0.0}; // Wall clock time spent decoding, includes reading the compressed data
+
+    double compressionRatio() const;
+    double decodeThroughputMBps() const;
+};
+
+struct PackageStatistics
+{
+    std::array<PackageCodecStatistics, assetCompressionCount> codecs{};
+
+    PackageCodecStatistics total() const;
+};
+
+/**
+ * Builds a package file. Used by the asset cooker.
+ */
+class AssetPackageWriter
+{
+public:
+    static constexpr uint32_t defaultChunkSize = 256u * 1024u;
+
+    AssetPackageWriter(uint32_t chunkSize = defaultChunkSize, int zstdLevel = 19);
+
+    /**
+     * Compress the asset into chunks and keep it in memory until write() is called
+     */
+    void addAsset(std::string_view name, std::span<const std::byte> data, AssetCompression compression);
+
+    void write(const std::string& path) const;
+
+    const PackageStatistics& getStatistics() const { return m_statistics; }
+
+private:
+    uint32_t m_chunkSize;
+    int m_zstdLevel;
+    std::vector<PackageEntry> m_entries;
+    std::vector<PackageChunk> m_chunks;
+    std::vector<std::byte> m_chunkData;
+    PackageStatistics m_statistics;
+};
+
+/**
+ * Read-only view of a package file. Asset chunks are decompressed in parallel directly to the memory given by the caller,
+ * for example a mapped staging buffer.
+ */
+class AssetPackage
+{
+public:
+    AssetPackage(const std::string& path);
+
+    bool contains(std::string_view name) const;
+    const PackageEntry& getEntry(std::string_view name) const;
+    const std::vector<PackageEntry>& getEntries() const { return m_entries; }
+
+    /**
+     * Decompress asset to destination which has to be at least getEntry(name).uncompressedSize bytes.
+     * Throws if a chunk checksum does not match or a chunk fails to decode.
+     */
+    void decompressAsset(std::string_view name, std::span<std::byte> destination);
+
+    std::vector<std::byte> loadAsset(std::string_view name);
+
+    PackageStatistics getStatistics() const;
+
+private:
+    std::vector<std::byte> readChunkRange(const PackageEntry& entry);
+
+    std::string m_path;
+    std::ifstream m_file;
+    std::mutex m_fileMutex;
+    std::vector<PackageEntry> m_entries;
+    std::vector<PackageChunk> m_chunks;
+    std::unordered_map<std::string, size_t> m_entryIndices;
+
+    mutable std::mutex m_statisticsMutex;
+    PackageStatistics m_statistics;
+};
+
+#endif // VULKANPROJECT_ASSETPACKAGE_H
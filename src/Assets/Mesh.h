@@ -0,0 +1,43 @@
+#ifndef VULKANPROJECT_MESH_H
+#define VULKANPROJECT_MESH_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct MeshVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+/**
+ * Indexed triangle list
+ */
+struct Mesh
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+/**
+ * GPU vertex layout, 16 bytes instead of the 32 of MeshVertex
+ */
+struct QuantizedMeshVertex
+{
+    uint16_t position[4]; // R16G16B16A16_SFLOAT, w is 1
+    int16_t normal[2]; // R16G16_SNORM, octahedral encoding
+    uint16_t texCoord[2]; // R16G16_SFLOAT
+};
+
+static_assert(sizeof(QuantizedMeshVertex) == 16);
+
+struct QuantizedMesh
+{
+    std::vector<QuantizedMeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+#endif // VULKANPROJECT_MESH_H
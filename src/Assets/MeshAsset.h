@@ -0,0 +1,22 @@
+#ifndef VULKANPROJECT_MESHASSET_H
+#define VULKANPROJECT_MESHASSET_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Meshes are stored in packages as "<name>/mesh" holding this header followed by the MeshVertex array and the
+ * 32-bit index array.
+ */
+struct MeshAssetHeader
+{
+    uint32_t vertexCount;
+    uint32_t indexCount;
+};
+
+inline std::string getMeshAssetName(const std::string& meshName)
+{
+    return meshName + "/mesh";
+}
+
+#endif // VULKANPROJECT_MESHASSET_H
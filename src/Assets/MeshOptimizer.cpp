@@ -0,0 +1,505 @@
+#include "MeshOptimizer.h"
+
+#include "../Utilities/HalfFloat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+
+constexpr size_t fetchCacheLineSize = 64u;
+constexpr uint32_t fetchCacheLineCount = 64u;
+
+/**
+ * Triangles using each vertex, in compressed row form
+ */
+struct VertexAdjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+VertexAdjacency buildAdjacency(std::span<const uint32_t> indices, size_t vertexCount)
+{
+    VertexAdjacency adjacency{};
+    adjacency.offsets.assign(vertexCount + 1, 0u);
+    for (const uint32_t index : indices)
+    {
+        ++adjacency.offsets[index + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+    std::vector<uint32_t> writePositions(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.triangles.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        adjacency.triangles[writePositions[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+    return adjacency;
+}
+
+/**
+ * FIFO cache simulated with insertion timestamps. A vertex is cached while fewer than cacheSize misses happened after
+ * it was inserted.
+ */
+class VertexCacheSimulator
+{
+public:
+    VertexCacheSimulator(size_t vertexCount, uint32_t cacheSize) :
+        m_insertionTimes(vertexCount, 0u),
+        m_time(cacheSize + 1u),
+        m_cacheSize(cacheSize)
+    {
+    }
+
+    /**
+     * @return True on a cache miss
+     */
+    bool access(uint32_t vertex)
+    {
+        if (m_time - m_insertionTimes[vertex] > m_cacheSize)
+        {
+            m_insertionTimes[vertex] = m_time++;
+            return true;
+        }
+        return false;
+    }
+
+    void reset()
+    {
+        // Jumping ahead in time evicts everything without touching the timestamps
+        m_time += m_cacheSize + 1u;
+    }
+
+private:
+    std::vector<uint64_t> m_insertionTimes;
+    uint64_t m_time;
+    uint32_t m_cacheSize;
+};
+
+struct VertexHasher
+{
+    size_t operator()(const MeshVertex& vertex) const
+    {
+        return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(&vertex), sizeof(MeshVertex)));
+    }
+};
+
+struct VertexBitwiseEqual
+{
+    bool operator()(const MeshVertex& a, const MeshVertex& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+    }
+};
+
+void validateIndices(std::span<const uint32_t> indices, size_t vertexCount)
+{
+    if (indices.size() % 3 != 0)
+    {
+        throw std::runtime_error("Mesh index count is not a multiple of three!");
+    }
+    for (const uint32_t index : indices)
+    {
+        if (index >= vertexCount)
+        {
+            throw std::runtime_error("Mesh index out of range!");
+        }
+    }
+}
+
+float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+int16_t toSnorm16(float value)
+{
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+} // namespace
+
+namespace MeshOptimization
+{
+
+void deduplicateVertices(Mesh& mesh)
+{
+    validateIndices(mesh.indices, mesh.vertices.size());
+
+    std::unordered_map<MeshVertex, uint32_t, VertexHasher, VertexBitwiseEqual> uniqueVertices;
+    uniqueVertices.reserve(mesh.vertices.size());
+
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> remap(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        const auto [it, inserted] = uniqueVertices.try_emplace(mesh.vertices[i], static_cast<uint32_t>(vertices.size()));
+        if (inserted)
+        {
+            vertices.push_back(mesh.vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    for (uint32_t& index : mesh.indices)
+    {
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+    validateIndices(indices, vertexCount);
+
+    const size_t triangleCount = indices.size() / 3;
+    const VertexAdjacency adjacency = buildAdjacency(indices, vertexCount);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        liveTriangles[vertex] = adjacency.offsets[vertex + 1] - adjacency.offsets[vertex];
+    }
+
+    std::vector<uint64_t> cacheTimes(vertexCount, 0u);
+    uint64_t time = cacheSize + 1u;
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    size_t cursor = 0;
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    // Dead ends continue from recently used vertices first, then from the next vertex in input order
+    auto skipDeadEnd = [&]() -> int64_t
+    {
+        while (!deadEndStack.empty())
+        {
+            const uint32_t vertex = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+        for (; cursor < vertexCount; ++cursor)
+        {
+            if (liveTriangles[cursor] > 0)
+            {
+                return static_cast<int64_t>(cursor++);
+            }
+        }
+        return -1;
+    };
+
+    int64_t fanningVertex = skipDeadEnd();
+    while (fanningVertex >= 0)
+    {
+        // Emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for (uint32_t i = adjacency.offsets[fanningVertex]; i < adjacency.offsets[fanningVertex + 1]; ++i)
+        {
+            const uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                if (time - cacheTimes[vertex] > cacheSize)
+                {
+                    cacheTimes[vertex] = time++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Next fanning vertex is the one that stays in the cache longest while its remaining triangles are emitted
+        int64_t nextVertex = -1;
+        int64_t bestPriority = -1;
+        for (const uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            const int64_t age = static_cast<int64_t>(time - cacheTimes[vertex]);
+            if (age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= static_cast<int64_t>(cacheSize))
+            {
+                priority = age;
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+        fanningVertex = nextVertex >= 0 ? nextVertex : skipDeadEnd();
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const MeshVertex> vertices, float threshold, uint32_t cacheSize)
+{
+    validateIndices(indices, vertices.size());
+
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Hard boundaries are where the cache optimized order restarts, a triangle missing all three vertices
+    std::vector<uint32_t> hardBoundaries;
+    VertexCacheSimulator cache(vertices.size(), cacheSize);
+    uint32_t totalMisses = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        uint32_t misses = 0;
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            misses += cache.access(indices[triangle * 3 + corner]) ? 1u : 0u;
+        }
+        if (misses == 3)
+        {
+            hardBoundaries.push_back(static_cast<uint32_t>(triangle));
+        }
+        totalMisses += misses;
+    }
+    if (hardBoundaries.empty() || hardBoundaries.front() != 0)
+    {
+        hardBoundaries.insert(hardBoundaries.begin(), 0u);
+    }
+    hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Split hard clusters further wherever the part since the last split has a good enough miss ratio on its own
+    const float maxClusterAcmr = threshold * static_cast<float>(totalMisses) / static_cast<float>(triangleCount);
+    std::vector<uint32_t> clusterStarts;
+    for (size_t hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); ++hardCluster)
+    {
+        const uint32_t end = hardBoundaries[hardCluster + 1];
+        uint32_t clusterStart = hardBoundaries[hardCluster];
+        uint32_t clusterMisses = 0;
+        clusterStarts.push_back(clusterStart);
+        cache.reset();
+
+        for (uint32_t triangle = clusterStart; triangle < end; ++triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                clusterMisses += cache.access(indices[triangle * 3 + corner]) ? 1u : 0u;
+            }
+            const float clusterAcmr = static_cast<float>(clusterMisses) / static_cast<float>(triangle - clusterStart + 1);
+            if (triangle + 1 < end && clusterAcmr <= maxClusterAcmr)
+            {
+                clusterStart = triangle + 1;
+                clusterMisses = 0;
+                clusterStarts.push_back(clusterStart);
+                cache.reset();
+            }
+        }
+    }
+    clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+    // Sort clusters by how much they face away from the mesh center, outward facing clusters occlude the rest
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        float clusterArea = 0.0f;
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+        {
+            const glm::vec3& a = vertices[indices[triangle * 3 + 0]].position;
+            const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+            const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+
+            const glm::vec3 areaNormal = glm::cross(b - a, c - a); // Length is twice the area
+            const float area = glm::length(areaNormal);
+            clusterCentroids[cluster] += (a + b + c) * (area / 3.0f);
+            clusterNormals[cluster] += areaNormal;
+            clusterArea += area;
+        }
+        meshCentroid += clusterCentroids[cluster];
+        meshArea += clusterArea;
+        clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : glm::vec3(0.0f);
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : glm::vec3(0.0f);
+
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        const float normalLength = glm::length(clusterNormals[cluster]);
+        sortKeys[cluster] = normalLength > 0.0f ? glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster] / normalLength) : 0.0f;
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t a, uint32_t b)
+                     {
+                         return sortKeys[a] > sortKeys[b];
+                     });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (const uint32_t cluster : clusterOrder)
+    {
+        output.insert(output.end(), indices.begin() + size_t(clusterStarts[cluster]) * 3, indices.begin() + size_t(clusterStarts[cluster + 1]) * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeVertexFetch(Mesh& mesh)
+{
+    validateIndices(mesh.indices, mesh.vertices.size());
+
+    constexpr uint32_t unassigned = ~0u;
+    std::vector<uint32_t> remap(mesh.vertices.size(), unassigned);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (uint32_t& index : mesh.indices)
+    {
+        if (remap[index] == unassigned)
+        {
+            remap[index] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+MeshOptimizationReport optimizeMesh(Mesh& mesh)
+{
+    MeshOptimizationReport report{};
+    report.inputVertexCount = mesh.vertices.size();
+    report.cacheBefore = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    report.fetchBefore = analyzeVertexFetch(mesh.indices, mesh.vertices.size(), sizeof(MeshVertex));
+
+    deduplicateVertices(mesh);
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeOverdraw(mesh.indices, mesh.vertices);
+    optimizeVertexFetch(mesh);
+
+    report.outputVertexCount = mesh.vertices.size();
+    report.cacheAfter = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+    report.fetchAfter = analyzeVertexFetch(mesh.indices, mesh.vertices.size(), sizeof(MeshVertex));
+    return report;
+}
+
+glm::vec2 encodeOctahedral(glm::vec3 normal)
+{
+    normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (normal.z < 0.0f)
+    {
+        return glm::vec2((1.0f - std::abs(normal.y)) * signNotZero(normal.x), (1.0f - std::abs(normal.x)) * signNotZero(normal.y));
+    }
+    return glm::vec2(normal.x, normal.y);
+}
+
+glm::vec3 decodeOctahedral(glm::vec2 encoded)
+{
+    glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+    if (normal.z < 0.0f)
+    {
+        normal.x = (1.0f - std::abs(encoded.y)) * signNotZero(encoded.x);
+        normal.y = (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y);
+    }
+    return glm::normalize(normal);
+}
+
+QuantizedMesh quantizeMesh(const Mesh& mesh)
+{
+    QuantizedMesh quantized{};
+    quantized.indices = mesh.indices;
+    quantized.vertices.resize(mesh.vertices.size());
+
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        const MeshVertex& vertex = mesh.vertices[i];
+        QuantizedMeshVertex& quantizedVertex = quantized.vertices[i];
+
+        quantizedVertex.position[0] = HalfFloat::fromFloat(vertex.position.x);
+        quantizedVertex.position[1] = HalfFloat::fromFloat(vertex.position.y);
+        quantizedVertex.position[2] = HalfFloat::fromFloat(vertex.position.z);
+        quantizedVertex.position[3] = HalfFloat::fromFloat(1.0f);
+
+        const bool hasNormal = glm::dot(vertex.normal, vertex.normal) > 0.0f;
+        const glm::vec2 normal = hasNormal ? encodeOctahedral(vertex.normal) : glm::vec2(0.0f, 0.0f);
+        quantizedVertex.normal[0] = toSnorm16(normal.x);
+        quantizedVertex.normal[1] = toSnorm16(normal.y);
+
+        quantizedVertex.texCoord[0] = HalfFloat::fromFloat(vertex.texCoord.x);
+        quantizedVertex.texCoord[1] = HalfFloat::fromFloat(vertex.texCoord.y);
+    }
+    return quantized;
+}
+
+VertexCacheStatistics analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize)
+{
+    validateIndices(indices, vertexCount);
+
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    size_t referencedCount = 0;
+
+    VertexCacheStatistics statistics{};
+    for (const uint32_t index : indices)
+    {
+        statistics.vertexTransforms += cache.access(index) ? 1u : 0u;
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++referencedCount;
+        }
+    }
+
+    const size_t triangleCount = indices.size() / 3;
+    statistics.acmr = triangleCount > 0 ? static_cast<float>(statistics.vertexTransforms) / static_cast<float>(triangleCount) : 0.0f;
+    statistics.atvr = referencedCount > 0 ? static_cast<float>(statistics.vertexTransforms) / static_cast<float>(referencedCount) : 0.0f;
+    return statistics;
+}
+
+VertexFetchStatistics analyzeVertexFetch(std::span<const uint32_t> indices, size_t vertexCount, size_t vertexSize)
+{
+    validateIndices(indices, vertexCount);
+
+    const size_t lineCount = (vertexCount * vertexSize + fetchCacheLineSize - 1) / fetchCacheLineSize;
+    VertexCacheSimulator cache(lineCount, fetchCacheLineCount);
+
+    VertexFetchStatistics statistics{};
+    for (const uint32_t index : indices)
+    {
+        const size_t firstLine = index * vertexSize / fetchCacheLineSize;
+        const size_t lastLine = ((index + 1) * vertexSize - 1) / fetchCacheLineSize;
+        for (size_t line = firstLine; line <= lastLine; ++line)
+        {
+            statistics.bytesFetched += cache.access(static_cast<uint32_t>(line)) ? fetchCacheLineSize : 0u;
+        }
+    }
+
+    const size_t bufferSize = vertexCount * vertexSize;
+    statistics.overfetch = bufferSize > 0 ? static_cast<float>(statistics.bytesFetched) / static_cast<float>(bufferSize) : 0.0f;
+    return statistics;
+}
+
+}
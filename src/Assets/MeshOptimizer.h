@@ -0,0 +1,88 @@
+#ifndef VULKANPROJECT_MESHOPTIMIZER_H
+#define VULKANPROJECT_MESHOPTIMIZER_H
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+struct VertexCacheStatistics
+{
+    uint32_t vertexTransforms; // Cache misses
+    float acmr; // Average cache miss ratio, transforms per triangle. 0.5 is the ideal for large regular meshes.
+    float atvr; // Average transform to vertex ratio, 1 is the ideal
+};
+
+struct VertexFetchStatistics
+{
+    uint64_t bytesFetched;
+    float overfetch; // Bytes fetched over vertex buffer size, 1 is the ideal
+};
+
+struct MeshOptimizationReport
+{
+    size_t inputVertexCount;
+    size_t outputVertexCount;
+    VertexCacheStatistics cacheBefore;
+    VertexCacheStatistics cacheAfter;
+    VertexFetchStatistics fetchBefore;
+    VertexFetchStatistics fetchAfter;
+};
+
+/**
+ * Mesh processing stage run on meshes as they are loaded, before they are uploaded or split into meshlets
+ */
+namespace MeshOptimization
+{
+
+constexpr uint32_t defaultCacheSize = 16u;
+
+/**
+ * Merge bitwise identical vertices and remap the indices
+ */
+void deduplicateVertices(Mesh& mesh);
+
+/**
+ * Reorder triangles for the post-transform vertex cache using Tipsify (Sander et al. 2007)
+ */
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+/**
+ * Reorder clusters of triangles so that outward facing clusters are drawn first, which reduces overdraw from any
+ * view direction. Expects indices already optimized with optimizeVertexCache(). Clusters are only split where the
+ * cache miss ratio stays within threshold times the ratio of the whole mesh.
+ */
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const MeshVertex> vertices, float threshold = 1.05f, uint32_t cacheSize = defaultCacheSize);
+
+/**
+ * Reorder vertices in the order the indices first reference them and drop unreferenced vertices
+ */
+void optimizeVertexFetch(Mesh& mesh);
+
+/**
+ * Run deduplication, vertex cache, overdraw and vertex fetch optimization in that order
+ */
+MeshOptimizationReport optimizeMesh(Mesh& mesh);
+
+/**
+ * Half float positions and texture coordinates, octahedral normals
+ */
+QuantizedMesh quantizeMesh(const Mesh& mesh);
+
+glm::vec2 encodeOctahedral(glm::vec3 normal);
+glm::vec3 decodeOctahedral(glm::vec2 encoded);
+
+/**
+ * Simulate a FIFO post-transform cache
+ */
+VertexCacheStatistics analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+/**
+ * Simulate fetching vertices through a small cache of 64 byte lines
+ */
+VertexFetchStatistics analyzeVertexFetch(std::span<const uint32_t> indices, size_t vertexCount, size_t vertexSize);
+
+}
+
+#endif // VULKANPROJECT_MESHOPTIMIZER_H
@@ -0,0 +1,360 @@
+#include "MeshSimplifier.h"
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+
+namespace
+{
+
+constexpr uint32_t noCollapse = std::numeric_limits<uint32_t>::max();
+constexpr size_t maxPasses = 100;
+
+// Levels that keep more than this fraction of the previous level's triangles are not worth storing
+constexpr float minLodReduction = 0.85f;
+
+/**
+ * Sum of squared distances to area weighted planes, kept as the symmetric matrix A, vector b and constant c of
+ * p'Ap + 2b'p + c
+ */
+struct Quadric
+{
+    double a00, a01, a02, a11, a12, a22;
+    double b0, b1, b2;
+    double c;
+    double weight;
+
+    Quadric& operator+=(const Quadric& other)
+    {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02;
+        a11 += other.a11; a12 += other.a12; a22 += other.a22;
+        b0 += other.b0; b1 += other.b1; b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+};
+
+Quadric makePlaneQuadric(glm::vec3 normal, float distance, float weight)
+{
+    const double x = normal.x, y = normal.y, z = normal.z, d = distance, w = weight;
+    return Quadric{w * x * x, w * x * y, w * x * z, w * y * y, w * y * z, w * z * z, w * d * x, w * d * y, w * d * z, w * d * d, w};
+}
+
+/**
+ * Mean squared distance of the point to the planes accumulated in both quadrics
+ */
+float evaluateQuadrics(const Quadric& first, const Quadric& second, glm::vec3 point)
+{
+    Quadric q = first;
+    q += second;
+    const double x = point.x, y = point.y, z = point.z;
+    const double error = x * x * q.a00 + y * y * q.a11 + z * z * q.a22 + 2.0 * (x * y * q.a01 + x * z * q.a02 + y * z * q.a12)
+                       + 2.0 * (x * q.b0 + y * q.b1 + z * q.b2) + q.c;
+    return q.weight > 0.0 ? static_cast<float>(std::max(error, 0.0) / q.weight) : 0.0f;
+}
+
+/**
+ * First vertex with the same position as each vertex, so topology is tracked across attribute seams
+ */
+std::vector<uint32_t> buildPositionRemap(std::span<const MeshVertex> vertices)
+{
+    std::vector<uint32_t> order(vertices.size());
+    std::iota(order.begin(), order.end(), 0u);
+    auto key = [&vertices](uint32_t vertex)
+    {
+        const glm::vec3& position = vertices[vertex].position;
+        return std::make_tuple(position.x, position.y, position.z);
+    };
+    std::sort(order.begin(), order.end(), [&key](uint32_t a, uint32_t b) { return key(a) < key(b) || (key(a) == key(b) && a < b); });
+
+    std::vector<uint32_t> remap(vertices.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        remap[order[i]] = i > 0 && key(order[i]) == key(order[i - 1]) ? remap[order[i - 1]] : order[i];
+    }
+    return remap;
+}
+
+struct Adjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+Adjacency buildAdjacency(std::span<const uint32_t> indices, std::span<const uint32_t> positionRemap)
+{
+    Adjacency adjacency{std::vector<uint32_t>(positionRemap.size() + 1, 0u), std::vector<uint32_t>(indices.size())};
+    for (const uint32_t index : indices)
+    {
+        ++adjacency.offsets[positionRemap[index] + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+    std::vector<uint32_t> writePositions(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        adjacency.triangles[writePositions[positionRemap[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+    }
+    return adjacency;
+}
+
+struct Collapse
+{
+    uint32_t from;
+    uint32_t to;
+    float error;
+};
+
+} // namespace
+
+namespace MeshSimplification
+{
+
+SimplifiedIndices simplify(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, size_t targetIndexCount, float maxError)
+{
+    if (indices.size() % 3 != 0 || std::any_of(indices.begin(), indices.end(), [&vertices](uint32_t index) { return index >= vertices.size(); }))
+    {
+        throw std::runtime_error("Invalid mesh given to the mesh simplifier!");
+    }
+
+    SimplifiedIndices output{std::vector<uint32_t>(indices.begin(), indices.end()), 0.0f};
+    const std::vector<uint32_t> positionRemap = buildPositionRemap(vertices);
+    auto position = [&vertices](uint32_t vertex) -> const glm::vec3& { return vertices[vertex].position; };
+
+    // Vertices with several attribute sets at one position lie on a seam
+    std::vector<uint32_t> wedgeCounts(vertices.size(), 0u);
+    for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+    {
+        ++wedgeCounts[positionRemap[vertex]];
+    }
+
+    // Edges not shared by exactly two triangles lie on an open border or a non-manifold junction
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t a = positionRemap[indices[i + corner]];
+            const uint32_t b = positionRemap[indices[i + (corner + 1) % 3]];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<bool> locked(vertices.size(), false);
+    for (size_t i = 0; i < edges.size();)
+    {
+        size_t end = i + 1;
+        while (end < edges.size() && edges[end] == edges[i])
+        {
+            ++end;
+        }
+        if (end - i != 2)
+        {
+            locked[edges[i].first] = true;
+            locked[edges[i].second] = true;
+        }
+        i = end;
+    }
+    for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+    {
+        locked[vertex] = locked[vertex] || wedgeCounts[vertex] > 1;
+    }
+
+    std::vector<Quadric> quadrics(vertices.size(), Quadric{});
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const glm::vec3& a = position(indices[i]);
+        const glm::vec3 cross = glm::cross(position(indices[i + 1]) - a, position(indices[i + 2]) - a);
+        const float length = glm::length(cross);
+        if (length == 0.0f)
+        {
+            continue;
+        }
+        const glm::vec3 normal = cross / length;
+        const Quadric quadric = makePlaneQuadric(normal, -glm::dot(normal, a), length * 0.5f);
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            quadrics[positionRemap[indices[i + corner]]] += quadric;
+        }
+    }
+
+    const float maxSquaredError = maxError * maxError;
+    float squaredError = 0.0f;
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> collapseTargets(vertices.size());
+    std::vector<bool> touched(vertices.size());
+
+    for (size_t pass = 0; pass < maxPasses && output.indices.size() > targetIndexCount; ++pass)
+    {
+        const Adjacency adjacency = buildAdjacency(output.indices, positionRemap);
+
+        edges.clear();
+        for (size_t i = 0; i < output.indices.size(); i += 3)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t a = positionRemap[output.indices[i + corner]];
+                const uint32_t b = positionRemap[output.indices[i + (corner + 1) % 3]];
+                edges.emplace_back(std::min(a, b), std::max(a, b));
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        collapses.clear();
+        for (const auto& [a, b] : edges)
+        {
+            if (!locked[a])
+            {
+                collapses.push_back(Collapse{a, b, evaluateQuadrics(quadrics[a], quadrics[b], position(b))});
+            }
+            if (!locked[b])
+            {
+                collapses.push_back(Collapse{b, a, evaluateQuadrics(quadrics[a], quadrics[b], position(a))});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // Each collapse only moves one vertex, so collapses sharing no triangles are independent within a pass
+        std::fill(collapseTargets.begin(), collapseTargets.end(), noCollapse);
+        std::fill(touched.begin(), touched.end(), false);
+        const size_t trianglesToRemove = (output.indices.size() - targetIndexCount) / 3;
+        size_t trianglesRemoved = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (trianglesRemoved >= trianglesToRemove || collapse.error > maxSquaredError)
+            {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to])
+            {
+                continue;
+            }
+
+            // The seam side of the target is taken from a triangle on the edge. The source is not on a seam, so all
+            // its triangles are on that side.
+            uint32_t target = noCollapse;
+            size_t removedByCollapse = 0;
+            bool flips = false;
+            for (uint32_t i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; ++i)
+            {
+                const uint32_t* corners = &output.indices[size_t(adjacency.triangles[i]) * 3];
+                const uint32_t* onEdge = std::find_if(corners, corners + 3, [&](uint32_t vertex) { return positionRemap[vertex] == collapse.to; });
+                if (onEdge != corners + 3)
+                {
+                    target = *onEdge;
+                    ++removedByCollapse;
+                    continue;
+                }
+
+                glm::vec3 moved[3];
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    moved[corner] = positionRemap[corners[corner]] == collapse.from ? position(collapse.to) : position(corners[corner]);
+                }
+                const glm::vec3 before = glm::cross(position(corners[1]) - position(corners[0]), position(corners[2]) - position(corners[0]));
+                const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                if (glm::dot(before, before) > 0.0f && glm::dot(before, after) <= 0.0f)
+                {
+                    flips = true;
+                    break;
+                }
+            }
+            if (flips || target == noCollapse)
+            {
+                continue;
+            }
+
+            collapseTargets[collapse.from] = target;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32_t i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; ++i)
+            {
+                const uint32_t* corners = &output.indices[size_t(adjacency.triangles[i]) * 3];
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    touched[positionRemap[corners[corner]]] = true;
+                }
+            }
+            trianglesRemoved += removedByCollapse;
+            squaredError = std::max(squaredError, collapse.error);
+        }
+
+        if (trianglesRemoved == 0)
+        {
+            break;
+        }
+
+        size_t writeIndex = 0;
+        for (size_t i = 0; i < output.indices.size(); i += 3)
+        {
+            uint32_t corners[3];
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = output.indices[i + corner];
+                corners[corner] = collapseTargets[vertex] != noCollapse ? collapseTargets[vertex] : vertex;
+            }
+            const uint32_t a = positionRemap[corners[0]], b = positionRemap[corners[1]], c = positionRemap[corners[2]];
+            if (a == b || b == c || a == c)
+            {
+                continue;
+            }
+            std::copy(corners, corners + 3, output.indices.begin() + static_cast<std::ptrdiff_t>(writeIndex));
+            writeIndex += 3;
+        }
+        output.indices.resize(writeIndex);
+    }
+
+    output.error = std::sqrt(squaredError);
+    return output;
+}
+
+MeshLodChain buildLodChain(const Mesh& mesh, uint32_t maxLodCount, float reductionPerLevel)
+{
+    MeshLodChain chain{};
+
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (const MeshVertex& vertex : mesh.vertices)
+    {
+        minimum = glm::min(minimum, vertex.position);
+        maximum = glm::max(maximum, vertex.position);
+    }
+    chain.boundsCenter = mesh.vertices.empty() ? glm::vec3(0.0f) : (minimum + maximum) * 0.5f;
+    for (const MeshVertex& vertex : mesh.vertices)
+    {
+        chain.boundsRadius = std::max(chain.boundsRadius, glm::distance(vertex.position, chain.boundsCenter));
+    }
+
+    chain.indices = mesh.indices;
+    chain.lods.push_back(MeshLod{0u, static_cast<uint32_t>(mesh.indices.size()), 0.0f});
+
+    std::vector<uint32_t> previous = mesh.indices;
+    float error = 0.0f;
+    while (chain.lods.size() < maxLodCount)
+    {
+        const size_t targetIndexCount = static_cast<size_t>(static_cast<float>(previous.size() / 3) * reductionPerLevel) * 3;
+        SimplifiedIndices level = simplify(mesh.vertices, previous, targetIndexCount, std::numeric_limits<float>::max());
+        if (level.indices.empty() || static_cast<float>(level.indices.size()) > static_cast<float>(previous.size()) * minLodReduction)
+        {
+            break;
+        }
+
+        // Each level is simplified from the previous one, so the distances to the full detail mesh add up
+        error += level.error;
+        MeshOptimization::optimizeVertexCache(level.indices, mesh.vertices.size());
+        chain.lods.push_back(MeshLod{static_cast<uint32_t>(chain.indices.size()), static_cast<uint32_t>(level.indices.size()), error});
+        chain.indices.insert(chain.indices.end(), level.indices.begin(), level.indices.end());
+        previous = std::move(level.indices);
+    }
+    return chain;
+}
+
+}
@@ -0,0 +1,53 @@
+#ifndef VULKANPROJECT_MESHSIMPLIFIER_H
+#define VULKANPROJECT_MESHSIMPLIFIER_H
+
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct SimplifiedIndices
+{
+    std::vector<uint32_t> indices; // Into the unchanged vertex array
+    float error; // Estimated distance from the input surface, in mesh units
+};
+
+struct MeshLod
+{
+    uint32_t firstIndex; // Into MeshLodChain::indices
+    uint32_t indexCount;
+    float error; // Estimated distance from the full detail mesh, in mesh units. Grows with the LOD index.
+};
+
+/**
+ * All levels index the vertex array of the full detail mesh, so a mesh needs only one vertex buffer
+ */
+struct MeshLodChain
+{
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+    glm::vec3 boundsCenter;
+    float boundsRadius;
+};
+
+namespace MeshSimplification
+{
+
+/**
+ * Quadric error metric edge collapse simplification (Garland and Heckbert 1997). Vertices collapse onto neighbouring
+ * vertices, so the vertex array is reused as is. Open borders and attribute seams are kept in place.
+ * Stops at targetIndexCount or when the next collapse would exceed maxError.
+ */
+SimplifiedIndices simplify(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, size_t targetIndexCount, float maxError);
+
+/**
+ * Simplify repeatedly, each level aiming for reductionPerLevel times the triangles of the previous one. Stops early
+ * when a level no longer reduces the triangle count meaningfully. Each level is optimized for the vertex cache.
+ */
+MeshLodChain buildLodChain(const Mesh& mesh, uint32_t maxLodCount = 8u, float reductionPerLevel = 0.5f);
+
+}
+
+#endif // VULKANPROJECT_MESHSIMPLIFIER_H
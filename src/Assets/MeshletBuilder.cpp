@@ -0,0 +1,266 @@
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+
+// Cones wider than this cover nearly a hemisphere and are practically never back facing
+constexpr float minConeDot = 0.1f;
+constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+
+int8_t toSnorm8(float value)
+{
+    return static_cast<int8_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+float fromSnorm8(int8_t value)
+{
+    return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+}
+
+glm::vec3 computeTriangleNormal(std::span<const MeshVertex> vertices, const uint32_t* triangle)
+{
+    const glm::vec3& a = vertices[triangle[0]].position;
+    const glm::vec3 normal = glm::cross(vertices[triangle[1]].position - a, vertices[triangle[2]].position - a);
+    const float length = glm::length(normal);
+    return length > 0.0f ? normal / length : glm::vec3(0.0f);
+}
+
+glm::vec3 normalizeOrZero(glm::vec3 vector)
+{
+    const float length = glm::length(vector);
+    return length > 0.0f ? vector / length : glm::vec3(0.0f);
+}
+
+} // namespace
+
+namespace MeshletGeneration
+{
+
+MeshletMesh buildMeshlets(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, float coneWeight)
+{
+    if (indices.size() % 3 != 0 || std::any_of(indices.begin(), indices.end(), [&vertices](uint32_t index) { return index >= vertices.size(); }))
+    {
+        throw std::runtime_error("Invalid mesh given to the meshlet builder!");
+    }
+
+    const size_t triangleCount = indices.size() / 3;
+    std::vector<glm::vec3> triangleCentroids(triangleCount);
+    std::vector<glm::vec3> triangleNormals(triangleCount);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const uint32_t* corners = &indices[triangle * 3];
+        triangleCentroids[triangle] = (vertices[corners[0]].position + vertices[corners[1]].position + vertices[corners[2]].position) / 3.0f;
+        triangleNormals[triangle] = computeTriangleNormal(vertices, corners);
+    }
+
+    // Triangles using each vertex
+    std::vector<uint32_t> adjacencyOffsets(vertices.size() + 1, 0u);
+    for (const uint32_t index : indices)
+    {
+        ++adjacencyOffsets[index + 1];
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    std::vector<uint32_t> adjacentTriangles(indices.size());
+    std::vector<uint32_t> writePositions(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        adjacentTriangles[writePositions[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> vertexMeshlet(vertices.size(), unassigned); // Meshlet the vertex was last added to
+    std::vector<uint32_t> candidateMeshlet(triangleCount, unassigned);
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> meshletTriangles;
+    size_t nextSeed = 0;
+
+    MeshletMesh output{};
+    output.indices.reserve(indices.size());
+
+    while (output.indices.size() < indices.size())
+    {
+        const uint32_t meshletIndex = static_cast<uint32_t>(output.meshlets.size());
+        uint32_t meshletVertexCount = 0;
+        glm::vec3 centroidSum(0.0f);
+        glm::vec3 normalSum(0.0f);
+        float extent = 0.0f;
+        candidates.clear();
+        meshletTriangles.clear();
+
+        auto addTriangle = [&](uint32_t triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = indices[size_t(triangle) * 3 + corner];
+                if (vertexMeshlet[vertex] == meshletIndex)
+                {
+                    continue;
+                }
+                vertexMeshlet[vertex] = meshletIndex;
+                ++meshletVertexCount;
+                for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+                {
+                    const uint32_t adjacent = adjacentTriangles[i];
+                    if (!emitted[adjacent] && candidateMeshlet[adjacent] != meshletIndex)
+                    {
+                        candidateMeshlet[adjacent] = meshletIndex;
+                        candidates.push_back(adjacent);
+                    }
+                }
+            }
+            emitted[triangle] = true;
+            meshletTriangles.push_back(triangle);
+
+            centroidSum += triangleCentroids[triangle];
+            normalSum += triangleNormals[triangle];
+            extent = std::max(extent, glm::distance(triangleCentroids[triangle], centroidSum / static_cast<float>(meshletTriangles.size())));
+        };
+
+        while (emitted[nextSeed])
+        {
+            ++nextSeed;
+        }
+        addTriangle(static_cast<uint32_t>(nextSeed));
+
+        while (meshletTriangles.size() < maxMeshletTriangles)
+        {
+            const glm::vec3 center = centroidSum / static_cast<float>(meshletTriangles.size());
+            const glm::vec3 axis = normalizeOrZero(normalSum);
+            const float distanceScale = 1.0f / std::max(extent, std::numeric_limits<float>::epsilon());
+
+            uint32_t bestTriangle = unassigned;
+            uint32_t bestNewVertices = 4;
+            float bestCost = std::numeric_limits<float>::max();
+
+            for (size_t i = 0; i < candidates.size();)
+            {
+                const uint32_t triangle = candidates[i];
+                if (emitted[triangle])
+                {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                ++i;
+
+                uint32_t newVertices = 0;
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    newVertices += vertexMeshlet[indices[size_t(triangle) * 3 + corner]] != meshletIndex ? 1u : 0u;
+                }
+                if (meshletVertexCount + newVertices > maxMeshletVertices || newVertices > bestNewVertices)
+                {
+                    continue;
+                }
+
+                const float distanceCost = glm::distance(triangleCentroids[triangle], center) * distanceScale;
+                const float coneCost = coneWeight * (1.0f - glm::dot(triangleNormals[triangle], axis));
+                const float cost = distanceCost + coneCost;
+                if (newVertices < bestNewVertices || cost < bestCost)
+                {
+                    bestTriangle = triangle;
+                    bestNewVertices = newVertices;
+                    bestCost = cost;
+                }
+            }
+
+            // Disconnected pieces start new meshlets rather than stretching this one
+            if (bestTriangle == unassigned)
+            {
+                break;
+            }
+            addTriangle(bestTriangle);
+        }
+
+        PackedMeshlet meshlet{};
+        meshlet.firstIndex = static_cast<uint32_t>(output.indices.size());
+        meshlet.triangleCount = static_cast<uint32_t>(meshletTriangles.size());
+        for (const uint32_t triangle : meshletTriangles)
+        {
+            output.indices.insert(output.indices.end(), indices.begin() + size_t(triangle) * 3, indices.begin() + size_t(triangle) * 3 + 3);
+        }
+        computeMeshletBounds(vertices, std::span(output.indices).subspan(meshlet.firstIndex), meshlet);
+        output.meshlets.push_back(meshlet);
+    }
+    return output;
+}
+
+void computeMeshletBounds(std::span<const MeshVertex> vertices, std::span<const uint32_t> triangleIndices, PackedMeshlet& meshlet)
+{
+    // Sphere around the bounding box center
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(std::numeric_limits<float>::lowest());
+    for (const uint32_t index : triangleIndices)
+    {
+        minimum = glm::min(minimum, vertices[index].position);
+        maximum = glm::max(maximum, vertices[index].position);
+    }
+    const glm::vec3 center = (minimum + maximum) * 0.5f;
+    float radius = 0.0f;
+    for (const uint32_t index : triangleIndices)
+    {
+        radius = std::max(radius, glm::distance(vertices[index].position, center));
+    }
+    meshlet.center[0] = center.x;
+    meshlet.center[1] = center.y;
+    meshlet.center[2] = center.z;
+    meshlet.radius = radius;
+
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = 0; i + 2 < triangleIndices.size(); i += 3)
+    {
+        normalSum += computeTriangleNormal(vertices, &triangleIndices[i]);
+    }
+
+    // The spread is measured against the quantized axis, so the stored cone stays conservative
+    const glm::vec3 axis = normalizeOrZero(normalSum);
+    const int8_t packedAxis[3] = {toSnorm8(axis.x), toSnorm8(axis.y), toSnorm8(axis.z)};
+    const glm::vec3 quantizedAxis = normalizeOrZero(glm::vec3(fromSnorm8(packedAxis[0]), fromSnorm8(packedAxis[1]), fromSnorm8(packedAxis[2])));
+
+    float minDot = glm::length(quantizedAxis) > 0.0f ? 1.0f : -1.0f;
+    for (size_t i = 0; i + 2 < triangleIndices.size(); i += 3)
+    {
+        const glm::vec3 normal = computeTriangleNormal(vertices, &triangleIndices[i]);
+        if (glm::dot(normal, normal) > 0.0f)
+        {
+            minDot = std::min(minDot, glm::dot(normal, quantizedAxis));
+        }
+    }
+
+    int8_t packedCutoff = 127;
+    if (minDot > minConeDot)
+    {
+        const float cutoff = std::sqrt(1.0f - minDot * minDot);
+        packedCutoff = static_cast<int8_t>(std::min(std::ceil(cutoff * 127.0f), 127.0f));
+    }
+
+    meshlet.cone = uint32_t(uint8_t(packedAxis[0])) | (uint32_t(uint8_t(packedAxis[1])) << 8) | (uint32_t(uint8_t(packedAxis[2])) << 16) | (uint32_t(uint8_t(packedCutoff)) << 24);
+}
+
+MeshletCone unpackMeshletCone(uint32_t packedCone)
+{
+    const glm::vec3 axis(fromSnorm8(static_cast<int8_t>(packedCone & 0xFFu)),
+                         fromSnorm8(static_cast<int8_t>((packedCone >> 8) & 0xFFu)),
+                         fromSnorm8(static_cast<int8_t>((packedCone >> 16) & 0xFFu)));
+    return MeshletCone{normalizeOrZero(axis), fromSnorm8(static_cast<int8_t>(packedCone >> 24))};
+}
+
+bool isMeshletBackFacing(const PackedMeshlet& meshlet, glm::vec3 cameraPosition)
+{
+    const MeshletCone cone = unpackMeshletCone(meshlet.cone);
+    if (cone.cutoff >= 1.0f)
+    {
+        return false;
+    }
+    // Every point of the sphere has to see the cone from behind
+    const glm::vec3 toCenter = glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2]) - cameraPosition;
+    return glm::dot(toCenter, cone.axis) >= cone.cutoff * glm::length(toCenter) + meshlet.radius * (1.0f + cone.cutoff);
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef VULKANPROJECT_MESHLETBUILDER_H
+#define VULKANPROJECT_MESHLETBUILDER_H
+
+#include "Mesh.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * GPU layout of one cluster, read by shaders/include/Meshlets.glsl. Bounds are in mesh space.
+ */
+struct PackedMeshlet
+{
+    float center[3]; // Bounding sphere
+    float radius;
+    uint32_t cone; // Normal cone axis xyz and cutoff as snorm8, x in the lowest byte. Cutoff 127 means never back facing.
+    uint32_t firstIndex; // Into MeshletMesh::indices
+    uint32_t triangleCount;
+    int32_t vertexOffset; // Added to the indices when drawn, zero until the mesh is placed in a shared vertex buffer
+};
+
+static_assert(sizeof(PackedMeshlet) == 32);
+
+/**
+ * Mesh whose index buffer is ordered so that the triangles of each meshlet are contiguous
+ */
+struct MeshletMesh
+{
+    std::vector<PackedMeshlet> meshlets;
+    std::vector<uint32_t> indices;
+};
+
+struct MeshletCone
+{
+    glm::vec3 axis;
+    float cutoff; // Sine of the cone spread, 1 when the cone covers a hemisphere or more
+};
+
+namespace MeshletGeneration
+{
+
+constexpr uint32_t maxMeshletVertices = 64u;
+constexpr uint32_t maxMeshletTriangles = 124u;
+
+/**
+ * Grow meshlets over triangle adjacency, preferring triangles that add the fewest new vertices and then those
+ * closest to the meshlet and best aligned with its normal cone. coneWeight trades spatial compactness for tighter
+ * cones, that is more back facing clusters culled.
+ */
+MeshletMesh buildMeshlets(std::span<const MeshVertex> vertices, std::span<const uint32_t> indices, float coneWeight = 0.25f);
+
+/**
+ * Bounding sphere and normal cone of triangles, already quantized the way PackedMeshlet stores them
+ */
+void computeMeshletBounds(std::span<const MeshVertex> vertices, std::span<const uint32_t> triangleIndices, PackedMeshlet& meshlet);
+
+MeshletCone unpackMeshletCone(uint32_t packedCone);
+
+/**
+ * CPU version of the cone test in shaders/ClusterCulling.comp, true when no triangle can face the camera
+ */
+bool isMeshletBackFacing(const PackedMeshlet& meshlet, glm::vec3 cameraPosition);
+
+}
+
+#endif // VULKANPROJECT_MESHLETBUILDER_H
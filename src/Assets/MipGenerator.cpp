@@ -0,0 +1,557 @@
+#include "MipGenerator.h"
+
+#include "../Utilities/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MIP_GENERATION_AVX2
+#define MIP_GENERATION_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIP_GENERATION_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIP_GENERATION_NEON
+#endif
+
+namespace
+{
+
+constexpr float kaiserAlpha = 4.0f;
+constexpr float kaiserRadius = 2.0f; // In destination pixels
+constexpr uint32_t rowsPerTask = 16u;
+constexpr size_t linearToSrgbTableSize = 1u << 14;
+
+struct FilterWeights
+{
+    uint32_t tapCount;
+    std::vector<uint32_t> indices; // tapCount source indices per destination pixel, clamped to the image
+    std::vector<float> weights;
+};
+
+float besselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    const float halfX = 0.5f * x;
+    for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+    {
+        const float factor = halfX / static_cast<float>(k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+float sinc(float x)
+{
+    if (std::abs(x) < 1e-6f)
+    {
+        return 1.0f;
+    }
+    const float piX = std::numbers::pi_v<float> * x;
+    return std::sin(piX) / piX;
+}
+
+/**
+ * The footprint is conservative, so most destination pixels have zero weights at the edges. Drop them to get the
+ * smallest tap count that covers every destination pixel.
+ */
+FilterWeights trimZeroTaps(const FilterWeights& filterWeights, uint32_t destinationSize)
+{
+    const uint32_t tapCount = filterWeights.tapCount;
+    std::vector<uint32_t> firstTaps(destinationSize);
+    uint32_t trimmedTapCount = 1;
+
+    for (uint32_t destination = 0; destination < destinationSize; ++destination)
+    {
+        const float* weights = &filterWeights.weights[size_t(destination) * tapCount];
+        uint32_t firstTap = 0;
+        uint32_t lastTap = tapCount - 1;
+        while (firstTap < lastTap && weights[firstTap] == 0.0f)
+        {
+            ++firstTap;
+        }
+        while (lastTap > firstTap && weights[lastTap] == 0.0f)
+        {
+            --lastTap;
+        }
+        firstTaps[destination] = firstTap;
+        trimmedTapCount = std::max(trimmedTapCount, lastTap - firstTap + 1);
+    }
+
+    FilterWeights trimmed{};
+    trimmed.tapCount = trimmedTapCount;
+    trimmed.indices.resize(size_t(destinationSize) * trimmedTapCount);
+    trimmed.weights.resize(size_t(destinationSize) * trimmedTapCount);
+
+    for (uint32_t destination = 0; destination < destinationSize; ++destination)
+    {
+        for (uint32_t tap = 0; tap < trimmedTapCount; ++tap)
+        {
+            // Taps past the end of the original footprint repeat its last index with zero weight
+            const uint32_t sourceTap = std::min(firstTaps[destination] + tap, tapCount - 1);
+            const bool inFootprint = firstTaps[destination] + tap < tapCount;
+            trimmed.indices[size_t(destination) * trimmedTapCount + tap] = filterWeights.indices[size_t(destination) * tapCount + sourceTap];
+            trimmed.weights[size_t(destination) * trimmedTapCount + tap] = inFootprint ? filterWeights.weights[size_t(destination) * tapCount + sourceTap] : 0.0f;
+        }
+    }
+    return trimmed;
+}
+
+FilterWeights computeFilterWeights(uint32_t sourceSize, uint32_t destinationSize, MipFilter filter)
+{
+    const float scale = static_cast<float>(sourceSize) / static_cast<float>(destinationSize);
+    const float support = filter == MipFilter::Box ? 0.5f * scale : kaiserRadius * scale;
+    const float kaiserNormalization = 1.0f / besselI0(kaiserAlpha);
+
+    FilterWeights filterWeights{};
+    filterWeights.tapCount = static_cast<uint32_t>(std::ceil(2.0f * support)) + 1;
+    filterWeights.indices.resize(size_t(destinationSize) * filterWeights.tapCount);
+    filterWeights.weights.resize(size_t(destinationSize) * filterWeights.tapCount);
+
+    for (uint32_t destination = 0; destination < destinationSize; ++destination)
+    {
+        const float center = (static_cast<float>(destination) + 0.5f) * scale;
+        const int firstSource = static_cast<int>(std::floor(center - support));
+        uint32_t* indices = &filterWeights.indices[size_t(destination) * filterWeights.tapCount];
+        float* weights = &filterWeights.weights[size_t(destination) * filterWeights.tapCount];
+
+        float weightSum = 0.0f;
+        for (uint32_t tap = 0; tap < filterWeights.tapCount; ++tap)
+        {
+            const int source = firstSource + static_cast<int>(tap);
+            float weight = 0.0f;
+
+            if (filter == MipFilter::Box)
+            {
+                const float overlapBegin = std::max(static_cast<float>(source), center - support);
+                const float overlapEnd = std::min(static_cast<float>(source + 1), center + support);
+                weight = std::max(overlapEnd - overlapBegin, 0.0f);
+            }
+            else
+            {
+                const float t = (static_cast<float>(source) + 0.5f - center) / scale;
+                const float x = t / kaiserRadius;
+                if (std::abs(x) < 1.0f)
+                {
+                    weight = sinc(t) * besselI0(kaiserAlpha * std::sqrt(1.0f - x * x)) * kaiserNormalization;
+                }
+            }
+
+            indices[tap] = static_cast<uint32_t>(std::clamp(source, 0, static_cast<int>(sourceSize) - 1));
+            weights[tap] = weight;
+            weightSum += weight;
+        }
+        for (uint32_t tap = 0; tap < filterWeights.tapCount; ++tap)
+        {
+            weights[tap] /= weightSum;
+        }
+    }
+    return trimZeroTaps(filterWeights, destinationSize);
+}
+
+float srgbToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+const std::array<float, 256>& getSrgbToLinearTable()
+{
+    static const std::array<float, 256> table = []()
+    {
+        std::array<float, 256> values{};
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = srgbToLinear(static_cast<float>(i) / 255.0f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+const std::vector<uint8_t>& getLinearToSrgbTable()
+{
+    static const std::vector<uint8_t> table = []()
+    {
+        std::vector<uint8_t> values(linearToSrgbTableSize);
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            const float linear = static_cast<float>(i) / static_cast<float>(linearToSrgbTableSize - 1);
+            values[i] = static_cast<uint8_t>(linearToSrgb(linear) * 255.0f + 0.5f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+template<typename Function>
+void forEachRowGroup(uint32_t rowCount, Function function)
+{
+    const uint32_t groupCount = (rowCount + rowsPerTask - 1) / rowsPerTask;
+    auto processGroup = [&](size_t group)
+    {
+        const uint32_t firstRow = static_cast<uint32_t>(group) * rowsPerTask;
+        function(firstRow, std::min(firstRow + rowsPerTask, rowCount));
+    };
+
+    // Small levels are not worth waking up worker threads for
+    if (groupCount <= 1)
+    {
+        for (size_t group = 0; group < groupCount; ++group)
+        {
+            processGroup(group);
+        }
+        return;
+    }
+    Parallel::forEach(groupCount, processGroup);
+}
+
+void decodeRowToLinear(const std::byte* source, float* destination, uint32_t width, MipImageFormat format)
+{
+    if (format == MipImageFormat::RGBA32Float)
+    {
+        std::memcpy(destination, source, size_t(width) * 4 * sizeof(float));
+        return;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(source);
+    const std::array<float, 256>& srgbTable = getSrgbToLinearTable();
+    const bool srgb = format == MipImageFormat::RGBA8Srgb;
+
+    for (size_t i = 0; i < size_t(width) * 4; i += 4)
+    {
+        for (size_t channel = 0; channel < 3; ++channel)
+        {
+            destination[i + channel] = srgb ? srgbTable[bytes[i + channel]] : static_cast<float>(bytes[i + channel]) * (1.0f / 255.0f);
+        }
+        destination[i + 3] = static_cast<float>(bytes[i + 3]) * (1.0f / 255.0f);
+    }
+}
+
+void encodeRowFromLinear(const float* source, std::byte* destination, uint32_t width, MipImageFormat format)
+{
+    if (format == MipImageFormat::RGBA32Float)
+    {
+        // Sharpening filters can undershoot
+        auto* floats = reinterpret_cast<float*>(destination);
+        for (size_t i = 0; i < size_t(width) * 4; ++i)
+        {
+            floats[i] = std::max(source[i], 0.0f);
+        }
+        return;
+    }
+
+    auto* bytes = reinterpret_cast<uint8_t*>(destination);
+    const std::vector<uint8_t>& srgbTable = getLinearToSrgbTable();
+    const bool srgb = format == MipImageFormat::RGBA8Srgb;
+
+    for (size_t i = 0; i < size_t(width) * 4; i += 4)
+    {
+        for (size_t channel = 0; channel < 3; ++channel)
+        {
+            const float value = std::clamp(source[i + channel], 0.0f, 1.0f);
+            bytes[i + channel] = srgb ? srgbTable[static_cast<size_t>(value * float(linearToSrgbTableSize - 1) + 0.5f)] : static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+        bytes[i + 3] = static_cast<uint8_t>(std::clamp(source[i + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+/**
+ * Filter one row horizontally. Each RGBA pixel is one 4-wide vector.
+ */
+void filterRowHorizontal(const float* source, float* destination, uint32_t destinationWidth, const FilterWeights& filter)
+{
+    const uint32_t tapCount = filter.tapCount;
+
+    for (uint32_t x = 0; x < destinationWidth; ++x)
+    {
+        const uint32_t* indices = &filter.indices[size_t(x) * tapCount];
+        const float* weights = &filter.weights[size_t(x) * tapCount];
+
+#if defined(MIP_GENERATION_SSE2)
+        __m128 sum = _mm_setzero_ps();
+        for (uint32_t tap = 0; tap < tapCount; ++tap)
+        {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(source + size_t(indices[tap]) * 4)));
+        }
+        _mm_storeu_ps(destination + size_t(x) * 4, sum);
+#elif defined(MIP_GENERATION_NEON)
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (uint32_t tap = 0; tap < tapCount; ++tap)
+        {
+            sum = vmlaq_n_f32(sum, vld1q_f32(source + size_t(indices[tap]) * 4), weights[tap]);
+        }
+        vst1q_f32(destination + size_t(x) * 4, sum);
+#else
+        float sum[4] = {};
+        for (uint32_t tap = 0; tap < tapCount; ++tap)
+        {
+            for (size_t channel = 0; channel < 4; ++channel)
+            {
+                sum[channel] += weights[tap] * source[size_t(indices[tap]) * 4 + channel];
+            }
+        }
+        std::memcpy(destination + size_t(x) * 4, sum, sizeof(sum));
+#endif
+    }
+}
+
+/**
+ * destination += weight * source over a whole row of floats
+ */
+void accumulateRow(float* destination, const float* source, float weight, size_t floatCount)
+{
+    size_t i = 0;
+#if defined(MIP_GENERATION_AVX2)
+    const __m256 weight8 = _mm256_set1_ps(weight);
+    for (; i + 8 <= floatCount; i += 8)
+    {
+        _mm256_storeu_ps(destination + i, _mm256_add_ps(_mm256_loadu_ps(destination + i), _mm256_mul_ps(weight8, _mm256_loadu_ps(source + i))));
+    }
+#endif
+#if defined(MIP_GENERATION_SSE2)
+    const __m128 weight4 = _mm_set1_ps(weight);
+    for (; i + 4 <= floatCount; i += 4)
+    {
+        _mm_storeu_ps(destination + i, _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(weight4, _mm_loadu_ps(source + i))));
+    }
+#elif defined(MIP_GENERATION_NEON)
+    for (; i + 4 <= floatCount; i += 4)
+    {
+        vst1q_f32(destination + i, vmlaq_n_f32(vld1q_f32(destination + i), vld1q_f32(source + i), weight));
+    }
+#endif
+    for (; i < floatCount; ++i)
+    {
+        destination[i] += weight * source[i];
+    }
+}
+
+struct LinearLevel
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> pixels;
+};
+
+struct LinearImageView
+{
+    uint32_t width;
+    uint32_t height;
+    const float* pixels;
+};
+
+LinearLevel downsample(LinearImageView source, MipFilter filter)
+{
+    LinearLevel destination{std::max(source.width / 2, 1u), std::max(source.height / 2, 1u), {}};
+    destination.pixels.resize(size_t(destination.width) * destination.height * 4);
+
+    const FilterWeights horizontal = computeFilterWeights(source.width, destination.width, filter);
+    const FilterWeights vertical = computeFilterWeights(source.height, destination.height, filter);
+    const size_t sourceRowFloats = size_t(source.width) * 4;
+
+    // Vertical pass into one source width row per destination row, then the horizontal pass straight into the
+    // destination. Keeps the working set to a few rows instead of a full intermediate image.
+    forEachRowGroup(destination.height, [&](uint32_t firstRow, uint32_t endRow)
+                    {
+                        std::vector<float> row(sourceRowFloats);
+                        for (uint32_t y = firstRow; y < endRow; ++y)
+                        {
+                            std::fill(row.begin(), row.end(), 0.0f);
+                            for (uint32_t tap = 0; tap < vertical.tapCount; ++tap)
+                            {
+                                const size_t weightIndex = size_t(y) * vertical.tapCount + tap;
+                                const float weight = vertical.weights[weightIndex];
+                                if (weight != 0.0f)
+                                {
+                                    accumulateRow(row.data(), source.pixels + vertical.indices[weightIndex] * sourceRowFloats, weight, sourceRowFloats);
+                                }
+                            }
+                            filterRowHorizontal(row.data(), &destination.pixels[size_t(y) * destination.width * 4], destination.width, horizontal);
+                        }
+                    });
+    return destination;
+}
+
+void validateImage(std::span<const std::byte> image, uint32_t width, uint32_t height, MipImageFormat format)
+{
+    if (width == 0 || height == 0 || image.size() < size_t(width) * height * MipGeneration::getPixelSize(format))
+    {
+        throw std::runtime_error("Invalid image given to the mip generator!");
+    }
+}
+
+} // namespace
+
+namespace MipGeneration
+{
+
+uint32_t getMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t mipCount = 1;
+    while (std::max(width, height) >> mipCount)
+    {
+        ++mipCount;
+    }
+    return mipCount;
+}
+
+size_t getPixelSize(MipImageFormat format)
+{
+    return format == MipImageFormat::RGBA32Float ? 4 * sizeof(float) : 4;
+}
+
+std::vector<MipLevel> generateMipChain(std::span<const std::byte> image, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter)
+{
+    validateImage(image, width, height, format);
+
+    const uint32_t mipCount = getMipCount(width, height);
+    const size_t pixelSize = getPixelSize(format);
+
+    // Float images are filtered in place, 8-bit images are decoded to linear floats first
+    std::vector<LinearLevel> linearLevels(mipCount);
+    if (format != MipImageFormat::RGBA32Float)
+    {
+        linearLevels[0] = LinearLevel{width, height, std::vector<float>(size_t(width) * height * 4)};
+        forEachRowGroup(height, [&](uint32_t firstRow, uint32_t endRow)
+                        {
+                            for (uint32_t y = firstRow; y < endRow; ++y)
+                            {
+                                decodeRowToLinear(image.data() + size_t(y) * width * pixelSize, &linearLevels[0].pixels[size_t(y) * width * 4], width, format);
+                            }
+                        });
+    }
+
+    // Each level is filtered from the previous full precision level, never from quantized data
+    for (uint32_t mip = 1; mip < mipCount; ++mip)
+    {
+        const LinearImageView source = (mip == 1 && format == MipImageFormat::RGBA32Float)
+                                           ? LinearImageView{width, height, reinterpret_cast<const float*>(image.data())}
+                                           : LinearImageView{linearLevels[mip - 1].width, linearLevels[mip - 1].height, linearLevels[mip - 1].pixels.data()};
+        linearLevels[mip] = downsample(source, filter);
+    }
+
+    std::vector<MipLevel> levels(mipCount);
+    levels[0] = MipLevel{width, height, std::vector<std::byte>(image.begin(), image.begin() + size_t(width) * height * pixelSize)};
+
+    // Encode all levels at once so that small levels share tasks with large ones
+    struct EncodeTask
+    {
+        uint32_t mip;
+        uint32_t firstRow;
+        uint32_t endRow;
+    };
+    std::vector<EncodeTask> encodeTasks;
+    for (uint32_t mip = 1; mip < mipCount; ++mip)
+    {
+        const LinearLevel& linear = linearLevels[mip];
+        levels[mip] = MipLevel{linear.width, linear.height, std::vector<std::byte>(size_t(linear.width) * linear.height * pixelSize)};
+        for (uint32_t row = 0; row < linear.height; row += rowsPerTask)
+        {
+            encodeTasks.push_back(EncodeTask{mip, row, std::min(row + rowsPerTask, linear.height)});
+        }
+    }
+
+    Parallel::forEach(encodeTasks.size(), [&](size_t taskIndex)
+                      {
+                          const EncodeTask& task = encodeTasks[taskIndex];
+                          const LinearLevel& linear = linearLevels[task.mip];
+                          for (uint32_t y = task.firstRow; y < task.endRow; ++y)
+                          {
+                              encodeRowFromLinear(&linear.pixels[size_t(y) * linear.width * 4], levels[task.mip].data.data() + size_t(y) * linear.width * pixelSize, linear.width, format);
+                          }
+                      });
+    return levels;
+}
+
+std::vector<MipLevel> generateMipChainReference(std::span<const std::byte> image, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter)
+{
+    validateImage(image, width, height, format);
+
+    const size_t pixelSize = getPixelSize(format);
+    const uint32_t mipCount = getMipCount(width, height);
+
+    auto readChannel = [format](const std::vector<std::byte>& data, size_t pixel, size_t channel)
+    {
+        if (format == MipImageFormat::RGBA32Float)
+        {
+            float value;
+            std::memcpy(&value, data.data() + (pixel * 4 + channel) * sizeof(float), sizeof(float));
+            return value;
+        }
+        const float value = static_cast<float>(static_cast<uint8_t>(data[pixel * 4 + channel])) / 255.0f;
+        return (format == MipImageFormat::RGBA8Srgb && channel < 3) ? srgbToLinear(value) : value;
+    };
+
+    auto writeChannel = [format](std::vector<std::byte>& data, size_t pixel, size_t channel, float value)
+    {
+        if (format == MipImageFormat::RGBA32Float)
+        {
+            value = std::max(value, 0.0f);
+            std::memcpy(data.data() + (pixel * 4 + channel) * sizeof(float), &value, sizeof(float));
+            return;
+        }
+        value = std::clamp(value, 0.0f, 1.0f);
+        if (format == MipImageFormat::RGBA8Srgb && channel < 3)
+        {
+            value = linearToSrgb(value);
+        }
+        data[pixel * 4 + channel] = static_cast<std::byte>(static_cast<uint8_t>(value * 255.0f + 0.5f));
+    };
+
+    std::vector<MipLevel> levels;
+    levels.push_back(MipLevel{width, height, std::vector<std::byte>(image.begin(), image.begin() + size_t(width) * height * pixelSize)});
+
+    for (uint32_t mip = 1; mip < mipCount; ++mip)
+    {
+        const MipLevel& source = levels.back();
+        MipLevel destination{std::max(source.width / 2, 1u), std::max(source.height / 2, 1u), {}};
+        destination.data.resize(size_t(destination.width) * destination.height * pixelSize);
+
+        const FilterWeights horizontal = computeFilterWeights(source.width, destination.width, filter);
+        const FilterWeights vertical = computeFilterWeights(source.height, destination.height, filter);
+
+        for (uint32_t y = 0; y < destination.height; ++y)
+        {
+            for (uint32_t x = 0; x < destination.width; ++x)
+            {
+                float sum[4] = {};
+                for (uint32_t ty = 0; ty < vertical.tapCount; ++ty)
+                {
+                    for (uint32_t tx = 0; tx < horizontal.tapCount; ++tx)
+                    {
+                        const size_t verticalIndex = size_t(y) * vertical.tapCount + ty;
+                        const size_t horizontalIndex = size_t(x) * horizontal.tapCount + tx;
+                        const float weight = vertical.weights[verticalIndex] * horizontal.weights[horizontalIndex];
+                        const size_t pixel = size_t(vertical.indices[verticalIndex]) * source.width + horizontal.indices[horizontalIndex];
+                        for (size_t channel = 0; channel < 4; ++channel)
+                        {
+                            sum[channel] += weight * readChannel(source.data, pixel, channel);
+                        }
+                    }
+                }
+                for (size_t channel = 0; channel < 4; ++channel)
+                {
+                    writeChannel(destination.data, size_t(y) * destination.width + x, channel, sum[channel]);
+                }
+            }
+        }
+        levels.push_back(std::move(destination));
+    }
+    return levels;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef VULKANPROJECT_MIPGENERATOR_H
+#define VULKANPROJECT_MIPGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class MipImageFormat
+{
+    RGBA8Unorm,
+    RGBA8Srgb, // Color channels are decoded to linear before filtering and encoded back after
+    RGBA32Float // HDR
+};
+
+enum class MipFilter
+{
+    Box, // Area average, cheapest
+    Kaiser // Kaiser windowed sinc, sharper mips with less aliasing
+};
+
+struct MipLevel
+{
+    uint32_t width;
+    uint32_t height;
+    std::vector<std::byte> data; // Pixels in the format of the source image
+};
+
+/**
+ * Builds full mip chains on the CPU. Filtering is separable and done in linear space on 32-bit floats, using SIMD
+ * for the filter loops and all hardware threads across rows and mip levels.
+ */
+namespace MipGeneration
+{
+
+uint32_t getMipCount(uint32_t width, uint32_t height);
+size_t getPixelSize(MipImageFormat format);
+
+/**
+ * @return All levels including a copy of the source as level 0
+ */
+std::vector<MipLevel> generateMipChain(std::span<const std::byte> image, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter);
+
+/**
+ * Straightforward scalar implementation: single threaded, non-separable filter and exact sRGB conversions per sample.
+ * Kept as the baseline for benchmarks and for validating generateMipChain().
+ */
+std::vector<MipLevel> generateMipChainReference(std::span<const std::byte> image, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter);
+
+}
+
+#endif // VULKANPROJECT_MIPGENERATOR_H
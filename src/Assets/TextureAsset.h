@@ -0,0 +1,32 @@
+#ifndef VULKANPROJECT_TEXTUREASSET_H
+#define VULKANPROJECT_TEXTUREASSET_H
+
+#include "TextureCompressor.h"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Cooked textures are stored in packages as "<name>/info" holding this header and "<name>/mip<N>" holding the
+ * compressed blocks of each mip level.
+ */
+struct TextureAssetHeader
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    BlockCompressionFormat format;
+    uint32_t isSrgb;
+};
+
+inline std::string getTextureInfoAssetName(const std::string& textureName)
+{
+    return textureName + "/info";
+}
+
+inline std::string getTextureMipAssetName(const std::string& textureName, uint32_t mip)
+{
+    return textureName + "/mip" + std::to_string(mip);
+}
+
+#endif // VULKANPROJECT_TEXTUREASSET_H
@@ -0,0 +1,1017 @@
+#include "TextureCompressor.h"
+
+#include "../Utilities/Parallel.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXTURE_COMPRESSION_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_COMPRESSION_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TEXTURE_COMPRESSION_NEON
+#endif
+
+namespace
+{
+
+constexpr size_t blockPixelCount = 16;
+constexpr size_t channelCount = 4;
+
+using Color = std::array<float, channelCount>;
+using ChannelWeights = std::array<float, channelCount>;
+using BlockIndices = std::array<uint8_t, blockPixelCount>;
+
+// Structure of arrays so that the SIMD kernels can load several pixels of one channel at once
+struct BlockPixels
+{
+    alignas(32) float channels[channelCount][blockPixelCount];
+};
+
+struct Palette
+{
+    Color colors[16];
+    uint32_t size;
+};
+
+struct Endpoints
+{
+    Color first;
+    Color second;
+};
+
+constexpr std::array<float, 4> bc1PaletteWeights = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+constexpr std::array<float, 8> bc4PaletteWeights = {0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f};
+constexpr std::array<uint32_t, 16> bc7Weights4 = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+size_t getBlockSize(BlockCompressionFormat format)
+{
+    return format == BlockCompressionFormat::BC1 ? 8u : 16u;
+}
+
+int getRefinementIterations(CompressionQuality quality)
+{
+    switch (quality)
+    {
+    case CompressionQuality::Fast:
+        return 0;
+    case CompressionQuality::Normal:
+        return 1;
+    case CompressionQuality::High:
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * Find the closest palette entry for each pixel. Returns the sum of weighted squared errors.
+ */
+float selectIndices(const BlockPixels& pixels, const Palette& palette, const ChannelWeights& weights, BlockIndices& indices)
+{
+    float totalError = 0.0f;
+
+#if defined(TEXTURE_COMPRESSION_AVX2)
+    const __m256 weightR = _mm256_set1_ps(weights[0]);
+    const __m256 weightG = _mm256_set1_ps(weights[1]);
+    const __m256 weightB = _mm256_set1_ps(weights[2]);
+    const __m256 weightA = _mm256_set1_ps(weights[3]);
+
+    for (size_t pixel = 0; pixel < blockPixelCount; pixel += 8)
+    {
+        const __m256 r = _mm256_load_ps(&pixels.channels[0][pixel]);
+        const __m256 g = _mm256_load_ps(&pixels.channels[1][pixel]);
+        const __m256 b = _mm256_load_ps(&pixels.channels[2][pixel]);
+        const __m256 a = _mm256_load_ps(&pixels.channels[3][pixel]);
+
+        __m256 bestError = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 bestIndex = _mm256_setzero_ps();
+
+        for (uint32_t entry = 0; entry < palette.size; ++entry)
+        {
+            const Color& color = palette.colors[entry];
+            const __m256 dr = _mm256_sub_ps(r, _mm256_set1_ps(color[0]));
+            const __m256 dg = _mm256_sub_ps(g, _mm256_set1_ps(color[1]));
+            const __m256 db = _mm256_sub_ps(b, _mm256_set1_ps(color[2]));
+            const __m256 da = _mm256_sub_ps(a, _mm256_set1_ps(color[3]));
+
+            __m256 error = _mm256_mul_ps(_mm256_mul_ps(dr, dr), weightR);
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(dg, dg), weightG));
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(db, db), weightB));
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(da, da), weightA));
+
+            const __m256 better = _mm256_cmp_ps(error, bestError, _CMP_LT_OQ);
+            bestError = _mm256_min_ps(error, bestError);
+            bestIndex = _mm256_blendv_ps(bestIndex, _mm256_set1_ps(static_cast<float>(entry)), better);
+        }
+
+        alignas(32) float errors[8];
+        alignas(32) int32_t bestIndices[8];
+        _mm256_store_ps(errors, bestError);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(bestIndices), _mm256_cvttps_epi32(bestIndex));
+        for (size_t i = 0; i < 8; ++i)
+        {
+            indices[pixel + i] = static_cast<uint8_t>(bestIndices[i]);
+            totalError += errors[i];
+        }
+    }
+#elif defined(TEXTURE_COMPRESSION_SSE2)
+    const __m128 weightR = _mm_set1_ps(weights[0]);
+    const __m128 weightG = _mm_set1_ps(weights[1]);
+    const __m128 weightB = _mm_set1_ps(weights[2]);
+    const __m128 weightA = _mm_set1_ps(weights[3]);
+
+    for (size_t pixel = 0; pixel < blockPixelCount; pixel += 4)
+    {
+        const __m128 r = _mm_load_ps(&pixels.channels[0][pixel]);
+        const __m128 g = _mm_load_ps(&pixels.channels[1][pixel]);
+        const __m128 b = _mm_load_ps(&pixels.channels[2][pixel]);
+        const __m128 a = _mm_load_ps(&pixels.channels[3][pixel]);
+
+        __m128 bestError = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 bestIndex = _mm_setzero_ps();
+
+        for (uint32_t entry = 0; entry < palette.size; ++entry)
+        {
+            const Color& color = palette.colors[entry];
+            const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(color[0]));
+            const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(color[1]));
+            const __m128 db = _mm_sub_ps(b, _mm_set1_ps(color[2]));
+            const __m128 da = _mm_sub_ps(a, _mm_set1_ps(color[3]));
+
+            __m128 error = _mm_mul_ps(_mm_mul_ps(dr, dr), weightR);
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(dg, dg), weightG));
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(db, db), weightB));
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(da, da), weightA));
+
+            // SSE2 has no blend, select with masks
+            const __m128 better = _mm_cmplt_ps(error, bestError);
+            bestError = _mm_min_ps(error, bestError);
+            bestIndex = _mm_or_ps(_mm_and_ps(better, _mm_set1_ps(static_cast<float>(entry))), _mm_andnot_ps(better, bestIndex));
+        }
+
+        alignas(16) float errors[4];
+        alignas(16) int32_t bestIndices[4];
+        _mm_store_ps(errors, bestError);
+        _mm_store_si128(reinterpret_cast<__m128i*>(bestIndices), _mm_cvttps_epi32(bestIndex));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            indices[pixel + i] = static_cast<uint8_t>(bestIndices[i]);
+            totalError += errors[i];
+        }
+    }
+#elif defined(TEXTURE_COMPRESSION_NEON)
+    const float32x4_t weightR = vdupq_n_f32(weights[0]);
+    const float32x4_t weightG = vdupq_n_f32(weights[1]);
+    const float32x4_t weightB = vdupq_n_f32(weights[2]);
+    const float32x4_t weightA = vdupq_n_f32(weights[3]);
+
+    for (size_t pixel = 0; pixel < blockPixelCount; pixel += 4)
+    {
+        const float32x4_t r = vld1q_f32(&pixels.channels[0][pixel]);
+        const float32x4_t g = vld1q_f32(&pixels.channels[1][pixel]);
+        const float32x4_t b = vld1q_f32(&pixels.channels[2][pixel]);
+        const float32x4_t a = vld1q_f32(&pixels.channels[3][pixel]);
+
+        float32x4_t bestError = vdupq_n_f32(std::numeric_limits<float>::max());
+        float32x4_t bestIndex = vdupq_n_f32(0.0f);
+
+        for (uint32_t entry = 0; entry < palette.size; ++entry)
+        {
+            const Color& color = palette.colors[entry];
+            const float32x4_t dr = vsubq_f32(r, vdupq_n_f32(color[0]));
+            const float32x4_t dg = vsubq_f32(g, vdupq_n_f32(color[1]));
+            const float32x4_t db = vsubq_f32(b, vdupq_n_f32(color[2]));
+            const float32x4_t da = vsubq_f32(a, vdupq_n_f32(color[3]));
+
+            float32x4_t error = vmulq_f32(vmulq_f32(dr, dr), weightR);
+            error = vmlaq_f32(error, vmulq_f32(dg, dg), weightG);
+            error = vmlaq_f32(error, vmulq_f32(db, db), weightB);
+            error = vmlaq_f32(error, vmulq_f32(da, da), weightA);
+
+            const uint32x4_t better = vcltq_f32(error, bestError);
+            bestError = vminq_f32(error, bestError);
+            bestIndex = vbslq_f32(better, vdupq_n_f32(static_cast<float>(entry)), bestIndex);
+        }
+
+        float errors[4];
+        int32_t bestIndices[4];
+        vst1q_f32(errors, bestError);
+        vst1q_s32(bestIndices, vcvtq_s32_f32(bestIndex));
+        for (size_t i = 0; i < 4; ++i)
+        {
+            indices[pixel + i] = static_cast<uint8_t>(bestIndices[i]);
+            totalError += errors[i];
+        }
+    }
+#else
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        float bestError = std::numeric_limits<float>::max();
+        uint8_t bestIndex = 0;
+        for (uint32_t entry = 0; entry < palette.size; ++entry)
+        {
+            float error = 0.0f;
+            for (size_t channel = 0; channel < channelCount; ++channel)
+            {
+                const float difference = pixels.channels[channel][pixel] - palette.colors[entry][channel];
+                error += difference * difference * weights[channel];
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                bestIndex = static_cast<uint8_t>(entry);
+            }
+        }
+        indices[pixel] = bestIndex;
+        totalError += bestError;
+    }
+#endif
+
+    return totalError;
+}
+
+Endpoints computeBoundingBoxEndpoints(const BlockPixels& pixels, const ChannelWeights& weights, float insetFraction)
+{
+    Endpoints endpoints{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        if (weights[channel] == 0.0f)
+        {
+            continue;
+        }
+        const auto [minimum, maximum] = std::minmax_element(std::begin(pixels.channels[channel]), std::end(pixels.channels[channel]));
+        const float inset = (*maximum - *minimum) * insetFraction;
+        endpoints.first[channel] = *maximum - inset;
+        endpoints.second[channel] = *minimum + inset;
+    }
+    return endpoints;
+}
+
+/**
+ * Endpoints at the extremes of the pixels projected to their principal axis
+ */
+Endpoints computePrincipalAxisEndpoints(const BlockPixels& pixels, const ChannelWeights& weights)
+{
+    Color mean{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        if (weights[channel] == 0.0f)
+        {
+            continue;
+        }
+        for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+        {
+            mean[channel] += pixels.channels[channel][pixel];
+        }
+        mean[channel] /= static_cast<float>(blockPixelCount);
+    }
+
+    float covariance[channelCount][channelCount] = {};
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        for (size_t i = 0; i < channelCount; ++i)
+        {
+            const float di = weights[i] == 0.0f ? 0.0f : pixels.channels[i][pixel] - mean[i];
+            for (size_t j = i; j < channelCount; ++j)
+            {
+                const float dj = weights[j] == 0.0f ? 0.0f : pixels.channels[j][pixel] - mean[j];
+                covariance[i][j] += di * dj;
+            }
+        }
+    }
+    for (size_t i = 0; i < channelCount; ++i)
+    {
+        for (size_t j = 0; j < i; ++j)
+        {
+            covariance[i][j] = covariance[j][i];
+        }
+    }
+
+    // Power iteration starting from the bounding box diagonal
+    const Endpoints box = computeBoundingBoxEndpoints(pixels, weights, 0.0f);
+    Color axis{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        axis[channel] = box.first[channel] - box.second[channel];
+    }
+
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        Color next{};
+        float largest = 0.0f;
+        for (size_t i = 0; i < channelCount; ++i)
+        {
+            for (size_t j = 0; j < channelCount; ++j)
+            {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            largest = std::max(largest, std::abs(next[i]));
+        }
+        if (largest == 0.0f)
+        {
+            break;
+        }
+        for (size_t i = 0; i < channelCount; ++i)
+        {
+            axis[i] = next[i] / largest;
+        }
+    }
+
+    float axisLengthSquared = 0.0f;
+    for (const float component : axis)
+    {
+        axisLengthSquared += component * component;
+    }
+    if (axisLengthSquared == 0.0f)
+    {
+        return Endpoints{mean, mean};
+    }
+
+    float minimumProjection = std::numeric_limits<float>::max();
+    float maximumProjection = std::numeric_limits<float>::lowest();
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        float projection = 0.0f;
+        for (size_t channel = 0; channel < channelCount; ++channel)
+        {
+            if (weights[channel] != 0.0f)
+            {
+                projection += (pixels.channels[channel][pixel] - mean[channel]) * axis[channel];
+            }
+        }
+        projection /= axisLengthSquared;
+        minimumProjection = std::min(minimumProjection, projection);
+        maximumProjection = std::max(maximumProjection, projection);
+    }
+
+    Endpoints endpoints{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        endpoints.first[channel] = std::clamp(mean[channel] + maximumProjection * axis[channel], 0.0f, 255.0f);
+        endpoints.second[channel] = std::clamp(mean[channel] + minimumProjection * axis[channel], 0.0f, 255.0f);
+    }
+    return endpoints;
+}
+
+/**
+ * Least squares fit of the endpoints for fixed indices, each index interpolating with paletteWeights[index]
+ */
+Endpoints refineEndpoints(const BlockPixels& pixels, const BlockIndices& indices, std::span<const float> paletteWeights, const Endpoints& previous)
+{
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    Color x0{}, x1{};
+
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        const float t = paletteWeights[indices[pixel]];
+        const float s = 1.0f - t;
+        a += s * s;
+        b += s * t;
+        c += t * t;
+        for (size_t channel = 0; channel < channelCount; ++channel)
+        {
+            x0[channel] += s * pixels.channels[channel][pixel];
+            x1[channel] += t * pixels.channels[channel][pixel];
+        }
+    }
+
+    const float determinant = a * c - b * b;
+    if (std::abs(determinant) < 1e-6f)
+    {
+        return previous;
+    }
+
+    Endpoints endpoints{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        endpoints.first[channel] = std::clamp((c * x0[channel] - b * x1[channel]) / determinant, 0.0f, 255.0f);
+        endpoints.second[channel] = std::clamp((a * x1[channel] - b * x0[channel]) / determinant, 0.0f, 255.0f);
+    }
+    return endpoints;
+}
+
+struct Fit
+{
+    Endpoints endpoints;
+    BlockIndices indices;
+    float error;
+};
+
+/**
+ * Pick endpoints, then alternate index selection and least squares refinement keeping the best result.
+ * buildPalette quantizes the endpoints exactly like the encoder will and fills the palette the decoder will produce.
+ */
+template<typename BuildPalette>
+Fit fitEndpoints(const BlockPixels& pixels, const ChannelWeights& weights, CompressionQuality quality, bool usePrincipalAxis, std::span<const float> paletteWeights, BuildPalette buildPalette)
+{
+    Endpoints endpoints = (quality == CompressionQuality::Fast || !usePrincipalAxis) ? computeBoundingBoxEndpoints(pixels, weights, quality == CompressionQuality::Fast ? 1.0f / 16.0f : 0.0f)
+                                                                                     : computePrincipalAxisEndpoints(pixels, weights);
+
+    Fit best{};
+    best.error = std::numeric_limits<float>::max();
+
+    const int iterations = getRefinementIterations(quality);
+    for (int iteration = 0; iteration <= iterations; ++iteration)
+    {
+        Palette palette{};
+        buildPalette(endpoints, palette);
+
+        Fit current{};
+        current.endpoints = endpoints;
+        current.error = selectIndices(pixels, palette, weights, current.indices);
+
+        if (current.error < best.error)
+        {
+            best = current;
+        }
+        if (current.error == 0.0f)
+        {
+            break;
+        }
+        endpoints = refineEndpoints(pixels, current.indices, paletteWeights, endpoints);
+    }
+    return best;
+}
+
+// BC1 color block
+
+uint16_t quantizeRgb565(const Color& color)
+{
+    const auto r = static_cast<uint16_t>(std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l));
+    const auto g = static_cast<uint16_t>(std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l));
+    const auto b = static_cast<uint16_t>(std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+std::array<uint32_t, 3> decodeRgb565(uint16_t color)
+{
+    const uint32_t r = (color >> 11) & 31u;
+    const uint32_t g = (color >> 5) & 63u;
+    const uint32_t b = color & 31u;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+std::array<std::array<uint32_t, 3>, 4> getBc1Colors(uint16_t color0, uint16_t color1)
+{
+    const auto c0 = decodeRgb565(color0);
+    const auto c1 = decodeRgb565(color1);
+    std::array<std::array<uint32_t, 3>, 4> colors{c0, c1};
+    for (size_t channel = 0; channel < 3; ++channel)
+    {
+        colors[2][channel] = (2 * c0[channel] + c1[channel] + 1) / 3;
+        colors[3][channel] = (c0[channel] + 2 * c1[channel] + 1) / 3;
+    }
+    return colors;
+}
+
+void encodeBc1ColorBlock(const BlockPixels& pixels, CompressionQuality quality, std::byte* output)
+{
+    constexpr ChannelWeights weights = {1.0f, 1.0f, 1.0f, 0.0f};
+
+    const Fit fit = fitEndpoints(pixels, weights, quality, true, bc1PaletteWeights, [](const Endpoints& endpoints, Palette& palette)
+                                 {
+                                     const auto colors = getBc1Colors(quantizeRgb565(endpoints.first), quantizeRgb565(endpoints.second));
+                                     palette.size = 4;
+                                     for (size_t entry = 0; entry < 4; ++entry)
+                                     {
+                                         palette.colors[entry] = {float(colors[entry][0]), float(colors[entry][1]), float(colors[entry][2]), 0.0f};
+                                     }
+                                 });
+
+    uint16_t color0 = quantizeRgb565(fit.endpoints.first);
+    uint16_t color1 = quantizeRgb565(fit.endpoints.second);
+    BlockIndices indices = fit.indices;
+
+    // color0 > color1 selects the four color mode
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+        for (uint8_t& index : indices)
+        {
+            index ^= 1u;
+        }
+    }
+    else if (color0 == color1)
+    {
+        indices.fill(0u);
+    }
+
+    uint32_t packedIndices = 0u;
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        packedIndices |= uint32_t(indices[pixel]) << (2 * pixel);
+    }
+
+    output[0] = std::byte(color0 & 0xFFu);
+    output[1] = std::byte(color0 >> 8);
+    output[2] = std::byte(color1 & 0xFFu);
+    output[3] = std::byte(color1 >> 8);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        output[4 + i] = std::byte((packedIndices >> (8 * i)) & 0xFFu);
+    }
+}
+
+void decodeBc1ColorBlock(const std::byte* input, uint8_t* rgba, size_t pixelStride)
+{
+    const uint16_t color0 = uint16_t(input[0]) | (uint16_t(input[1]) << 8);
+    const uint16_t color1 = uint16_t(input[2]) | (uint16_t(input[3]) << 8);
+    const uint32_t packedIndices = uint32_t(input[4]) | (uint32_t(input[5]) << 8) | (uint32_t(input[6]) << 16) | (uint32_t(input[7]) << 24);
+    const auto colors = getBc1Colors(color0, color1);
+
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        const auto& color = colors[(packedIndices >> (2 * pixel)) & 3u];
+        uint8_t* destination = rgba + pixel * pixelStride;
+        destination[0] = static_cast<uint8_t>(color[0]);
+        destination[1] = static_cast<uint8_t>(color[1]);
+        destination[2] = static_cast<uint8_t>(color[2]);
+    }
+}
+
+// BC4 single channel block, used for BC3 alpha and both BC5 channels
+
+std::array<uint32_t, 8> getBc4Values(uint32_t value0, uint32_t value1)
+{
+    std::array<uint32_t, 8> values{value0, value1};
+    if (value0 > value1)
+    {
+        for (uint32_t i = 2; i < 8; ++i)
+        {
+            values[i] = ((8 - i) * value0 + (i - 1) * value1 + 3) / 7;
+        }
+    }
+    else
+    {
+        for (uint32_t i = 2; i < 6; ++i)
+        {
+            values[i] = ((6 - i) * value0 + (i - 1) * value1 + 2) / 5;
+        }
+        values[6] = 0;
+        values[7] = 255;
+    }
+    return values;
+}
+
+uint8_t quantizeUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::clamp(std::lround(value), 0l, 255l));
+}
+
+void encodeBc4Block(const BlockPixels& pixels, size_t channel, CompressionQuality quality, std::byte* output)
+{
+    ChannelWeights weights{};
+    weights[channel] = 1.0f;
+
+    const Fit fit = fitEndpoints(pixels, weights, quality, false, bc4PaletteWeights, [channel](const Endpoints& endpoints, Palette& palette)
+                                 {
+                                     uint8_t value0 = quantizeUnorm8(endpoints.first[channel]);
+                                     uint8_t value1 = quantizeUnorm8(endpoints.second[channel]);
+                                     if (value0 < value1)
+                                     {
+                                         std::swap(value0, value1);
+                                     }
+                                     // Palette in the order of the unswapped endpoints so indices match refineEndpoints()
+                                     const bool swapped = quantizeUnorm8(endpoints.first[channel]) < quantizeUnorm8(endpoints.second[channel]);
+                                     const auto values = getBc4Values(value0, value1);
+                                     palette.size = 8;
+                                     for (size_t entry = 0; entry < 8; ++entry)
+                                     {
+                                         // Equal endpoints are encoded with all indices zero
+                                         const size_t source = value0 == value1 ? 0u : (swapped ? (entry < 2 ? entry ^ 1u : 9 - entry) : entry);
+                                         palette.colors[entry] = Color{};
+                                         palette.colors[entry][channel] = float(values[source]);
+                                     }
+                                 });
+
+    uint8_t value0 = quantizeUnorm8(fit.endpoints.first[channel]);
+    uint8_t value1 = quantizeUnorm8(fit.endpoints.second[channel]);
+    BlockIndices indices = fit.indices;
+
+    // value0 > value1 selects the eight value mode
+    if (value0 < value1)
+    {
+        std::swap(value0, value1);
+        for (uint8_t& index : indices)
+        {
+            index = index < 2 ? index ^ 1u : 9 - index;
+        }
+    }
+    else if (value0 == value1)
+    {
+        indices.fill(0u);
+    }
+
+    uint64_t packedIndices = 0u;
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        packedIndices |= uint64_t(indices[pixel]) << (3 * pixel);
+    }
+
+    output[0] = std::byte(value0);
+    output[1] = std::byte(value1);
+    for (size_t i = 0; i < 6; ++i)
+    {
+        output[2 + i] = std::byte((packedIndices >> (8 * i)) & 0xFFu);
+    }
+}
+
+void decodeBc4Block(const std::byte* input, uint8_t* channelOutput, size_t pixelStride)
+{
+    const auto values = getBc4Values(uint32_t(input[0]), uint32_t(input[1]));
+    uint64_t packedIndices = 0u;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        packedIndices |= uint64_t(input[2 + i]) << (8 * i);
+    }
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        channelOutput[pixel * pixelStride] = static_cast<uint8_t>(values[(packedIndices >> (3 * pixel)) & 7u]);
+    }
+}
+
+// BC7 mode 6: one subset, RGBA endpoints with 7 bits and a unique p-bit per endpoint, 4-bit indices
+
+struct Bc7Endpoint
+{
+    std::array<uint32_t, 4> values; // 7-bit
+    uint32_t pBit;
+
+    uint32_t decode(size_t channel) const { return (values[channel] << 1) | pBit; }
+};
+
+Bc7Endpoint quantizeBc7Endpoint(const Color& color)
+{
+    Bc7Endpoint best{};
+    float bestError = std::numeric_limits<float>::max();
+    for (uint32_t pBit = 0; pBit < 2; ++pBit)
+    {
+        Bc7Endpoint candidate{};
+        candidate.pBit = pBit;
+        float error = 0.0f;
+        for (size_t channel = 0; channel < channelCount; ++channel)
+        {
+            candidate.values[channel] = static_cast<uint32_t>(std::clamp(std::lround((color[channel] - float(pBit)) * 0.5f), 0l, 127l));
+            const float difference = float(candidate.decode(channel)) - color[channel];
+            error += difference * difference;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+std::array<std::array<uint32_t, 4>, 16> getBc7Colors(const Bc7Endpoint& endpoint0, const Bc7Endpoint& endpoint1)
+{
+    std::array<std::array<uint32_t, 4>, 16> colors{};
+    for (size_t entry = 0; entry < 16; ++entry)
+    {
+        for (size_t channel = 0; channel < channelCount; ++channel)
+        {
+            colors[entry][channel] = ((64 - bc7Weights4[entry]) * endpoint0.decode(channel) + bc7Weights4[entry] * endpoint1.decode(channel) + 32) >> 6;
+        }
+    }
+    return colors;
+}
+
+class BitWriter
+{
+public:
+    void write(uint64_t value, uint32_t bitCount)
+    {
+        for (uint32_t bit = 0; bit < bitCount; ++bit, ++m_position)
+        {
+            if ((value >> bit) & 1u)
+            {
+                m_bits[m_position / 64] |= uint64_t(1) << (m_position % 64);
+            }
+        }
+    }
+
+    void store(std::byte* output) const
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            output[i] = std::byte((m_bits[i / 8] >> (8 * (i % 8))) & 0xFFu);
+        }
+    }
+
+private:
+    std::array<uint64_t, 2> m_bits{};
+    uint32_t m_position{0u};
+};
+
+class BitReader
+{
+public:
+    BitReader(const std::byte* input)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            m_bits[i / 8] |= uint64_t(input[i]) << (8 * (i % 8));
+        }
+    }
+
+    uint32_t read(uint32_t bitCount)
+    {
+        uint32_t value = 0u;
+        for (uint32_t bit = 0; bit < bitCount; ++bit, ++m_position)
+        {
+            value |= uint32_t((m_bits[m_position / 64] >> (m_position % 64)) & 1u) << bit;
+        }
+        return value;
+    }
+
+private:
+    std::array<uint64_t, 2> m_bits{};
+    uint32_t m_position{0u};
+};
+
+void encodeBc7Block(const BlockPixels& pixels, CompressionQuality quality, std::byte* output)
+{
+    constexpr ChannelWeights weights = {1.0f, 1.0f, 1.0f, 1.0f};
+    std::array<float, 16> paletteWeights{};
+    for (size_t i = 0; i < 16; ++i)
+    {
+        paletteWeights[i] = float(bc7Weights4[i]) / 64.0f;
+    }
+
+    const Fit fit = fitEndpoints(pixels, weights, quality, true, paletteWeights, [](const Endpoints& endpoints, Palette& palette)
+                                 {
+                                     const auto colors = getBc7Colors(quantizeBc7Endpoint(endpoints.first), quantizeBc7Endpoint(endpoints.second));
+                                     palette.size = 16;
+                                     for (size_t entry = 0; entry < 16; ++entry)
+                                     {
+                                         palette.colors[entry] = {float(colors[entry][0]), float(colors[entry][1]), float(colors[entry][2]), float(colors[entry][3])};
+                                     }
+                                 });
+
+    Bc7Endpoint endpoint0 = quantizeBc7Endpoint(fit.endpoints.first);
+    Bc7Endpoint endpoint1 = quantizeBc7Endpoint(fit.endpoints.second);
+    BlockIndices indices = fit.indices;
+
+    // The anchor index is stored without its highest bit, which therefore has to be zero
+    if (indices[0] >= 8)
+    {
+        std::swap(endpoint0, endpoint1);
+        for (uint8_t& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer;
+    writer.write(1u << 6, 7); // Mode 6
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        writer.write(endpoint0.values[channel], 7);
+        writer.write(endpoint1.values[channel], 7);
+    }
+    writer.write(endpoint0.pBit, 1);
+    writer.write(endpoint1.pBit, 1);
+    writer.write(indices[0], 3);
+    for (size_t pixel = 1; pixel < blockPixelCount; ++pixel)
+    {
+        writer.write(indices[pixel], 4);
+    }
+    writer.store(output);
+}
+
+void decodeBc7Block(const std::byte* input, uint8_t* rgba)
+{
+    BitReader reader(input);
+    if (reader.read(7) != (1u << 6))
+    {
+        throw std::runtime_error("Only BC7 mode 6 blocks can be decoded!");
+    }
+
+    Bc7Endpoint endpoint0{}, endpoint1{};
+    for (size_t channel = 0; channel < channelCount; ++channel)
+    {
+        endpoint0.values[channel] = reader.read(7);
+        endpoint1.values[channel] = reader.read(7);
+    }
+    endpoint0.pBit = reader.read(1);
+    endpoint1.pBit = reader.read(1);
+
+    const auto colors = getBc7Colors(endpoint0, endpoint1);
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        const uint32_t index = reader.read(pixel == 0 ? 3 : 4);
+        for (size_t channel = 0; channel < channelCount; ++channel)
+        {
+            rgba[pixel * 4 + channel] = static_cast<uint8_t>(colors[index][channel]);
+        }
+    }
+}
+
+void loadBlock(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, BlockPixels& pixels)
+{
+    for (uint32_t y = 0; y < 4; ++y)
+    {
+        const uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+        for (uint32_t x = 0; x < 4; ++x)
+        {
+            const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+            const uint8_t* source = rgba.data() + (size_t(sourceY) * width + sourceX) * 4;
+            for (size_t channel = 0; channel < channelCount; ++channel)
+            {
+                pixels.channels[channel][y * 4 + x] = static_cast<float>(source[channel]);
+            }
+        }
+    }
+}
+
+void encodeBlock(const BlockPixels& pixels, BlockCompressionFormat format, CompressionQuality quality, std::byte* output)
+{
+    switch (format)
+    {
+    case BlockCompressionFormat::BC1:
+        encodeBc1ColorBlock(pixels, quality, output);
+        break;
+    case BlockCompressionFormat::BC3:
+        encodeBc4Block(pixels, 3, quality, output);
+        encodeBc1ColorBlock(pixels, quality, output + 8);
+        break;
+    case BlockCompressionFormat::BC5:
+        encodeBc4Block(pixels, 0, quality, output);
+        encodeBc4Block(pixels, 1, quality, output + 8);
+        break;
+    case BlockCompressionFormat::BC7:
+        encodeBc7Block(pixels, quality, output);
+        break;
+    }
+}
+
+void decodeBlock(const std::byte* input, BlockCompressionFormat format, uint8_t* rgba)
+{
+    for (size_t pixel = 0; pixel < blockPixelCount; ++pixel)
+    {
+        rgba[pixel * 4 + 0] = 0;
+        rgba[pixel * 4 + 1] = 0;
+        rgba[pixel * 4 + 2] = 0;
+        rgba[pixel * 4 + 3] = 255;
+    }
+
+    switch (format)
+    {
+    case BlockCompressionFormat::BC1:
+        decodeBc1ColorBlock(input, rgba, 4);
+        break;
+    case BlockCompressionFormat::BC3:
+        decodeBc4Block(input, rgba + 3, 4);
+        decodeBc1ColorBlock(input + 8, rgba, 4);
+        break;
+    case BlockCompressionFormat::BC5:
+        decodeBc4Block(input, rgba + 0, 4);
+        decodeBc4Block(input + 8, rgba + 1, 4);
+        break;
+    case BlockCompressionFormat::BC7:
+        decodeBc7Block(input, rgba);
+        break;
+    }
+}
+
+} // namespace
+
+namespace TextureCompression
+{
+
+size_t getCompressedSize(BlockCompressionFormat format, uint32_t width, uint32_t height)
+{
+    const size_t blocksX = (width + 3) / 4;
+    const size_t blocksY = (height + 3) / 4;
+    return blocksX * blocksY * getBlockSize(format);
+}
+
+std::vector<std::byte> compressImage(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, BlockCompressionFormat format, CompressionQuality quality)
+{
+    if (width == 0 || height == 0 || rgba.size() < size_t(width) * height * 4)
+    {
+        throw std::runtime_error("Invalid image given to the texture compressor!");
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const size_t blockSize = getBlockSize(format);
+    std::vector<std::byte> blocks(getCompressedSize(format, width, height));
+
+    // One row of blocks per task keeps the tasks large enough to amortize scheduling
+    Parallel::forEach(blocksY, [&](size_t blockY)
+                      {
+                          BlockPixels pixels;
+                          for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+                          {
+                              loadBlock(rgba, width, height, blockX, static_cast<uint32_t>(blockY), pixels);
+                              encodeBlock(pixels, format, quality, blocks.data() + (blockY * blocksX + blockX) * blockSize);
+                          }
+                      });
+    return blocks;
+}
+
+std::vector<uint8_t> decompressImage(std::span<const std::byte> blocks, uint32_t width, uint32_t height, BlockCompressionFormat format)
+{
+    if (blocks.size() < getCompressedSize(format, width, height))
+    {
+        throw std::runtime_error("Not enough block data for the image size!");
+    }
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const size_t blockSize = getBlockSize(format);
+    std::vector<uint8_t> rgba(size_t(width) * height * 4);
+
+    Parallel::forEach(blocksY, [&](size_t blockY)
+                      {
+                          uint8_t blockRgba[blockPixelCount * 4];
+                          for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+                          {
+                              decodeBlock(blocks.data() + (blockY * blocksX + blockX) * blockSize, format, blockRgba);
+                              for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y)
+                              {
+                                  for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x)
+                                  {
+                                      const size_t destination = ((blockY * 4 + y) * width + blockX * 4 + x) * 4;
+                                      std::copy_n(blockRgba + (y * 4 + x) * 4, 4, rgba.data() + destination);
+                                  }
+                              }
+                          }
+                      });
+    return rgba;
+}
+
+double computePsnr(std::span<const uint8_t> originalRgba, std::span<const uint8_t> decodedRgba, BlockCompressionFormat format)
+{
+    if (originalRgba.size() != decodedRgba.size())
+    {
+        throw std::runtime_error("Images given to PSNR computation have different sizes!");
+    }
+
+    std::array<bool, channelCount> channels = {true, true, true, true};
+    if (format == BlockCompressionFormat::BC1)
+    {
+        channels = {true, true, true, false};
+    }
+    else if (format == BlockCompressionFormat::BC5)
+    {
+        channels = {true, true, false, false};
+    }
+
+    double squaredErrorSum = 0.0;
+    size_t sampleCount = 0u;
+    for (size_t i = 0; i < originalRgba.size(); ++i)
+    {
+        if (channels[i % channelCount])
+        {
+            const double difference = double(originalRgba[i]) - double(decodedRgba[i]);
+            squaredErrorSum += difference * difference;
+            ++sampleCount;
+        }
+    }
+
+    if (squaredErrorSum == 0.0 || sampleCount == 0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double meanSquaredError = squaredErrorSum / double(sampleCount);
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+TextureCompressionResult compressImageWithReport(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, BlockCompressionFormat format, CompressionQuality quality)
+{
+    TextureCompressionResult result{};
+
+    const auto startTime = std::chrono::steady_clock::now();
+    result.blocks = compressImage(rgba, width, height, format, quality);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    const std::vector<uint8_t> decoded = decompressImage(result.blocks, width, height, format);
+    result.psnr = computePsnr(rgba.first(size_t(width) * height * 4), decoded, format);
+    return result;
+}
+
+const char* getSimdPathName()
+{
+#if defined(TEXTURE_COMPRESSION_AVX2)
+    return "AVX2";
+#elif defined(TEXTURE_COMPRESSION_SSE2)
+    return "SSE2";
+#elif defined(TEXTURE_COMPRESSION_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+}
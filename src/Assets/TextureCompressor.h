@@ -0,0 +1,64 @@
+#ifndef VULKANPROJECT_TEXTURECOMPRESSOR_H
+#define VULKANPROJECT_TEXTURECOMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class BlockCompressionFormat
+{
+    BC1, // RGB, 4 bits per pixel
+    BC3, // RGBA, 8 bits per pixel
+    BC5, // Two channels (normal maps), 8 bits per pixel
+    BC7 // RGBA, 8 bits per pixel, highest quality. Encoded using mode 6 only.
+};
+
+enum class CompressionQuality
+{
+    Fast, // Bounding box endpoints
+    Normal, // Principal axis endpoints with one least squares refinement
+    High // Principal axis endpoints with several least squares refinements
+};
+
+struct TextureCompressionResult
+{
+    std::vector<std::byte> blocks;
+    double psnr; // Over the channels the format stores, infinity for a lossless result
+    double seconds;
+};
+
+/**
+ * CPU block compression for the asset cooker. Block encoders use AVX2, SSE2 or NEON depending on the build target
+ * and images are compressed on all hardware threads.
+ */
+namespace TextureCompression
+{
+
+size_t getCompressedSize(BlockCompressionFormat format, uint32_t width, uint32_t height);
+
+/**
+ * @param rgba Tightly packed 8-bit RGBA pixels. Images that are not a multiple of four in size have their edges clamped.
+ */
+std::vector<std::byte> compressImage(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, BlockCompressionFormat format, CompressionQuality quality);
+
+/**
+ * Decode blocks produced by compressImage() back to 8-bit RGBA. BC7 blocks must use mode 6.
+ */
+std::vector<uint8_t> decompressImage(std::span<const std::byte> blocks, uint32_t width, uint32_t height, BlockCompressionFormat format);
+
+double computePsnr(std::span<const uint8_t> originalRgba, std::span<const uint8_t> decodedRgba, BlockCompressionFormat format);
+
+/**
+ * Compress, then decode to report the PSNR of the result
+ */
+TextureCompressionResult compressImageWithReport(std::span<const uint8_t> rgba, uint32_t width, uint32_t height, BlockCompressionFormat format, CompressionQuality quality);
+
+/**
+ * Name of the SIMD path compiled in, for reports
+ */
+const char* getSimdPathName();
+
+}
+
+#endif // VULKANPROJECT_TEXTURECOMPRESSOR_H
@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+
+#include "BenchmarkMeshes.h"
+#include "../Assets/AssetPackage.h"
+#include "../Assets/MeshAsset.h"
+#include "../Utilities/Filesystem.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+/**
+ * Temporary file removed when the group is done, also when it throws
+ */
+class TemporaryFile
+{
+public:
+    explicit TemporaryFile(const std::string& name) :
+        m_path((std::filesystem::temp_directory_path() / name).string())
+    {
+    }
+
+    ~TemporaryFile()
+    {
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+
+    const std::string& getPath() const
+    {
+        return m_path;
+    }
+private:
+    std::string m_path;
+};
+
+/**
+ * Serialized like the cooked mesh assets that CPUResourceManager loads, so the data compresses like real assets
+ */
+std::vector<std::byte> createMeshAsset(const Mesh& mesh)
+{
+    const MeshAssetHeader header{static_cast<uint32_t>(mesh.vertices.size()), static_cast<uint32_t>(mesh.indices.size())};
+    const size_t verticesSize = mesh.vertices.size() * sizeof(MeshVertex);
+    const size_t indicesSize = mesh.indices.size() * sizeof(uint32_t);
+    std::vector<std::byte> data(sizeof(header) + verticesSize + indicesSize);
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), mesh.vertices.data(), verticesSize);
+    std::memcpy(data.data() + sizeof(header) + verticesSize, mesh.indices.data(), indicesSize);
+    return data;
+}
+
+void runFileSystemBenchmarks(Benchmark::Context& context)
+{
+    for (const size_t megabytes : {1u, 64u})
+    {
+        const TemporaryFile file("VulkanProjectBenchmark" + std::to_string(megabytes) + ".bin");
+        {
+            std::ofstream output(file.getPath(), std::ios::binary);
+            const std::vector<char> data(megabytes * 1024u * 1024u, 'x');
+            output.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        // Repeated reads come from the page cache, so this measures the read path rather than the disk
+        context.measure("Load " + std::to_string(megabytes) + " MB file", [&]()
+                        { Benchmark::doNotOptimize(FileSystem::loadTextFile(file.getPath())); });
+    }
+}
+
+void runAssetPackageBenchmarks(Benchmark::Context& context)
+{
+    const std::vector<std::byte> meshAsset = createMeshAsset(Benchmark::createTestSphere(512u, 1024u));
+    const std::pair<AssetCompression, const char*> compressions[] = {{AssetCompression::None, "None"}, {AssetCompression::LZ4, "LZ4"}, {AssetCompression::Zstd, "Zstd"}};
+
+    const TemporaryFile packageFile("VulkanProjectBenchmark.pak");
+    {
+        // Lower zstd level than the cooker, this only needs representative data
+        AssetPackageWriter writer(AssetPackageWriter::defaultChunkSize, 3);
+        for (const auto& [compression, compressionName] : compressions)
+        {
+            writer.addAsset(compressionName, meshAsset, compression);
+        }
+        writer.write(packageFile.getPath());
+    }
+
+    const std::string megabytes = std::to_string(meshAsset.size() / (1024u * 1024u));
+    context.measure("Open package", [&]()
+                    {
+                        AssetPackage package(packageFile.getPath());
+                        Benchmark::doNotOptimize(package.getEntries());
+                    });
+
+    AssetPackage package(packageFile.getPath());
+    std::vector<std::byte> destination(meshAsset.size());
+    for (const auto& [compression, compressionName] : compressions)
+    {
+        context.measure("Load " + megabytes + " MB mesh " + compressionName, [&]()
+                        {
+                            package.decompressAsset(compressionName, destination);
+                            Benchmark::doNotOptimize(destination.data());
+                        });
+    }
+}
+
+const Benchmark::Registration fileSystemRegistration("FileSystem", runFileSystemBenchmarks);
+const Benchmark::Registration assetPackageRegistration("AssetPackage", runAssetPackageBenchmarks);
+
+}
@@ -0,0 +1,107 @@
+#ifndef VULKANPROJECT_BENCHMARK_H
+#define VULKANPROJECT_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal benchmark harness. Benchmark groups register themselves with a static Benchmark::Registration and measure
+ * their cases through the Context they are given.
+ */
+namespace Benchmark
+{
+
+struct Result
+{
+    std::string group;
+    std::string name;
+    uint32_t iterations;
+    double minMilliseconds;
+    double meanMilliseconds;
+    double p50Milliseconds;
+    double p90Milliseconds;
+    double p99Milliseconds;
+    double maxMilliseconds;
+};
+
+class Context
+{
+public:
+    explicit Context(double minSecondsPerCase);
+
+    /**
+     * Run function once to warm up, then repeatedly until minSecondsPerCase has passed.
+     */
+    template<typename Function>
+    const Result& measure(const std::string& name, Function function)
+    {
+        function();
+
+        std::vector<double> samples;
+        double totalMilliseconds = 0.0;
+        while (samples.empty() || totalMilliseconds < m_minSecondsPerCase * 1000.0)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            samples.push_back(milliseconds);
+            totalMilliseconds += milliseconds;
+        }
+        return report(name, std::move(samples));
+    }
+
+    /**
+     * Name of the group whose cases are measured next
+     */
+    void beginGroup(std::string group);
+    const std::vector<Result>& getResults() const;
+
+    /**
+     * Write every result as JSON, for comparing runs across versions
+     */
+    void writeJson(const std::string& path) const;
+
+private:
+    const Result& report(const std::string& name, std::vector<double> samples);
+
+    double m_minSecondsPerCase;
+    std::string m_group;
+    std::vector<Result> m_results;
+};
+
+using Group = std::function<void(Context&)>;
+
+struct Registration
+{
+    Registration(std::string name, Group group);
+};
+
+struct RegisteredGroup
+{
+    std::string name;
+    Group group;
+};
+
+std::vector<RegisteredGroup>& getRegisteredGroups();
+
+/**
+ * Keeps the optimizer from discarding results that are otherwise unused
+ */
+template<typename T>
+void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+}
+
+#endif // VULKANPROJECT_BENCHMARK_H
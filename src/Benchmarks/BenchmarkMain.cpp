@@ -0,0 +1,159 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace Benchmark
+{
+
+Context::Context(double minSecondsPerCase) :
+    m_minSecondsPerCase(minSecondsPerCase)
+{
+}
+
+void Context::beginGroup(std::string group)
+{
+    m_group = std::move(group);
+}
+
+const std::vector<Result>& Context::getResults() const
+{
+    return m_results;
+}
+
+void Context::writeJson(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open " + path + " for writing!");
+    }
+
+    // Group and case names are plain text written by the benchmarks, they never need escaping
+    file << std::fixed << std::setprecision(6);
+    file << "{\n  \"minSecondsPerCase\": " << m_minSecondsPerCase << ",\n  \"results\": [";
+    for (size_t i = 0; i < m_results.size(); ++i)
+    {
+        const Result& result = m_results[i];
+        file << (i == 0 ? "\n" : ",\n");
+        file << "    {\"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+             << ", \"minMs\": " << result.minMilliseconds << ", \"meanMs\": " << result.meanMilliseconds << ", \"p50Ms\": " << result.p50Milliseconds
+             << ", \"p90Ms\": " << result.p90Milliseconds << ", \"p99Ms\": " << result.p99Milliseconds << ", \"maxMs\": " << result.maxMilliseconds << "}";
+    }
+    file << "\n  ]\n}\n";
+}
+
+const Result& Context::report(const std::string& name, std::vector<double> samples)
+{
+    double totalMilliseconds = 0.0;
+    for (const double sample : samples)
+    {
+        totalMilliseconds += sample;
+    }
+    std::sort(samples.begin(), samples.end());
+    // Nearest rank percentiles
+    auto percentile = [&samples](double fraction)
+    { return samples[std::min(samples.size() - 1, static_cast<size_t>(fraction * static_cast<double>(samples.size())))]; };
+
+    Result result{};
+    result.group = m_group;
+    result.name = name;
+    result.iterations = static_cast<uint32_t>(samples.size());
+    result.minMilliseconds = samples.front();
+    result.meanMilliseconds = totalMilliseconds / static_cast<double>(samples.size());
+    result.p50Milliseconds = percentile(0.5);
+    result.p90Milliseconds = percentile(0.9);
+    result.p99Milliseconds = percentile(0.99);
+    result.maxMilliseconds = samples.back();
+
+    std::printf("  %-56s %8u iterations %12.3f ms min %12.3f ms mean %12.3f ms p99\n",
+                result.name.c_str(),
+                result.iterations,
+                result.minMilliseconds,
+                result.meanMilliseconds,
+                result.p99Milliseconds);
+    m_results.push_back(std::move(result));
+    return m_results.back();
+}
+
+Registration::Registration(std::string name, Group group)
+{
+    getRegisteredGroups().push_back(RegisteredGroup{std::move(name), std::move(group)});
+}
+
+std::vector<RegisteredGroup>& getRegisteredGroups()
+{
+    static std::vector<RegisteredGroup> groups;
+    return groups;
+}
+
+}
+
+/**
+ * Usage: Benchmarks [group filter] [--min-time seconds] [--json output path]
+ *
+ * A group that throws is reported and skipped, the others still run. The exit code tells whether any group failed.
+ */
+int main(int argc, char** argv)
+{
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    double minSecondsPerCase = 0.5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            minSecondsPerCase = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    Benchmark::Context context(minSecondsPerCase);
+    bool hasFailed = false;
+    for (const Benchmark::RegisteredGroup& group : Benchmark::getRegisteredGroups())
+    {
+        if (filter && group.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        std::printf("%s\n", group.name.c_str());
+        context.beginGroup(group.name);
+        try
+        {
+            group.group(context);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << group.name << " failed: " << e.what() << std::endl;
+            hasFailed = true;
+        }
+    }
+
+    if (jsonPath)
+    {
+        try
+        {
+            context.writeJson(jsonPath);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return hasFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,44 @@
+#include "BenchmarkMeshes.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+
+namespace Benchmark
+{
+
+Mesh createTestSphere(uint32_t rings, uint32_t segments)
+{
+    Mesh mesh;
+    mesh.vertices.reserve(size_t(rings + 1) * (segments + 1));
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        const float v = float(ring) / float(rings);
+        const float polar = v * glm::pi<float>();
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            const float u = float(segment) / float(segments);
+            const float azimuth = u * glm::two_pi<float>();
+            const glm::vec3 normal(std::sin(polar) * std::cos(azimuth), std::cos(polar), std::sin(polar) * std::sin(azimuth));
+            const float bump = 1.0f + 0.05f * std::sin(polar * 12.0f) * std::sin(azimuth * 9.0f);
+            mesh.vertices.push_back(MeshVertex{normal * bump, normal, glm::vec2(u, v)});
+        }
+    }
+
+    mesh.indices.reserve(size_t(rings) * segments * 6);
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            const uint32_t first = ring * (segments + 1) + segment;
+            const uint32_t below = first + segments + 1;
+            for (const uint32_t index : {first, below, first + 1, first + 1, below, below + 1})
+            {
+                mesh.indices.push_back(index);
+            }
+        }
+    }
+    return mesh;
+}
+
+}
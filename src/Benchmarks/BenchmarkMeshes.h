@@ -0,0 +1,19 @@
+#ifndef VULKANPROJECT_BENCHMARKMESHES_H
+#define VULKANPROJECT_BENCHMARKMESHES_H
+
+#include "../Assets/Mesh.h"
+
+#include <cstdint>
+
+namespace Benchmark
+{
+
+/**
+ * Unit UV sphere with a bumpy surface, so that simplification has real error to weigh. The seam vertices are
+ * duplicated like in exported meshes. (rings + 1) * (segments + 1) vertices.
+ */
+Mesh createTestSphere(uint32_t rings, uint32_t segments);
+
+}
+
+#endif // VULKANPROJECT_BENCHMARKMESHES_H
@@ -0,0 +1,130 @@
+#include "Benchmark.h"
+
+#include "../Renderer/CpuCulling.h"
+#include "../Renderer/OcclusionBuffer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace
+{
+
+struct TestScene
+{
+    BoundingSpheres spheres;
+    BoundingBoxes boxes;
+    std::vector<glm::vec3> occluderVertices;
+    std::vector<uint32_t> occluderIndices;
+    glm::mat4 viewProjection;
+};
+
+void addOccluderBox(TestScene& scene, glm::vec3 boxMin, glm::vec3 boxMax)
+{
+    const uint32_t firstVertex = static_cast<uint32_t>(scene.occluderVertices.size());
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        scene.occluderVertices.emplace_back((corner & 1u) ? boxMax.x : boxMin.x, (corner & 2u) ? boxMax.y : boxMin.y, (corner & 4u) ? boxMax.z : boxMin.z);
+    }
+    const uint32_t faces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+    for (const auto& face : faces)
+    {
+        for (const uint32_t corner : {face[0], face[1], face[2], face[0], face[2], face[3]})
+        {
+            scene.occluderIndices.push_back(firstVertex + corner);
+        }
+    }
+}
+
+/**
+ * Objects scattered over a large ground plane around the camera, with a row of walls in front of it as occluders
+ */
+TestScene createTestScene(size_t objectCount)
+{
+    TestScene scene;
+    std::mt19937 random(1234u);
+    std::uniform_real_distribution<float> horizontal(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> vertical(0.0f, 20.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+    scene.spheres.reserve(objectCount);
+    scene.boxes.reserve(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+    {
+        const glm::vec3 center(horizontal(random), vertical(random), horizontal(random));
+        const glm::vec3 extent(size(random), size(random), size(random));
+        scene.spheres.add(center, glm::length(extent));
+        scene.boxes.add(center - extent, center + extent);
+    }
+
+    for (int wall = -4; wall < 4; ++wall)
+    {
+        const float x = static_cast<float>(wall) * 40.0f;
+        addOccluderBox(scene, glm::vec3(x, 0.0f, 60.0f), glm::vec3(x + 36.0f, 40.0f, 62.0f));
+    }
+
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 10.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+    projection[1][1] *= -1.0f;
+    scene.viewProjection = projection * view;
+    return scene;
+}
+
+size_t countVisible(const std::vector<uint8_t>& visible)
+{
+    return std::accumulate(visible.begin(), visible.end(), size_t(0));
+}
+
+void runCullingBenchmarks(Benchmark::Context& context)
+{
+    for (const size_t objectCount : {size_t(100000), size_t(1000000)})
+    {
+        const TestScene scene = createTestScene(objectCount);
+        const Frustum frustum = extractFrustum(scene.viewProjection);
+        std::vector<uint8_t> visible(objectCount);
+        const std::string prefix = std::to_string(objectCount) + " ";
+
+        const double sphereReference = context.measure(prefix + "spheres frustum reference", [&]()
+                                                       {
+                                                           CpuCulling::cullSpheresReference(frustum, scene.spheres, visible);
+                                                           Benchmark::doNotOptimize(visible.data());
+                                                       }).minMilliseconds;
+        const double sphereOptimized = context.measure(prefix + "spheres frustum", [&]()
+                                                       {
+                                                           CpuCulling::cullSpheres(frustum, scene.spheres, visible);
+                                                           Benchmark::doNotOptimize(visible.data());
+                                                       }).minMilliseconds;
+        std::printf("  %-56s %8.1fx\n", (prefix + "spheres frustum speedup").c_str(), sphereReference / sphereOptimized);
+
+        const double boxReference = context.measure(prefix + "boxes frustum reference", [&]()
+                                                    {
+                                                        CpuCulling::cullBoxesReference(frustum, scene.boxes, visible);
+                                                        Benchmark::doNotOptimize(visible.data());
+                                                    }).minMilliseconds;
+        const double boxOptimized = context.measure(prefix + "boxes frustum", [&]()
+                                                    {
+                                                        CpuCulling::cullBoxes(frustum, scene.boxes, visible);
+                                                        Benchmark::doNotOptimize(visible.data());
+                                                    }).minMilliseconds;
+        std::printf("  %-56s %8.1fx\n", (prefix + "boxes frustum speedup").c_str(), boxReference / boxOptimized);
+        const size_t frustumVisible = countVisible(visible);
+
+        OcclusionBuffer occlusionBuffer(256, 144);
+        context.measure(prefix + "boxes frustum and occlusion", [&]()
+                        {
+                            CpuCulling::cullBoxes(frustum, scene.boxes, visible);
+                            occlusionBuffer.begin(scene.viewProjection);
+                            occlusionBuffer.rasterizeOccluders(scene.occluderVertices, scene.occluderIndices);
+                            occlusionBuffer.buildHierarchy();
+                            occlusionBuffer.cullBoxes(scene.boxes, visible);
+                            Benchmark::doNotOptimize(visible.data());
+                        });
+        std::printf("  %-56s %8zu frustum %8zu occlusion\n", (prefix + "boxes visible").c_str(), frustumVisible, countVisible(visible));
+    }
+}
+
+const Benchmark::Registration registration("Culling", runCullingBenchmarks);
+
+}
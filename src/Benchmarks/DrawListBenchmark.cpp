@@ -0,0 +1,98 @@
+#include "Benchmark.h"
+
+#include "../Renderer/DrawList.h"
+#include "../Utilities/RadixSort.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace
+{
+
+constexpr uint32_t meshCount = 64u;
+constexpr uint32_t pipelineCount = 8u;
+
+std::vector<RadixSort::KeyValue> createKeys(size_t count)
+{
+    std::mt19937_64 random(1234u);
+    std::vector<RadixSort::KeyValue> keys(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i] = RadixSort::KeyValue{random(), static_cast<uint32_t>(i)};
+    }
+    return keys;
+}
+
+/**
+ * Random transforms of a few meshes and pipelines scattered around the camera, with four LODs per mesh
+ */
+void submitTestScene(DrawList& drawList, std::unordered_map<uint32_t, DrawListMesh>& meshes, size_t drawCount)
+{
+    std::mt19937 random(1234u);
+    std::uniform_real_distribution<float> horizontal(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> scale(0.5f, 4.0f);
+
+    for (uint32_t mesh = 0; mesh < meshCount; ++mesh)
+    {
+        meshes[mesh] = DrawListMesh{glm::vec3(0.0f), 1.0f, {{0u, 0u, 0.0f}, {0u, 0u, 0.01f}, {0u, 0u, 0.04f}, {0u, 0u, 0.16f}}};
+    }
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        const glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(horizontal(random), 0.0f, horizontal(random))), glm::vec3(scale(random)));
+        const auto mesh = static_cast<uint16_t>(random() % meshCount);
+        const auto pipeline = static_cast<uint16_t>(random() % pipelineCount);
+        drawList.submit(Handle<HandleType::Mesh>(mesh, 0u), Handle<HandleType::Pipeline>(pipeline, 0u), transform);
+    }
+}
+
+void runDrawListBenchmarks(Benchmark::Context& context)
+{
+    for (const size_t count : {size_t(100000), size_t(1000000)})
+    {
+        const std::string prefix = std::to_string(count) + " ";
+        const std::vector<RadixSort::KeyValue> keys = createKeys(count);
+        std::vector<RadixSort::KeyValue> sorted;
+        std::vector<RadixSort::KeyValue> scratch;
+
+        const double reference = context.measure(prefix + "keys std::sort", [&]()
+                                                 {
+                                                     sorted = keys;
+                                                     std::sort(sorted.begin(), sorted.end(), [](const RadixSort::KeyValue& a, const RadixSort::KeyValue& b)
+                                                               { return a.key < b.key; });
+                                                     Benchmark::doNotOptimize(sorted.data());
+                                                 }).minMilliseconds;
+        const double radix = context.measure(prefix + "keys radix sort", [&]()
+                                             {
+                                                 sorted = keys;
+                                                 RadixSort::sort(sorted, scratch);
+                                                 Benchmark::doNotOptimize(sorted.data());
+                                             }).minMilliseconds;
+        std::printf("  %-56s %8.1fx\n", (prefix + "keys radix sort speedup").c_str(), reference / radix);
+
+        DrawList drawList;
+        std::unordered_map<uint32_t, DrawListMesh> meshes;
+        submitTestScene(drawList, meshes, count);
+
+        const glm::vec3 cameraPosition(0.0f, 10.0f, 0.0f);
+        const glm::mat4 view = glm::lookAt(cameraPosition, glm::vec3(0.0f, 10.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 2000.0f);
+        projection[1][1] *= -1.0f;
+        const Frustum frustum = extractFrustum(projection * view);
+        const LodSelectionSettings settings{computeLodProjectionScale(glm::radians(60.0f), 1080.0f), 1.0f};
+
+        Vulkan::InstancedDrawList built;
+        context.measure(prefix + "draws cull, sort and batch", [&]()
+                        {
+                            built = drawList.build(meshes, frustum, cameraPosition, settings);
+                            Benchmark::doNotOptimize(built.draws.data());
+                        });
+        std::printf("  %-56s %8zu instances %8zu draws\n", (prefix + "draws batched").c_str(), built.instances.size(), built.draws.size());
+    }
+}
+
+const Benchmark::Registration registration("DrawList", runDrawListBenchmarks);
+
+}
@@ -0,0 +1,68 @@
+#include "Benchmark.h"
+
+#include "../Renderer/Backend/Handle.h"
+
+#include <random>
+#include <string>
+
+namespace
+{
+
+struct TestData
+{
+    uint64_t value;
+    uint64_t padding[3];
+};
+
+using TestStorage = HandleStorage<HandleType::Buffer, TestData>;
+
+void runHandleStorageBenchmarks(Benchmark::Context& context)
+{
+    constexpr uint32_t elementCount = 50000u; // Ids are 16 bits
+
+    context.measure("Insert " + std::to_string(elementCount), [&]()
+                    {
+                        TestStorage storage;
+                        for (uint32_t i = 0; i < elementCount; ++i)
+                        {
+                            Benchmark::doNotOptimize(storage.insertElement(TestData{i, {}}));
+                        }
+                    });
+
+    TestStorage storage;
+    std::vector<Handle<HandleType::Buffer>> handles;
+    for (uint32_t i = 0; i < elementCount; ++i)
+    {
+        handles.push_back(storage.insertElement(TestData{i, {}}));
+    }
+
+    // Random order, as handles are looked up by the objects that hold them
+    std::vector<Handle<HandleType::Buffer>> shuffledHandles = handles;
+    std::shuffle(shuffledHandles.begin(), shuffledHandles.end(), std::mt19937(1234u));
+    context.measure("Get " + std::to_string(elementCount) + " in random order", [&]()
+                    {
+                        uint64_t sum = 0u;
+                        for (const Handle<HandleType::Buffer> handle : shuffledHandles)
+                        {
+                            sum += storage.getElement(handle).value;
+                        }
+                        Benchmark::doNotOptimize(sum);
+                    });
+
+    // Every other element is destroyed and replaced, which recycles ids with new generations
+    context.measure("Pop and reinsert " + std::to_string(elementCount / 2), [&]()
+                    {
+                        for (uint32_t i = 0; i < elementCount; i += 2)
+                        {
+                            const TestData data = storage.popElement(handles[i]);
+                            handles[i] = storage.insertElement(data);
+                        }
+                    });
+
+    context.measure("Get alive data of " + std::to_string(elementCount), [&]()
+                    { Benchmark::doNotOptimize(storage.getAliveData()); });
+}
+
+const Benchmark::Registration registration("HandleStorage", runHandleStorageBenchmarks);
+
+}
@@ -0,0 +1,37 @@
+#include "Benchmark.h"
+
+#include "BenchmarkMeshes.h"
+#include "../Assets/MeshOptimizer.h"
+#include "../Assets/MeshSimplifier.h"
+#include "../Assets/MeshletBuilder.h"
+
+#include <string>
+
+namespace
+{
+
+void runMeshProcessingBenchmarks(Benchmark::Context& context)
+{
+    const Mesh sourceMesh = Benchmark::createTestSphere(256u, 512u);
+    const std::string triangles = std::to_string(sourceMesh.indices.size() / 3000u) + "k triangles";
+
+    // The optimizer works in place, so every iteration copies the unoptimized mesh
+    context.measure("Optimize " + triangles, [&]()
+                    {
+                        Mesh mesh = sourceMesh;
+                        Benchmark::doNotOptimize(MeshOptimization::optimizeMesh(mesh));
+                    });
+
+    Mesh mesh = sourceMesh;
+    MeshOptimization::optimizeMesh(mesh);
+    context.measure("Quantize " + triangles, [&]()
+                    { Benchmark::doNotOptimize(MeshOptimization::quantizeMesh(mesh)); });
+    context.measure("Build LOD chain of " + triangles, [&]()
+                    { Benchmark::doNotOptimize(MeshSimplification::buildLodChain(mesh)); });
+    context.measure("Build meshlets of " + triangles, [&]()
+                    { Benchmark::doNotOptimize(MeshletGeneration::buildMeshlets(mesh.vertices, mesh.indices)); });
+}
+
+const Benchmark::Registration registration("MeshProcessing", runMeshProcessingBenchmarks);
+
+}
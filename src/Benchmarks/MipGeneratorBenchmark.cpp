@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+
+#include "../Assets/MipGenerator.h"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+std::vector<std::byte> createTestImage(uint32_t width, uint32_t height, MipImageFormat format)
+{
+    std::vector<std::byte> image(size_t(width) * height * MipGeneration::getPixelSize(format));
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            // Checkerboard over gradients, high frequencies are what separates the filters
+            const float pixel[4] = {((x ^ y) & 8u) ? 1.0f : 0.05f, float(x) / float(width), float(y) / float(height), 0.5f + 0.5f * std::sin(float(x + y) * 0.1f)};
+            const size_t index = size_t(y) * width + x;
+            if (format == MipImageFormat::RGBA32Float)
+            {
+                std::memcpy(image.data() + index * sizeof(pixel), pixel, sizeof(pixel));
+            }
+            else
+            {
+                for (size_t channel = 0; channel < 4; ++channel)
+                {
+                    image[index * 4 + channel] = static_cast<std::byte>(static_cast<uint8_t>(pixel[channel] * 255.0f));
+                }
+            }
+        }
+    }
+    return image;
+}
+
+void runMipGeneratorBenchmarks(Benchmark::Context& context)
+{
+    constexpr uint32_t size = 2048;
+    const std::pair<MipImageFormat, const char*> formats[] = {{MipImageFormat::RGBA8Unorm, "RGBA8Unorm"}, {MipImageFormat::RGBA8Srgb, "RGBA8Srgb"}, {MipImageFormat::RGBA32Float, "RGBA32Float"}};
+    const std::pair<MipFilter, const char*> filters[] = {{MipFilter::Box, "Box"}, {MipFilter::Kaiser, "Kaiser"}};
+
+    for (const auto& [format, formatName] : formats)
+    {
+        const std::vector<std::byte> image = createTestImage(size, size, format);
+        for (const auto& [filter, filterName] : filters)
+        {
+            const std::string name = std::to_string(size) + " " + formatName + " " + filterName;
+            const double reference = context.measure(name + " reference", [&]()
+                                                     {
+                                                         Benchmark::doNotOptimize(MipGeneration::generateMipChainReference(image, size, size, format, filter));
+                                                     }).minMilliseconds;
+            const double optimized = context.measure(name, [&]()
+                                                     {
+                                                         Benchmark::doNotOptimize(MipGeneration::generateMipChain(image, size, size, format, filter));
+                                                     }).minMilliseconds;
+            std::printf("  %-56s %8.1fx\n", (name + " speedup").c_str(), reference / optimized);
+        }
+    }
+}
+
+const Benchmark::Registration registration("MipGeneration", runMipGeneratorBenchmarks);
+
+}
@@ -0,0 +1,125 @@
+#include "Benchmark.h"
+
+#include "BenchmarkMeshes.h"
+#include "../Assets/MeshOptimizer.h"
+#include "../Assets/MeshSimplifier.h"
+#include "../Renderer/Frustum.h"
+#include "../Renderer/LodSelection.h"
+#include "../Renderer/ShaderCompiler.h"
+#include "../Renderer/Backend/Vulkan/VulkanBackend.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const glm::uvec2 resolution(1280u, 720u);
+
+/**
+ * Surface without a window from VK_EXT_headless_surface, which CPU drivers such as lavapipe provide. Presenting to it
+ * only returns the image, so frames cost what the renderer costs.
+ */
+VkSurfaceKHR createHeadlessSurface(VkInstance& instance)
+{
+    const auto createSurface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(vkGetInstanceProcAddr(instance, "vkCreateHeadlessSurfaceEXT"));
+    if (!createSurface)
+    {
+        throw std::runtime_error("VK_EXT_headless_surface is not available!");
+    }
+    VkHeadlessSurfaceCreateInfoEXT createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+    VkSurfaceKHR surface;
+    if (createSurface(instance, &createInfo, nullptr, &surface) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a headless surface!");
+    }
+    return surface;
+}
+
+std::vector<uint32_t> compileShader(ShaderCompiler& compiler, const std::string& path, EShLanguage stage)
+{
+    return compiler.compileShader(path, path, stage).spirvCode;
+}
+
+/**
+ * Square grid of instances in front of the camera, the far ones small enough on screen to use coarse LODs
+ */
+std::vector<Vulkan::GpuInstanceUpdate> createInstances(uint32_t instanceCount, Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> pipeline)
+{
+    const auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+    std::vector<Vulkan::GpuInstanceUpdate> instances;
+    instances.reserve(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; ++i)
+    {
+        const glm::vec3 position(3.0f * (float(i % side) - 0.5f * float(side)), 0.0f, -3.0f * float(i / side));
+        const Vulkan::GpuInstance instance{glm::translate(glm::mat4(1.0f), position), mesh.getId(), pipeline.getId(), Vulkan::instanceVisibleFlag, 0u};
+        instances.push_back(Vulkan::GpuInstanceUpdate{i, {0u, 0u, 0u}, instance});
+    }
+    return instances;
+}
+
+void runRenderingBenchmarks(Benchmark::Context& context)
+{
+    const std::vector<const char*> instanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+    Vulkan::VulkanBackend backend(false, resolution, createHeadlessSurface, instanceExtensions);
+
+    {
+        // Relative to the working directory, the build copies the shaders next to the executables
+        ShaderCompiler compiler;
+        backend.createInstanceCullingPipeline(compileShader(compiler, "shaders/InstanceCulling.comp", EShLanguage::EShLangCompute));
+        backend.createInstanceUploadPipeline(compileShader(compiler, "shaders/InstanceUpload.comp", EShLanguage::EShLangCompute));
+        backend.createClusterCullingPipeline(compileShader(compiler, "shaders/ClusterCulling.comp", EShLanguage::EShLangCompute));
+    }
+    ShaderCompiler compiler;
+    const Handle<HandleType::Pipeline> pipeline = backend.createGraphicsPipeline(compileShader(compiler, "shaders/shader.vert", EShLanguage::EShLangVertex),
+                                                                                 compileShader(compiler, "shaders/shader.frag", EShLanguage::EShLangFragment));
+
+    // Processed like CPUResourceManager processes loaded meshes
+    Mesh sphere = Benchmark::createTestSphere(64u, 128u);
+    MeshOptimization::optimizeMesh(sphere);
+    const QuantizedMesh quantizedSphere = MeshOptimization::quantizeMesh(sphere);
+    const Handle<HandleType::Mesh> mesh = backend.createMesh(quantizedSphere.vertices, MeshSimplification::buildLodChain(sphere));
+
+    const glm::vec3 cameraPosition(0.0f, 20.0f, 20.0f);
+    const float verticalFov = glm::radians(60.0f);
+    glm::mat4 projection = glm::perspective(verticalFov, float(resolution.x) / float(resolution.y), 0.1f, 1000.0f);
+    projection[1][1] *= -1.0f;
+    Vulkan::FrameView view{};
+    view.viewProjection = projection * glm::lookAt(cameraPosition, glm::vec3(0.0f, 0.0f, -100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    view.frustumPlanes = extractFrustum(view.viewProjection).planes;
+    view.cameraPosition = cameraPosition;
+    view.lodProjectionScale = computeLodProjectionScale(verticalFov, float(resolution.y));
+    view.maxLodPixelError = 1.0f;
+
+    // Every iteration is one frame. The frames in flight keep the GPU busy, so steady state frame times include
+    // waiting for the GPU when it is the bottleneck.
+    for (const uint32_t instanceCount : {1000u, 10000u, 50000u})
+    {
+        const std::vector<Vulkan::GpuInstanceUpdate> instances = createInstances(instanceCount, mesh, pipeline);
+        const std::string instanceText = std::to_string(instanceCount) + " instances";
+        context.measure("Frame of " + instanceText + ", all uploaded", [&]()
+                        { backend.drawFrame(instanceCount, instances, view); });
+        // Instances persist on the GPU, so frames upload only what changed
+        context.measure("Frame of " + instanceText + ", none changed", [&]()
+                        { backend.drawFrame(instanceCount, {}, view); });
+        const std::span<const Vulkan::GpuInstanceUpdate> changedInstances = std::span(instances).first(instanceCount / 100u);
+        context.measure("Frame of " + instanceText + ", 1% changed", [&]()
+                        { backend.drawFrame(instanceCount, changedInstances, view); });
+    }
+
+    for (const Vulkan::GpuScopeStatistics& scope : backend.getGpuProfile())
+    {
+        std::printf("  %-56s %12.3f ms GPU average\n", scope.name.c_str(), scope.averageMilliseconds);
+    }
+}
+
+const Benchmark::Registration registration("Rendering", runRenderingBenchmarks);
+
+}
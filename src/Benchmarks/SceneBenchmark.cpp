@@ -0,0 +1,81 @@
+#include "Benchmark.h"
+
+#include "../Scene/Scene.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t objectCount = 50000u;
+
+struct Velocity
+{
+    glm::vec3 value;
+};
+
+void runSceneBenchmarks(Benchmark::Context& context)
+{
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+
+    Scene scene;
+    std::vector<Entity> objects;
+    for (uint32_t i = 0; i < objectCount; ++i)
+    {
+        const Entity object = scene.createObject(LocalTransform{glm::vec3(position(random), position(random), position(random))});
+        // Every other object is drawn, every fourth one moves
+        if (i % 2u == 0u)
+        {
+            scene.setMesh(object, Handle<HandleType::Mesh>(0, 0), Handle<HandleType::Pipeline>(0, 0));
+        }
+        if (i % 4u == 0u)
+        {
+            scene.getRegistry().addComponent(object, Velocity{glm::vec3(position(random))});
+        }
+        objects.push_back(object);
+    }
+    scene.update();
+    const std::string objectText = std::to_string(objectCount / 1000u) + "k objects";
+
+    // Extraction to the renderer sends only the objects whose world matrices this recomputes
+    std::vector<Entity> movedObjects = objects;
+    std::shuffle(movedObjects.begin(), movedObjects.end(), random);
+    movedObjects.erase(movedObjects.begin() + static_cast<std::ptrdiff_t>(objects.size() / 100u), movedObjects.end());
+    context.measure("Update " + objectText + ", 1% moved", [&]()
+                    {
+                        for (const Entity object : movedObjects)
+                        {
+                            scene.setLocalTransform(object, LocalTransform{glm::vec3(position(random))});
+                        }
+                        scene.update();
+                    });
+
+    EntityRegistry& registry = scene.getRegistry();
+    context.measure("Iterate velocity and transform components of " + objectText, [&]()
+                    {
+                        registry.forEach<Velocity, TransformComponent>([&](Entity entity, Velocity& velocity, TransformComponent& transform)
+                                                                       {
+                                                                           velocity.value *= 0.99f;
+                                                                           registry.markChanged<Velocity>(entity);
+                                                                           Benchmark::doNotOptimize(transform.node);
+                                                                       });
+                    });
+
+    context.measure("Look up components of " + objectText + " by entity", [&]()
+                    {
+                        uint32_t nodeSum = 0u;
+                        for (const Entity object : objects)
+                        {
+                            nodeSum += registry.getComponent<TransformComponent>(object).node;
+                        }
+                        Benchmark::doNotOptimize(nodeSum);
+                    });
+}
+
+const Benchmark::Registration registration("Scene", runSceneBenchmarks);
+
+}
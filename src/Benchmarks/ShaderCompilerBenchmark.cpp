@@ -0,0 +1,34 @@
+#include "Benchmark.h"
+
+#include "../Renderer/ShaderCompiler.h"
+
+#include <string>
+
+namespace
+{
+
+void runShaderCompilerBenchmarks(Benchmark::Context& context)
+{
+    // Relative to the working directory, the build copies the shaders next to the executables
+    const std::pair<const char*, EShLanguage> shaders[] = {{"shaders/shader.vert", EShLanguage::EShLangVertex},
+                                                           {"shaders/shader.frag", EShLanguage::EShLangFragment},
+                                                           {"shaders/ClusterCulling.comp", EShLanguage::EShLangCompute}};
+
+    for (const auto& [path, stage] : shaders)
+    {
+        // Cold includes initializing and finalizing glslang, as a process compiling a single shader pays
+        context.measure(std::string("Compile ") + path + " cold", [&]()
+                        {
+                            ShaderCompiler compiler;
+                            Benchmark::doNotOptimize(compiler.compileShader(path, path, stage));
+                        });
+
+        ShaderCompiler compiler;
+        context.measure(std::string("Compile ") + path + " warm", [&]()
+                        { Benchmark::doNotOptimize(compiler.compileShader(path, path, stage)); });
+    }
+}
+
+const Benchmark::Registration registration("ShaderCompiler", runShaderCompilerBenchmarks);
+
+}
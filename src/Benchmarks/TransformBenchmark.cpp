@@ -0,0 +1,92 @@
+#include "Benchmark.h"
+
+#include "../Scene/TransformHierarchy.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t nodeCount = 131072u;
+constexpr uint32_t rootCount = 256u;
+
+/**
+ * Scene shaped like a large glTF: a few hundred root objects whose subtrees are mostly small
+ */
+TransformHierarchy createHierarchy(std::vector<uint32_t>& nodes)
+{
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    auto randomTransform = [&]()
+    {
+        LocalTransform transform;
+        transform.translation = glm::vec3(position(random), position(random), position(random));
+        transform.rotation = glm::angleAxis(position(random), glm::normalize(glm::vec3(position(random), position(random), 1.0f)));
+        return transform;
+    };
+
+    TransformHierarchy hierarchy;
+    for (uint32_t i = 0; i < rootCount; ++i)
+    {
+        nodes.push_back(hierarchy.addNode(TransformHierarchy::noParent, randomTransform()));
+    }
+    while (nodes.size() < nodeCount)
+    {
+        // Parents are picked from the earlier nodes, which gives depths up to around a dozen
+        const uint32_t parent = nodes[std::uniform_int_distribution<size_t>(0, nodes.size() - 1)(random)];
+        nodes.push_back(hierarchy.addNode(parent, randomTransform()));
+    }
+    return hierarchy;
+}
+
+void runTransformBenchmarks(Benchmark::Context& context)
+{
+    std::vector<uint32_t> nodes;
+    TransformHierarchy hierarchy = createHierarchy(nodes);
+    hierarchy.update();
+    const std::string nodeText = std::to_string(nodes.size() / 1024u) + "k nodes";
+
+    context.measure("Update " + nodeText + ", nothing changed", [&]()
+                    { hierarchy.update(); });
+
+    // Descendants of the changed nodes are recomputed too, so more than the changed share of the nodes is updated
+    std::mt19937 random(7u);
+    for (const uint32_t changedPercent : {1u, 10u, 100u})
+    {
+        std::vector<uint32_t> changedNodes = nodes;
+        std::shuffle(changedNodes.begin(), changedNodes.end(), random);
+        changedNodes.resize(nodes.size() * changedPercent / 100u);
+        context.measure("Update " + nodeText + ", " + std::to_string(changedPercent) + "% changed", [&]()
+                        {
+                            for (const uint32_t node : changedNodes)
+                            {
+                                LocalTransform transform = hierarchy.getLocalTransform(node);
+                                transform.translation.x += 0.001f;
+                                hierarchy.setLocalTransform(node, transform);
+                            }
+                            hierarchy.update();
+                        });
+    }
+
+    // Baseline: every world matrix recomputed with plain glm, one node after another
+    std::vector<glm::mat4> worldMatrices(nodes.size());
+    context.measure("Recompute " + nodeText + " with glm, single threaded", [&]()
+                    {
+                        for (size_t i = 0; i < nodes.size(); ++i)
+                        {
+                            const LocalTransform transform = hierarchy.getLocalTransform(nodes[i]);
+                            const uint32_t parent = hierarchy.getParent(nodes[i]);
+                            glm::mat4 local = glm::mat4_cast(transform.rotation);
+                            local[3] = glm::vec4(transform.translation, 1.0f);
+                            worldMatrices[i] = parent == TransformHierarchy::noParent ? local : worldMatrices[parent] * local;
+                        }
+                        Benchmark::doNotOptimize(worldMatrices.back());
+                    });
+}
+
+const Benchmark::Registration registration("TransformHierarchy", runTransformBenchmarks);
+
+}
@@ -1,7 +1,161 @@
 
 #include "CPUResourceManager.h"
 
+#include "Assets/MeshAsset.h"
+#include "Utilities/Parallel.h"
+#include "Utilities/Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
 CPUResourceManager::CPUResourceManager(std::string_view assetFilePath)
 {
 
+}
+
+void CPUResourceManager::mountPackage(const std::string& packagePath)
+{
+    m_packages.push_back(std::make_unique<AssetPackage>(packagePath));
+}
+
+AssetPackage& CPUResourceManager::findPackage(std::string_view name) const
+{
+    for (auto it = m_packages.rbegin(); it != m_packages.rend(); ++it)
+    {
+        if ((*it)->contains(name))
+        {
+            return **it;
+        }
+    }
+    throw std::runtime_error("Asset " + std::string(name) + " was not found in any mounted package!");
+}
+
+bool CPUResourceManager::hasAsset(std::string_view name) const
+{
+    for (const auto& package : m_packages)
+    {
+        if (package->contains(name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t CPUResourceManager::getAssetSize(std::string_view name) const
+{
+    return findPackage(name).getEntry(name).uncompressedSize;
+}
+
+void CPUResourceManager::loadAssetInto(std::string_view name, std::span<std::byte> stagingMemory) const
+{
+    findPackage(name).decompressAsset(name, stagingMemory);
+}
+
+std::vector<std::byte> CPUResourceManager::loadAsset(std::string_view name) const
+{
+    return findPackage(name).loadAsset(name);
+}
+
+std::vector<MipLevel> CPUResourceManager::loadUncookedTexture(std::string_view name, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter) const
+{
+    const std::vector<std::byte> pixels = loadAsset(name);
+    if (pixels.size() != size_t(width) * height * MipGeneration::getPixelSize(format))
+    {
+        throw std::runtime_error("Uncooked texture " + std::string(name) + " does not match its expected size!");
+    }
+    return MipGeneration::generateMipChain(pixels, width, height, format, filter);
+}
+
+const LoadedMesh& CPUResourceManager::loadMesh(const std::string& name)
+{
+    const auto it = m_meshes.find(name);
+    if (it != m_meshes.end())
+    {
+        return it->second;
+    }
+    return m_meshes.emplace(name, processMesh(name)).first->second;
+}
+
+std::vector<const LoadedMesh*> CPUResourceManager::loadMeshes(std::span<const std::string> names)
+{
+    TRACE_ZONE("CPUResourceManager::loadMeshes");
+    std::vector<std::string> missingNames;
+    for (const std::string& name : names)
+    {
+        if (!m_meshes.contains(name) && std::find(missingNames.begin(), missingNames.end(), name) == missingNames.end())
+        {
+            missingNames.push_back(name);
+        }
+    }
+
+    // Reading the packages is thread safe, only the map is updated on this thread
+    std::vector<LoadedMesh> missingMeshes(missingNames.size());
+    Parallel::forEach(missingNames.size(), [&](size_t i)
+                      { missingMeshes[i] = processMesh(missingNames[i]); });
+    for (size_t i = 0; i < missingNames.size(); ++i)
+    {
+        m_meshes.emplace(missingNames[i], std::move(missingMeshes[i]));
+    }
+
+    std::vector<const LoadedMesh*> meshes;
+    meshes.reserve(names.size());
+    for (const std::string& name : names)
+    {
+        meshes.push_back(&m_meshes.at(name));
+    }
+    return meshes;
+}
+
+LoadedMesh CPUResourceManager::processMesh(const std::string& name) const
+{
+    TRACE_ZONE("CPUResourceManager::processMesh");
+    const std::vector<std::byte> data = loadAsset(getMeshAssetName(name));
+    MeshAssetHeader header{};
+    if (data.size() < sizeof(header))
+    {
+        throw std::runtime_error("Mesh " + name + " is truncated!");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    const size_t verticesSize = size_t(header.vertexCount) * sizeof(MeshVertex);
+    const size_t indicesSize = size_t(header.indexCount) * sizeof(uint32_t);
+    if (data.size() != sizeof(header) + verticesSize + indicesSize)
+    {
+        throw std::runtime_error("Mesh " + name + " does not match its header!");
+    }
+
+    LoadedMesh loadedMesh{};
+    loadedMesh.mesh.vertices.resize(header.vertexCount);
+    loadedMesh.mesh.indices.resize(header.indexCount);
+    std::memcpy(loadedMesh.mesh.vertices.data(), data.data() + sizeof(header), verticesSize);
+    std::memcpy(loadedMesh.mesh.indices.data(), data.data() + sizeof(header) + verticesSize, indicesSize);
+
+    loadedMesh.report = MeshOptimization::optimizeMesh(loadedMesh.mesh);
+    loadedMesh.quantizedMesh = MeshOptimization::quantizeMesh(loadedMesh.mesh);
+    loadedMesh.lodChain = MeshSimplification::buildLodChain(loadedMesh.mesh);
+    return loadedMesh;
+}
+
+void CPUResourceManager::unloadMesh(const std::string& name)
+{
+    m_meshes.erase(name);
+}
+
+PackageStatistics CPUResourceManager::getPackageStatistics() const
+{
+    PackageStatistics statistics{};
+    for (const auto& package : m_packages)
+    {
+        const PackageStatistics packageStatistics = package->getStatistics();
+        for (size_t i = 0; i < assetCompressionCount; ++i)
+        {
+            statistics.codecs[i].compressedBytes += packageStatistics.codecs[i].compressedBytes;
+            statistics.codecs[i].uncompressedBytes += packageStatistics.codecs[i].uncompressedBytes;
+            statistics.codecs[i].chunkCount += packageStatistics.codecs[i].chunkCount;
+            statistics.codecs[i].decodeSeconds += packageStatistics.codecs[i].decodeSeconds;
+        }
+    }
+    return statistics;
 }
\ No newline at end of file
@@ -1,7 +1,26 @@
 #ifndef VULKANPROJECT_CPURESOURCEMANAGER_H
 #define VULKANPROJECT_CPURESOURCEMANAGER_H
 
+#include "Assets/AssetPackage.h"
+#include "Assets/MeshOptimizer.h"
+#include "Assets/MeshSimplifier.h"
+#include "Assets/MipGenerator.h"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct LoadedMesh
+{
+    Mesh mesh; // Optimized, full precision
+    QuantizedMesh quantizedMesh; // For upload
+    MeshOptimizationReport report;
+    MeshLodChain lodChain; // Level 0 is the optimized mesh itself
+};
 
 /**
  * Holds data loaded to CPU memory; textures, meshes etc.
@@ -10,7 +29,45 @@ class CPUResourceManager
 {
 public:
     CPUResourceManager(std::string_view assetFilePath);
+
+    /**
+     * Make the assets of a package available. Packages mounted later override assets with the same name.
+     */
+    void mountPackage(const std::string& packagePath);
+
+    bool hasAsset(std::string_view name) const;
+    size_t getAssetSize(std::string_view name) const;
+
+    /**
+     * Decompress asset directly to caller owned memory, for example a mapped staging buffer
+     */
+    void loadAssetInto(std::string_view name, std::span<std::byte> stagingMemory) const;
+    std::vector<std::byte> loadAsset(std::string_view name) const;
+
+    /**
+     * Load an uncooked texture asset of tightly packed pixels and generate its mip chain
+     */
+    std::vector<MipLevel> loadUncookedTexture(std::string_view name, uint32_t width, uint32_t height, MipImageFormat format, MipFilter filter = MipFilter::Kaiser) const;
+
+    /**
+     * Load a mesh asset, run it through the mesh optimization stage and build its LOD chain. Meshes stay loaded until
+     * unloadMesh().
+     */
+    const LoadedMesh& loadMesh(const std::string& name);
+
+    /**
+     * Load several meshes at once, processing the ones not loaded yet in parallel on the job system
+     */
+    std::vector<const LoadedMesh*> loadMeshes(std::span<const std::string> names);
+    void unloadMesh(const std::string& name);
+
+    PackageStatistics getPackageStatistics() const;
 private:
+    AssetPackage& findPackage(std::string_view name) const;
+    LoadedMesh processMesh(const std::string& name) const;
+
+    std::vector<std::unique_ptr<AssetPackage>> m_packages;
+    std::unordered_map<std::string, LoadedMesh> m_meshes;
 };
 
 
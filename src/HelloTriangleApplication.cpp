@@ -1,13 +1,26 @@
 
 #include "HelloTriangleApplication.h"
 
+#include "Utilities/StartupTimer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+
+constexpr const char* meshVertexShaderPath = "shaders/shader.vert";
+constexpr const char* meshFragmentShaderPath = "shaders/shader.frag";
+
+}
+
 
 HelloTriangleApplication::HelloTriangleApplication() :
+    m_shaderCompilation(Renderer::compileShadersAsync({meshVertexShaderPath, meshFragmentShaderPath})),
     m_cpuResourceManager("assets/test.gltf"),
     m_window(800, 600),
-    m_renderer(m_window, m_cpuResourceManager)
+    m_renderer(m_window, m_cpuResourceManager, m_shaderCompilation),
+    m_meshPipeline(m_renderer.createRenderPipeline(meshVertexShaderPath, meshFragmentShaderPath))
 {
-    m_renderer.createRenderPipeline("shaders/shader.vert", "shaders/shader.frag");
 }
 
 void HelloTriangleApplication::run()
@@ -17,7 +30,30 @@ void HelloTriangleApplication::run()
 
 void HelloTriangleApplication::mainLoop()
 {
+    const glm::uvec2 resolution = m_window.getResolution();
+    Camera camera{};
+    camera.position = glm::vec3(0.0f, 2.0f, 10.0f);
+    camera.verticalFov = glm::radians(60.0f);
+    camera.view = glm::lookAt(camera.position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    camera.projection = glm::perspective(camera.verticalFov, static_cast<float>(resolution.x) / static_cast<float>(resolution.y), 0.1f, 1000.0f);
+    camera.projection[1][1] *= -1.0f; // Vulkan clip space y points down
+
+    if (m_window.update())
+    {
+        {
+            StartupTimer::Phase phase("Record first frame");
+            m_scene.update();
+            m_scene.extract(m_renderer);
+            m_renderer.updateTextureStreaming();
+            m_renderer.drawFrame(camera);
+        }
+        StartupTimer::printReport(std::cout);
+    }
     while (m_window.update())
     {
+        m_scene.update();
+        m_scene.extract(m_renderer);
+        m_renderer.updateTextureStreaming();
+        m_renderer.drawFrame(camera);
     }
 }
\ No newline at end of file
@@ -3,12 +3,14 @@
 
 #include "CPUResourceManager.h"
 #include "Renderer/Renderer.h"
+#include "Scene/Scene.h"
 #include "Window.h"
 
 #include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -23,9 +25,13 @@ public:
 private:
     void mainLoop();
 
+    // Declared first so that shaders compile while the window and the renderer are created
+    std::shared_ptr<ShaderCompilation> m_shaderCompilation;
     CPUResourceManager m_cpuResourceManager;
     Window m_window;
     Renderer m_renderer;
+    Handle<HandleType::Pipeline> m_meshPipeline;
+    Scene m_scene;
 };
 
 #endif // VULKANPROJECT_HELLOTRIANGLEAPPLICATION_H
@@ -18,11 +18,11 @@ public:
     {
         return o1.m_idAndGeneration == o2.m_idAndGeneration;
     };
-    uint16_t getId()
+    uint16_t getId() const
     {
         return static_cast<uint16_t>(m_idAndGeneration >> 16);
     }
-    uint16_t getGeneration()
+    uint16_t getGeneration() const
     {
         return static_cast<uint16_t>(m_idAndGeneration & uint32_t(std::numeric_limits<uint16_t>::max()));
     }
@@ -70,7 +70,7 @@ public:
         }
         const uint16_t index = m_freeIndices.top();
         m_freeIndices.pop();
-        m_list[index].dataGeneration == m_list[index].generation;
+        m_list[index].dataGeneration = m_list[index].generation;
         m_list[index].data = element;
         return Handle<type>{index, m_list[index].generation};
     }
@@ -84,20 +84,30 @@ public:
         const uint16_t id = handle.getId();
         ++m_list[handle.getId()].generation; // Bump generation, dataGeneration is now one smaller
         m_freeIndices.emplace(id);
-        return m_list[handle.getId()].second;
+        return m_list[handle.getId()].data;
     }
 
     /**
      * Return the data associated with this handle. Exception is thrown if the object has been destroyed.
      * @element handle Handle
      */
-    T getElement(Handle<type> handle)
+    T& getElement(Handle<type> handle)
     {
         if (m_list[handle.getId()].generation != handle.getGeneration())
         {
             throw std::runtime_error("Trying to fetch an element that has been destroyed!");
         }
-        return m_list[handle.getId()].scond;
+        return m_list[handle.getId()].data;
+    }
+
+    /**
+     * Whether the handle refers to data that has not been destroyed
+     * @element handle Handle
+     */
+    bool isValid(Handle<type> handle) const
+    {
+        const uint16_t id = handle.getId();
+        return id < m_list.size() && m_list[id].generation == handle.getGeneration() && m_list[id].dataGeneration == m_list[id].generation;
     }
 
     /**
@@ -15,7 +15,11 @@ enum class HandleType : uint16_t
     ImageView,
     Buffer,
     BufferView,
-    Texture
+    Texture,
+    Geometry,
+    Mesh,
+    Entity,
+    Instance
 };
 
 
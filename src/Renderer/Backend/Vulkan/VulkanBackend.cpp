@@ -1,22 +1,74 @@
 #include "VulkanBackend.h"
 
+#include "VulkanCommands.h"
 #include "VulkanDebug.h"
+#include "VulkanDescriptors.h"
 #include "VulkanDevice.h"
 #include "VulkanImage.h"
 #include "VulkanPipeline.h"
 #include "VulkanShader.h"
+#include "../../../Utilities/JobSystem.h"
+#include "../../../Utilities/StartupTimer.h"
+#include "../../../Utilities/Trace.h"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <exception>
 #include <functional>
-#include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 
+namespace
+{
+
+// Streamed texture handle ids index the feedback and info buffers
+constexpr uint32_t maxStreamedTextures = 4096u;
+constexpr uint32_t noTextureFeedback = ~0u; // Feedback of textures that were not sampled
+
+constexpr uint32_t maxMeshletGeometries = 1024u;
+
+// Bindings of the bindless table, must match shaders/include/Bindless.glsl. Slots are handle ids.
+constexpr uint32_t bindlessTexturesBinding = 0u; // Streamed textures
+constexpr uint32_t bindlessMeshletsBinding = 1u; // PackedMeshlet buffer of each meshlet geometry
+constexpr uint32_t bindlessMeshletDrawCommandsBinding = 2u; // Indirect commands of each meshlet geometry
+constexpr uint32_t clusterCullingGroupSize = 64u; // local_size_x of shaders/ClusterCulling.comp
+
+constexpr uint32_t framesInFlight = 2u;
+constexpr VkFormat depthFormat = VK_FORMAT_D32_SFLOAT;
+
+// Capacities of the indirect draw path. Mesh and graphics pipeline handle ids index the mesh table and batches.
+constexpr uint32_t maxMeshes = 4096u;
+constexpr uint32_t maxGraphicsPipelines = 64u;
+constexpr uint32_t maxDrawnInstances = 65536u;
+constexpr uint64_t sceneVertexCapacity = 4ull * 1024ull * 1024ull;
+constexpr uint64_t sceneIndexCapacity = 16ull * 1024ull * 1024ull;
+constexpr uint32_t instanceCullingGroupSize = 64u; // local_size_x of shaders/InstanceCulling.comp
+constexpr uint32_t instanceUploadGroupSize = 64u; // local_size_x of shaders/InstanceUpload.comp
+constexpr uint32_t noBatch = ~0u;
+
+// Per frame allocators. Descriptor pools are chained when a frame needs more sets.
+constexpr VkDeviceSize uniformBytesPerFrame = 64u * 1024u;
+constexpr uint32_t descriptorSetsPerPool = 16u;
+constexpr uint32_t storageBufferDescriptorsPerPool = 64u;
+
+// Draws are recorded into secondary command buffers on the job system when there are at least two jobs worth of them
+constexpr size_t drawsPerRecordingJob = 8u;
+
+}
+
 namespace Vulkan
 {
 
 VulkanBackend::VulkanBackend(bool enableDebug, glm::uvec2 resolution, std::function<VkSurfaceKHR(VkInstance&)> surfaceCreationFunction, std::vector<const char*> windowVulkanExtensions) :
-    m_enableDebug(enableDebug)
+    m_enableDebug(enableDebug),
+    m_vertexAllocator(sceneVertexCapacity),
+    m_indexAllocator(sceneIndexCapacity)
 {
+    TRACE_ZONE("VulkanBackend::VulkanBackend");
+    uint64_t phaseBegin = Trace::now();
     createInstance(windowVulkanExtensions);
 
     if (m_enableDebug)
@@ -25,30 +77,137 @@ VulkanBackend::VulkanBackend(bool enableDebug, glm::uvec2 resolution, std::funct
     }
 
     m_surface = surfaceCreationFunction(m_instance);
+    StartupTimer::record("Create Vulkan instance and surface", phaseBegin, Trace::now());
+
+    phaseBegin = Trace::now();
     m_physicalDevice = selectPhysicalDevice(m_instance, m_surface);
     const QueueFamilyIndices queueFamilies = findSuitableQueueFamilies(m_physicalDevice, m_surface);
-    m_device = createLogicalDevice(m_physicalDevice, queueFamilies, getValidationLayers());
+    const DynamicRenderingSupport dynamicRendering = getDynamicRenderingSupport(m_physicalDevice);
+    const bool enableMemoryBudget = isMemoryBudgetSupported(m_physicalDevice);
+    m_device = createLogicalDevice(m_physicalDevice, queueFamilies, getValidationLayers(), dynamicRendering, enableMemoryBudget);
+    m_memoryBudget.create(m_physicalDevice, enableMemoryBudget);
+    m_dynamicRendering = loadDynamicRenderingFunctions(m_device, dynamicRendering);
 
     vkGetDeviceQueue(m_device, queueFamilies.graphicsAndComputeFamily.value(), 0, &m_queueGraphicsCompute);
     vkGetDeviceQueue(m_device, queueFamilies.presentFamily.value(), 0, &m_queuePresent);
+    m_graphicsQueueFamily = queueFamilies.graphicsAndComputeFamily.value();
+    StartupTimer::record("Create Vulkan device", phaseBegin, Trace::now());
 
+    phaseBegin = Trace::now();
     const std::array<uint32_t, 2> queueFamilyIndices = {queueFamilies.graphicsAndComputeFamily.value(), queueFamilies.presentFamily.value()};
     m_swapchainInfo = createSwapChain(m_physicalDevice, m_device, m_surface, resolution, queueFamilyIndices);
 
     m_swapchainImageViews = createImageViewsForImages(m_device, m_swapchainInfo.images, m_swapchainInfo.format.format);
+    StartupTimer::record("Create swapchain", phaseBegin, Trace::now());
+
+    phaseBegin = Trace::now();
+    m_commandPool = createCommandPool(m_device, m_graphicsQueueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    m_gpuProfiler.create(m_physicalDevice, m_device, m_instance, m_graphicsQueueFamily, framesInFlight, m_enableDebug);
+    if constexpr (Trace::enabled)
+    {
+        m_gpuProfiler.calibrateClock(m_commandPool, m_queueGraphicsCompute);
+    }
+
+    m_textureFeedback.resize(maxStreamedTextures, noTextureFeedback);
+    m_readTextureFeedback.resize(maxStreamedTextures, noTextureFeedback);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+    m_maxDrawIndirectCount = properties.limits.maxDrawIndirectCount;
+
+    createBindlessTable();
+    createSceneResources();
+    StartupTimer::record("Create renderer resources", phaseBegin, Trace::now());
 }
 
 VulkanBackend::~VulkanBackend()
 {
-    vkDestroyPipeline(m_device, m_pipeline, nullptr);
-    vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+    vkDeviceWaitIdle(m_device);
+
+    for (FrameResources& frame : m_frames)
+    {
+        destroyRetiredResources(frame.retired);
+        vkDestroySemaphore(m_device, frame.imageAvailable, nullptr);
+        vkDestroyFence(m_device, frame.inFlight, nullptr);
+        destroyBuffer(m_device, frame.instanceUpdateBuffer);
+        destroyBuffer(m_device, frame.drawListInstanceBuffer);
+        destroyBuffer(m_device, frame.batchBuffer);
+        destroyBuffer(m_device, frame.drawCommandBuffer);
+        destroyBuffer(m_device, frame.drawCountBuffer);
+        destroyBuffer(m_device, frame.meshletInstanceBuffer);
+        destroyBuffer(m_device, frame.streamedTextureInfoBuffer);
+        destroyBuffer(m_device, frame.textureFeedbackBuffer);
+        frame.descriptorAllocator.destroy();
+        for (const CommandRecorder& recorder : frame.recorders)
+        {
+            vkDestroyCommandPool(m_device, recorder.commandPool, nullptr);
+        }
+    }
+    for (VkSemaphore semaphore : m_renderFinishedSemaphores)
+    {
+        vkDestroySemaphore(m_device, semaphore, nullptr);
+    }
+    for (GraphicsPipeline* pipeline : m_graphicsPipelines.getAliveData())
+    {
+        vkDestroyPipeline(m_device, pipeline->pipeline, nullptr);
+    }
+    vkDestroyPipeline(m_device, m_instanceCullingPipeline, nullptr);
+    vkDestroyPipelineLayout(m_device, m_instanceCullingPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_instanceCullingSetLayout, nullptr);
+    vkDestroyPipeline(m_device, m_instanceUploadPipeline, nullptr);
+    vkDestroyPipelineLayout(m_device, m_instanceUploadPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_instanceUploadSetLayout, nullptr);
+    vkDestroyPipelineLayout(m_device, m_drawPipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_drawSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_textureStreamingSetLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_viewSetLayout, nullptr);
+    vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+    m_uniformAllocator.destroy(m_device);
+    destroyBuffer(m_device, m_vertexBuffer);
+    destroyBuffer(m_device, m_indexBuffer);
+    destroyBuffer(m_device, m_meshBuffer);
+    destroyBuffer(m_device, m_instanceBuffer);
 
-    const std::vector<VkFramebuffer*> aliveFramebuffers = m_framebuffers.getAliveData();
-    for (const VkFramebuffer* framebuffer : aliveFramebuffers)
+    destroyRetiredResources(m_retiredResources);
+    // Images of updates that were never recorded chain from the last recorded image to the texture's current one
+    for (std::vector<StreamedTextureUpdate>* updates : {&m_loadedTextureUpdates, &m_streamedTextureUpdates})
     {
-        vkDestroyFramebuffer(m_device, *framebuffer, nullptr);
+        for (StreamedTextureUpdate& update : *updates)
+        {
+            waitForTextureLoad(update);
+            if (update.oldImage.image)
+            {
+                destroyImage(m_device, update.oldImage);
+            }
+            if (update.stagingBuffer.buffer)
+            {
+                destroyBuffer(m_device, update.stagingBuffer);
+            }
+        }
+    }
+    for (StreamedTexture* texture : m_streamedTextures.getAliveData())
+    {
+        if (texture->image.image)
+        {
+            destroyImage(m_device, texture->image);
+        }
+    }
+    for (MeshletGeometry* geometry : m_meshletGeometries.getAliveData())
+    {
+        destroyBuffer(m_device, geometry->vertexBuffer);
+        destroyBuffer(m_device, geometry->indexBuffer);
+        destroyBuffer(m_device, geometry->meshletBuffer);
+        destroyBuffer(m_device, geometry->drawCommandBuffer);
     }
-    vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+    vkDestroyPipeline(m_device, m_clusterCullingPipeline, nullptr);
+    vkDestroyPipelineLayout(m_device, m_clusterCullingPipelineLayout, nullptr);
+    m_bindlessTable.destroy();
+    destroyImage(m_device, m_fallbackTexture);
+
+    vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+
+    m_renderGraph.destroy();
+    m_gpuProfiler.destroy();
 
     for (auto swapchainImageView : m_swapchainImageViews)
     {
@@ -72,6 +231,7 @@ VulkanBackend::~VulkanBackend()
 
 void VulkanBackend::createInstance(const std::vector<const char*>& neededInstanceExtensions)
 {
+    TRACE_ZONE("VulkanBackend::createInstance");
     const std::vector<const char*> validationLayers = getValidationLayers();
 
     // Check that defined validation layers are available if in use
@@ -86,19 +246,14 @@ void VulkanBackend::createInstance(const std::vector<const char*>& neededInstanc
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "Jongine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_2;
+    // 1.3 for core dynamic rendering, older devices still get 1.2 and use the extension or render pass objects
+    appInfo.apiVersion = VK_API_VERSION_1_3;
 
     // Get supported instance level extensions
     uint32_t availableExtensionCount = 0;
     vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionCount, nullptr);
     std::vector<VkExtensionProperties> availableExtensions(availableExtensionCount);
     vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionCount, availableExtensions.data());
-    std::cout << "Available extensions:" << std::endl;
-
-    for (const auto& extension : availableExtensions)
-    {
-        std::cout << "\t" << extension.extensionName << std::endl;
-    }
 
     // Check that all extensions required by our apps are supported
     for (const char* extension : neededInstanceExtensions)
@@ -140,57 +295,1363 @@ void VulkanBackend::createInstance(const std::vector<const char*>& neededInstanc
     }
 }
 
-void VulkanBackend::createGraphicsPipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV)
+void VulkanBackend::createBindlessTable()
 {
-    VkShaderModule vertexShaderModule = createShaderModule(m_device, vertexShaderSpirV);
-    VkShaderModule fragmentShaderModule = createShaderModule(m_device, fragmentShaderSpirV);
+    TRACE_ZONE("VulkanBackend::createBindlessTable");
+    m_fallbackTexture = createImage(m_physicalDevice,
+                                    m_device,
+                                    VkExtent2D{1u, 1u},
+                                    1u,
+                                    VK_FORMAT_R8G8B8A8_UNORM,
+                                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(m_device, m_commandPool);
+    recordImageBarrier(commandBuffer, m_fallbackTexture.image, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+    const VkClearColorValue white{{1.0f, 1.0f, 1.0f, 1.0f}};
+    const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdClearColorImage(commandBuffer, m_fallbackTexture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &white, 1, &range);
+    recordImageBarrier(commandBuffer, m_fallbackTexture.image, 0, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    endSingleTimeCommands(m_device, m_commandPool, m_queueGraphicsCompute, commandBuffer);
+
+    // Indexed by bindlessTexturesBinding, bindlessMeshletsBinding and bindlessMeshletDrawCommandsBinding. Streamed
+    // textures get a copy per frame in flight, so that swapping in new mips never rewrites a descriptor being read.
+    const std::array<BindlessBinding, 3> bindings = {
+        BindlessBinding{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxStreamedTextures, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, framesInFlight},
+        BindlessBinding{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxMeshletGeometries, VK_SHADER_STAGE_COMPUTE_BIT, 1u},
+        BindlessBinding{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxMeshletGeometries, VK_SHADER_STAGE_COMPUTE_BIT, 1u}};
+    m_bindlessTable.create(m_device, bindings, m_fallbackTexture.view);
+}
+
+void VulkanBackend::createSceneResources()
+{
+    TRACE_ZONE("VulkanBackend::createSceneResources");
+    m_vertexBuffer = createBuffer(m_physicalDevice,
+                                  m_device,
+                                  sceneVertexCapacity * sizeof(QuantizedMeshVertex),
+                                  VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                  MemoryCategory::Geometry);
+    m_indexBuffer = createBuffer(m_physicalDevice,
+                                 m_device,
+                                 sceneIndexCapacity * sizeof(uint32_t),
+                                 VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 MemoryCategory::Geometry);
+
+    const VkMemoryPropertyFlags hostMemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    m_meshBuffer = createBuffer(m_physicalDevice, m_device, maxMeshes * sizeof(GpuMesh), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::Geometry);
+    std::memset(m_meshBuffer.mapped, 0, m_meshBuffer.size);
+
+    // Each batch is drawn with one indirect count draw, which can not exceed the device limit
+    m_maxInstances = std::min(maxDrawnInstances, m_maxDrawIndirectCount);
+    m_batchDrawCounts.resize(maxGraphicsPipelines);
+    m_instanceBuffer = createBuffer(m_physicalDevice,
+                                    m_device,
+                                    m_maxInstances * sizeof(GpuInstance),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                    MemoryCategory::Geometry);
+    m_instanceBatches.resize(m_maxInstances, noBatch);
+
+    const std::array<VkDescriptorSetLayoutBinding, 2> uploadBindings = {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}};
+    m_instanceUploadSetLayout = createDescriptorSetLayout(m_device, uploadBindings);
+
+    const std::array<VkDescriptorSetLayoutBinding, 5> cullingBindings = {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}};
+    m_instanceCullingSetLayout = createDescriptorSetLayout(m_device, cullingBindings);
+
+    const VkDescriptorSetLayoutBinding drawBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr};
+    m_drawSetLayout = createDescriptorSetLayout(m_device, std::span(&drawBinding, 1));
+
+    // The view is written once per frame to the uniform allocator. Its set is written once, every bind only passes
+    // the offset of the frame's allocation.
+    m_uniformAllocator.create(m_physicalDevice, m_device, uniformBytesPerFrame, framesInFlight);
+    const VkDescriptorSetLayoutBinding viewBinding{0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT, nullptr};
+    m_viewSetLayout = createDescriptorSetLayout(m_device, std::span(&viewBinding, 1));
+    const VkDescriptorPoolSize viewPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1};
+    m_descriptorPool = createDescriptorPool(m_device, std::span(&viewPoolSize, 1), 1);
+    m_viewDescriptorSet = allocateDescriptorSet(m_device, m_descriptorPool, m_viewSetLayout);
+    writeDynamicUniformBufferDescriptor(m_device, m_viewDescriptorSet, m_uniformAllocator.getBuffer(), sizeof(GpuView));
+
+    // Streamed texture infos and the feedback written by sampling them, must match TEXTURE_STREAMING_SET in
+    // shaders/shader.frag
+    const std::array<VkDescriptorSetLayoutBinding, 2> textureStreamingBindings = {
+        VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+        VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}};
+    m_textureStreamingSetLayout = createDescriptorSetLayout(m_device, textureStreamingBindings);
 
-    if (m_renderPass)
+    // Set 1 is the bindless table, so materials find their textures from ids without binding anything per draw
+    const std::array<VkDescriptorSetLayout, 4> drawSetLayouts = {m_drawSetLayout, m_bindlessTable.getLayout(), m_viewSetLayout, m_textureStreamingSetLayout};
+    m_drawPipelineLayout = createPipelineLayout(m_device, drawSetLayouts, {});
+
+    const VkDescriptorPoolSize framePoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBufferDescriptorsPerPool};
+
+    m_frames.resize(framesInFlight);
+    for (FrameResources& frame : m_frames)
     {
-        throw std::runtime_error("Currently only one render pass is supported!");
+        frame.commandBuffer = allocateCommandBuffer(m_device, m_commandPool);
+        frame.imageAvailable = createSemaphore(m_device);
+        frame.inFlight = createFence(m_device, true);
+        // Large enough to update every instance in one frame
+        frame.instanceUpdateBuffer = createBuffer(m_physicalDevice, m_device, m_maxInstances * sizeof(GpuInstanceUpdate), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::FrameData);
+        frame.drawListInstanceBuffer = createBuffer(m_physicalDevice, m_device, m_maxInstances * sizeof(GpuInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::FrameData);
+        frame.batchBuffer = createBuffer(m_physicalDevice, m_device, maxGraphicsPipelines * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::FrameData);
+        frame.drawCommandBuffer = createBuffer(m_physicalDevice,
+                                               m_device,
+                                               m_maxInstances * sizeof(VkDrawIndexedIndirectCommand),
+                                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                               VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                               MemoryCategory::FrameData);
+        frame.drawCountBuffer = createBuffer(m_physicalDevice,
+                                             m_device,
+                                             maxGraphicsPipelines * sizeof(uint32_t),
+                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                             MemoryCategory::FrameData);
+        frame.meshletInstanceBuffer = createBuffer(m_physicalDevice, m_device, maxMeshletGeometries * sizeof(GpuInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::FrameData);
+        frame.streamedTextureInfoBuffer = createBuffer(m_physicalDevice, m_device, maxStreamedTextures * sizeof(StreamedTextureShaderInfo), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::Textures);
+        frame.textureFeedbackBuffer = createBuffer(m_physicalDevice, m_device, maxStreamedTextures * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostMemory, MemoryCategory::Textures);
+        std::memset(frame.textureFeedbackBuffer.mapped, 0xFF, frame.textureFeedbackBuffer.size);
+        frame.descriptorAllocator.create(m_device, std::span(&framePoolSize, 1), descriptorSetsPerPool);
+
+        frame.recorders.resize(JobSystem::get().getWorkerCount() + 1);
+        for (CommandRecorder& recorder : frame.recorders)
+        {
+            recorder.commandPool = createCommandPool(m_device, m_graphicsQueueFamily, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+            recorder.usedCount = 0u;
+        }
     }
-    m_renderPass = createRenderPass(m_device, m_swapchainInfo.format.format);
 
-    if (m_pipelineLayout)
+    m_renderFinishedSemaphores.resize(m_swapchainInfo.images.size());
+    for (VkSemaphore& semaphore : m_renderFinishedSemaphores)
     {
-        throw std::runtime_error("Currently only one pipeline is supported!");
+        semaphore = createSemaphore(m_device);
     }
-    m_pipelineLayout = createPipelineLayout(m_device);
 
-    m_pipeline = createVulkanGraphicsPipeline(m_device, m_pipelineLayout, m_renderPass, vertexShaderModule, fragmentShaderModule, m_swapchainInfo.extent);
+    createRenderGraph();
+}
+
+void VulkanBackend::createRenderGraph()
+{
+    TRACE_ZONE("VulkanBackend::createRenderGraph");
+    // The acquire semaphore makes the swapchain image available to color attachment output, its first use
+    m_swapchainImageResource = m_renderGraph.importImage("Swapchain image", m_swapchainInfo.extent, m_swapchainInfo.format.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    const RenderGraphResource depth = m_renderGraph.createImage("Depth", m_swapchainInfo.extent, depthFormat);
+    // Per frame in flight buffers, the frame fence orders them with their previous use
+    const RenderGraphResource drawCounts = m_renderGraph.importBuffer("Draw counts");
+    const RenderGraphResource drawCommands = m_renderGraph.importBuffer("Draw commands");
+    // Persistent, the upload pass orders its writes after the reads of the previous frames itself
+    const RenderGraphResource instances = m_renderGraph.importBuffer("Instances");
+    // Draw commands of every meshlet geometry, persistent like the instances
+    const RenderGraphResource meshletDrawCommands = m_renderGraph.importBuffer("Meshlet draw commands");
+
+    // Streamed texture images are not graph resources, the pass orders its copies with barriers of its own
+    m_renderGraph.addPass({
+        .name = "Texture streaming",
+        .hasSideEffects = true,
+        .execute = [this](const RenderGraphPassContext& context)
+        { recordStreamedTextureUpdates(context); }});
+    m_renderGraph.addPass({
+        .name = "Instance upload",
+        .uses = {{instances, ResourceAccess::ComputeWrite}},
+        .execute = [this](const RenderGraphPassContext& context)
+        { recordInstanceUpload(context); }});
+    m_renderGraph.addPass({
+        .name = "Reset draw counts",
+        .uses = {{drawCounts, ResourceAccess::TransferWrite}},
+        .execute = [this](const RenderGraphPassContext& context)
+        { vkCmdFillBuffer(context.commandBuffer, m_recording.frame->drawCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0u); }});
+    m_renderGraph.addPass({
+        .name = "Instance culling",
+        .uses = {{instances, ResourceAccess::ComputeRead}, {drawCounts, ResourceAccess::ComputeReadWrite}, {drawCommands, ResourceAccess::ComputeWrite}},
+        .execute = [this](const RenderGraphPassContext& context)
+        { recordInstanceCulling(context); }});
+    m_renderGraph.addPass({
+        .name = "Cluster culling",
+        .uses = {{meshletDrawCommands, ResourceAccess::ComputeWrite}},
+        .execute = [this](const RenderGraphPassContext& context)
+        { recordClusterCulling(context); }});
+
+    VkClearValue clearColor{};
+    clearColor.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    VkClearValue clearDepth{};
+    clearDepth.depthStencil = {1.0f, 0u};
+    m_scenePass = m_renderGraph.addPass({
+        .name = "Scene",
+        .uses = {{instances, ResourceAccess::VertexShaderRead},
+                 {drawCounts, ResourceAccess::IndirectRead},
+                 {drawCommands, ResourceAccess::IndirectRead},
+                 {meshletDrawCommands, ResourceAccess::IndirectRead}},
+        .colorAttachments = {RenderGraphAttachment{m_swapchainImageResource, clearColor}},
+        .depthAttachment = RenderGraphAttachment{depth, clearDepth},
+        .execute = [this](const RenderGraphPassContext& context)
+        { recordScene(context); }});
+
+    m_renderGraph.compile(m_physicalDevice, m_device, m_dynamicRendering);
+    m_sceneRenderTarget = m_renderGraph.getRenderTarget(m_scenePass);
+}
+
+Handle<HandleType::Pipeline> VulkanBackend::createGraphicsPipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV)
+{
+    TRACE_ZONE("VulkanBackend::createGraphicsPipeline");
+    const VkPipeline pipeline = createScenePipeline(vertexShaderSpirV, fragmentShaderSpirV);
+    const Handle<HandleType::Pipeline> handle = m_graphicsPipelines.insertElement(GraphicsPipeline{pipeline, 0u});
+    if (handle.getId() >= maxGraphicsPipelines)
+    {
+        m_graphicsPipelines.popElement(handle);
+        vkDestroyPipeline(m_device, pipeline, nullptr);
+        throw std::runtime_error("Too many graphics pipelines!");
+    }
+    m_graphicsPipelines.getElement(handle).batchIndex = handle.getId();
+    return handle;
+}
+
+void VulkanBackend::destroyGraphicsPipeline(Handle<HandleType::Pipeline> handle)
+{
+    vkQueueWaitIdle(m_queueGraphicsCompute);
+
+    GraphicsPipeline pipeline = m_graphicsPipelines.popElement(handle);
+    vkDestroyPipeline(m_device, pipeline.pipeline, nullptr);
+}
+
+void VulkanBackend::replaceGraphicsPipeline(Handle<HandleType::Pipeline> handle, const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV)
+{
+    TRACE_ZONE("VulkanBackend::replaceGraphicsPipeline");
+    GraphicsPipeline& graphicsPipeline = m_graphicsPipelines.getElement(handle);
+    const VkPipeline pipeline = createScenePipeline(vertexShaderSpirV, fragmentShaderSpirV);
+
+    // Frames in flight may still use the old pipeline, the next frame is the first to record with the new one
+    m_retiredResources.pipelines.push_back(graphicsPipeline.pipeline);
+    graphicsPipeline.pipeline = pipeline;
+}
+
+VkPipeline VulkanBackend::createScenePipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV) const
+{
+    VkShaderModule vertexShaderModule = createShaderModule(m_device, vertexShaderSpirV);
+    VkShaderModule fragmentShaderModule = createShaderModule(m_device, fragmentShaderSpirV);
+
+    const VkVertexInputBindingDescription vertexBinding{0, sizeof(QuantizedMeshVertex), VK_VERTEX_INPUT_RATE_VERTEX};
+    const std::array<VkVertexInputAttributeDescription, 3> vertexAttributes = {
+        VkVertexInputAttributeDescription{0, 0, VK_FORMAT_R16G16B16A16_SFLOAT, offsetof(QuantizedMeshVertex, position)},
+        VkVertexInputAttributeDescription{1, 0, VK_FORMAT_R16G16_SNORM, offsetof(QuantizedMeshVertex, normal)},
+        VkVertexInputAttributeDescription{2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(QuantizedMeshVertex, texCoord)}};
+
+    const VkPipeline pipeline = createVulkanGraphicsPipeline(m_device,
+                                                             m_drawPipelineLayout,
+                                                             m_sceneRenderTarget,
+                                                             vertexShaderModule,
+                                                             fragmentShaderModule,
+                                                             std::span(&vertexBinding, 1),
+                                                             vertexAttributes,
+                                                             m_swapchainInfo.extent);
 
     destroyShaderModule(m_device, vertexShaderModule);
     destroyShaderModule(m_device, fragmentShaderModule);
+    return pipeline;
+}
+
+void VulkanBackend::replaceComputePipeline(VkPipeline& pipeline, VkPipelineLayout pipelineLayout, const std::vector<uint32_t>& computeShaderSpirV)
+{
+    VkShaderModule computeShaderModule = createShaderModule(m_device, computeShaderSpirV);
+    const VkPipeline newPipeline = createComputePipeline(m_device, pipelineLayout, computeShaderModule);
+    destroyShaderModule(m_device, computeShaderModule);
+
+    m_retiredResources.pipelines.push_back(pipeline);
+    pipeline = newPipeline;
+}
+
+void VulkanBackend::createInstanceCullingPipeline(const std::vector<uint32_t>& computeShaderSpirV)
+{
+    TRACE_ZONE("VulkanBackend::createInstanceCullingPipeline");
+    if (m_instanceCullingPipeline)
+    {
+        replaceComputePipeline(m_instanceCullingPipeline, m_instanceCullingPipelineLayout, computeShaderSpirV);
+        return;
+    }
+
+    const VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(InstanceCullingConstants)};
+    const std::array<VkDescriptorSetLayout, 2> setLayouts = {m_instanceCullingSetLayout, m_viewSetLayout};
+    m_instanceCullingPipelineLayout = createPipelineLayout(m_device, setLayouts, std::span(&pushConstantRange, 1));
+
+    VkShaderModule computeShaderModule = createShaderModule(m_device, computeShaderSpirV);
+    m_instanceCullingPipeline = createComputePipeline(m_device, m_instanceCullingPipelineLayout, computeShaderModule);
+    destroyShaderModule(m_device, computeShaderModule);
+}
+
+void VulkanBackend::createInstanceUploadPipeline(const std::vector<uint32_t>& computeShaderSpirV)
+{
+    TRACE_ZONE("VulkanBackend::createInstanceUploadPipeline");
+    if (m_instanceUploadPipeline)
+    {
+        replaceComputePipeline(m_instanceUploadPipeline, m_instanceUploadPipelineLayout, computeShaderSpirV);
+        return;
+    }
+
+    const VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(InstanceUploadConstants)};
+    m_instanceUploadPipelineLayout = createPipelineLayout(m_device, std::span(&m_instanceUploadSetLayout, 1), std::span(&pushConstantRange, 1));
+
+    VkShaderModule computeShaderModule = createShaderModule(m_device, computeShaderSpirV);
+    m_instanceUploadPipeline = createComputePipeline(m_device, m_instanceUploadPipelineLayout, computeShaderModule);
+    destroyShaderModule(m_device, computeShaderModule);
+}
+
+Handle<HandleType::Mesh> VulkanBackend::createMesh(std::span<const QuantizedMeshVertex> vertices, const MeshLodChain& lodChain)
+{
+    TRACE_ZONE("VulkanBackend::createMesh");
+    if (vertices.empty() || lodChain.lods.empty() || lodChain.indices.empty())
+    {
+        throw std::runtime_error("Mesh needs vertices and at least one LOD!");
+    }
+
+    SceneMesh mesh{};
+    mesh.vertexCount = vertices.size();
+    mesh.indexCount = lodChain.indices.size();
+    mesh.firstVertex = m_vertexAllocator.allocate(mesh.vertexCount);
+    if (mesh.firstVertex == RangeAllocator::invalidOffset)
+    {
+        throw std::runtime_error("Shared vertex buffer is full!");
+    }
+    mesh.firstIndex = m_indexAllocator.allocate(mesh.indexCount);
+    if (mesh.firstIndex == RangeAllocator::invalidOffset)
+    {
+        m_vertexAllocator.free(mesh.firstVertex, mesh.vertexCount);
+        throw std::runtime_error("Shared index buffer is full!");
+    }
+
+    const Handle<HandleType::Mesh> handle = m_meshes.insertElement(mesh);
+    if (handle.getId() >= maxMeshes)
+    {
+        m_meshes.popElement(handle);
+        m_vertexAllocator.free(mesh.firstVertex, mesh.vertexCount);
+        m_indexAllocator.free(mesh.firstIndex, mesh.indexCount);
+        throw std::runtime_error("Too many meshes!");
+    }
+
+    uploadToBuffer(m_physicalDevice, m_device, m_commandPool, m_queueGraphicsCompute, m_vertexBuffer, mesh.firstVertex * sizeof(QuantizedMeshVertex), std::as_bytes(vertices));
+    uploadToBuffer(m_physicalDevice, m_device, m_commandPool, m_queueGraphicsCompute, m_indexBuffer, mesh.firstIndex * sizeof(uint32_t), std::as_bytes(std::span(lodChain.indices)));
+
+    // The slot is unused by frames in flight, since the handle id was free
+    GpuMesh gpuMesh{};
+    gpuMesh.center[0] = lodChain.boundsCenter.x;
+    gpuMesh.center[1] = lodChain.boundsCenter.y;
+    gpuMesh.center[2] = lodChain.boundsCenter.z;
+    gpuMesh.radius = lodChain.boundsRadius;
+    gpuMesh.vertexOffset = static_cast<int32_t>(mesh.firstVertex);
+    gpuMesh.lodCount = static_cast<uint32_t>(std::min<size_t>(lodChain.lods.size(), maxMeshLods));
+    for (uint32_t lod = 0; lod < gpuMesh.lodCount; ++lod)
+    {
+        gpuMesh.lods[lod] = GpuMeshLod{static_cast<uint32_t>(mesh.firstIndex) + lodChain.lods[lod].firstIndex, lodChain.lods[lod].indexCount, lodChain.lods[lod].error, 0u};
+    }
+    static_cast<GpuMesh*>(m_meshBuffer.mapped)[handle.getId()] = gpuMesh;
+    m_meshes.getElement(handle).gpuMesh = gpuMesh;
+    return handle;
+}
+
+void VulkanBackend::destroyMesh(Handle<HandleType::Mesh> handle)
+{
+    vkQueueWaitIdle(m_queueGraphicsCompute);
+
+    const SceneMesh mesh = m_meshes.popElement(handle);
+    static_cast<GpuMesh*>(m_meshBuffer.mapped)[handle.getId()] = GpuMesh{};
+    m_vertexAllocator.free(mesh.firstVertex, mesh.vertexCount);
+    m_indexAllocator.free(mesh.firstIndex, mesh.indexCount);
+}
+
+void VulkanBackend::drawFrame(uint32_t instanceCount,
+                              std::span<const GpuInstanceUpdate> instanceUpdates,
+                              const FrameView& view,
+                              const InstancedDrawList& drawList,
+                              std::span<const MeshletDraw> meshletDraws)
+{
+    TRACE_FRAME(m_frameIndex);
+    TRACE_ZONE("VulkanBackend::drawFrame");
+    TRACE_COUNTER("Instances", instanceCount);
+    TRACE_COUNTER("Instance updates", instanceUpdates.size());
+    // Rethrows failed texture loads before anything of the frame has changed
+    collectLoadedTextureUpdates();
+    if (!m_instanceCullingPipeline || !m_instanceUploadPipeline)
+    {
+        throw std::runtime_error("Instance culling and upload pipelines have not been created!");
+    }
+    if (instanceCount > m_maxInstances)
+    {
+        throw std::runtime_error("Too many instances to draw!");
+    }
+    if (instanceUpdates.size() > m_maxInstances)
+    {
+        throw std::runtime_error("Too many instance updates!");
+    }
+    for (const GpuInstanceUpdate& update : instanceUpdates)
+    {
+        if (update.instanceIndex >= instanceCount)
+        {
+            throw std::runtime_error("Instance update is out of range!");
+        }
+        if (update.instance.meshIndex >= maxMeshes || update.instance.batchIndex >= maxGraphicsPipelines)
+        {
+            throw std::runtime_error("Instance refers to an invalid mesh or pipeline!");
+        }
+        if (update.instance.textureIndex != noTexture && update.instance.textureIndex >= maxStreamedTextures)
+        {
+            throw std::runtime_error("Instance refers to an invalid texture!");
+        }
+    }
+    if (instanceCount > m_instanceCount)
+    {
+        // Slots past the current count are only drawable if this frame uploads them
+        std::vector<uint8_t> isSlotUploaded(instanceCount - m_instanceCount, 0u);
+        for (const GpuInstanceUpdate& update : instanceUpdates)
+        {
+            if (update.instanceIndex >= m_instanceCount)
+            {
+                isSlotUploaded[update.instanceIndex - m_instanceCount] = 1u;
+            }
+        }
+        for (uint32_t slot = m_instanceCount; slot < instanceCount; ++slot)
+        {
+            if (!isSlotUploaded[slot - m_instanceCount] && m_instanceBatches[slot] == noBatch)
+            {
+                throw std::runtime_error("Drawing an instance that has never been uploaded!");
+            }
+        }
+    }
+    validateDrawList(drawList);
+    validateMeshletDraws(meshletDraws);
+
+    // Nothing is changed until everything above has been validated. Each batch gets a region of the draw command
+    // buffer large enough for all of its instances. The counts follow the slots that are dropped and updated instead
+    // of being recounted.
+    for (uint32_t slot = instanceCount; slot < m_instanceCount; ++slot)
+    {
+        --m_batchDrawCounts[m_instanceBatches[slot]];
+        m_instanceBatches[slot] = noBatch;
+    }
+    for (const GpuInstanceUpdate& update : instanceUpdates)
+    {
+        uint32_t& batch = m_instanceBatches[update.instanceIndex];
+        if (batch != noBatch)
+        {
+            --m_batchDrawCounts[batch];
+        }
+        batch = update.instance.batchIndex;
+        ++m_batchDrawCounts[batch];
+    }
+    m_instanceCount = instanceCount;
+    resolveDrawList(drawList);
+    resolveMeshletDraws(meshletDraws, view);
+
+    FrameResources& frame = m_frames[m_frameIndex % framesInFlight];
+    {
+        TRACE_ZONE("Wait for frame in flight");
+        vkWaitForFences(m_device, 1, &frame.inFlight, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+    m_memoryBudget.update();
+    destroyRetiredResources(frame.retired);
+    collectTextureFeedback(frame);
+
+    uint32_t imageIndex;
+    const VkResult acquireResult = vkAcquireNextImageKHR(m_device, m_swapchainInfo.swapchain, std::numeric_limits<uint64_t>::max(), frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+    if (acquireResult != VK_SUCCESS && acquireResult != VK_SUBOPTIMAL_KHR)
+    {
+        throw std::runtime_error("Failed to acquire a swapchain image!");
+    }
+    vkResetFences(m_device, 1, &frame.inFlight);
+    for (CommandRecorder& recorder : frame.recorders)
+    {
+        vkResetCommandPool(m_device, recorder.commandPool, 0);
+        recorder.usedCount = 0u;
+    }
+    frame.descriptorAllocator.reset();
+    m_uniformAllocator.beginFrame(m_frameIndex);
+
+    frame.instanceUploadDescriptorSet = frame.descriptorAllocator.allocate(m_instanceUploadSetLayout);
+    const std::array<VkBuffer, 2> uploadBuffers = {frame.instanceUpdateBuffer.buffer, m_instanceBuffer.buffer};
+    writeStorageBufferDescriptors(m_device, frame.instanceUploadDescriptorSet, uploadBuffers);
+    frame.cullingDescriptorSet = frame.descriptorAllocator.allocate(m_instanceCullingSetLayout);
+    const std::array<VkBuffer, 5> cullingBuffers = {
+        m_instanceBuffer.buffer, m_meshBuffer.buffer, frame.batchBuffer.buffer, frame.drawCommandBuffer.buffer, frame.drawCountBuffer.buffer};
+    writeStorageBufferDescriptors(m_device, frame.cullingDescriptorSet, cullingBuffers);
+    frame.drawDescriptorSet = frame.descriptorAllocator.allocate(m_drawSetLayout);
+    writeStorageBufferDescriptors(m_device, frame.drawDescriptorSet, std::span(&m_instanceBuffer.buffer, 1));
+    std::memcpy(frame.drawListInstanceBuffer.mapped, drawList.instances.data(), drawList.instances.size_bytes());
+    frame.drawListDescriptorSet = frame.descriptorAllocator.allocate(m_drawSetLayout);
+    writeStorageBufferDescriptors(m_device, frame.drawListDescriptorSet, std::span(&frame.drawListInstanceBuffer.buffer, 1));
+    auto* meshletInstances = static_cast<GpuInstance*>(frame.meshletInstanceBuffer.mapped);
+    for (const ResolvedMeshletDraw& draw : m_meshletDraws)
+    {
+        meshletInstances[draw.constants.instanceIndex] = GpuInstance{draw.model, 0u, 0u, instanceVisibleFlag, noTexture};
+    }
+    frame.meshletDescriptorSet = frame.descriptorAllocator.allocate(m_drawSetLayout);
+    writeStorageBufferDescriptors(m_device, frame.meshletDescriptorSet, std::span(&frame.meshletInstanceBuffer.buffer, 1));
+    applyStreamedTextureUpdates(frame);
+    frame.textureStreamingDescriptorSet = frame.descriptorAllocator.allocate(m_textureStreamingSetLayout);
+    const std::array<VkBuffer, 2> textureStreamingBuffers = {frame.streamedTextureInfoBuffer.buffer, frame.textureFeedbackBuffer.buffer};
+    writeStorageBufferDescriptors(m_device, frame.textureStreamingDescriptorSet, textureStreamingBuffers);
+
+    GpuView gpuView{};
+    gpuView.viewProjection = view.viewProjection;
+    std::copy(view.frustumPlanes.begin(), view.frustumPlanes.end(), gpuView.frustumPlanes);
+    gpuView.cameraPosition = glm::vec4(view.cameraPosition, 1.0f);
+    gpuView.lodProjectionScale = view.lodProjectionScale;
+    gpuView.maxLodPixelError = view.maxLodPixelError;
+    const uint32_t viewOffset = m_uniformAllocator.write(gpuView);
+
+    auto* batchFirstDraws = static_cast<uint32_t*>(frame.batchBuffer.mapped);
+    uint32_t firstDraw = 0u;
+    for (uint32_t batch = 0; batch < maxGraphicsPipelines; ++batch)
+    {
+        batchFirstDraws[batch] = firstDraw;
+        firstDraw += m_batchDrawCounts[batch];
+    }
+    std::memcpy(frame.instanceUpdateBuffer.mapped, instanceUpdates.data(), instanceUpdates.size_bytes());
+
+    recordFrame(frame, imageIndex, static_cast<uint32_t>(instanceUpdates.size()), viewOffset);
+    m_loadedTextureUpdates.clear();
+
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.pWaitSemaphores = &frame.imageAvailable;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &frame.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_renderFinishedSemaphores[imageIndex];
+    if (vkQueueSubmit(m_queueGraphicsCompute, 1, &submitInfo, frame.inFlight) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to submit a frame!");
+    }
+
+    VkPresentInfoKHR presentInfo{};
+    presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+    presentInfo.waitSemaphoreCount = 1;
+    presentInfo.pWaitSemaphores = &m_renderFinishedSemaphores[imageIndex];
+    presentInfo.swapchainCount = 1;
+    presentInfo.pSwapchains = &m_swapchainInfo.swapchain;
+    presentInfo.pImageIndices = &imageIndex;
+    const VkResult presentResult = vkQueuePresentKHR(m_queuePresent, &presentInfo);
+    if (presentResult != VK_SUCCESS && presentResult != VK_SUBOPTIMAL_KHR)
+    {
+        throw std::runtime_error("Failed to present a frame!");
+    }
+    ++m_frameIndex;
+}
+
+void VulkanBackend::recordFrame(FrameResources& frame, uint32_t imageIndex, uint32_t instanceUpdateCount, uint32_t viewOffset)
+{
+    TRACE_ZONE("VulkanBackend::recordFrame");
+    VkCommandBuffer commandBuffer = frame.commandBuffer;
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(commandBuffer, &beginInfo);
+    m_gpuProfiler.beginFrame(commandBuffer, m_frameIndex);
+
+    m_recording = FrameRecording{&frame, m_instanceCount, instanceUpdateCount, m_batchDrawCounts, viewOffset};
+    m_renderGraph.setImportedImage(m_swapchainImageResource, m_swapchainInfo.images[imageIndex], m_swapchainImageViews[imageIndex]);
+    m_renderGraph.execute(commandBuffer, &m_gpuProfiler);
+
+    // Texture feedback is read on the CPU once the frame fence has signaled
+    recordMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+    vkEndCommandBuffer(commandBuffer);
+}
+
+void VulkanBackend::recordInstanceUpload(const RenderGraphPassContext& context)
+{
+    if (m_recording.instanceUpdateCount == 0)
+    {
+        return;
+    }
+
+    // The previous frames may still be reading and writing the slots being updated
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(context.commandBuffer,
+                         VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+
+    const InstanceUploadConstants constants{m_recording.instanceUpdateCount};
+    vkCmdBindPipeline(context.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_instanceUploadPipeline);
+    vkCmdBindDescriptorSets(context.commandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            m_instanceUploadPipelineLayout,
+                            0,
+                            1,
+                            &m_recording.frame->instanceUploadDescriptorSet,
+                            0,
+                            nullptr);
+    vkCmdPushConstants(context.commandBuffer, m_instanceUploadPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(context.commandBuffer, (m_recording.instanceUpdateCount + instanceUploadGroupSize - 1) / instanceUploadGroupSize, 1, 1);
+}
+
+void VulkanBackend::recordInstanceCulling(const RenderGraphPassContext& context)
+{
+    if (m_recording.instanceCount == 0)
+    {
+        return;
+    }
+
+    const InstanceCullingConstants constants{m_recording.instanceCount};
+
+    vkCmdBindPipeline(context.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_instanceCullingPipeline);
+    const std::array<VkDescriptorSet, 2> descriptorSets = {m_recording.frame->cullingDescriptorSet, m_viewDescriptorSet};
+    vkCmdBindDescriptorSets(context.commandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            m_instanceCullingPipelineLayout,
+                            0,
+                            static_cast<uint32_t>(descriptorSets.size()),
+                            descriptorSets.data(),
+                            1,
+                            &m_recording.viewOffset);
+    vkCmdPushConstants(context.commandBuffer, m_instanceCullingPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(context.commandBuffer, (m_recording.instanceCount + instanceCullingGroupSize - 1) / instanceCullingGroupSize, 1, 1);
+}
+
+void VulkanBackend::recordScene(const RenderGraphPassContext& context)
+{
+    TRACE_ZONE("VulkanBackend::recordScene");
+    FrameResources& frame = *m_recording.frame;
+    const std::span<const uint32_t> batchDrawCounts = m_recording.batchDrawCounts;
+
+    std::vector<const GraphicsPipeline*> drawnPipelines;
+    for (const GraphicsPipeline* pipeline : m_graphicsPipelines.getAliveData())
+    {
+        if (batchDrawCounts[pipeline->batchIndex] > 0)
+        {
+            drawnPipelines.push_back(pipeline);
+        }
+    }
+    const uint32_t viewOffset = m_recording.viewOffset;
+
+    if (drawnPipelines.size() + m_drawListDraws.size() < 2 * drawsPerRecordingJob)
+    {
+        context.beginRenderPass(VK_SUBPASS_CONTENTS_INLINE);
+        recordDraws(context.commandBuffer, frame, viewOffset, drawnPipelines, batchDrawCounts);
+        recordDrawList(context.commandBuffer, frame, viewOffset, 0u, m_drawListDraws.size());
+        recordMeshletDraws(context.commandBuffer, frame, viewOffset);
+        context.endRenderPass();
+        return;
+    }
+
+    // Each job records a chunk of the batches or of the draw list with the command pool of the thread it runs on, the
+    // meshlets get a chunk of their own. The primary command buffer executes the chunks in order.
+    const size_t batchChunkCount = (drawnPipelines.size() + drawsPerRecordingJob - 1) / drawsPerRecordingJob;
+    const size_t drawListChunkCount = (m_drawListDraws.size() + drawsPerRecordingJob - 1) / drawsPerRecordingJob;
+    const size_t meshletChunkCount = m_meshletDraws.empty() ? 0u : 1u;
+    JobSystem& jobSystem = JobSystem::get();
+    std::vector<VkCommandBuffer> secondaryCommandBuffers(batchChunkCount + drawListChunkCount + meshletChunkCount);
+    jobSystem.parallelFor(secondaryCommandBuffers.size(), 1u, [&](size_t begin, size_t end)
+                          {
+                              CommandRecorder& recorder = frame.recorders[jobSystem.getCurrentThreadIndex()];
+                              for (size_t chunk = begin; chunk < end; ++chunk)
+                              {
+                                  if (recorder.usedCount == recorder.secondaryCommandBuffers.size())
+                                  {
+                                      recorder.secondaryCommandBuffers.push_back(allocateCommandBuffer(m_device, recorder.commandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+                                  }
+                                  VkCommandBuffer secondaryCommandBuffer = recorder.secondaryCommandBuffers[recorder.usedCount++];
+
+                                  context.beginSecondaryCommandBuffer(secondaryCommandBuffer);
+                                  if (chunk < batchChunkCount)
+                                  {
+                                      const size_t firstPipeline = chunk * drawsPerRecordingJob;
+                                      const size_t pipelineCount = std::min(drawsPerRecordingJob, drawnPipelines.size() - firstPipeline);
+                                      recordDraws(secondaryCommandBuffer, frame, viewOffset, std::span(drawnPipelines).subspan(firstPipeline, pipelineCount), batchDrawCounts);
+                                  }
+                                  else if (chunk < batchChunkCount + drawListChunkCount)
+                                  {
+                                      const size_t firstDraw = (chunk - batchChunkCount) * drawsPerRecordingJob;
+                                      recordDrawList(secondaryCommandBuffer, frame, viewOffset, firstDraw, std::min(firstDraw + drawsPerRecordingJob, m_drawListDraws.size()));
+                                  }
+                                  else
+                                  {
+                                      recordMeshletDraws(secondaryCommandBuffer, frame, viewOffset);
+                                  }
+                                  vkEndCommandBuffer(secondaryCommandBuffer);
+                                  secondaryCommandBuffers[chunk] = secondaryCommandBuffer;
+                              }
+                          });
+
+    context.beginRenderPass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(context.commandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+    context.endRenderPass();
+}
+
+void VulkanBackend::recordDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset, std::span<const GraphicsPipeline* const> pipelines, std::span<const uint32_t> batchDrawCounts) const
+{
+    // State is not inherited by secondary command buffers, so every chunk binds everything
+    const VkDeviceSize vertexBufferOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer.buffer, &vertexBufferOffset);
+    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    const std::array<VkDescriptorSet, 4> drawDescriptorSets = {frame.drawDescriptorSet, m_bindlessTable.getSet(), m_viewDescriptorSet, frame.textureStreamingDescriptorSet};
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            m_drawPipelineLayout,
+                            0,
+                            static_cast<uint32_t>(drawDescriptorSets.size()),
+                            drawDescriptorSets.data(),
+                            1,
+                            &viewOffset);
+
+    // One draw per pipeline, the culling pass wrote how many of the batch's commands are used
+    const auto* batchFirstDraws = static_cast<const uint32_t*>(frame.batchBuffer.mapped);
+    for (const GraphicsPipeline* pipeline : pipelines)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
+        vkCmdDrawIndexedIndirectCount(commandBuffer,
+                                      frame.drawCommandBuffer.buffer,
+                                      batchFirstDraws[pipeline->batchIndex] * sizeof(VkDrawIndexedIndirectCommand),
+                                      frame.drawCountBuffer.buffer,
+                                      pipeline->batchIndex * sizeof(uint32_t),
+                                      batchDrawCounts[pipeline->batchIndex],
+                                      sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void VulkanBackend::validateDrawList(const InstancedDrawList& drawList) const
+{
+    if (drawList.instances.size() > m_maxInstances)
+    {
+        throw std::runtime_error("Too many draw list instances!");
+    }
+    for (const InstancedDraw& draw : drawList.draws)
+    {
+        if (size_t(draw.firstInstance) + draw.instanceCount > drawList.instances.size())
+        {
+            throw std::runtime_error("Draw list draw is out of range!");
+        }
+        if (!m_graphicsPipelines.isValid(draw.pipeline) || !m_meshes.isValid(draw.mesh))
+        {
+            throw std::runtime_error("Draw list draw refers to a destroyed mesh or pipeline!");
+        }
+    }
+}
+
+void VulkanBackend::resolveDrawList(const InstancedDrawList& drawList)
+{
+    // Looked up once here, so recording only reads plain values
+    m_drawListDraws.clear();
+    for (const InstancedDraw& draw : drawList.draws)
+    {
+        const GpuMesh& mesh = m_meshes.getElement(draw.mesh).gpuMesh;
+        const GpuMeshLod& lod = mesh.lods[std::min(draw.lod, mesh.lodCount - 1)];
+        m_drawListDraws.push_back(ResolvedDraw{m_graphicsPipelines.getElement(draw.pipeline).pipeline,
+                                               lod.indexCount,
+                                               lod.firstIndex,
+                                               mesh.vertexOffset,
+                                               draw.firstInstance,
+                                               draw.instanceCount});
+    }
+}
+
+void VulkanBackend::recordDrawList(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset, size_t beginDraw, size_t endDraw) const
+{
+    if (beginDraw == endDraw)
+    {
+        return;
+    }
+
+    const VkDeviceSize vertexBufferOffset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_vertexBuffer.buffer, &vertexBufferOffset);
+    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+    const std::array<VkDescriptorSet, 4> drawDescriptorSets = {frame.drawListDescriptorSet, m_bindlessTable.getSet(), m_viewDescriptorSet, frame.textureStreamingDescriptorSet};
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            m_drawPipelineLayout,
+                            0,
+                            static_cast<uint32_t>(drawDescriptorSets.size()),
+                            drawDescriptorSets.data(),
+                            1,
+                            &viewOffset);
+
+    // The vertex shader finds the instance through gl_InstanceIndex, which starts from firstInstance
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    for (const ResolvedDraw& draw : std::span(m_drawListDraws).subspan(beginDraw, endDraw - beginDraw))
+    {
+        if (draw.pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline);
+            boundPipeline = draw.pipeline;
+        }
+        vkCmdDrawIndexed(commandBuffer, draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+    }
+}
+
+Handle<HandleType::Texture> VulkanBackend::createStreamedTexture(uint32_t width, uint32_t height, uint32_t mipCount, VkFormat format)
+{
+    const StreamedTexture texture{
+        .image = {},
+        .width = width,
+        .height = height,
+        .mipCount = mipCount,
+        .residentMip = mipCount,
+        .sampledResidentMip = mipCount,
+        .format = format,
+        .descriptorCopy = 0u,
+        .isSwapPending = false};
+
+    const Handle<HandleType::Texture> handle = m_streamedTextures.insertElement(texture);
+    if (handle.getId() >= maxStreamedTextures)
+    {
+        m_streamedTextures.popElement(handle);
+        throw std::runtime_error("Too many streamed textures!");
+    }
+    if (handle.getId() >= m_streamedTextureInfos.size())
+    {
+        m_streamedTextureInfos.resize(handle.getId() + 1u, StreamedTextureShaderInfo{});
+    }
+    m_textureFeedback[handle.getId()] = noTextureFeedback;
+    writeStreamedTextureShaderInfo(handle);
+    // Retiring the previous texture with this id released the slot after the last frame sampling it
+    m_bindlessTable.writeImage(bindlessTexturesBinding, handle, VK_NULL_HANDLE);
+    return handle;
+}
+
+void VulkanBackend::destroyStreamedTexture(Handle<HandleType::Texture> handle)
+{
+    StreamedTexture& texture = m_streamedTextures.getElement(handle);
+
+    // Images of updates that were not recorded yet chain from the one frames in flight sample to the current one.
+    // Loaded updates are only left over when a drawFrame() threw before recording them.
+    for (std::vector<StreamedTextureUpdate>* updates : {&m_loadedTextureUpdates, &m_streamedTextureUpdates})
+    {
+        for (StreamedTextureUpdate& update : *updates)
+        {
+            if (update.handle.getId() != handle.getId())
+            {
+                continue;
+            }
+            waitForTextureLoad(update);
+            if (update.oldImage.image)
+            {
+                m_retiredResources.images.push_back(update.oldImage);
+            }
+            if (update.stagingBuffer.buffer)
+            {
+                m_retiredResources.buffers.push_back(update.stagingBuffer);
+            }
+        }
+        std::erase_if(*updates, [&handle](const StreamedTextureUpdate& update)
+                      { return update.handle.getId() == handle.getId(); });
+    }
+
+    if (texture.image.image)
+    {
+        m_retiredResources.images.push_back(texture.image);
+        texture.image = Image{};
+    }
+    m_retiredResources.textures.push_back(handle);
+}
+
+VkDeviceSize VulkanBackend::getStreamedTextureMipSize(Handle<HandleType::Texture> handle, uint32_t mip)
+{
+    const StreamedTexture& texture = m_streamedTextures.getElement(handle);
+    return getImageMipSize(texture.format, texture.width, texture.height, mip);
+}
+
+void VulkanBackend::writeStreamedTextureShaderInfo(Handle<HandleType::Texture> handle)
+{
+    const StreamedTexture& texture = m_streamedTextures.getElement(handle);
+    m_streamedTextureInfos[handle.getId()] = StreamedTextureShaderInfo{texture.sampledResidentMip,
+                                                                       texture.width,
+                                                                       texture.height,
+                                                                       texture.mipCount,
+                                                                       m_bindlessTable.getDescriptorIndex(bindlessTexturesBinding, handle.getId(), texture.descriptorCopy)};
 }
 
-std::vector<Handle<HandleType::Framebuffer>> VulkanBackend::createFramebuffers()
+void VulkanBackend::updateStreamedTexture(Handle<HandleType::Texture> handle, uint32_t newResidentMip, const std::function<void(uint32_t mip, std::span<std::byte> destination)>& loadMip)
 {
-    std::vector<Handle<HandleType::Framebuffer>> returnedHandles;
-    returnedHandles.reserve(m_swapchainImageViews.size());
+    TRACE_ZONE("VulkanBackend::updateStreamedTexture");
+    StreamedTexture& texture = m_streamedTextures.getElement(handle);
+    newResidentMip = std::min(newResidentMip, texture.mipCount);
+    if (newResidentMip == texture.residentMip)
+    {
+        return;
+    }
+
+    StreamedTextureUpdate update{handle, texture.image, Image{}, Buffer{}, {}, texture.residentMip, newResidentMip};
+    if (newResidentMip < texture.mipCount)
+    {
+        const VkExtent2D extent{std::max(texture.width >> newResidentMip, 1u), std::max(texture.height >> newResidentMip, 1u)};
+        update.newImage = createImage(m_physicalDevice,
+                                      m_device,
+                                      extent,
+                                      texture.mipCount - newResidentMip,
+                                      texture.format,
+                                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+    }
+
+    // Mips [newResidentMip, loadedMipsEnd) are new, the rest can be copied from the old image
+    const uint32_t loadedMipsEnd = std::min(texture.residentMip, texture.mipCount);
+    if (newResidentMip < loadedMipsEnd)
+    {
+        std::vector<VkDeviceSize> mipSizes;
+        VkDeviceSize stagingSize = 0u;
+        for (uint32_t mip = newResidentMip; mip < loadedMipsEnd; ++mip)
+        {
+            mipSizes.push_back(getImageMipSize(texture.format, texture.width, texture.height, mip));
+            stagingSize += mipSizes.back();
+        }
+        update.stagingBuffer = createBuffer(m_physicalDevice,
+                                            m_device,
+                                            stagingSize,
+                                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                            MemoryCategory::Staging);
+
+        VkDeviceSize offset = 0u;
+        for (uint32_t mip = newResidentMip; mip < loadedMipsEnd; ++mip)
+        {
+            const VkDeviceSize mipSize = mipSizes[mip - newResidentMip];
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = mip - newResidentMip;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = {std::max(texture.width >> mip, 1u), std::max(texture.height >> mip, 1u), 1u};
+            update.uploadRegions.push_back(region);
+
+            offset += mipSize;
+        }
+
+        // Reading and decompressing the mips stays off the frame, the update is recorded once they are in place
+        update.loadCounter = std::make_unique<JobCounter>();
+        JobSystem::get().run([loadMip, firstMip = newResidentMip, mipSizes = std::move(mipSizes), staging = static_cast<std::byte*>(update.stagingBuffer.mapped)]()
+                             {
+                                 VkDeviceSize mipOffset = 0u;
+                                 for (size_t i = 0; i < mipSizes.size(); ++i)
+                                 {
+                                     loadMip(firstMip + static_cast<uint32_t>(i), std::span<std::byte>(staging + mipOffset, mipSizes[i]));
+                                     mipOffset += mipSizes[i];
+                                 }
+                             },
+                             update.loadCounter.get());
+    }
+
+    // Frames keep sampling the current image until the update has been recorded. Later updates of the texture chain
+    // from the new image.
+    texture.image = update.newImage;
+    texture.residentMip = newResidentMip;
+    m_streamedTextureUpdates.push_back(std::move(update));
+}
+
+void VulkanBackend::collectLoadedTextureUpdates()
+{
+    // Updates of a texture chain from one image to the next, so they are recorded in request order and one that is
+    // still loading holds back the later ones of its texture. A failed load is rethrown once the updates have been
+    // sorted, its update is recorded anyway so that the chain stays intact.
+    std::vector<StreamedTextureUpdate> loadingUpdates;
+    std::vector<uint32_t> loadingTextureIds;
+    std::exception_ptr loadException;
+    for (StreamedTextureUpdate& update : m_streamedTextureUpdates)
+    {
+        const uint32_t textureId = update.handle.getId();
+        if ((update.loadCounter && !update.loadCounter->isDone()) || std::find(loadingTextureIds.begin(), loadingTextureIds.end(), textureId) != loadingTextureIds.end())
+        {
+            loadingTextureIds.push_back(textureId);
+            loadingUpdates.push_back(std::move(update));
+            continue;
+        }
+        if (update.loadCounter)
+        {
+            try
+            {
+                JobSystem::get().wait(*update.loadCounter);
+            }
+            catch (...)
+            {
+                if (!loadException)
+                {
+                    loadException = std::current_exception();
+                }
+            }
+            update.loadCounter.reset();
+        }
+        m_loadedTextureUpdates.push_back(std::move(update));
+    }
+    m_streamedTextureUpdates = std::move(loadingUpdates);
+
+    if (loadException)
+    {
+        std::rethrow_exception(loadException);
+    }
+}
 
-    for (size_t i = 0; i < m_swapchainImageViews.size(); i++) {
-        VkImageView attachments[] = {
-            m_swapchainImageViews[i]
-        };
+void VulkanBackend::waitForTextureLoad(StreamedTextureUpdate& update)
+{
+    if (!update.loadCounter)
+    {
+        return;
+    }
+    try
+    {
+        JobSystem::get().wait(*update.loadCounter);
+    }
+    catch (...)
+    {
+        // The staging buffer is about to be destroyed, so whatever failed to load into it does not matter
+    }
+    update.loadCounter.reset();
+}
 
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = m_renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = m_swapchainInfo.extent.width;
-        framebufferInfo.height = m_swapchainInfo.extent.height;
-        framebufferInfo.layers = 1;
+void VulkanBackend::applyStreamedTextureUpdates(FrameResources& frame)
+{
+    // Resources retired since the previous frame may still be used by it, so they live as long as this frame
+    RetiredResources& retired = frame.retired;
+    retired.images.insert(retired.images.end(), m_retiredResources.images.begin(), m_retiredResources.images.end());
+    retired.buffers.insert(retired.buffers.end(), m_retiredResources.buffers.begin(), m_retiredResources.buffers.end());
+    retired.textures.insert(retired.textures.end(), m_retiredResources.textures.begin(), m_retiredResources.textures.end());
+    retired.pipelines.insert(retired.pipelines.end(), m_retiredResources.pipelines.begin(), m_retiredResources.pipelines.end());
+    m_retiredResources = RetiredResources{};
 
-        VkFramebuffer framebuffer;
+    for (const StreamedTextureUpdate& update : m_loadedTextureUpdates)
+    {
+        // Read by this frame's copies, and the old image by the previous frame
+        if (update.oldImage.image)
+        {
+            retired.images.push_back(update.oldImage);
+        }
+        if (update.stagingBuffer.buffer)
+        {
+            retired.buffers.push_back(update.stagingBuffer);
+        }
+        m_streamedTextures.getElement(update.handle).isSwapPending = true;
+    }
 
-        if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS) {
-            throw std::runtime_error("Failed to create a framebuffer!");
+    // Textures updated several times in this frame are swapped once, to the image of their last update. The copy
+    // written here was last read by the frame that was waited for, the other ones are read by frames in flight.
+    for (auto it = m_loadedTextureUpdates.rbegin(); it != m_loadedTextureUpdates.rend(); ++it)
+    {
+        StreamedTexture& texture = m_streamedTextures.getElement(it->handle);
+        if (texture.isSwapPending)
+        {
+            texture.descriptorCopy = (texture.descriptorCopy + 1u) % framesInFlight;
+            m_bindlessTable.writeImage(bindlessTexturesBinding, it->handle, it->newImage.view, texture.descriptorCopy);
+            texture.sampledResidentMip = it->newResidentMip;
+            texture.isSwapPending = false;
+            writeStreamedTextureShaderInfo(it->handle);
         }
-        Handle<HandleType::Framebuffer> handle = m_framebuffers.insertElement(framebuffer);
-        returnedHandles.push_back(handle);
     }
-    return returnedHandles;
+
+    if (!m_streamedTextureInfos.empty())
+    {
+        const std::span<const StreamedTextureShaderInfo> infos(m_streamedTextureInfos);
+        std::memcpy(frame.streamedTextureInfoBuffer.mapped, infos.data(), infos.size_bytes());
+    }
+}
+
+void VulkanBackend::recordStreamedTextureUpdates(const RenderGraphPassContext& context)
+{
+    VkCommandBuffer commandBuffer = context.commandBuffer;
+    for (const StreamedTextureUpdate& update : m_loadedTextureUpdates)
+    {
+        if (!update.newImage.image)
+        {
+            continue;
+        }
+        const StreamedTexture& texture = m_streamedTextures.getElement(update.handle);
+        const Image& newImage = update.newImage;
+        const Image& oldImage = update.oldImage;
+
+        recordImageBarrier(commandBuffer, newImage.image, 0, newImage.mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+        if (!update.uploadRegions.empty())
+        {
+            vkCmdCopyBufferToImage(commandBuffer, update.stagingBuffer.buffer, newImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(update.uploadRegions.size()), update.uploadRegions.data());
+        }
+
+        if (oldImage.image)
+        {
+            // Also waits for the previous frame, which may still be sampling the old image
+            const uint32_t firstKeptMip = std::max(update.newResidentMip, update.oldResidentMip);
+            recordImageBarrier(commandBuffer, oldImage.image, firstKeptMip - update.oldResidentMip, texture.mipCount - firstKeptMip,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+            std::vector<VkImageCopy> copyRegions;
+            for (uint32_t mip = firstKeptMip; mip < texture.mipCount; ++mip)
+            {
+                VkImageCopy region{};
+                region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - update.oldResidentMip, 0, 1};
+                region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - update.newResidentMip, 0, 1};
+                region.extent = {std::max(texture.width >> mip, 1u), std::max(texture.height >> mip, 1u), 1u};
+                copyRegions.push_back(region);
+            }
+            vkCmdCopyImage(commandBuffer, oldImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+        }
+
+        recordImageBarrier(commandBuffer, newImage.image, 0, newImage.mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                           VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+    }
+}
+
+void VulkanBackend::collectTextureFeedback(FrameResources& frame)
+{
+    // The frame has finished, and made its feedback writes visible to the host before signaling its fence
+    const auto* frameFeedback = static_cast<const uint32_t*>(frame.textureFeedbackBuffer.mapped);
+    for (size_t textureId = 0; textureId < m_streamedTextureInfos.size(); ++textureId)
+    {
+        m_textureFeedback[textureId] = std::min(m_textureFeedback[textureId], frameFeedback[textureId]);
+    }
+    std::memset(frame.textureFeedbackBuffer.mapped, 0xFF, m_streamedTextureInfos.size() * sizeof(uint32_t));
+}
+
+std::span<const uint32_t> VulkanBackend::readTextureFeedback()
+{
+    std::swap(m_textureFeedback, m_readTextureFeedback);
+    std::fill(m_textureFeedback.begin(), m_textureFeedback.end(), noTextureFeedback);
+    return m_readTextureFeedback;
+}
+
+void VulkanBackend::destroyRetiredResources(RetiredResources& retired)
+{
+    for (Image& image : retired.images)
+    {
+        destroyImage(m_device, image);
+    }
+    for (Buffer& buffer : retired.buffers)
+    {
+        destroyBuffer(m_device, buffer);
+    }
+    for (const Handle<HandleType::Texture> handle : retired.textures)
+    {
+        m_bindlessTable.release(bindlessTexturesBinding, handle);
+        m_streamedTextures.popElement(handle);
+    }
+    for (const VkPipeline pipeline : retired.pipelines)
+    {
+        vkDestroyPipeline(m_device, pipeline, nullptr);
+    }
+    retired = RetiredResources{};
+}
+
+void VulkanBackend::createClusterCullingPipeline(const std::vector<uint32_t>& computeShaderSpirV)
+{
+    TRACE_ZONE("VulkanBackend::createClusterCullingPipeline");
+    if (m_clusterCullingPipeline)
+    {
+        replaceComputePipeline(m_clusterCullingPipeline, m_clusterCullingPipelineLayout, computeShaderSpirV);
+        return;
+    }
+
+    const VkPushConstantRange pushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCullingConstants)};
+    const VkDescriptorSetLayout bindlessLayout = m_bindlessTable.getLayout();
+    m_clusterCullingPipelineLayout = createPipelineLayout(m_device, std::span(&bindlessLayout, 1), std::span(&pushConstantRange, 1));
+
+    VkShaderModule computeShaderModule = createShaderModule(m_device, computeShaderSpirV);
+    m_clusterCullingPipeline = createComputePipeline(m_device, m_clusterCullingPipelineLayout, computeShaderModule);
+    destroyShaderModule(m_device, computeShaderModule);
+}
+
+Handle<HandleType::Geometry> VulkanBackend::createMeshletGeometry(std::span<const QuantizedMeshVertex> vertices, const MeshletMesh& meshletMesh)
+{
+    TRACE_ZONE("VulkanBackend::createMeshletGeometry");
+    if (meshletMesh.meshlets.empty())
+    {
+        throw std::runtime_error("Meshlet geometry needs at least one meshlet!");
+    }
+
+    MeshletGeometry geometry{};
+    geometry.meshletCount = static_cast<uint32_t>(meshletMesh.meshlets.size());
+    geometry.vertexBuffer = createDeviceLocalBuffer(m_physicalDevice, m_device, m_commandPool, m_queueGraphicsCompute, std::as_bytes(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MemoryCategory::Geometry);
+    geometry.indexBuffer = createDeviceLocalBuffer(m_physicalDevice, m_device, m_commandPool, m_queueGraphicsCompute, std::as_bytes(std::span(meshletMesh.indices)), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, MemoryCategory::Geometry);
+    geometry.meshletBuffer = createDeviceLocalBuffer(m_physicalDevice, m_device, m_commandPool, m_queueGraphicsCompute, std::as_bytes(std::span(meshletMesh.meshlets)), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, MemoryCategory::Geometry);
+    geometry.drawCommandBuffer = createBuffer(m_physicalDevice,
+                                              m_device,
+                                              geometry.meshletCount * sizeof(VkDrawIndexedIndirectCommand),
+                                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                              VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                              MemoryCategory::Geometry);
+
+    const Handle<HandleType::Geometry> handle = m_meshletGeometries.insertElement(geometry);
+    if (handle.getId() >= maxMeshletGeometries)
+    {
+        m_meshletGeometries.popElement(handle);
+        destroyBuffer(m_device, geometry.vertexBuffer);
+        destroyBuffer(m_device, geometry.indexBuffer);
+        destroyBuffer(m_device, geometry.meshletBuffer);
+        destroyBuffer(m_device, geometry.drawCommandBuffer);
+        throw std::runtime_error("Too many meshlet geometries!");
+    }
+    m_bindlessTable.writeBuffer(bindlessMeshletsBinding, handle, geometry.meshletBuffer.buffer);
+    m_bindlessTable.writeBuffer(bindlessMeshletDrawCommandsBinding, handle, geometry.drawCommandBuffer.buffer);
+    return handle;
+}
+
+void VulkanBackend::destroyMeshletGeometry(Handle<HandleType::Geometry> handle)
+{
+    vkQueueWaitIdle(m_queueGraphicsCompute);
+
+    m_bindlessTable.release(bindlessMeshletsBinding, handle);
+    m_bindlessTable.release(bindlessMeshletDrawCommandsBinding, handle);
+    MeshletGeometry geometry = m_meshletGeometries.popElement(handle);
+    destroyBuffer(m_device, geometry.vertexBuffer);
+    destroyBuffer(m_device, geometry.indexBuffer);
+    destroyBuffer(m_device, geometry.meshletBuffer);
+    destroyBuffer(m_device, geometry.drawCommandBuffer);
+}
+
+void VulkanBackend::validateMeshletDraws(std::span<const MeshletDraw> meshletDraws) const
+{
+    if (meshletDraws.empty())
+    {
+        return;
+    }
+    if (!m_clusterCullingPipeline)
+    {
+        throw std::runtime_error("Cluster culling pipeline has not been created!");
+    }
+    if (meshletDraws.size() > maxMeshletGeometries)
+    {
+        throw std::runtime_error("Too many meshlet draws!");
+    }
+
+    std::vector<uint8_t> isGeometryDrawn(maxMeshletGeometries, 0u);
+    for (const MeshletDraw& draw : meshletDraws)
+    {
+        if (!m_meshletGeometries.isValid(draw.geometry) || !m_graphicsPipelines.isValid(draw.pipeline))
+        {
+            throw std::runtime_error("Meshlet draw refers to a destroyed geometry or pipeline!");
+        }
+        if (isGeometryDrawn[draw.geometry.getId()])
+        {
+            throw std::runtime_error("Meshlet geometry is drawn more than once in a frame!");
+        }
+        isGeometryDrawn[draw.geometry.getId()] = 1u;
+    }
+}
+
+void VulkanBackend::resolveMeshletDraws(std::span<const MeshletDraw> meshletDraws, const FrameView& view)
+{
+    m_meshletDraws.clear();
+    for (const MeshletDraw& draw : meshletDraws)
+    {
+        const MeshletGeometry& geometry = m_meshletGeometries.getElement(draw.geometry);
+
+        // Planes transform to mesh space with the transpose of the model matrix, renormalized so that sphere distances
+        // stay in mesh units
+        ClusterCullingConstants constants{};
+        const glm::mat4 transposedModel = glm::transpose(draw.model);
+        for (size_t plane = 0; plane < view.frustumPlanes.size(); ++plane)
+        {
+            const glm::vec4 meshPlane = transposedModel * view.frustumPlanes[plane];
+            constants.frustumPlanes[plane] = meshPlane / glm::length(glm::vec3(meshPlane.x, meshPlane.y, meshPlane.z));
+        }
+        constants.cameraPosition = glm::inverse(draw.model) * glm::vec4(view.cameraPosition, 1.0f);
+        constants.meshletCount = geometry.meshletCount;
+        constants.geometryIndex = draw.geometry.getId();
+        constants.instanceIndex = static_cast<uint32_t>(m_meshletDraws.size());
+
+        m_meshletDraws.push_back(ResolvedMeshletDraw{m_graphicsPipelines.getElement(draw.pipeline).pipeline,
+                                                     geometry.vertexBuffer.buffer,
+                                                     geometry.indexBuffer.buffer,
+                                                     geometry.drawCommandBuffer.buffer,
+                                                     draw.model,
+                                                     constants});
+    }
+}
+
+void VulkanBackend::recordClusterCulling(const RenderGraphPassContext& context)
+{
+    if (m_meshletDraws.empty())
+    {
+        return;
+    }
+
+    // The previous frames may still be drawing with the commands being rewritten
+    recordMemoryBarrier(context.commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0);
+
+    vkCmdBindPipeline(context.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_clusterCullingPipeline);
+    const VkDescriptorSet bindlessSet = m_bindlessTable.getSet();
+    vkCmdBindDescriptorSets(context.commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_clusterCullingPipelineLayout, 0, 1, &bindlessSet, 0, nullptr);
+    for (const ResolvedMeshletDraw& draw : m_meshletDraws)
+    {
+        vkCmdPushConstants(context.commandBuffer, m_clusterCullingPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(draw.constants), &draw.constants);
+        vkCmdDispatch(context.commandBuffer, (draw.constants.meshletCount + clusterCullingGroupSize - 1) / clusterCullingGroupSize, 1, 1);
+    }
+}
+
+void VulkanBackend::recordMeshletDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset) const
+{
+    if (m_meshletDraws.empty())
+    {
+        return;
+    }
+
+    const std::array<VkDescriptorSet, 4> drawDescriptorSets = {frame.meshletDescriptorSet, m_bindlessTable.getSet(), m_viewDescriptorSet, frame.textureStreamingDescriptorSet};
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS,
+                            m_drawPipelineLayout,
+                            0,
+                            static_cast<uint32_t>(drawDescriptorSets.size()),
+                            drawDescriptorSets.data(),
+                            1,
+                            &viewOffset);
+
+    // Every command of a geometry has the draw's instance as its first instance. Culled meshlets have zero instances.
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    for (const ResolvedMeshletDraw& draw : m_meshletDraws)
+    {
+        if (draw.pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline);
+            boundPipeline = draw.pipeline;
+        }
+        const VkDeviceSize vertexBufferOffset = 0;
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, &draw.vertexBuffer, &vertexBufferOffset);
+        vkCmdBindIndexBuffer(commandBuffer, draw.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+        // Split to stay within the device draw count limit
+        const uint32_t meshletCount = draw.constants.meshletCount;
+        for (uint32_t firstDraw = 0; firstDraw < meshletCount; firstDraw += m_maxDrawIndirectCount)
+        {
+            const uint32_t drawCount = std::min(meshletCount - firstDraw, m_maxDrawIndirectCount);
+            vkCmdDrawIndexedIndirect(commandBuffer, draw.drawCommandBuffer, firstDraw * sizeof(VkDrawIndexedIndirectCommand), drawCount, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+}
+
+const MemoryReport& VulkanBackend::getMemoryReport() const
+{
+    return m_memoryBudget.getReport();
+}
+
+int64_t VulkanBackend::getDeviceMemoryHeadroom() const
+{
+    return m_memoryBudget.getPrimaryHeapHeadroom();
+}
+
+std::vector<GpuScopeStatistics> VulkanBackend::getGpuProfile() const
+{
+    return m_gpuProfiler.getStatistics();
 }
 
 } // namespace Vulkan
\ No newline at end of file
@@ -1,30 +1,405 @@
 #ifndef VULKANPROJECT_VULKANBACKEND_H
 #define VULKANPROJECT_VULKANBACKEND_H
 
+#include "VulkanBindlessTable.h"
+#include "VulkanBuffer.h"
+#include "VulkanDescriptors.h"
+#include "VulkanImage.h"
+#include "VulkanMemoryBudget.h"
+#include "VulkanProfiler.h"
+#include "VulkanRenderGraph.h"
 #include "VulkanSwapchain.h"
 #include "../Types.h"
 #include "../Handle.h"
+#include "../../../Assets/Mesh.h"
+#include "../../../Assets/MeshletBuilder.h"
+#include "../../../Assets/MeshSimplifier.h"
+#include "../../../Utilities/JobSystem.h"
+#include "../../../Utilities/RangeAllocator.h"
 
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace Vulkan
 {
+
+/**
+ * Texture whose GPU image only holds the resident mips [residentMip, mipCount)
+ */
+struct StreamedTexture
+{
+    Image image; // Latest requested mips, sampled once the update creating it has been recorded
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t residentMip; // Of image, equal to mipCount when nothing is resident
+    uint32_t sampledResidentMip; // Of the image shaders sample, behind residentMip while its mips are loading
+    VkFormat format;
+    uint32_t descriptorCopy; // Copy of the bindless slot read by the latest recorded frame
+    bool isSwapPending; // Sampled image changed since the latest recorded frame
+};
+
+// Per texture data read by shaders/include/TextureStreaming.glsl, indexed by texture handle id
+struct StreamedTextureShaderInfo
+{
+    uint32_t residentMip;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t descriptorIndex; // Of the bindless texture copy holding the resident mips
+};
+
+/**
+ * Mip change of a streamed texture, recorded into the command buffer of the first frame after its mips have loaded
+ */
+struct StreamedTextureUpdate
+{
+    Handle<HandleType::Texture> handle;
+    Image oldImage; // Copied from, then retired with the frame
+    Image newImage; // Empty when no mips stay resident
+    Buffer stagingBuffer; // Mips that were not resident before, empty when there are none
+    std::vector<VkBufferImageCopy> uploadRegions;
+    uint32_t oldResidentMip;
+    uint32_t newResidentMip;
+    std::unique_ptr<JobCounter> loadCounter; // Job writing the new mips to the staging buffer, null when there are none
+};
+
+/**
+ * Resources that frames in flight may still use, destroyed once the GPU has finished the frame they are retired with
+ */
+struct RetiredResources
+{
+    std::vector<Image> images;
+    std::vector<Buffer> buffers;
+    std::vector<Handle<HandleType::Texture>> textures; // Bindless slots are released and handle ids recycled
+    std::vector<VkPipeline> pipelines; // Replaced by shader hot reload
+};
+
+/**
+ * Meshlet geometry with one indirect draw command slot per meshlet, written by the cluster culling pass
+ */
+struct MeshletGeometry
+{
+    Buffer vertexBuffer; // QuantizedMeshVertex
+    Buffer indexBuffer;
+    Buffer meshletBuffer; // PackedMeshlet
+    Buffer drawCommandBuffer; // VkDrawIndexedIndirectCommand
+    uint32_t meshletCount;
+};
+
+// Push constants of shaders/ClusterCulling.comp
+struct ClusterCullingConstants
+{
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cameraPosition;
+    uint32_t meshletCount;
+    uint32_t geometryIndex; // Geometry handle id, slot of its buffers in the bindless table
+    uint32_t instanceIndex; // First instance of the meshlet draws, the draw's slot in the meshlet instance buffer
+};
+
+/**
+ * Meshlet geometry drawn with a graphics pipeline from createGraphicsPipeline(), culled per meshlet on the GPU
+ */
+struct MeshletDraw
+{
+    Handle<HandleType::Geometry> geometry;
+    Handle<HandleType::Pipeline> pipeline;
+    glm::mat4 model;
+};
+
+constexpr uint32_t maxMeshLods = 8u; // MAX_MESH_LODS in shaders/include/SceneData.glsl
+
+// Shader side structs of the indirect draw path, must match shaders/include/SceneData.glsl
+struct GpuMeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+    uint32_t padding;
+};
+
+struct GpuMesh
+{
+    float center[3];
+    float radius;
+    int32_t vertexOffset;
+    uint32_t lodCount; // 0 for destroyed meshes
+    uint32_t padding[2];
+    GpuMeshLod lods[maxMeshLods];
+};
+
+static_assert(sizeof(GpuMesh) == 160);
+
+constexpr uint32_t instanceVisibleFlag = 1u; // GpuInstance::flags, hidden instances are culled
+constexpr uint32_t noTexture = ~0u; // GpuInstance::textureIndex of untextured instances
+
+struct GpuInstance
+{
+    glm::mat4 model;
+    uint32_t meshIndex; // Mesh handle id
+    uint32_t batchIndex; // Graphics pipeline handle id
+    uint32_t flags;
+    uint32_t textureIndex; // Streamed texture handle id or noTexture
+};
+
+static_assert(sizeof(GpuInstance) == 80);
+
+/**
+ * New contents of one slot of the persistent instance buffer
+ */
+struct GpuInstanceUpdate
+{
+    uint32_t instanceIndex;
+    uint32_t padding[3];
+    GpuInstance instance;
+};
+
+static_assert(sizeof(GpuInstanceUpdate) == 96);
+
+/**
+ * Ranges of the shared vertex and index buffers owned by a mesh, in vertices and indices
+ */
+struct SceneMesh
+{
+    uint64_t firstVertex;
+    uint64_t vertexCount;
+    uint64_t firstIndex;
+    uint64_t indexCount;
+    GpuMesh gpuMesh; // Copy of the mesh table entry for drawing from the CPU
+};
+
+/**
+ * Instances [firstInstance, firstInstance + instanceCount) of an InstancedDrawList drawn with one instanced draw
+ */
+struct InstancedDraw
+{
+    Handle<HandleType::Pipeline> pipeline;
+    Handle<HandleType::Mesh> mesh;
+    uint32_t lod; // Clamped to the mesh's coarsest LOD
+    uint32_t firstInstance;
+    uint32_t instanceCount;
+};
+
+/**
+ * Draws culled, sorted and merged on the CPU, drawn after the GPU culled instances in the same pass
+ */
+struct InstancedDrawList
+{
+    std::span<const GpuInstance> instances;
+    std::span<const InstancedDraw> draws; // Drawn in order, the pipeline is bound only when it changes
+};
+
+struct GraphicsPipeline
+{
+    VkPipeline pipeline;
+    uint32_t batchIndex;
+};
+
+// Push constants of shaders/InstanceCulling.comp
+struct InstanceCullingConstants
+{
+    uint32_t instanceCount;
+};
+
+// Push constants of shaders/InstanceUpload.comp
+struct InstanceUploadConstants
+{
+    uint32_t updateCount;
+};
+
+// Uniform of the view shared by culling and drawing, must match GpuView in shaders/include/SceneData.glsl
+struct GpuView
+{
+    glm::mat4 viewProjection;
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cameraPosition;
+    float lodProjectionScale;
+    float maxLodPixelError;
+    uint32_t padding[2];
+};
+
+static_assert(sizeof(GpuView) == 192);
+
+/**
+ * Camera of one frame, in world space
+ */
+struct FrameView
+{
+    glm::mat4 viewProjection;
+    std::array<glm::vec4, 6> frustumPlanes;
+    glm::vec3 cameraPosition;
+    float lodProjectionScale; // Pixels per world unit at distance 1
+    float maxLodPixelError;
+};
+
+/**
+ * Command pool of one thread for one frame in flight, reset when the frame is reused
+ */
+struct CommandRecorder
+{
+    VkCommandPool commandPool;
+    std::vector<VkCommandBuffer> secondaryCommandBuffers; // Allocated so far, reused every frame
+    uint32_t usedCount;
+};
+
+/**
+ * Per frame in flight objects. Buffers written by the CPU or GPU during a frame are duplicated so the next frame can
+ * be recorded while the previous one is still executing.
+ */
+struct FrameResources
+{
+    VkCommandBuffer commandBuffer;
+    VkSemaphore imageAvailable;
+    VkFence inFlight;
+    Buffer instanceUpdateBuffer; // GpuInstanceUpdate, host visible
+    Buffer drawListInstanceBuffer; // GpuInstance of the InstancedDrawList, host visible
+    Buffer batchBuffer; // First draw command of each batch, host visible
+    Buffer drawCommandBuffer; // VkDrawIndexedIndirectCommand
+    Buffer drawCountBuffer; // Draw count of each batch
+    Buffer meshletInstanceBuffer; // GpuInstance of each MeshletDraw, host visible
+    DescriptorAllocator descriptorAllocator; // Reset when the frame is reused
+    VkDescriptorSet instanceUploadDescriptorSet; // Allocated from descriptorAllocator every frame
+    VkDescriptorSet cullingDescriptorSet;
+    VkDescriptorSet drawDescriptorSet;
+    VkDescriptorSet drawListDescriptorSet;
+    VkDescriptorSet meshletDescriptorSet;
+    Buffer streamedTextureInfoBuffer; // StreamedTextureShaderInfo, host visible
+    Buffer textureFeedbackBuffer; // Finest requested mip per texture, host visible, read once the frame has finished
+    VkDescriptorSet textureStreamingDescriptorSet;
+    RetiredResources retired; // Destroyed when the frame is reused
+    std::vector<CommandRecorder> recorders; // Indexed by JobSystem::getCurrentThreadIndex()
+};
+
 class VulkanBackend
 {
 public:
     VulkanBackend(bool enableDebug, glm::uvec2 resolution, std::function<VkSurfaceKHR(VkInstance&)> surfaceCreationFunction, std::vector<const char*> windowVulkanExtensions);
     ~VulkanBackend();
 
-    void createGraphicsPipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV);
-    std::vector<Handle<HandleType::Framebuffer>> createFramebuffers();
+    /**
+     * Create a pipeline drawing QuantizedMeshVertex meshes from the shared geometry buffers. Each pipeline is one batch
+     * of the indirect draw path.
+     */
+    Handle<HandleType::Pipeline> createGraphicsPipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV);
+    void destroyGraphicsPipeline(Handle<HandleType::Pipeline> handle);
+
+    /**
+     * Swap the shaders of a pipeline, keeping its handle and batch. The old pipeline is kept if the new one fails to
+     * be created, and destroyed once the frames in flight that may use it are done otherwise. Call between frames.
+     */
+    void replaceGraphicsPipeline(Handle<HandleType::Pipeline> handle, const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV);
+
+    /**
+     * Calling these again replaces the pipeline like replaceGraphicsPipeline()
+     */
+    void createInstanceCullingPipeline(const std::vector<uint32_t>& computeShaderSpirV);
+    void createInstanceUploadPipeline(const std::vector<uint32_t>& computeShaderSpirV);
+
+    /**
+     * Upload the vertices and all LOD index buffers of a mesh to the shared geometry buffers
+     */
+    Handle<HandleType::Mesh> createMesh(std::span<const QuantizedMeshVertex> vertices, const MeshLodChain& lodChain);
+    void destroyMesh(Handle<HandleType::Mesh> handle);
+
+    /**
+     * Cull instances and select their LODs on the GPU, then draw each graphics pipeline with one indirect count draw.
+     * CPU cost is independent of how many instances are visible.
+     *
+     * Instances live in a device local buffer that persists between frames. Only the given updates are uploaded,
+     * scattered to their slots by a compute pass, so the upload cost grows with the number of changed instances.
+     * @param instanceCount Slots [0, instanceCount) are drawn. Slots that have never been written have to be updated.
+     * @param drawList Drawn as is, without GPU culling
+     * @param meshletDraws Culled per meshlet by a compute pass, then drawn with one indirect draw per geometry. Each
+     * geometry has one set of draw commands, so it can be drawn once per frame.
+     */
+    void drawFrame(uint32_t instanceCount,
+                   std::span<const GpuInstanceUpdate> instanceUpdates,
+                   const FrameView& view,
+                   const InstancedDrawList& drawList = {},
+                   std::span<const MeshletDraw> meshletDraws = {});
+
+    Handle<HandleType::Texture> createStreamedTexture(uint32_t width, uint32_t height, uint32_t mipCount, VkFormat format);
+
+    /**
+     * The texture is destroyed, and its handle id recycled, once the GPU has finished the frames sampling it
+     */
+    void destroyStreamedTexture(Handle<HandleType::Texture> handle);
+    VkDeviceSize getStreamedTextureMipSize(Handle<HandleType::Texture> handle, uint32_t mip);
+
+    /**
+     * Reallocate the texture image so that it holds mips [newResidentMip, mipCount). The missing mips are written by
+     * loadMip directly to a mapped staging buffer in a job on the job system, so loadMip has to be safe to call from
+     * any thread and must not refer to anything that may go away before it runs. The first drawFrame() after the job
+     * is done records copying them and the already resident mips to the new image and swaps the image in, so neither
+     * the loading nor the GPU is waited for. Loading errors are rethrown by that drawFrame().
+     */
+    void updateStreamedTexture(Handle<HandleType::Texture> handle, uint32_t newResidentMip, const std::function<void(uint32_t mip, std::span<std::byte> destination)>& loadMip);
 
+    /**
+     * Return the finest mip that shaders requested for each texture id in the frames the GPU has finished since the
+     * last call. The span stays valid until the next call.
+     */
+    std::span<const uint32_t> readTextureFeedback();
+
+    /**
+     * Calling this again replaces the pipeline like replaceGraphicsPipeline()
+     */
+    void createClusterCullingPipeline(const std::vector<uint32_t>& computeShaderSpirV);
+    Handle<HandleType::Geometry> createMeshletGeometry(std::span<const QuantizedMeshVertex> vertices, const MeshletMesh& meshletMesh);
+    void destroyMeshletGeometry(Handle<HandleType::Geometry> handle);
+
+    /**
+     * GPU time of every render graph pass over the last frames
+     */
+    std::vector<GpuScopeStatistics> getGpuProfile() const;
+
+    /**
+     * Heap budgets and usage per heap and per memory category, refreshed every frame
+     */
+    const MemoryReport& getMemoryReport() const;
+
+    /**
+     * Bytes that can still be allocated from the device local heap images use, negative when it is over its budget
+     */
+    int64_t getDeviceMemoryHeadroom() const;
 
 private:
     void createInstance(const std::vector<const char*>& neededInstanceExtensions);
+    void createSceneResources();
+    void createRenderGraph();
+    void createBindlessTable();
+    VkPipeline createScenePipeline(const std::vector<uint32_t>& vertexShaderSpirV, const std::vector<uint32_t>& fragmentShaderSpirV) const;
+    void replaceComputePipeline(VkPipeline& pipeline, VkPipelineLayout pipelineLayout, const std::vector<uint32_t>& computeShaderSpirV);
+    void recordFrame(FrameResources& frame, uint32_t imageIndex, uint32_t instanceUpdateCount, uint32_t viewOffset);
+    void recordInstanceUpload(const RenderGraphPassContext& context);
+    void recordInstanceCulling(const RenderGraphPassContext& context);
+    void recordScene(const RenderGraphPassContext& context);
+    void recordDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset, std::span<const GraphicsPipeline* const> pipelines, std::span<const uint32_t> batchDrawCounts) const;
+    void validateDrawList(const InstancedDrawList& drawList) const;
+    void resolveDrawList(const InstancedDrawList& drawList);
+    void recordDrawList(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset, size_t beginDraw, size_t endDraw) const;
+    void validateMeshletDraws(std::span<const MeshletDraw> meshletDraws) const;
+    void resolveMeshletDraws(std::span<const MeshletDraw> meshletDraws, const FrameView& view);
+
+    /**
+     * Cull meshlets against the frustum and their normal cones and write their indirect draw commands
+     */
+    void recordClusterCulling(const RenderGraphPassContext& context);
+    void recordMeshletDraws(VkCommandBuffer commandBuffer, const FrameResources& frame, uint32_t viewOffset) const;
+    void writeStreamedTextureShaderInfo(Handle<HandleType::Texture> handle);
+    void collectTextureFeedback(FrameResources& frame);
+    void collectLoadedTextureUpdates();
+    void waitForTextureLoad(StreamedTextureUpdate& update);
+    void applyStreamedTextureUpdates(FrameResources& frame);
+    void recordStreamedTextureUpdates(const RenderGraphPassContext& context);
+    void destroyRetiredResources(RetiredResources& retired);
 
     bool m_enableDebug{false};
 
@@ -36,10 +411,94 @@ private:
     VkDevice m_device{VK_NULL_HANDLE};
     VkQueue m_queueGraphicsCompute{VK_NULL_HANDLE};
     VkQueue m_queuePresent{VK_NULL_HANDLE};
-    VkRenderPass m_renderPass{VK_NULL_HANDLE};
-    VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
-    VkPipeline m_pipeline;
-    HandleStorage<HandleType::Framebuffer, VkFramebuffer> m_framebuffers;
+    uint32_t m_graphicsQueueFamily{0u};
+    VkCommandPool m_commandPool{VK_NULL_HANDLE};
+    BindlessTable m_bindlessTable; // Textures and meshlet geometry buffers, indexed by handle id
+    Image m_fallbackTexture; // Sampled through the slots of textures without resident mips
+    RenderGraph m_renderGraph;
+    GpuProfiler m_gpuProfiler; // Scopes around the render graph passes
+    MemoryBudget m_memoryBudget;
+    RenderGraphResource m_swapchainImageResource{};
+    uint32_t m_scenePass{0u};
+    PipelineRenderTarget m_sceneRenderTarget{}; // Render pass owned by m_renderGraph, if any
+    DynamicRenderingFunctions m_dynamicRendering{}; // Null without dynamic rendering support
+    std::vector<VkSemaphore> m_renderFinishedSemaphores; // One per swapchain image
+    std::vector<FrameResources> m_frames;
+    uint64_t m_frameIndex{0u};
+
+    // Frame being recorded, read by the render graph passes
+    struct FrameRecording
+    {
+        FrameResources* frame;
+        uint32_t instanceCount;
+        uint32_t instanceUpdateCount;
+        std::span<const uint32_t> batchDrawCounts;
+        uint32_t viewOffset; // Of the GpuView in m_uniformAllocator
+    };
+    FrameRecording m_recording{};
+
+    // Indirect draw path
+    Buffer m_vertexBuffer;
+    Buffer m_indexBuffer;
+    RangeAllocator m_vertexAllocator;
+    RangeAllocator m_indexAllocator;
+    Buffer m_meshBuffer; // GpuMesh indexed by mesh handle id
+    HandleStorage<HandleType::Mesh, SceneMesh> m_meshes;
+    uint32_t m_maxInstances{0u};
+    Buffer m_instanceBuffer; // GpuInstance, device local, written only by the instance upload pass
+    uint32_t m_instanceCount{0u};
+    std::vector<uint32_t> m_instanceBatches; // Batch of each slot as last uploaded, noBatch for unwritten slots
+    std::vector<uint32_t> m_batchDrawCounts; // Instances of each batch, kept up to date with the uploads
+
+    // Draw list draws of the frame being recorded, with their pipelines and index ranges looked up
+    struct ResolvedDraw
+    {
+        VkPipeline pipeline;
+        uint32_t indexCount;
+        uint32_t firstIndex;
+        int32_t vertexOffset;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+    std::vector<ResolvedDraw> m_drawListDraws;
+
+    // Meshlet draws of the frame being recorded, with the view transformed to the space of each mesh
+    struct ResolvedMeshletDraw
+    {
+        VkPipeline pipeline;
+        VkBuffer vertexBuffer;
+        VkBuffer indexBuffer;
+        VkBuffer drawCommandBuffer;
+        glm::mat4 model;
+        ClusterCullingConstants constants;
+    };
+    std::vector<ResolvedMeshletDraw> m_meshletDraws;
+    UniformAllocator m_uniformAllocator;
+    VkDescriptorPool m_descriptorPool{VK_NULL_HANDLE};
+    VkDescriptorSetLayout m_viewSetLayout{VK_NULL_HANDLE};
+    VkDescriptorSet m_viewDescriptorSet{VK_NULL_HANDLE}; // Dynamic uniform buffer covering m_uniformAllocator
+    VkDescriptorSetLayout m_instanceCullingSetLayout{VK_NULL_HANDLE};
+    VkPipelineLayout m_instanceCullingPipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_instanceCullingPipeline{VK_NULL_HANDLE};
+    VkDescriptorSetLayout m_instanceUploadSetLayout{VK_NULL_HANDLE};
+    VkPipelineLayout m_instanceUploadPipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_instanceUploadPipeline{VK_NULL_HANDLE};
+    VkDescriptorSetLayout m_drawSetLayout{VK_NULL_HANDLE};
+    VkPipelineLayout m_drawPipelineLayout{VK_NULL_HANDLE};
+    HandleStorage<HandleType::Pipeline, GraphicsPipeline> m_graphicsPipelines;
+
+    HandleStorage<HandleType::Texture, StreamedTexture> m_streamedTextures;
+    VkDescriptorSetLayout m_textureStreamingSetLayout{VK_NULL_HANDLE};
+    std::vector<StreamedTextureShaderInfo> m_streamedTextureInfos; // Copied to every frame, up to the largest id in use
+    std::vector<StreamedTextureUpdate> m_streamedTextureUpdates; // In request order, waiting for their mips to load
+    std::vector<StreamedTextureUpdate> m_loadedTextureUpdates; // Recorded by the next frame
+    std::vector<uint32_t> m_textureFeedback; // Of the finished frames since the last readTextureFeedback()
+    std::vector<uint32_t> m_readTextureFeedback; // Returned by the last readTextureFeedback()
+    RetiredResources m_retiredResources; // Retired between frames, moved to the next recorded frame
+    uint32_t m_maxDrawIndirectCount{1u};
+    VkPipelineLayout m_clusterCullingPipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_clusterCullingPipeline{VK_NULL_HANDLE};
+    HandleStorage<HandleType::Geometry, MeshletGeometry> m_meshletGeometries;
     VkDebugUtilsMessengerEXT m_debugMessenger{VK_NULL_HANDLE};
 };
 } // namespace Vulkan
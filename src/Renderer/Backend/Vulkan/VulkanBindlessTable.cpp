@@ -0,0 +1,185 @@
+#include "VulkanBindlessTable.h"
+
+#include "VulkanDescriptors.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan
+{
+
+void BindlessTable::create(VkDevice device, std::span<const BindlessBinding> bindings, VkImageView fallbackImageView)
+{
+    if (m_device)
+    {
+        throw std::runtime_error("Bindless table has already been created!");
+    }
+    m_device = device;
+    m_bindings.assign(bindings.begin(), bindings.end());
+    m_fallbackImageView = fallbackImageView;
+
+    // Partially bound: unused slots do not need valid descriptors. Update unused while pending: slots can be written
+    // while command buffers using other slots of the set are in flight.
+    const VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+                                                  | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                                                  | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+    std::vector<VkDescriptorBindingFlags> layoutBindingFlags;
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (uint32_t binding = 0; binding < m_bindings.size(); ++binding)
+    {
+        const BindlessBinding& bindlessBinding = m_bindings[binding];
+        if (bindlessBinding.copiesPerSlot == 0)
+        {
+            throw std::runtime_error("Bindless binding " + std::to_string(binding) + " has no copies per slot!");
+        }
+        const uint32_t descriptorCount = bindlessBinding.slotCount * bindlessBinding.copiesPerSlot;
+        layoutBindings.push_back(VkDescriptorSetLayoutBinding{binding, bindlessBinding.type, descriptorCount, bindlessBinding.stages, nullptr});
+        layoutBindingFlags.push_back(bindingFlags);
+        poolSizes.push_back(VkDescriptorPoolSize{bindlessBinding.type, descriptorCount});
+        m_slots.emplace_back(bindlessBinding.slotCount, Slot{0u, false});
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(layoutBindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = layoutBindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(layoutBindings.size());
+    layoutInfo.pBindings = layoutBindings.data();
+    if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the bindless descriptor set layout!");
+    }
+
+    m_pool = createDescriptorPool(m_device, poolSizes, 1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    m_set = allocateDescriptorSet(m_device, m_pool, m_layout);
+
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    if (vkCreateSampler(m_device, &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the bindless sampler!");
+    }
+}
+
+void BindlessTable::destroy()
+{
+    if (!m_device)
+    {
+        return;
+    }
+    vkDestroySampler(m_device, m_sampler, nullptr);
+    vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_layout, nullptr);
+
+    m_bindings.clear();
+    m_slots.clear();
+    m_device = VK_NULL_HANDLE;
+    m_layout = VK_NULL_HANDLE;
+    m_pool = VK_NULL_HANDLE;
+    m_set = VK_NULL_HANDLE;
+    m_sampler = VK_NULL_HANDLE;
+    m_fallbackImageView = VK_NULL_HANDLE;
+}
+
+uint32_t BindlessTable::getDescriptorIndex(uint32_t binding, uint32_t slot, uint32_t copy) const
+{
+    const BindlessBinding& bindlessBinding = m_bindings.at(binding);
+    if (copy >= bindlessBinding.copiesPerSlot)
+    {
+        throw std::runtime_error("Bindless binding " + std::to_string(binding) + " has no copy " + std::to_string(copy) + "!");
+    }
+    return slot * bindlessBinding.copiesPerSlot + copy;
+}
+
+VkDescriptorSetLayout BindlessTable::getLayout() const
+{
+    return m_layout;
+}
+
+VkDescriptorSet BindlessTable::getSet() const
+{
+    return m_set;
+}
+
+void BindlessTable::claimSlot(uint32_t binding, uint16_t slot, uint16_t generation)
+{
+    if (slot >= m_slots.at(binding).size())
+    {
+        throw std::runtime_error("Bindless binding " + std::to_string(binding) + " has no slot " + std::to_string(slot) + "!");
+    }
+    Slot& claimedSlot = m_slots[binding][slot];
+    if (claimedSlot.isUsed && claimedSlot.generation != generation)
+    {
+        throw std::runtime_error("Bindless slot " + std::to_string(slot) + " is still used by another generation!");
+    }
+    claimedSlot = Slot{generation, true};
+}
+
+void BindlessTable::releaseSlot(uint32_t binding, uint16_t slot, uint16_t generation)
+{
+    Slot& releasedSlot = m_slots.at(binding).at(slot);
+    if (!releasedSlot.isUsed || releasedSlot.generation != generation)
+    {
+        throw std::runtime_error("Releasing bindless slot " + std::to_string(slot) + " with a stale handle!");
+    }
+    releasedSlot.isUsed = false;
+
+    if (m_bindings[binding].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+    {
+        for (uint32_t copy = 0; copy < m_bindings[binding].copiesPerSlot; ++copy)
+        {
+            writeImageDescriptor(binding, getDescriptorIndex(binding, slot, copy), VK_NULL_HANDLE);
+        }
+    }
+}
+
+void BindlessTable::writeImageDescriptor(uint32_t binding, uint32_t descriptorIndex, VkImageView view)
+{
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = m_sampler;
+    imageInfo.imageView = view ? view : m_fallbackImageView;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = m_set;
+    write.dstBinding = binding;
+    write.dstArrayElement = descriptorIndex;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+}
+
+void BindlessTable::writeBufferDescriptor(uint32_t binding, uint32_t descriptorIndex, VkBuffer buffer)
+{
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = m_set;
+    write.dstBinding = binding;
+    write.dstArrayElement = descriptorIndex;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+}
+
+} // namespace Vulkan
@@ -0,0 +1,100 @@
+#ifndef VULKANPROJECT_VULKANBINDLESSTABLE_H
+#define VULKANPROJECT_VULKANBINDLESSTABLE_H
+
+#include "../Handle.h"
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <vector>
+
+namespace Vulkan
+{
+
+struct BindlessBinding
+{
+    VkDescriptorType type; // VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER or VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+    uint32_t slotCount;
+    VkShaderStageFlags stages;
+    uint32_t copiesPerSlot; // Descriptors per slot, so that a slot can be rewritten while frames read its other copies
+};
+
+/**
+ * One update-after-bind descriptor set holding arrays of every sampled image and storage buffer, bound once per
+ * command buffer. Shaders index the arrays with ids passed in push constants instead of binding a set per object.
+ *
+ * Slots are the ids of the handles owning the resources, so a slot is recycled exactly when HandleStorage hands out
+ * its id again with a new generation. The table remembers the generation occupying each slot and refuses writes from
+ * any other one until the slot has been released. Slots can be written while frames using other slots are in flight,
+ * rewriting a slot needs the GPU to be done with its previous contents. Bindings with several copies per slot let the
+ * owner write a copy the frames in flight do not read instead, and shaders index them with getDescriptorIndex().
+ */
+class BindlessTable
+{
+public:
+    /**
+     * @param fallbackImageView Shader read only image written to every image slot that has no image
+     */
+    void create(VkDevice device, std::span<const BindlessBinding> bindings, VkImageView fallbackImageView);
+    void destroy();
+
+    /**
+     * Claim the slot of the handle and point a copy of it at the view, or at the fallback image with VK_NULL_HANDLE
+     */
+    template<HandleType type>
+    void writeImage(uint32_t binding, Handle<type> handle, VkImageView view, uint32_t copy = 0u)
+    {
+        claimSlot(binding, handle.getId(), handle.getGeneration());
+        writeImageDescriptor(binding, getDescriptorIndex(binding, handle.getId(), copy), view);
+    }
+
+    template<HandleType type>
+    void writeBuffer(uint32_t binding, Handle<type> handle, VkBuffer buffer)
+    {
+        claimSlot(binding, handle.getId(), handle.getGeneration());
+        writeBufferDescriptor(binding, getDescriptorIndex(binding, handle.getId(), 0u), buffer);
+    }
+
+    /**
+     * Free the slot of a destroyed handle. Every copy of image slots is pointed back at the fallback image, so that a
+     * stale id never samples a destroyed image.
+     */
+    template<HandleType type>
+    void release(uint32_t binding, Handle<type> handle)
+    {
+        releaseSlot(binding, handle.getId(), handle.getGeneration());
+    }
+
+    /**
+     * Index of a copy of a slot in the descriptor array of the binding
+     */
+    uint32_t getDescriptorIndex(uint32_t binding, uint32_t slot, uint32_t copy) const;
+
+    VkDescriptorSetLayout getLayout() const;
+    VkDescriptorSet getSet() const;
+private:
+    struct Slot
+    {
+        uint16_t generation;
+        bool isUsed;
+    };
+
+    void claimSlot(uint32_t binding, uint16_t slot, uint16_t generation);
+    void releaseSlot(uint32_t binding, uint16_t slot, uint16_t generation);
+    void writeImageDescriptor(uint32_t binding, uint32_t descriptorIndex, VkImageView view);
+    void writeBufferDescriptor(uint32_t binding, uint32_t descriptorIndex, VkBuffer buffer);
+
+    std::vector<BindlessBinding> m_bindings;
+    std::vector<std::vector<Slot>> m_slots; // Per binding
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkDescriptorSetLayout m_layout{VK_NULL_HANDLE};
+    VkDescriptorPool m_pool{VK_NULL_HANDLE};
+    VkDescriptorSet m_set{VK_NULL_HANDLE};
+    VkSampler m_sampler{VK_NULL_HANDLE};
+    VkImageView m_fallbackImageView{VK_NULL_HANDLE};
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANBINDLESSTABLE_H
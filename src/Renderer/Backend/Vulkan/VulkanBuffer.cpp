@@ -0,0 +1,165 @@
+#include "VulkanBuffer.h"
+
+#include "VulkanCommands.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Vulkan
+{
+
+uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if ((typeFilter & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+    throw std::runtime_error("Failed to find a suitable memory type!");
+}
+
+Buffer createBuffer(VkPhysicalDevice physicalDevice,
+                    VkDevice device,
+                    VkDeviceSize size,
+                    VkBufferUsageFlags usage,
+                    VkMemoryPropertyFlags memoryProperties,
+                    MemoryCategory category)
+{
+    Buffer buffer{};
+    buffer.size = size;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer.buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a buffer!");
+    }
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetBufferMemoryRequirements(device, buffer.buffer, &memoryRequirements);
+
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = memoryRequirements.size;
+    allocateInfo.memoryTypeIndex = findMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, memoryProperties);
+
+    if (vkAllocateMemory(device, &allocateInfo, nullptr, &buffer.memory) != VK_SUCCESS)
+    {
+        vkDestroyBuffer(device, buffer.buffer, nullptr);
+        throw std::runtime_error("Failed to allocate buffer memory!");
+    }
+    vkBindBufferMemory(device, buffer.buffer, buffer.memory, 0);
+    buffer.allocation = trackAllocation(physicalDevice, allocateInfo.memoryTypeIndex, allocateInfo.allocationSize, category);
+
+    if (memoryProperties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        vkMapMemory(device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped);
+    }
+    return buffer;
+}
+
+void destroyBuffer(VkDevice device, Buffer& buffer)
+{
+    if (buffer.mapped)
+    {
+        vkUnmapMemory(device, buffer.memory);
+    }
+    vkDestroyBuffer(device, buffer.buffer, nullptr);
+    vkFreeMemory(device, buffer.memory, nullptr);
+    untrackAllocation(buffer.allocation);
+    buffer = Buffer{};
+}
+
+Buffer createDeviceLocalBuffer(VkPhysicalDevice physicalDevice,
+                              VkDevice device,
+                              VkCommandPool commandPool,
+                              VkQueue queue,
+                              std::span<const std::byte> data,
+                              VkBufferUsageFlags usage,
+                              MemoryCategory category)
+{
+    Buffer buffer = createBuffer(physicalDevice, device, data.size(), usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category);
+    uploadToBuffer(physicalDevice, device, commandPool, queue, buffer, 0, data);
+    return buffer;
+}
+
+void uploadToBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue queue, const Buffer& buffer, VkDeviceSize offset, std::span<const std::byte> data)
+{
+    if (offset + data.size() > buffer.size)
+    {
+        throw std::runtime_error("Upload does not fit in the buffer!");
+    }
+
+    Buffer stagingBuffer = createBuffer(physicalDevice,
+                                        device,
+                                        data.size(),
+                                        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                        MemoryCategory::Staging);
+    std::memcpy(stagingBuffer.mapped, data.data(), data.size());
+
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
+    VkBufferCopy region{};
+    region.dstOffset = offset;
+    region.size = data.size();
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer, buffer.buffer, 1, &region);
+    endSingleTimeCommands(device, commandPool, queue, commandBuffer);
+
+    destroyBuffer(device, stagingBuffer);
+}
+
+void UniformAllocator::create(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize frameSize, uint32_t frameCount)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+    // Regions start aligned too
+    m_frameSize = (frameSize + m_alignment - 1) / m_alignment * m_alignment;
+    m_frameCount = frameCount;
+    m_buffer = createBuffer(physicalDevice,
+                            device,
+                            m_frameSize * m_frameCount,
+                            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                            MemoryCategory::FrameData);
+}
+
+void UniformAllocator::destroy(VkDevice device)
+{
+    destroyBuffer(device, m_buffer);
+}
+
+void UniformAllocator::beginFrame(uint64_t frameIndex)
+{
+    m_offset = (frameIndex % m_frameCount) * m_frameSize;
+    m_frameEnd = m_offset + m_frameSize;
+}
+
+UniformAllocation UniformAllocator::allocate(VkDeviceSize size)
+{
+    if (m_offset + size > m_frameEnd)
+    {
+        throw std::runtime_error("Uniform allocator ran out of space for the frame!");
+    }
+    const UniformAllocation allocation{static_cast<uint32_t>(m_offset), static_cast<std::byte*>(m_buffer.mapped) + m_offset};
+    m_offset = std::min((m_offset + size + m_alignment - 1) / m_alignment * m_alignment, m_frameEnd);
+    return allocation;
+}
+
+VkBuffer UniformAllocator::getBuffer() const
+{
+    return m_buffer.buffer;
+}
+
+} // namespace Vulkan
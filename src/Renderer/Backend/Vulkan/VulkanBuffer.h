@@ -0,0 +1,97 @@
+#ifndef VULKANPROJECT_VULKANBUFFER_H
+#define VULKANPROJECT_VULKANBUFFER_H
+
+#include "VulkanMemoryBudget.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+namespace Vulkan
+{
+
+struct Buffer
+{
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkDeviceSize size{0u};
+    void* mapped{nullptr}; // Persistently mapped pointer if the memory is host visible
+    TrackedAllocation allocation;
+};
+
+uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
+
+/**
+ * Create a buffer with its own memory allocation. Host visible buffers are mapped for their whole lifetime.
+ */
+Buffer createBuffer(VkPhysicalDevice physicalDevice,
+                    VkDevice device,
+                    VkDeviceSize size,
+                    VkBufferUsageFlags usage,
+                    VkMemoryPropertyFlags memoryProperties,
+                    MemoryCategory category = MemoryCategory::Other);
+void destroyBuffer(VkDevice device, Buffer& buffer);
+
+/**
+ * Create a device local buffer and fill it through a staging buffer. Waits for the upload to finish.
+ */
+Buffer createDeviceLocalBuffer(VkPhysicalDevice physicalDevice,
+                              VkDevice device,
+                              VkCommandPool commandPool,
+                              VkQueue queue,
+                              std::span<const std::byte> data,
+                              VkBufferUsageFlags usage,
+                              MemoryCategory category = MemoryCategory::Other);
+
+/**
+ * Copy data to a range of a device local buffer through a staging buffer. Waits for the upload to finish.
+ */
+void uploadToBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkCommandPool commandPool, VkQueue queue, const Buffer& buffer, VkDeviceSize offset, std::span<const std::byte> data);
+
+struct UniformAllocation
+{
+    uint32_t offset; // Dynamic offset to bind the allocation with
+    void* mapped;
+};
+
+/**
+ * Host visible uniform buffer split into one region per frame in flight. Allocations are bumped from the region of the
+ * current frame and aligned to minUniformBufferOffsetAlignment, so one VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+ * descriptor covers all of them and per draw constants only cost a dynamic offset at bind time.
+ */
+class UniformAllocator
+{
+public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize frameSize, uint32_t frameCount);
+    void destroy(VkDevice device);
+
+    /**
+     * Start allocating from the region of the frame. The GPU has to be done with the frame that last used it.
+     */
+    void beginFrame(uint64_t frameIndex);
+    UniformAllocation allocate(VkDeviceSize size);
+
+    template<typename T>
+    uint32_t write(const T& data)
+    {
+        const UniformAllocation allocation = allocate(sizeof(T));
+        std::memcpy(allocation.mapped, &data, sizeof(T));
+        return allocation.offset;
+    }
+
+    VkBuffer getBuffer() const;
+private:
+    Buffer m_buffer;
+    VkDeviceSize m_frameSize{0u};
+    uint32_t m_frameCount{0u};
+    VkDeviceSize m_alignment{1u};
+    VkDeviceSize m_frameEnd{0u};
+    VkDeviceSize m_offset{0u};
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANBUFFER_H
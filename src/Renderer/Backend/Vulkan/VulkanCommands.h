@@ -0,0 +1,68 @@
+#ifndef VULKANPROJECT_VULKANCOMMANDS_H
+#define VULKANPROJECT_VULKANCOMMANDS_H
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+
+namespace Vulkan
+{
+
+/**
+ * Entry points of dynamic rendering, from Vulkan 1.3 or VK_KHR_dynamic_rendering. Null when render pass objects are used.
+ */
+struct DynamicRenderingFunctions
+{
+    PFN_vkCmdBeginRendering beginRendering{nullptr};
+    PFN_vkCmdEndRendering endRendering{nullptr};
+};
+
+VkCommandPool createCommandPool(VkDevice device, uint32_t queueFamilyIndex, VkCommandPoolCreateFlags flags);
+VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool commandPool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+VkSemaphore createSemaphore(VkDevice device);
+VkFence createFence(VkDevice device, bool signaled);
+
+/**
+ * Allocate and begin a command buffer for a one-off operation such as an upload
+ */
+VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
+
+/**
+ * Begin a secondary command buffer that continues subpass 0 of the given render pass
+ */
+void beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer);
+
+/**
+ * Begin a secondary command buffer that continues dynamic rendering to attachments of the given formats
+ */
+void beginSecondaryCommandBuffer(VkCommandBuffer commandBuffer, std::span<const VkFormat> colorAttachmentFormats, VkFormat depthAttachmentFormat);
+
+/**
+ * End, submit and wait for a command buffer from beginSingleTimeCommands() and free it
+ */
+void endSingleTimeCommands(VkDevice device, VkCommandPool commandPool, VkQueue queue, VkCommandBuffer commandBuffer);
+
+void recordImageBarrier(VkCommandBuffer commandBuffer,
+                        VkImage image,
+                        uint32_t baseMipLevel,
+                        uint32_t levelCount,
+                        VkImageLayout oldLayout,
+                        VkImageLayout newLayout,
+                        VkPipelineStageFlags sourceStage,
+                        VkAccessFlags sourceAccess,
+                        VkPipelineStageFlags destinationStage,
+                        VkAccessFlags destinationAccess);
+
+/**
+ * Global memory barrier, for buffers written and read within the same queue
+ */
+void recordMemoryBarrier(VkCommandBuffer commandBuffer,
+                         VkPipelineStageFlags sourceStage,
+                         VkAccessFlags sourceAccess,
+                         VkPipelineStageFlags destinationStage,
+                         VkAccessFlags destinationAccess);
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANCOMMANDS_H
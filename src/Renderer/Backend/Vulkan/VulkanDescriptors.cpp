@@ -0,0 +1,155 @@
+#include "VulkanDescriptors.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace Vulkan
+{
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, std::span<const VkDescriptorSetLayoutBinding> bindings)
+{
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout descriptorSetLayout;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a descriptor set layout!");
+    }
+    return descriptorSetLayout;
+}
+
+VkDescriptorPool createDescriptorPool(VkDevice device, std::span<const VkDescriptorPoolSize> poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags)
+{
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = flags;
+    poolInfo.maxSets = maxSets;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+
+    VkDescriptorPool descriptorPool;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a descriptor pool!");
+    }
+    return descriptorPool;
+}
+
+VkDescriptorSet allocateDescriptorSet(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSetLayout descriptorSetLayout)
+{
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorPool = descriptorPool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &descriptorSetLayout;
+
+    VkDescriptorSet descriptorSet;
+    if (vkAllocateDescriptorSets(device, &allocateInfo, &descriptorSet) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate a descriptor set!");
+    }
+    return descriptorSet;
+}
+
+void writeStorageBufferDescriptors(VkDevice device, VkDescriptorSet descriptorSet, std::span<const VkBuffer> buffers)
+{
+    std::vector<VkDescriptorBufferInfo> bufferInfos(buffers.size());
+    std::vector<VkWriteDescriptorSet> writes(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i)
+    {
+        bufferInfos[i].buffer = buffers[i];
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = descriptorSet;
+        writes[i].dstBinding = static_cast<uint32_t>(i);
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
+
+void writeDynamicUniformBufferDescriptor(VkDevice device, VkDescriptorSet descriptorSet, VkBuffer buffer, VkDeviceSize range)
+{
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = range;
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+
+void DescriptorAllocator::create(VkDevice device, std::span<const VkDescriptorPoolSize> poolSizes, uint32_t setsPerPool)
+{
+    m_device = device;
+    m_poolSizes.assign(poolSizes.begin(), poolSizes.end());
+    m_setsPerPool = setsPerPool;
+    m_pools.push_back(createDescriptorPool(m_device, m_poolSizes, m_setsPerPool));
+    m_currentPool = 0u;
+}
+
+void DescriptorAllocator::destroy()
+{
+    for (VkDescriptorPool pool : m_pools)
+    {
+        vkDestroyDescriptorPool(m_device, pool, nullptr);
+    }
+    m_pools.clear();
+    m_device = VK_NULL_HANDLE;
+}
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout descriptorSetLayout)
+{
+    VkDescriptorSetAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &descriptorSetLayout;
+
+    VkDescriptorSet descriptorSet;
+    bool isNewPool = false; // A set that does not fit in an empty pool never will
+    while (true)
+    {
+        allocateInfo.descriptorPool = m_pools[m_currentPool];
+        const VkResult result = vkAllocateDescriptorSets(m_device, &allocateInfo, &descriptorSet);
+        if (result == VK_SUCCESS)
+        {
+            return descriptorSet;
+        }
+        const bool isPoolFull = result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL;
+        if (!isPoolFull || isNewPool)
+        {
+            throw std::runtime_error("Failed to allocate a descriptor set!");
+        }
+
+        // Pools stay in the chain after a reset, so a frame only creates new ones when it needs more than any before
+        ++m_currentPool;
+        isNewPool = m_currentPool == m_pools.size();
+        if (isNewPool)
+        {
+            m_pools.push_back(createDescriptorPool(m_device, m_poolSizes, m_setsPerPool));
+        }
+    }
+}
+
+void DescriptorAllocator::reset()
+{
+    for (size_t i = 0; i <= m_currentPool; ++i)
+    {
+        vkResetDescriptorPool(m_device, m_pools[i], 0);
+    }
+    m_currentPool = 0u;
+}
+
+} // namespace Vulkan
@@ -0,0 +1,53 @@
+#ifndef VULKANPROJECT_VULKANDESCRIPTORS_H
+#define VULKANPROJECT_VULKANDESCRIPTORS_H
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <vector>
+
+namespace Vulkan
+{
+
+VkDescriptorSetLayout createDescriptorSetLayout(VkDevice device, std::span<const VkDescriptorSetLayoutBinding> bindings);
+VkDescriptorPool createDescriptorPool(VkDevice device, std::span<const VkDescriptorPoolSize> poolSizes, uint32_t maxSets, VkDescriptorPoolCreateFlags flags = 0);
+VkDescriptorSet allocateDescriptorSet(VkDevice device, VkDescriptorPool descriptorPool, VkDescriptorSetLayout descriptorSetLayout);
+
+/**
+ * Point bindings [0, buffers.size()) of the set to whole buffers
+ */
+void writeStorageBufferDescriptors(VkDevice device, VkDescriptorSet descriptorSet, std::span<const VkBuffer> buffers);
+
+/**
+ * Point binding 0 of the set to the first range bytes of a buffer, the dynamic offset given at bind time moves it
+ */
+void writeDynamicUniformBufferDescriptor(VkDevice device, VkDescriptorSet descriptorSet, VkBuffer buffer, VkDeviceSize range);
+
+/**
+ * Linear allocator for the descriptor sets of one frame in flight. Sets are not freed one by one, reset() returns all
+ * of them at once when the GPU is done with the frame. A full pool is followed by a new one, so the pool sizes do not
+ * need to cover the worst frame.
+ */
+class DescriptorAllocator
+{
+public:
+    /**
+     * @param poolSizes Descriptors of each pool in the chain
+     */
+    void create(VkDevice device, std::span<const VkDescriptorPoolSize> poolSizes, uint32_t setsPerPool);
+    void destroy();
+
+    VkDescriptorSet allocate(VkDescriptorSetLayout descriptorSetLayout);
+    void reset();
+private:
+    std::vector<VkDescriptorPoolSize> m_poolSizes;
+    uint32_t m_setsPerPool{0u};
+    std::vector<VkDescriptorPool> m_pools;
+    size_t m_currentPool{0u};
+    VkDevice m_device{VK_NULL_HANDLE};
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANDESCRIPTORS_H
@@ -2,6 +2,8 @@
 
 #include "VulkanSwapchain.h"
 
+#include <algorithm>
+#include <cstring>
 #include <set>
 
 namespace
@@ -15,9 +17,43 @@ VkPhysicalDeviceFeatures getNeededPhysicalDeviceFeatures()
     VkPhysicalDeviceFeatures neededFeatures{};
     neededFeatures.textureCompressionBC = true;
     neededFeatures.multiDrawIndirect = true;
+    neededFeatures.drawIndirectFirstInstance = true;
+    // Texture streaming feedback is written with atomics from fragment shaders
+    neededFeatures.fragmentStoresAndAtomics = true;
+    // GPU profiler scopes, which secondary command buffers inherit
+    neededFeatures.pipelineStatisticsQuery = true;
+    neededFeatures.inheritedQueries = true;
     return neededFeatures;
 }
 
+VkPhysicalDeviceVulkan12Features getNeededVulkan12Features()
+{
+    VkPhysicalDeviceVulkan12Features neededFeatures{};
+    neededFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    neededFeatures.drawIndirectCount = true;
+    // Bindless descriptor table
+    neededFeatures.descriptorIndexing = true;
+    neededFeatures.runtimeDescriptorArray = true;
+    neededFeatures.descriptorBindingPartiallyBound = true;
+    neededFeatures.descriptorBindingUpdateUnusedWhilePending = true;
+    neededFeatures.descriptorBindingSampledImageUpdateAfterBind = true;
+    neededFeatures.descriptorBindingStorageBufferUpdateAfterBind = true;
+    neededFeatures.shaderSampledImageArrayNonUniformIndexing = true;
+    return neededFeatures;
+}
+
+bool isDeviceExtensionSupported(VkPhysicalDevice device, const char* extensionName)
+{
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    return std::any_of(availableExtensions.begin(), availableExtensions.end(), [extensionName](const VkExtensionProperties& extension)
+                       { return std::strcmp(extension.extensionName, extensionName) == 0; });
+}
+
 bool checkDeviceExtensionSupport(VkPhysicalDevice device)
 {
     uint32_t extensionCount;
@@ -41,12 +77,18 @@ bool isPhysicalDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
     VkPhysicalDeviceProperties deviceProperties;
     vkGetPhysicalDeviceProperties(device, &deviceProperties);
 
-    VkPhysicalDeviceFeatures deviceFeatures;
-    vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+    VkPhysicalDeviceVulkan12Features deviceVulkan12Features{};
+    deviceVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 deviceFeatures2{};
+    deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures2.pNext = &deviceVulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &deviceFeatures2);
+    const VkPhysicalDeviceFeatures& deviceFeatures = deviceFeatures2.features;
 
     const Vulkan::QueueFamilyIndices familyIndices = Vulkan::findSuitableQueueFamilies(device, surface);
 
     VkPhysicalDeviceFeatures neededFeatures = getNeededPhysicalDeviceFeatures();
+    VkPhysicalDeviceVulkan12Features neededVulkan12Features = getNeededVulkan12Features();
 
     const bool neededExtensionsAreSupported = checkDeviceExtensionSupport(device);
 
@@ -62,7 +104,7 @@ bool isPhysicalDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
     deviceIsSuitable &= neededExtensionsAreSupported;
     deviceIsSuitable &= swapChainAdequate;
 
-    // These need to match getNeededPhysicalDeviceFeatures()
+    // These need to match getNeededPhysicalDeviceFeatures() and getNeededVulkan12Features()
     if (neededFeatures.textureCompressionBC && !deviceFeatures.textureCompressionBC)
     {
         deviceIsSuitable = false;
@@ -71,6 +113,54 @@ bool isPhysicalDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
     {
         deviceIsSuitable = false;
     }
+    if (neededFeatures.drawIndirectFirstInstance && !deviceFeatures.drawIndirectFirstInstance)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededFeatures.fragmentStoresAndAtomics && !deviceFeatures.fragmentStoresAndAtomics)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededFeatures.pipelineStatisticsQuery && !deviceFeatures.pipelineStatisticsQuery)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededFeatures.inheritedQueries && !deviceFeatures.inheritedQueries)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.drawIndirectCount && !deviceVulkan12Features.drawIndirectCount)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.descriptorIndexing && !deviceVulkan12Features.descriptorIndexing)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.runtimeDescriptorArray && !deviceVulkan12Features.runtimeDescriptorArray)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.descriptorBindingPartiallyBound && !deviceVulkan12Features.descriptorBindingPartiallyBound)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.descriptorBindingUpdateUnusedWhilePending && !deviceVulkan12Features.descriptorBindingUpdateUnusedWhilePending)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.descriptorBindingSampledImageUpdateAfterBind && !deviceVulkan12Features.descriptorBindingSampledImageUpdateAfterBind)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.descriptorBindingStorageBufferUpdateAfterBind && !deviceVulkan12Features.descriptorBindingStorageBufferUpdateAfterBind)
+    {
+        deviceIsSuitable = false;
+    }
+    if (neededVulkan12Features.shaderSampledImageArrayNonUniformIndexing && !deviceVulkan12Features.shaderSampledImageArrayNonUniformIndexing)
+    {
+        deviceIsSuitable = false;
+    }
 
     return deviceIsSuitable;
 };
@@ -144,7 +234,51 @@ QueueFamilyIndices findSuitableQueueFamilies(VkPhysicalDevice device, VkSurfaceK
     return indices;
 }
 
-VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice, const QueueFamilyIndices& suitableQueueFamilyIndices, const std::vector<const char*>& validationLayers)
+DynamicRenderingSupport getDynamicRenderingSupport(VkPhysicalDevice device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    if (properties.apiVersion >= VK_API_VERSION_1_3)
+    {
+        VkPhysicalDeviceVulkan13Features vulkan13Features{};
+        vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &vulkan13Features;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (vulkan13Features.dynamicRendering)
+        {
+            return DynamicRenderingSupport::Core;
+        }
+    }
+
+    if (isDeviceExtensionSupported(device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+    {
+        VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{};
+        dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &dynamicRenderingFeatures;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (dynamicRenderingFeatures.dynamicRendering)
+        {
+            return DynamicRenderingSupport::Extension;
+        }
+    }
+    return DynamicRenderingSupport::None;
+}
+
+bool isMemoryBudgetSupported(VkPhysicalDevice device)
+{
+    return isDeviceExtensionSupported(device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+}
+
+VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice,
+                             const QueueFamilyIndices& suitableQueueFamilyIndices,
+                             const std::vector<const char*>& validationLayers,
+                             DynamicRenderingSupport dynamicRendering,
+                             bool enableMemoryBudget)
 {
     const float queuePriority = 1.0f;
 
@@ -162,15 +296,43 @@ VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice, const QueueFamily
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
-    VkPhysicalDeviceFeatures deviceFeatures = getNeededPhysicalDeviceFeatures();
+    std::vector<const char*> enabledExtensions = deviceExtensions;
+
+    // Dynamic rendering is enabled through the 1.3 features or the extension's own feature struct
+    VkPhysicalDeviceVulkan13Features vulkan13Features{};
+    vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+    vulkan13Features.dynamicRendering = true;
+    VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+    dynamicRenderingFeatures.dynamicRendering = true;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = getNeededVulkan12Features();
+    if (dynamicRendering == DynamicRenderingSupport::Core)
+    {
+        vulkan12Features.pNext = &vulkan13Features;
+    }
+    else if (dynamicRendering == DynamicRenderingSupport::Extension)
+    {
+        vulkan12Features.pNext = &dynamicRenderingFeatures;
+        enabledExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+    if (enableMemoryBudget)
+    {
+        enabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    VkPhysicalDeviceFeatures2 deviceFeatures{};
+    deviceFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    deviceFeatures.pNext = &vulkan12Features;
+    deviceFeatures.features = getNeededPhysicalDeviceFeatures();
 
+    // Features are chained through pNext, so pEnabledFeatures stays null
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &deviceFeatures;
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.queueCreateInfoCount = queueCreateInfos.size();
-    createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     // In Vulkan it's no longer needed to set validation layers also for logical device,
     // but done here to support older Vulkan implementations
@@ -186,5 +348,22 @@ VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice, const QueueFamily
     return device;
 }
 
+DynamicRenderingFunctions loadDynamicRenderingFunctions(VkDevice device, DynamicRenderingSupport dynamicRendering)
+{
+    DynamicRenderingFunctions functions{};
+    if (dynamicRendering == DynamicRenderingSupport::None)
+    {
+        return functions;
+    }
+
+    const bool isCore = dynamicRendering == DynamicRenderingSupport::Core;
+    functions.beginRendering = reinterpret_cast<PFN_vkCmdBeginRendering>(vkGetDeviceProcAddr(device, isCore ? "vkCmdBeginRendering" : "vkCmdBeginRenderingKHR"));
+    functions.endRendering = reinterpret_cast<PFN_vkCmdEndRendering>(vkGetDeviceProcAddr(device, isCore ? "vkCmdEndRendering" : "vkCmdEndRenderingKHR"));
+    if (!functions.beginRendering || !functions.endRendering)
+    {
+        throw std::runtime_error("Failed to load the dynamic rendering functions!");
+    }
+    return functions;
+}
 
 } // namespace Vulkan
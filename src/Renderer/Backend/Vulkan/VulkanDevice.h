@@ -1,6 +1,8 @@
 #ifndef VULKANPROJECT_VULKANDEVICE_H
 #define VULKANPROJECT_VULKANDEVICE_H
 
+#include "VulkanCommands.h"
+
 #include <vulkan/vulkan.h>
 
 #include <optional>
@@ -15,9 +17,28 @@ struct QueueFamilyIndices
     std::optional<uint32_t> presentFamily;
 };
 
+enum class DynamicRenderingSupport
+{
+    None, // Render pass and framebuffer objects are used instead
+    Extension, // VK_KHR_dynamic_rendering
+    Core, // Vulkan 1.3
+};
+
 VkPhysicalDevice selectPhysicalDevice(VkInstance instance, VkSurfaceKHR surface);
 QueueFamilyIndices findSuitableQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
-VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice, const QueueFamilyIndices& suitableQueueFamilyIndices, const std::vector<const char*>& validationLayers);
+DynamicRenderingSupport getDynamicRenderingSupport(VkPhysicalDevice device);
+bool isMemoryBudgetSupported(VkPhysicalDevice device);
+
+/**
+ * @param dynamicRendering Support from getDynamicRenderingSupport(), enables the matching feature or extension
+ * @param enableMemoryBudget Enables VK_EXT_memory_budget, has to be supported
+ */
+VkDevice createLogicalDevice(VkPhysicalDevice& physicalDevice,
+                             const QueueFamilyIndices& suitableQueueFamilyIndices,
+                             const std::vector<const char*>& validationLayers,
+                             DynamicRenderingSupport dynamicRendering,
+                             bool enableMemoryBudget);
+DynamicRenderingFunctions loadDynamicRenderingFunctions(VkDevice device, DynamicRenderingSupport dynamicRendering);
 
 } // namespace Vulkan
 
@@ -1,5 +1,10 @@
 #include "VulkanImage.h"
 
+#include "VulkanBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
 
 namespace Vulkan
 {
@@ -34,4 +39,144 @@ std::vector<VkImageView> createImageViewsForImages(VkDevice logicalDevice, const
     return swapChainImageViews;
 }
 
+Image createImage(VkPhysicalDevice physicalDevice,
+                  VkDevice device,
+                  VkExtent2D extent,
+                  uint32_t mipLevels,
+                  VkFormat format,
+                  VkImageUsageFlags usage,
+                  VkImageAspectFlags viewAspect,
+                  MemoryCategory category)
+{
+    Image image{};
+    image.extent = extent;
+    image.mipLevels = mipLevels;
+    image.format = format;
+
+    image.image = createImageWithoutMemory(device, extent, mipLevels, format, usage);
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(device, image.image, &memoryRequirements);
+
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = memoryRequirements.size;
+    allocateInfo.memoryTypeIndex = findMemoryType(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    if (vkAllocateMemory(device, &allocateInfo, nullptr, &image.memory) != VK_SUCCESS)
+    {
+        vkDestroyImage(device, image.image, nullptr);
+        throw std::runtime_error("Failed to allocate image memory!");
+    }
+    vkBindImageMemory(device, image.image, image.memory, 0);
+    image.allocation = trackAllocation(physicalDevice, allocateInfo.memoryTypeIndex, allocateInfo.allocationSize, category);
+
+    image.view = createImageView(device, image.image, format, mipLevels, viewAspect);
+    return image;
+}
+
+VkImage createImageWithoutMemory(VkDevice device, VkExtent2D extent, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage)
+{
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = {extent.width, extent.height, 1u};
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = format;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = usage;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkImage image;
+    if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create an image!");
+    }
+    return image;
+}
+
+VkImageView createImageView(VkDevice device, VkImage image, VkFormat format, uint32_t mipLevels, VkImageAspectFlags aspect)
+{
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = format;
+    viewInfo.subresourceRange.aspectMask = aspect;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = mipLevels;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    VkImageView view;
+    if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create an image view!");
+    }
+    return view;
+}
+
+bool isDepthFormat(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_D16_UNORM:
+    case VK_FORMAT_X8_D24_UNORM_PACK32:
+    case VK_FORMAT_D32_SFLOAT:
+    case VK_FORMAT_D16_UNORM_S8_UINT:
+    case VK_FORMAT_D24_UNORM_S8_UINT:
+    case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void destroyImage(VkDevice device, Image& image)
+{
+    vkDestroyImageView(device, image.view, nullptr);
+    vkDestroyImage(device, image.image, nullptr);
+    vkFreeMemory(device, image.memory, nullptr);
+    untrackAllocation(image.allocation);
+    image = Image{};
+}
+
+VkDeviceSize getImageMipSize(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevel)
+{
+    const VkDeviceSize mipWidth = std::max(width >> mipLevel, 1u);
+    const VkDeviceSize mipHeight = std::max(height >> mipLevel, 1u);
+    const VkDeviceSize blocksX = (mipWidth + 3) / 4;
+    const VkDeviceSize blocksY = (mipHeight + 3) / 4;
+
+    switch (format)
+    {
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        return blocksX * blocksY * 8;
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+        return blocksX * blocksY * 16;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return mipWidth * mipHeight * 4;
+    case VK_FORMAT_R16G16B16A16_SFLOAT:
+        return mipWidth * mipHeight * 8;
+    case VK_FORMAT_R32G32B32A32_SFLOAT:
+        return mipWidth * mipHeight * 16;
+    default:
+        throw std::runtime_error("Unsupported image format!");
+    }
+}
+
 } // namespace Vulkan
@@ -1,6 +1,8 @@
 #ifndef VULKANPROJECT_VULKANIMAGE_H
 #define VULKANPROJECT_VULKANIMAGE_H
 
+#include "VulkanMemoryBudget.h"
+
 #include <vulkan/vulkan.hpp>
 
 #include <vector>
@@ -8,8 +10,45 @@
 namespace Vulkan
 {
 
+struct Image
+{
+    VkImage image{VK_NULL_HANDLE};
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkImageView view{VK_NULL_HANDLE};
+    VkExtent2D extent{0u, 0u};
+    uint32_t mipLevels{0u};
+    VkFormat format{VK_FORMAT_UNDEFINED};
+    TrackedAllocation allocation;
+};
+
 std::vector<VkImageView> createImageViewsForImages(VkDevice logicalDevice, const std::vector<VkImage>& images, VkFormat format);
 
+/**
+ * Create a device local 2D image with its own memory allocation and a view covering all mip levels
+ */
+Image createImage(VkPhysicalDevice physicalDevice,
+                  VkDevice device,
+                  VkExtent2D extent,
+                  uint32_t mipLevels,
+                  VkFormat format,
+                  VkImageUsageFlags usage,
+                  VkImageAspectFlags viewAspect = VK_IMAGE_ASPECT_COLOR_BIT,
+                  MemoryCategory category = MemoryCategory::Textures);
+void destroyImage(VkDevice device, Image& image);
+
+/**
+ * Create a 2D image without memory, for callers that place several images in one allocation
+ */
+VkImage createImageWithoutMemory(VkDevice device, VkExtent2D extent, uint32_t mipLevels, VkFormat format, VkImageUsageFlags usage);
+VkImageView createImageView(VkDevice device, VkImage image, VkFormat format, uint32_t mipLevels, VkImageAspectFlags aspect);
+
+bool isDepthFormat(VkFormat format);
+
+/**
+ * Size in bytes of one mip level of a tightly packed image, handles block compressed formats
+ */
+VkDeviceSize getImageMipSize(VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevel);
+
 }
 
 
@@ -0,0 +1,123 @@
+#include "VulkanMemoryBudget.h"
+
+#include "../../../Utilities/Trace.h"
+
+#include <atomic>
+
+namespace
+{
+
+// Share of a heap the estimate budgets for this process when the driver does not report budgets
+constexpr VkDeviceSize estimatedBudgetPercent = 80u;
+
+constexpr std::array<const char*, Vulkan::memoryCategoryCount> categoryNames = {"Geometry", "Textures", "Render targets", "Frame data", "Staging", "Other"};
+
+// Trace counter names have to outlive the capture
+constexpr std::array<const char*, Vulkan::memoryCategoryCount> categoryCounterNames = {"GPU memory MB: Geometry",
+                                                                                       "GPU memory MB: Textures",
+                                                                                       "GPU memory MB: Render targets",
+                                                                                       "GPU memory MB: Frame data",
+                                                                                       "GPU memory MB: Staging",
+                                                                                       "GPU memory MB: Other"};
+
+std::array<std::atomic<VkDeviceSize>, VK_MAX_MEMORY_HEAPS> trackedHeapUsage{};
+std::array<std::atomic<VkDeviceSize>, Vulkan::memoryCategoryCount> trackedCategoryUsage{};
+
+}
+
+namespace Vulkan
+{
+
+const char* getMemoryCategoryName(MemoryCategory category)
+{
+    return categoryNames[static_cast<uint32_t>(category)];
+}
+
+TrackedAllocation trackAllocation(VkPhysicalDevice physicalDevice, uint32_t memoryTypeIndex, VkDeviceSize size, MemoryCategory category)
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    const TrackedAllocation allocation{size, memoryProperties.memoryTypes[memoryTypeIndex].heapIndex, category};
+    trackedHeapUsage[allocation.heapIndex].fetch_add(size, std::memory_order_relaxed);
+    trackedCategoryUsage[static_cast<uint32_t>(category)].fetch_add(size, std::memory_order_relaxed);
+    return allocation;
+}
+
+void untrackAllocation(TrackedAllocation& allocation)
+{
+    trackedHeapUsage[allocation.heapIndex].fetch_sub(allocation.size, std::memory_order_relaxed);
+    trackedCategoryUsage[static_cast<uint32_t>(allocation.category)].fetch_sub(allocation.size, std::memory_order_relaxed);
+    allocation.size = 0u;
+}
+
+void MemoryBudget::create(VkPhysicalDevice physicalDevice, bool isExtensionEnabled)
+{
+    m_physicalDevice = physicalDevice;
+    m_isExtensionEnabled = isExtensionEnabled;
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    // Images use the first device local memory type, see findMemoryType()
+    m_report.primaryHeapIndex = 0u;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+        {
+            m_report.primaryHeapIndex = memoryProperties.memoryTypes[i].heapIndex;
+            break;
+        }
+    }
+    update();
+}
+
+void MemoryBudget::update()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memoryProperties{};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = m_isExtensionEnabled ? &budgetProperties : nullptr;
+    vkGetPhysicalDeviceMemoryProperties2(m_physicalDevice, &memoryProperties);
+
+    const VkPhysicalDeviceMemoryProperties& properties = memoryProperties.memoryProperties;
+    m_report.heaps.resize(properties.memoryHeapCount);
+    m_report.isEstimated = !m_isExtensionEnabled;
+    for (uint32_t i = 0; i < properties.memoryHeapCount; ++i)
+    {
+        MemoryHeapBudget& heap = m_report.heaps[i];
+        heap.size = properties.memoryHeaps[i].size;
+        heap.trackedUsage = trackedHeapUsage[i].load(std::memory_order_relaxed);
+        heap.isDeviceLocal = (properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        if (m_isExtensionEnabled)
+        {
+            heap.budget = budgetProperties.heapBudget[i];
+            heap.usage = budgetProperties.heapUsage[i];
+        }
+        else
+        {
+            heap.budget = heap.size / 100u * estimatedBudgetPercent;
+            heap.usage = heap.trackedUsage;
+        }
+    }
+
+    for (uint32_t i = 0; i < memoryCategoryCount; ++i)
+    {
+        m_report.categoryUsage[i] = trackedCategoryUsage[i].load(std::memory_order_relaxed);
+        TRACE_COUNTER(categoryCounterNames[i], m_report.categoryUsage[i] / (1024u * 1024u));
+    }
+}
+
+const MemoryReport& MemoryBudget::getReport() const
+{
+    return m_report;
+}
+
+int64_t MemoryBudget::getPrimaryHeapHeadroom() const
+{
+    const MemoryHeapBudget& heap = m_report.heaps[m_report.primaryHeapIndex];
+    return static_cast<int64_t>(heap.budget) - static_cast<int64_t>(heap.usage);
+}
+
+} // namespace Vulkan
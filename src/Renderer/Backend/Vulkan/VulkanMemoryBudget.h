@@ -0,0 +1,89 @@
+#ifndef VULKANPROJECT_VULKANMEMORYBUDGET_H
+#define VULKANPROJECT_VULKANMEMORYBUDGET_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Vulkan
+{
+
+enum class MemoryCategory : uint32_t
+{
+    Geometry, // Vertex, index, mesh and instance buffers
+    Textures,
+    RenderTargets,
+    FrameData, // Buffers duplicated per frame in flight
+    Staging,
+    Other,
+};
+
+constexpr uint32_t memoryCategoryCount = 6u;
+
+const char* getMemoryCategoryName(MemoryCategory category);
+
+/**
+ * Device memory allocation counted in the process wide usage until untrackAllocation()
+ */
+struct TrackedAllocation
+{
+    VkDeviceSize size{0u};
+    uint32_t heapIndex{0u};
+    MemoryCategory category{MemoryCategory::Other};
+};
+
+/**
+ * Count an allocation per heap and per category. The buffer and image helpers track their allocations, memory
+ * allocated directly with vkAllocateMemory has to be tracked by its owner. Thread safe.
+ */
+TrackedAllocation trackAllocation(VkPhysicalDevice physicalDevice, uint32_t memoryTypeIndex, VkDeviceSize size, MemoryCategory category);
+void untrackAllocation(TrackedAllocation& allocation);
+
+struct MemoryHeapBudget
+{
+    VkDeviceSize size;
+    VkDeviceSize budget; // How much the process can allocate from the heap before allocations fail or start paging
+    VkDeviceSize usage; // Of the whole process, including driver internal allocations when reported by the driver
+    VkDeviceSize trackedUsage; // Allocated through trackAllocation()
+    bool isDeviceLocal;
+};
+
+struct MemoryReport
+{
+    std::vector<MemoryHeapBudget> heaps;
+    std::array<VkDeviceSize, memoryCategoryCount> categoryUsage; // Indexed by MemoryCategory
+    uint32_t primaryHeapIndex; // Device local heap that images are allocated from
+    bool isEstimated; // Without VK_EXT_memory_budget budgets are a fraction of the heap sizes and usage is tracked usage
+};
+
+/**
+ * Heap budgets and usage from VK_EXT_memory_budget, or an estimate from the heap sizes and the tracked allocations
+ * when the extension is not supported. Refreshed by update(), which is cheap enough to call every frame.
+ */
+class MemoryBudget
+{
+public:
+    /**
+     * @param isExtensionEnabled Whether the device was created with VK_EXT_memory_budget
+     */
+    void create(VkPhysicalDevice physicalDevice, bool isExtensionEnabled);
+    void update();
+
+    const MemoryReport& getReport() const;
+
+    /**
+     * Bytes that can still be allocated from the primary heap, negative when it is over its budget
+     */
+    int64_t getPrimaryHeapHeadroom() const;
+private:
+    VkPhysicalDevice m_physicalDevice{VK_NULL_HANDLE};
+    bool m_isExtensionEnabled{false};
+    MemoryReport m_report{};
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANMEMORYBUDGET_H
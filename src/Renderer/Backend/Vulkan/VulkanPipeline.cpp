@@ -1,16 +1,24 @@
 #include "VulkanPipeline.h"
 
+#include <stdexcept>
+#include <vector>
+
 namespace Vulkan
 {
 
 VkPipelineLayout createPipelineLayout(VkDevice device)
+{
+    return createPipelineLayout(device, {}, {});
+}
+
+VkPipelineLayout createPipelineLayout(VkDevice device, std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> pushConstantRanges)
 {
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0; // Optional
-    pipelineLayoutInfo.pSetLayouts = nullptr; // Optional
-    pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-    pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
     VkPipelineLayout pipelineLayout;
     if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
@@ -20,31 +28,49 @@ VkPipelineLayout createPipelineLayout(VkDevice device)
 }
 
 
-VkRenderPass createRenderPass(VkDevice device, VkFormat colorAttachmentFormat)
+VkRenderPass createRenderPass(VkDevice device, std::span<const RenderPassAttachment> colorAttachments, const RenderPassAttachment* depthAttachment)
 {
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = colorAttachmentFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    std::vector<VkAttachmentDescription> attachments;
+    std::vector<VkAttachmentReference> colorAttachmentRefs;
+    for (const RenderPassAttachment& colorAttachment : colorAttachments)
+    {
+        colorAttachmentRefs.push_back(VkAttachmentReference{static_cast<uint32_t>(attachments.size()), colorAttachment.layout});
+        attachments.push_back(VkAttachmentDescription{0,
+                                                      colorAttachment.format,
+                                                      VK_SAMPLE_COUNT_1_BIT,
+                                                      colorAttachment.loadOp,
+                                                      colorAttachment.storeOp,
+                                                      VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                                      VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                                      colorAttachment.layout,
+                                                      colorAttachment.layout});
+    }
+
+    VkAttachmentReference depthAttachmentRef{};
+    if (depthAttachment)
+    {
+        depthAttachmentRef = VkAttachmentReference{static_cast<uint32_t>(attachments.size()), depthAttachment->layout};
+        attachments.push_back(VkAttachmentDescription{0,
+                                                      depthAttachment->format,
+                                                      VK_SAMPLE_COUNT_1_BIT,
+                                                      depthAttachment->loadOp,
+                                                      depthAttachment->storeOp,
+                                                      VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                                                      VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                                                      depthAttachment->layout,
+                                                      depthAttachment->layout});
+    }
 
     VkSubpassDescription subpass{};
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentRefs.size());
+    subpass.pColorAttachments = colorAttachmentRefs.data();
+    subpass.pDepthStencilAttachment = depthAttachment ? &depthAttachmentRef : nullptr;
 
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassInfo.pAttachments = attachments.data();
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
 
@@ -55,7 +81,14 @@ VkRenderPass createRenderPass(VkDevice device, VkFormat colorAttachmentFormat)
     return renderPass;
 }
 
-VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkRenderPass renderPass, VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule, VkExtent2D viewportAndScissorExtent)
+VkPipeline createVulkanGraphicsPipeline(VkDevice device,
+                                        VkPipelineLayout pipelineLayout,
+                                        const PipelineRenderTarget& renderTarget,
+                                        VkShaderModule vertexShaderModule,
+                                        VkShaderModule fragmentShaderModule,
+                                        std::span<const VkVertexInputBindingDescription> vertexBindings,
+                                        std::span<const VkVertexInputAttributeDescription> vertexAttributes,
+                                        VkExtent2D viewportAndScissorExtent)
 {
     VkPipelineShaderStageCreateInfo vertexShaderStageInfo{};
     vertexShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -73,10 +106,10 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr; // Optional
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr; // Optional
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = vertexAttributes.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -110,7 +143,7 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
     rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE; // Projections flip y, which keeps counter clockwise mesh triangles counter clockwise on screen
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0f; // Optional
     rasterizer.depthBiasClamp = 0.0f; // Optional
@@ -125,6 +158,14 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
     multisampling.alphaToCoverageEnable = VK_FALSE; // Optional
     multisampling.alphaToOneEnable = VK_FALSE; // Optional
 
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = VK_TRUE;
+    depthStencil.depthWriteEnable = VK_TRUE;
+    depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+    depthStencil.depthBoundsTestEnable = VK_FALSE;
+    depthStencil.stencilTestEnable = VK_FALSE;
+
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
     colorBlendAttachment.blendEnable = VK_FALSE;
@@ -146,8 +187,16 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
     colorBlending.blendConstants[2] = 0.0f; // Optional
     colorBlending.blendConstants[3] = 0.0f; // Optional
 
+    // Without a render pass the attachment formats are given directly
+    VkPipelineRenderingCreateInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(renderTarget.colorAttachmentFormats.size());
+    renderingInfo.pColorAttachmentFormats = renderTarget.colorAttachmentFormats.data();
+    renderingInfo.depthAttachmentFormat = renderTarget.depthAttachmentFormat;
+
     VkGraphicsPipelineCreateInfo pipelineInfo{};
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = renderTarget.renderPass ? nullptr : &renderingInfo;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
     pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -155,11 +204,11 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = nullptr; // Optional
+    pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.pColorBlendState = &colorBlending;
     pipelineInfo.pDynamicState = nullptr; // Optional
     pipelineInfo.layout = pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
+    pipelineInfo.renderPass = renderTarget.renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
     pipelineInfo.basePipelineIndex = -1; // Optional
@@ -172,4 +221,27 @@ VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipeli
     return graphicsPipeline;
 }
 
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShaderModule)
+{
+    VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
+    computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    computeShaderStageInfo.module = computeShaderModule;
+    computeShaderStageInfo.pName = "main";
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShaderStageInfo;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline computePipeline;
+    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a compute pipeline!");
+    }
+    return computePipeline;
+}
+
 }
\ No newline at end of file
@@ -3,12 +3,50 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <span>
+#include <vector>
+
 namespace Vulkan
 {
 
 VkPipelineLayout createPipelineLayout(VkDevice device);
-VkRenderPass createRenderPass(VkDevice device, VkFormat colorAttachmentFormat);
-VkPipeline createVulkanGraphicsPipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkRenderPass renderPass, VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule, VkExtent2D viewportAndScissorExtent);
+VkPipelineLayout createPipelineLayout(VkDevice device, std::span<const VkDescriptorSetLayout> setLayouts, std::span<const VkPushConstantRange> pushConstantRanges);
+
+struct RenderPassAttachment
+{
+    VkFormat format;
+    VkAttachmentLoadOp loadOp;
+    VkAttachmentStoreOp storeOp;
+    VkImageLayout layout; // Kept for the whole pass, transitions are left to barriers recorded around it
+};
+
+/**
+ * Single subpass writing the color attachments [0, colorAttachments.size()) and an optional depth attachment after them
+ */
+VkRenderPass createRenderPass(VkDevice device, std::span<const RenderPassAttachment> colorAttachments, const RenderPassAttachment* depthAttachment);
+
+/**
+ * Attachments a graphics pipeline draws to: a render pass, or with dynamic rendering only their formats
+ */
+struct PipelineRenderTarget
+{
+    VkRenderPass renderPass; // VK_NULL_HANDLE with dynamic rendering
+    std::vector<VkFormat> colorAttachmentFormats;
+    VkFormat depthAttachmentFormat;
+};
+
+/**
+ * Pipeline with depth test and write, drawing to one color attachment and a depth attachment
+ */
+VkPipeline createVulkanGraphicsPipeline(VkDevice device,
+                                        VkPipelineLayout pipelineLayout,
+                                        const PipelineRenderTarget& renderTarget,
+                                        VkShaderModule vertexShaderModule,
+                                        VkShaderModule fragmentShaderModule,
+                                        std::span<const VkVertexInputBindingDescription> vertexBindings,
+                                        std::span<const VkVertexInputAttributeDescription> vertexAttributes,
+                                        VkExtent2D viewportAndScissorExtent);
+VkPipeline createComputePipeline(VkDevice device, VkPipelineLayout pipelineLayout, VkShaderModule computeShaderModule);
 
 }
 
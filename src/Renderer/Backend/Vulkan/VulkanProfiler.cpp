@@ -0,0 +1,269 @@
+#include "VulkanProfiler.h"
+
+#include "VulkanCommands.h"
+#include "../../../Utilities/Trace.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Vulkan
+{
+
+void GpuProfiler::create(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance, uint32_t queueFamilyIndex, uint32_t frameCount, bool enableLabels)
+{
+    m_device = device;
+    m_frameCount = frameCount;
+    m_recordedScopes.resize(m_frameCount);
+    m_recordedFrameIndices.resize(m_frameCount, 0u);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_timestampPeriod = properties.limits.timestampPeriod;
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    const uint32_t timestampValidBits = queueFamilies.at(queueFamilyIndex).timestampValidBits;
+    if (timestampValidBits == 0)
+    {
+        throw std::runtime_error("Queue family does not support timestamps!");
+    }
+    m_timestampMask = timestampValidBits >= 64 ? ~0ull : (1ull << timestampValidBits) - 1ull;
+
+    VkQueryPoolCreateInfo timestampPoolInfo{};
+    timestampPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    timestampPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    timestampPoolInfo.queryCount = m_frameCount * maxScopesPerFrame * 2;
+    if (vkCreateQueryPool(m_device, &timestampPoolInfo, nullptr, &m_timestampPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the timestamp query pool!");
+    }
+
+    VkQueryPoolCreateInfo statisticsPoolInfo{};
+    statisticsPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    statisticsPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    statisticsPoolInfo.queryCount = m_frameCount * maxScopesPerFrame;
+    statisticsPoolInfo.pipelineStatistics = pipelineStatistics;
+    if (vkCreateQueryPool(m_device, &statisticsPoolInfo, nullptr, &m_statisticsPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create the pipeline statistics query pool!");
+    }
+
+    if (enableLabels)
+    {
+        m_beginLabel = reinterpret_cast<PFN_vkCmdBeginDebugUtilsLabelEXT>(vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT"));
+        m_endLabel = reinterpret_cast<PFN_vkCmdEndDebugUtilsLabelEXT>(vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT"));
+    }
+}
+
+void GpuProfiler::destroy()
+{
+    if (!m_device)
+    {
+        return;
+    }
+    vkDestroyQueryPool(m_device, m_timestampPool, nullptr);
+    vkDestroyQueryPool(m_device, m_statisticsPool, nullptr);
+    m_timestampPool = VK_NULL_HANDLE;
+    m_statisticsPool = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+}
+
+void GpuProfiler::calibrateClock(VkCommandPool commandPool, VkQueue queue)
+{
+    // Uses the first timestamp query, which beginFrame() resets before the frames use it
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(m_device, commandPool);
+    vkCmdResetQueryPool(commandBuffer, m_timestampPool, 0, 1);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, 0);
+    const uint64_t submitTime = Trace::now();
+    endSingleTimeCommands(m_device, commandPool, queue, commandBuffer);
+
+    uint64_t ticks = 0u;
+    if (vkGetQueryPoolResults(m_device, m_timestampPool, 0, 1, sizeof(ticks), &ticks, sizeof(ticks), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to read the calibration timestamp!");
+    }
+    m_calibrationTicks = ticks;
+    m_calibrationNanoseconds = submitTime;
+    m_isCalibrated = true;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint64_t frameIndex)
+{
+    if (!m_openScopes.empty())
+    {
+        throw std::runtime_error("GPU profiler scope " + m_openScopes.back().name + " was not ended!");
+    }
+
+    m_frameSlot = static_cast<uint32_t>(frameIndex % m_frameCount);
+    m_frameIndex = frameIndex;
+    collectResults(m_frameSlot, m_recordedFrameIndices[m_frameSlot]);
+    m_recordedScopes[m_frameSlot].clear();
+    m_recordedFrameIndices[m_frameSlot] = frameIndex;
+
+    vkCmdResetQueryPool(commandBuffer, m_timestampPool, m_frameSlot * maxScopesPerFrame * 2, maxScopesPerFrame * 2);
+    vkCmdResetQueryPool(commandBuffer, m_statisticsPool, m_frameSlot * maxScopesPerFrame, maxScopesPerFrame);
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const std::string& name)
+{
+    const std::string fullName = m_openScopes.empty() ? name : m_openScopes.back().name + "/" + name;
+
+    if (m_beginLabel)
+    {
+        VkDebugUtilsLabelEXT label{};
+        label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+        label.pLabelName = name.c_str();
+        m_beginLabel(commandBuffer, &label);
+    }
+
+    std::vector<RecordedScope>& scopes = m_recordedScopes[m_frameSlot];
+    if (scopes.size() == maxScopesPerFrame)
+    {
+        // Still tracked so that endScope() pairs up, but not measured
+        m_openScopes.push_back(OpenScope{fullName, noQuery});
+        return;
+    }
+
+    const auto scopeIndex = static_cast<uint32_t>(scopes.size());
+    const uint32_t firstQuery = m_frameSlot * maxScopesPerFrame;
+    uint32_t statisticsQuery = noQuery;
+    if (m_openStatisticsQuery == noQuery)
+    {
+        statisticsQuery = scopeIndex;
+        m_openStatisticsQuery = statisticsQuery;
+        vkCmdBeginQuery(commandBuffer, m_statisticsPool, firstQuery + statisticsQuery, 0);
+    }
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_timestampPool, (firstQuery + scopeIndex) * 2);
+
+    scopes.push_back(RecordedScope{fullName, statisticsQuery});
+    m_openScopes.push_back(OpenScope{fullName, scopeIndex});
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer)
+{
+    if (m_openScopes.empty())
+    {
+        throw std::runtime_error("Ending a GPU profiler scope that was not begun!");
+    }
+    const OpenScope scope = m_openScopes.back();
+    m_openScopes.pop_back();
+
+    if (scope.scopeIndex != noQuery)
+    {
+        const uint32_t firstQuery = m_frameSlot * maxScopesPerFrame;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestampPool, (firstQuery + scope.scopeIndex) * 2 + 1);
+        if (m_openStatisticsQuery == scope.scopeIndex)
+        {
+            vkCmdEndQuery(commandBuffer, m_statisticsPool, firstQuery + m_openStatisticsQuery);
+            m_openStatisticsQuery = noQuery;
+        }
+    }
+
+    if (m_endLabel)
+    {
+        m_endLabel(commandBuffer);
+    }
+}
+
+void GpuProfiler::collectResults(uint32_t frameSlot, uint64_t frameIndex)
+{
+    const std::vector<RecordedScope>& scopes = m_recordedScopes[frameSlot];
+    if (scopes.empty())
+    {
+        return;
+    }
+
+    // The frame's fence has been waited for, so the results are available. Without VK_QUERY_RESULT_WAIT_BIT a frame
+    // that is somehow not done is dropped rather than stalled on.
+    const auto scopeCount = static_cast<uint32_t>(scopes.size());
+    std::vector<uint64_t> timestamps(scopeCount * 2);
+    const VkResult timestampResult = vkGetQueryPoolResults(m_device,
+                                                           m_timestampPool,
+                                                           frameSlot * maxScopesPerFrame * 2,
+                                                           scopeCount * 2,
+                                                           timestamps.size() * sizeof(uint64_t),
+                                                           timestamps.data(),
+                                                           sizeof(uint64_t),
+                                                           VK_QUERY_RESULT_64_BIT);
+    if (timestampResult != VK_SUCCESS)
+    {
+        return;
+    }
+
+    const bool isTracing = m_isCalibrated && Trace::isCapturing();
+    for (uint32_t i = 0; i < scopeCount; ++i)
+    {
+        const RecordedScope& scope = scopes[i];
+        const uint64_t ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & m_timestampMask;
+
+        // Map nodes are stable, so the key outlives the trace capture as the trace requires of names
+        const auto historyIt = m_histories.try_emplace(scope.name).first;
+        ScopeHistory& history = historyIt->second;
+        if (isTracing)
+        {
+            const auto beginOffset = static_cast<double>((timestamps[i * 2] - m_calibrationTicks) & m_timestampMask) * m_timestampPeriod;
+            const uint64_t begin = m_calibrationNanoseconds + static_cast<uint64_t>(beginOffset);
+            const uint64_t end = begin + static_cast<uint64_t>(static_cast<double>(ticks) * m_timestampPeriod);
+            Trace::recordGpuZone(historyIt->first.c_str(), begin, end);
+        }
+        history.milliseconds[history.nextSample] = static_cast<double>(ticks) * m_timestampPeriod * 1e-6;
+        history.nextSample = (history.nextSample + 1) % windowSize;
+        history.sampleCount = std::min(history.sampleCount + 1, windowSize);
+        history.lastFrame = frameIndex;
+
+        if (scope.statisticsQuery != noQuery)
+        {
+            // Results are written in the order of the bits of pipelineStatistics
+            std::array<uint64_t, statisticCount> statistics{};
+            const VkResult statisticsResult = vkGetQueryPoolResults(m_device,
+                                                                    m_statisticsPool,
+                                                                    frameSlot * maxScopesPerFrame + scope.statisticsQuery,
+                                                                    1,
+                                                                    sizeof(statistics),
+                                                                    statistics.data(),
+                                                                    sizeof(statistics),
+                                                                    VK_QUERY_RESULT_64_BIT);
+            if (statisticsResult == VK_SUCCESS)
+            {
+                history.statistics = statistics;
+            }
+        }
+    }
+}
+
+std::vector<GpuScopeStatistics> GpuProfiler::getStatistics() const
+{
+    std::vector<GpuScopeStatistics> statistics;
+    for (const auto& [name, history] : m_histories)
+    {
+        // Scopes that stopped being recorded age out with the window
+        if (history.sampleCount == 0 || history.lastFrame + windowSize < m_frameIndex)
+        {
+            continue;
+        }
+
+        GpuScopeStatistics scope{};
+        scope.name = name;
+        scope.sampleCount = history.sampleCount;
+        scope.minMilliseconds = history.milliseconds[0];
+        scope.maxMilliseconds = history.milliseconds[0];
+        double sum = 0.0;
+        for (uint32_t i = 0; i < history.sampleCount; ++i)
+        {
+            scope.minMilliseconds = std::min(scope.minMilliseconds, history.milliseconds[i]);
+            scope.maxMilliseconds = std::max(scope.maxMilliseconds, history.milliseconds[i]);
+            sum += history.milliseconds[i];
+        }
+        scope.averageMilliseconds = sum / history.sampleCount;
+        scope.inputAssemblyPrimitives = history.statistics[0];
+        scope.vertexShaderInvocations = history.statistics[1];
+        scope.fragmentShaderInvocations = history.statistics[2];
+        scope.computeShaderInvocations = history.statistics[3];
+        statistics.push_back(scope);
+    }
+    return statistics;
+}
+
+} // namespace Vulkan
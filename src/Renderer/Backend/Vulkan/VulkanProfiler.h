@@ -0,0 +1,130 @@
+#ifndef VULKANPROJECT_VULKANPROFILER_H
+#define VULKANPROJECT_VULKANPROFILER_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Vulkan
+{
+
+/**
+ * GPU time of one scope over the profiler's sliding window, and the pipeline statistics of its latest frame
+ */
+struct GpuScopeStatistics
+{
+    std::string name; // Nested scopes are "Parent/Child"
+    double minMilliseconds;
+    double averageMilliseconds;
+    double maxMilliseconds;
+    uint32_t sampleCount;
+
+    // Only collected for outermost scopes, zero for nested ones
+    uint64_t inputAssemblyPrimitives;
+    uint64_t vertexShaderInvocations;
+    uint64_t fragmentShaderInvocations;
+    uint64_t computeShaderInvocations;
+};
+
+/**
+ * Named GPU scopes measured with timestamp and pipeline statistics queries. Every frame in flight has its own range of
+ * queries, which is read back when the frame comes around again, so results are never waited for.
+ *
+ * Vulkan allows only one active pipeline statistics query at a time, so nested scopes get timestamps only. Scopes are
+ * also emitted as VK_EXT_debug_utils labels when labels are enabled, so captures show the same structure.
+ */
+class GpuProfiler
+{
+public:
+    /**
+     * Statistics queried by outermost scopes. Secondary command buffers executed inside a scope have to inherit them.
+     */
+    static constexpr VkQueryPipelineStatisticFlags pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+                                                                        | VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+                                                                        | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+                                                                        | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    /**
+     * @param instance Used to load the debug label functions when enableLabels is set, which needs VK_EXT_debug_utils
+     * @param queueFamilyIndex Family of the queue the profiled command buffers are submitted to
+     */
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, VkInstance instance, uint32_t queueFamilyIndex, uint32_t frameCount, bool enableLabels);
+    void destroy();
+
+    /**
+     * Match the GPU clock to Trace::now() by waiting for a timestamp written at submission, so that captured traces
+     * show the scopes on a GPU track. Accurate to within the submission latency.
+     */
+    void calibrateClock(VkCommandPool commandPool, VkQueue queue);
+
+    /**
+     * Collect the results of the frame that last used this frame's queries and reset them. Has to be recorded outside
+     * of render passes after the frame's fence has been waited for.
+     */
+    void beginFrame(VkCommandBuffer commandBuffer, uint64_t frameIndex);
+    void beginScope(VkCommandBuffer commandBuffer, const std::string& name);
+    void endScope(VkCommandBuffer commandBuffer);
+
+    /**
+     * Scopes seen within the window, sorted by name
+     */
+    std::vector<GpuScopeStatistics> getStatistics() const;
+private:
+    static constexpr uint32_t maxScopesPerFrame = 64u;
+    static constexpr uint32_t windowSize = 120u; // Frames
+    static constexpr uint32_t statisticCount = 4u;
+    static constexpr uint32_t noQuery = ~0u;
+
+    struct RecordedScope
+    {
+        std::string name;
+        uint32_t statisticsQuery; // noQuery for nested scopes
+    };
+
+    struct OpenScope
+    {
+        std::string name;
+        uint32_t scopeIndex; // noQuery when the frame ran out of queries
+    };
+
+    struct ScopeHistory
+    {
+        std::array<double, windowSize> milliseconds;
+        uint32_t sampleCount;
+        uint32_t nextSample;
+        uint64_t lastFrame; // Frame index of the latest sample
+        std::array<uint64_t, statisticCount> statistics;
+    };
+
+    void collectResults(uint32_t frameSlot, uint64_t frameIndex);
+
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkQueryPool m_timestampPool{VK_NULL_HANDLE}; // Begin and end timestamp of every scope
+    VkQueryPool m_statisticsPool{VK_NULL_HANDLE};
+    double m_timestampPeriod{1.0}; // Nanoseconds per tick
+    uint64_t m_timestampMask{~0ull};
+    bool m_isCalibrated{false};
+    uint64_t m_calibrationTicks{0u};
+    uint64_t m_calibrationNanoseconds{0u}; // Trace::now() at m_calibrationTicks
+    uint32_t m_frameCount{0u};
+    PFN_vkCmdBeginDebugUtilsLabelEXT m_beginLabel{nullptr};
+    PFN_vkCmdEndDebugUtilsLabelEXT m_endLabel{nullptr};
+
+    // Recording state of the current frame
+    uint32_t m_frameSlot{0u};
+    uint64_t m_frameIndex{0u};
+    std::vector<OpenScope> m_openScopes;
+    uint32_t m_openStatisticsQuery{noQuery};
+
+    std::vector<std::vector<RecordedScope>> m_recordedScopes; // Per frame slot
+    std::vector<uint64_t> m_recordedFrameIndices; // Per frame slot
+    std::map<std::string, ScopeHistory> m_histories;
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANPROFILER_H
@@ -0,0 +1,803 @@
+#include "VulkanRenderGraph.h"
+
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanPipeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+
+constexpr uint32_t unusedPass = ~0u;
+
+struct AccessInfo
+{
+    VkPipelineStageFlags stages;
+    VkAccessFlags readAccess;
+    VkAccessFlags writeAccess;
+    VkImageLayout layout; // VK_IMAGE_LAYOUT_UNDEFINED for buffer only accesses
+    VkImageUsageFlags imageUsage;
+};
+
+AccessInfo getAccessInfo(Vulkan::ResourceAccess access)
+{
+    using Vulkan::ResourceAccess;
+    switch (access)
+    {
+    case ResourceAccess::TransferRead:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, 0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+    case ResourceAccess::TransferWrite:
+        return {VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+    case ResourceAccess::ComputeRead:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT};
+    case ResourceAccess::ComputeWrite:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT};
+    case ResourceAccess::ComputeReadWrite:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT};
+    case ResourceAccess::ComputeSampled:
+        return {VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT};
+    case ResourceAccess::IndirectRead:
+        return {VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, 0};
+    case ResourceAccess::VertexShaderRead:
+        return {VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, 0};
+    case ResourceAccess::FragmentSampled:
+        return {VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT};
+    case ResourceAccess::ColorAttachment:
+        return {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+    case ResourceAccess::DepthAttachment:
+        return {VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+    }
+    throw std::runtime_error("Unknown resource access!");
+}
+
+bool isClearedAttachment(const Vulkan::RenderGraphPassDescription& pass, uint32_t resource)
+{
+    for (const Vulkan::RenderGraphAttachment& attachment : pass.colorAttachments)
+    {
+        if (attachment.image.index == resource && attachment.clearValue)
+        {
+            return true;
+        }
+    }
+    return pass.depthAttachment && pass.depthAttachment->image.index == resource && pass.depthAttachment->clearValue;
+}
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+namespace Vulkan
+{
+
+void RenderGraphPassContext::beginRenderPass(VkSubpassContents contents) const
+{
+    if (dynamicRendering)
+    {
+        VkRenderingInfo renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+        if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+        {
+            renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+        }
+        renderingInfo.renderArea.extent = extent;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+        renderingInfo.pColorAttachments = colorAttachments.data();
+        renderingInfo.pDepthAttachment = depthAttachment;
+        dynamicRendering->beginRendering(commandBuffer, &renderingInfo);
+        return;
+    }
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.extent = extent;
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+void RenderGraphPassContext::endRenderPass() const
+{
+    if (dynamicRendering)
+    {
+        dynamicRendering->endRendering(commandBuffer);
+        return;
+    }
+    vkCmdEndRenderPass(commandBuffer);
+}
+
+void RenderGraphPassContext::beginSecondaryCommandBuffer(VkCommandBuffer secondaryCommandBuffer) const
+{
+    if (dynamicRendering)
+    {
+        Vulkan::beginSecondaryCommandBuffer(secondaryCommandBuffer, colorAttachmentFormats, depthAttachmentFormat);
+    }
+    else
+    {
+        Vulkan::beginSecondaryCommandBuffer(secondaryCommandBuffer, renderPass, framebuffer);
+    }
+}
+
+RenderGraphResource RenderGraph::createImage(const std::string& name, VkExtent2D extent, VkFormat format)
+{
+    Resource resource{};
+    resource.name = name;
+    resource.isImage = true;
+    resource.extent = extent;
+    resource.format = format;
+    resource.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    resource.finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    m_resources.push_back(resource);
+    return RenderGraphResource{static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::importImage(const std::string& name, VkExtent2D extent, VkFormat format, VkImageLayout initialLayout, VkImageLayout finalLayout)
+{
+    Resource resource{};
+    resource.name = name;
+    resource.isImage = true;
+    resource.isImported = true;
+    resource.extent = extent;
+    resource.format = format;
+    resource.initialLayout = initialLayout;
+    resource.finalLayout = finalLayout;
+    m_resources.push_back(resource);
+    return RenderGraphResource{static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+RenderGraphResource RenderGraph::importBuffer(const std::string& name)
+{
+    Resource resource{};
+    resource.name = name;
+    resource.isImported = true;
+    m_resources.push_back(resource);
+    return RenderGraphResource{static_cast<uint32_t>(m_resources.size() - 1)};
+}
+
+uint32_t RenderGraph::addPass(RenderGraphPassDescription pass)
+{
+    if (m_device)
+    {
+        throw std::runtime_error("Passes can not be added to a compiled render graph!");
+    }
+
+    for (const RenderGraphAttachment& attachment : pass.colorAttachments)
+    {
+        pass.uses.push_back(RenderGraphResourceUse{attachment.image, ResourceAccess::ColorAttachment});
+    }
+    if (pass.depthAttachment)
+    {
+        pass.uses.push_back(RenderGraphResourceUse{pass.depthAttachment->image, ResourceAccess::DepthAttachment});
+    }
+
+    for (const RenderGraphResourceUse& use : pass.uses)
+    {
+        if (use.resource.index >= m_resources.size())
+        {
+            throw std::runtime_error("Pass " + pass.name + " uses an unknown resource!");
+        }
+        const bool isImageAccess = getAccessInfo(use.access).layout != VK_IMAGE_LAYOUT_UNDEFINED;
+        if (m_resources[use.resource.index].isImage && !isImageAccess)
+        {
+            throw std::runtime_error("Pass " + pass.name + " uses image " + m_resources[use.resource.index].name + " with a buffer only access!");
+        }
+    }
+    m_passes.push_back(std::move(pass));
+    return static_cast<uint32_t>(m_passes.size() - 1);
+}
+
+void RenderGraph::compile(VkPhysicalDevice physicalDevice, VkDevice device, const DynamicRenderingFunctions& dynamicRendering)
+{
+    if (m_device)
+    {
+        throw std::runtime_error("Render graph has already been compiled!");
+    }
+    m_dynamicRendering = dynamicRendering;
+    m_physicalDevice = physicalDevice;
+    m_device = device;
+
+    std::vector<bool> isPassKept(m_passes.size(), false);
+    cullPasses(isPassKept);
+
+    m_compiledPassIndices.assign(m_passes.size(), unusedPass);
+    for (Resource& resource : m_resources)
+    {
+        resource.firstPass = unusedPass;
+        resource.lastPass = unusedPass;
+    }
+    for (uint32_t passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+    {
+        if (!isPassKept[passIndex])
+        {
+            continue;
+        }
+        const auto compiledIndex = static_cast<uint32_t>(m_compiledPasses.size());
+        m_compiledPassIndices[passIndex] = compiledIndex;
+        m_compiledPasses.push_back(CompiledPass{passIndex, {}, {}, false, {}, {}, {}, VK_NULL_HANDLE, {}, {}});
+
+        for (const RenderGraphResourceUse& use : m_passes[passIndex].uses)
+        {
+            Resource& resource = m_resources[use.resource.index];
+            if (resource.firstPass == unusedPass)
+            {
+                resource.firstPass = compiledIndex;
+            }
+            resource.lastPass = compiledIndex;
+            resource.usage |= getAccessInfo(use.access).imageUsage;
+        }
+    }
+
+    allocateTransientImages();
+    recordBarriers();
+    createRenderPasses();
+}
+
+void RenderGraph::destroy()
+{
+    for (CompiledPass& pass : m_compiledPasses)
+    {
+        for (const auto& [views, framebuffer] : pass.framebuffers)
+        {
+            vkDestroyFramebuffer(m_device, framebuffer, nullptr);
+        }
+        if (pass.renderPass)
+        {
+            vkDestroyRenderPass(m_device, pass.renderPass, nullptr);
+        }
+    }
+    for (const Resource& resource : m_resources)
+    {
+        if (resource.isImage && !resource.isImported && resource.image)
+        {
+            vkDestroyImageView(m_device, resource.view, nullptr);
+            vkDestroyImage(m_device, resource.image, nullptr);
+        }
+    }
+    if (m_transientMemory)
+    {
+        vkFreeMemory(m_device, m_transientMemory, nullptr);
+        untrackAllocation(m_transientAllocation);
+    }
+
+    m_resources.clear();
+    m_passes.clear();
+    m_compiledPasses.clear();
+    m_compiledPassIndices.clear();
+    m_finalBarriers = BarrierBatch{};
+    m_dynamicRendering = DynamicRenderingFunctions{};
+    m_physicalDevice = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+    m_transientMemory = VK_NULL_HANDLE;
+    m_transientMemorySize = 0u;
+    m_unaliasedTransientMemorySize = 0u;
+}
+
+void RenderGraph::setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view)
+{
+    Resource& importedImage = m_resources.at(resource.index);
+    if (!importedImage.isImage || !importedImage.isImported)
+    {
+        throw std::runtime_error("Resource " + importedImage.name + " is not an imported image!");
+    }
+    importedImage.image = image;
+    importedImage.view = view;
+}
+
+void RenderGraph::execute(VkCommandBuffer commandBuffer, GpuProfiler* profiler)
+{
+    for (CompiledPass& pass : m_compiledPasses)
+    {
+        recordBarrierBatch(commandBuffer, pass.barriers);
+
+        const RenderGraphPassDescription& description = m_passes[pass.passIndex];
+        if (!description.execute)
+        {
+            continue;
+        }
+        RenderGraphPassContext context{};
+        context.commandBuffer = commandBuffer;
+        context.hasAttachments = !pass.attachments.empty();
+        if (context.hasAttachments && m_dynamicRendering.beginRendering)
+        {
+            for (size_t i = 0; i < pass.attachments.size(); ++i)
+            {
+                const Resource& attachment = m_resources[pass.attachments[i]];
+                if (!attachment.view)
+                {
+                    throw std::runtime_error("Imported image " + attachment.name + " has not been set!");
+                }
+                pass.renderingAttachments[i].imageView = attachment.view;
+            }
+            const size_t colorAttachmentCount = pass.colorAttachmentFormats.size();
+            context.extent = m_resources[pass.attachments.front()].extent;
+            context.dynamicRendering = &m_dynamicRendering;
+            context.colorAttachments = std::span<const VkRenderingAttachmentInfo>(pass.renderingAttachments).first(colorAttachmentCount);
+            context.depthAttachment = pass.hasDepthAttachment ? &pass.renderingAttachments.back() : nullptr;
+            context.colorAttachmentFormats = pass.colorAttachmentFormats;
+            context.depthAttachmentFormat = pass.hasDepthAttachment ? pass.attachmentInfos.back().format : VK_FORMAT_UNDEFINED;
+        }
+        else if (context.hasAttachments)
+        {
+            context.renderPass = pass.renderPass;
+            context.framebuffer = getFramebuffer(pass);
+            context.extent = m_resources[pass.attachments.front()].extent;
+            context.clearValues = pass.clearValues;
+        }
+        // Passes begin their render pass inside execute, so the scope's queries stay outside of it
+        if (profiler)
+        {
+            profiler->beginScope(commandBuffer, description.name);
+        }
+        description.execute(context);
+        if (profiler)
+        {
+            profiler->endScope(commandBuffer);
+        }
+    }
+    recordBarrierBatch(commandBuffer, m_finalBarriers);
+}
+
+PipelineRenderTarget RenderGraph::getRenderTarget(uint32_t passIndex) const
+{
+    const uint32_t compiledIndex = m_compiledPassIndices.at(passIndex);
+    if (compiledIndex == unusedPass)
+    {
+        throw std::runtime_error("Pass " + m_passes[passIndex].name + " has been culled!");
+    }
+    const CompiledPass& pass = m_compiledPasses[compiledIndex];
+    return PipelineRenderTarget{
+        pass.renderPass,
+        pass.colorAttachmentFormats,
+        pass.hasDepthAttachment ? pass.attachmentInfos.back().format : VK_FORMAT_UNDEFINED};
+}
+
+bool RenderGraph::isPassCulled(uint32_t passIndex) const
+{
+    return m_compiledPassIndices.at(passIndex) == unusedPass;
+}
+
+VkDeviceSize RenderGraph::getTransientMemorySize() const
+{
+    return m_transientMemorySize;
+}
+
+VkDeviceSize RenderGraph::getUnaliasedTransientMemorySize() const
+{
+    return m_unaliasedTransientMemorySize;
+}
+
+void RenderGraph::cullPasses(std::vector<bool>& isPassKept) const
+{
+    // Walk backwards from the imported resources, a pass is needed if it writes something a needed pass reads
+    std::vector<bool> isResourceNeeded(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        isResourceNeeded[i] = m_resources[i].isImported;
+    }
+
+    for (size_t passIndex = m_passes.size(); passIndex-- > 0;)
+    {
+        const RenderGraphPassDescription& pass = m_passes[passIndex];
+        bool isNeeded = pass.hasSideEffects;
+        for (const RenderGraphResourceUse& use : pass.uses)
+        {
+            isNeeded = isNeeded || (getAccessInfo(use.access).writeAccess && isResourceNeeded[use.resource.index]);
+        }
+        if (!isNeeded)
+        {
+            continue;
+        }
+
+        isPassKept[passIndex] = true;
+        for (const RenderGraphResourceUse& use : pass.uses)
+        {
+            // Cleared attachments do not depend on earlier contents
+            if (getAccessInfo(use.access).readAccess && !isClearedAttachment(pass, use.resource.index))
+            {
+                isResourceNeeded[use.resource.index] = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::allocateTransientImages()
+{
+    std::vector<uint32_t> transientImages;
+    uint32_t memoryTypeBits = ~0u;
+    std::vector<VkDeviceSize> alignments(m_resources.size(), 1u);
+    for (uint32_t i = 0; i < m_resources.size(); ++i)
+    {
+        Resource& resource = m_resources[i];
+        if (!resource.isImage || resource.isImported || resource.firstPass == unusedPass)
+        {
+            continue;
+        }
+        resource.image = createImageWithoutMemory(m_device, resource.extent, 1, resource.format, resource.usage);
+
+        VkMemoryRequirements memoryRequirements;
+        vkGetImageMemoryRequirements(m_device, resource.image, &memoryRequirements);
+        resource.memorySize = memoryRequirements.size;
+        alignments[i] = memoryRequirements.alignment;
+        memoryTypeBits &= memoryRequirements.memoryTypeBits;
+        m_unaliasedTransientMemorySize += alignUp(memoryRequirements.size, memoryRequirements.alignment);
+        transientImages.push_back(i);
+    }
+    if (transientImages.empty())
+    {
+        return;
+    }
+    if (memoryTypeBits == 0u)
+    {
+        throw std::runtime_error("Transient images have no memory type in common!");
+    }
+
+    // Largest first, each at the lowest offset that no image alive at the same time occupies
+    std::sort(transientImages.begin(), transientImages.end(), [this](uint32_t a, uint32_t b)
+              { return m_resources[a].memorySize > m_resources[b].memorySize; });
+    std::vector<uint32_t> placedImages;
+    for (uint32_t i : transientImages)
+    {
+        Resource& resource = m_resources[i];
+        const auto isAliveAtSameTime = [&resource](const Resource& other)
+        { return resource.firstPass <= other.lastPass && other.firstPass <= resource.lastPass; };
+
+        std::vector<VkDeviceSize> candidateOffsets = {0u};
+        for (uint32_t placed : placedImages)
+        {
+            if (isAliveAtSameTime(m_resources[placed]))
+            {
+                candidateOffsets.push_back(alignUp(m_resources[placed].memoryOffset + m_resources[placed].memorySize, alignments[i]));
+            }
+        }
+        std::sort(candidateOffsets.begin(), candidateOffsets.end());
+
+        for (VkDeviceSize offset : candidateOffsets)
+        {
+            const bool isFree = std::none_of(placedImages.begin(), placedImages.end(), [&](uint32_t placed)
+                                             {
+                                                 const Resource& other = m_resources[placed];
+                                                 return isAliveAtSameTime(other) && offset < other.memoryOffset + other.memorySize && other.memoryOffset < offset + resource.memorySize;
+                                             });
+            if (isFree)
+            {
+                resource.memoryOffset = offset;
+                break;
+            }
+        }
+        m_transientMemorySize = std::max(m_transientMemorySize, resource.memoryOffset + resource.memorySize);
+        placedImages.push_back(i);
+    }
+
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = m_transientMemorySize;
+    allocateInfo.memoryTypeIndex = findMemoryType(m_physicalDevice, memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(m_device, &allocateInfo, nullptr, &m_transientMemory) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to allocate render graph memory!");
+    }
+    m_transientAllocation = trackAllocation(m_physicalDevice, allocateInfo.memoryTypeIndex, m_transientMemorySize, MemoryCategory::RenderTargets);
+
+    for (uint32_t i : transientImages)
+    {
+        Resource& resource = m_resources[i];
+        vkBindImageMemory(m_device, resource.image, m_transientMemory, resource.memoryOffset);
+        resource.view = createImageView(m_device, resource.image, resource.format, 1, isDepthFormat(resource.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+}
+
+void RenderGraph::recordBarriers()
+{
+    std::vector<ResourceState> states(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        states[i] = ResourceState{m_resources[i].initialLayout, 0, 0, 0, 0, 0, false};
+    }
+    std::vector<std::pair<uint32_t, size_t>> transientFirstUses; // Compiled pass and image barrier index
+
+    for (uint32_t compiledIndex = 0; compiledIndex < m_compiledPasses.size(); ++compiledIndex)
+    {
+        CompiledPass& pass = m_compiledPasses[compiledIndex];
+        BarrierBatch& barriers = pass.barriers;
+
+        // A pass may use a resource several times, it is synchronized once with all the uses combined
+        std::vector<std::pair<uint32_t, AccessInfo>> accesses;
+        for (const RenderGraphResourceUse& use : m_passes[pass.passIndex].uses)
+        {
+            const AccessInfo info = getAccessInfo(use.access);
+            auto existing = std::find_if(accesses.begin(), accesses.end(), [&use](const auto& access)
+                                         { return access.first == use.resource.index; });
+            if (existing == accesses.end())
+            {
+                accesses.emplace_back(use.resource.index, info);
+                continue;
+            }
+            if (m_resources[use.resource.index].isImage && existing->second.layout != info.layout)
+            {
+                throw std::runtime_error("Pass " + m_passes[pass.passIndex].name + " uses " + m_resources[use.resource.index].name + " in conflicting layouts!");
+            }
+            existing->second.stages |= info.stages;
+            existing->second.readAccess |= info.readAccess;
+            existing->second.writeAccess |= info.writeAccess;
+        }
+
+        const auto addBarrier = [this, &barriers](uint32_t resource, VkImageLayout oldLayout, const AccessInfo& info, VkPipelineStageFlags sourceStages, VkAccessFlags sourceAccess, VkAccessFlags destinationAccess)
+        {
+            sourceStages = sourceStages ? sourceStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            if (m_resources[resource].isImage)
+            {
+                barriers.imageBarriers.push_back(ImageBarrier{resource, oldLayout, info.layout, sourceStages, sourceAccess, info.stages, destinationAccess});
+                return;
+            }
+            barriers.memorySourceStages |= sourceStages;
+            barriers.memorySourceAccess |= sourceAccess;
+            barriers.memoryDestinationStages |= info.stages;
+            barriers.memoryDestinationAccess |= destinationAccess;
+        };
+
+        for (const auto& [resourceIndex, info] : accesses)
+        {
+            const Resource& resource = m_resources[resourceIndex];
+            ResourceState& state = states[resourceIndex];
+            const VkAccessFlags access = info.readAccess | info.writeAccess;
+            const bool needsTransition = resource.isImage && ((!state.isUsed && !resource.isImported) || state.layout != info.layout);
+
+            if (!state.isUsed)
+            {
+                // Imported resources are available at their first use, transient images wait for the previous users
+                // of their memory, which are patched in once all final states are known
+                if (needsTransition)
+                {
+                    if (!resource.isImported)
+                    {
+                        transientFirstUses.emplace_back(compiledIndex, barriers.imageBarriers.size());
+                    }
+                    barriers.imageBarriers.push_back(ImageBarrier{resourceIndex, state.layout, info.layout, info.stages, 0, info.stages, access});
+                }
+                const bool isWritten = info.writeAccess || needsTransition;
+                state = ResourceState{info.layout, isWritten ? info.stages : 0, info.writeAccess, isWritten ? 0 : info.stages, info.stages, access, true};
+                continue;
+            }
+
+            if (info.writeAccess || needsTransition)
+            {
+                // Write after write or read, or a layout transition, waits for everything since the last write
+                addBarrier(resourceIndex, state.layout, info, state.writeStages | state.readStages, state.writeAccess, access);
+                state = ResourceState{info.layout, info.stages, info.writeAccess, info.writeAccess ? 0 : info.stages, info.stages, access, true};
+                continue;
+            }
+
+            // Read after write needs a barrier only for stages and accesses the write has not been made visible to yet
+            if (state.writeStages && ((info.stages & ~state.visibleStages) || (info.readAccess & ~state.visibleAccess)))
+            {
+                addBarrier(resourceIndex, state.layout, info, state.writeStages, state.writeAccess, info.readAccess);
+                state.visibleStages |= info.stages;
+                state.visibleAccess |= info.readAccess;
+            }
+            state.readStages |= info.stages;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_resources.size(); ++i)
+    {
+        const Resource& resource = m_resources[i];
+        const ResourceState& state = states[i];
+        if (!resource.isImage || !resource.isImported || resource.finalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.finalLayout == state.layout)
+        {
+            continue;
+        }
+        const VkPipelineStageFlags sourceStages = state.writeStages | state.readStages;
+        m_finalBarriers.imageBarriers.push_back(ImageBarrier{
+            i, state.layout, resource.finalLayout, sourceStages ? sourceStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, state.writeAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0});
+    }
+
+    // The first use of a transient image waits for the last use of every image sharing its memory, earlier in this
+    // execution or in the previous one
+    for (const auto& [compiledIndex, barrierIndex] : transientFirstUses)
+    {
+        ImageBarrier& barrier = m_compiledPasses[compiledIndex].barriers.imageBarriers[barrierIndex];
+        const Resource& resource = m_resources[barrier.resource];
+        barrier.sourceStages = 0;
+        for (uint32_t i = 0; i < m_resources.size(); ++i)
+        {
+            const Resource& other = m_resources[i];
+            if (!other.isImage || other.isImported || !other.image)
+            {
+                continue;
+            }
+            if (resource.memoryOffset < other.memoryOffset + other.memorySize && other.memoryOffset < resource.memoryOffset + resource.memorySize)
+            {
+                barrier.sourceStages |= states[i].writeStages | states[i].readStages;
+                barrier.sourceAccess |= states[i].writeAccess;
+            }
+        }
+    }
+}
+
+void RenderGraph::createRenderPasses()
+{
+    for (uint32_t compiledIndex = 0; compiledIndex < m_compiledPasses.size(); ++compiledIndex)
+    {
+        CompiledPass& pass = m_compiledPasses[compiledIndex];
+        const RenderGraphPassDescription& description = m_passes[pass.passIndex];
+        if (description.colorAttachments.empty() && !description.depthAttachment)
+        {
+            continue;
+        }
+
+        const auto toRenderPassAttachment = [&](const RenderGraphAttachment& attachment, ResourceAccess access)
+        {
+            const Resource& resource = m_resources[attachment.image.index];
+            if (resource.extent.width != m_resources[pass.attachments.front()].extent.width || resource.extent.height != m_resources[pass.attachments.front()].extent.height)
+            {
+                throw std::runtime_error("Attachments of pass " + description.name + " have different sizes!");
+            }
+            // Contents are kept only if a later pass or the caller can see them
+            const bool hasEarlierContents = resource.firstPass < compiledIndex || (resource.isImported && resource.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED);
+            const bool hasLaterUse = resource.lastPass > compiledIndex || resource.isImported;
+
+            pass.clearValues.push_back(attachment.clearValue.value_or(VkClearValue{}));
+            return RenderPassAttachment{
+                resource.format,
+                attachment.clearValue ? VK_ATTACHMENT_LOAD_OP_CLEAR : hasEarlierContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                hasLaterUse ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                getAccessInfo(access).layout};
+        };
+
+        for (const RenderGraphAttachment& attachment : description.colorAttachments)
+        {
+            pass.attachments.push_back(attachment.image.index);
+        }
+        if (description.depthAttachment)
+        {
+            pass.attachments.push_back(description.depthAttachment->image.index);
+        }
+
+        for (const RenderGraphAttachment& attachment : description.colorAttachments)
+        {
+            pass.attachmentInfos.push_back(toRenderPassAttachment(attachment, ResourceAccess::ColorAttachment));
+            pass.colorAttachmentFormats.push_back(pass.attachmentInfos.back().format);
+        }
+        if (description.depthAttachment)
+        {
+            pass.attachmentInfos.push_back(toRenderPassAttachment(*description.depthAttachment, ResourceAccess::DepthAttachment));
+            pass.hasDepthAttachment = true;
+        }
+
+        // Dynamic rendering needs neither render pass nor framebuffer objects, the same load and store operations
+        // and layouts are given to vkCmdBeginRendering() every execution
+        if (m_dynamicRendering.beginRendering)
+        {
+            for (size_t i = 0; i < pass.attachmentInfos.size(); ++i)
+            {
+                VkRenderingAttachmentInfo renderingAttachment{};
+                renderingAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+                renderingAttachment.imageLayout = pass.attachmentInfos[i].layout;
+                renderingAttachment.loadOp = pass.attachmentInfos[i].loadOp;
+                renderingAttachment.storeOp = pass.attachmentInfos[i].storeOp;
+                renderingAttachment.clearValue = pass.clearValues[i];
+                pass.renderingAttachments.push_back(renderingAttachment);
+            }
+            continue;
+        }
+
+        const std::span<const RenderPassAttachment> attachmentInfos(pass.attachmentInfos);
+        pass.renderPass = createRenderPass(m_device,
+                                           attachmentInfos.first(pass.colorAttachmentFormats.size()),
+                                           pass.hasDepthAttachment ? &pass.attachmentInfos.back() : nullptr);
+    }
+}
+
+void RenderGraph::recordBarrierBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const
+{
+    VkPipelineStageFlags sourceStages = batch.memorySourceStages;
+    VkPipelineStageFlags destinationStages = batch.memoryDestinationStages;
+
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    imageBarriers.reserve(batch.imageBarriers.size());
+    for (const ImageBarrier& barrier : batch.imageBarriers)
+    {
+        const Resource& resource = m_resources[barrier.resource];
+        if (!resource.image)
+        {
+            throw std::runtime_error("Imported image " + resource.name + " has not been set!");
+        }
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrier.sourceAccess;
+        imageBarrier.dstAccessMask = barrier.destinationAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resource.image;
+        imageBarrier.subresourceRange.aspectMask = isDepthFormat(resource.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBarrier.subresourceRange.baseMipLevel = 0;
+        imageBarrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+        imageBarriers.push_back(imageBarrier);
+
+        sourceStages |= barrier.sourceStages;
+        destinationStages |= barrier.destinationStages;
+    }
+
+    const bool hasMemoryBarrier = batch.memoryDestinationStages != 0;
+    if (!hasMemoryBarrier && imageBarriers.empty())
+    {
+        return;
+    }
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = batch.memorySourceAccess;
+    memoryBarrier.dstAccessMask = batch.memoryDestinationAccess;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         sourceStages,
+                         destinationStages,
+                         0,
+                         hasMemoryBarrier ? 1 : 0,
+                         &memoryBarrier,
+                         0,
+                         nullptr,
+                         static_cast<uint32_t>(imageBarriers.size()),
+                         imageBarriers.data());
+}
+
+VkFramebuffer RenderGraph::getFramebuffer(CompiledPass& pass)
+{
+    std::vector<VkImageView> views;
+    views.reserve(pass.attachments.size());
+    for (uint32_t attachment : pass.attachments)
+    {
+        if (!m_resources[attachment].view)
+        {
+            throw std::runtime_error("Imported image " + m_resources[attachment].name + " has not been set!");
+        }
+        views.push_back(m_resources[attachment].view);
+    }
+
+    // Imported images such as swapchain images cycle through a few views, so the cache stays small
+    for (const auto& [cachedViews, framebuffer] : pass.framebuffers)
+    {
+        if (cachedViews == views)
+        {
+            return framebuffer;
+        }
+    }
+
+    const VkExtent2D extent = m_resources[pass.attachments.front()].extent;
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = pass.renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = extent.width;
+    framebufferInfo.height = extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer;
+    if (vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a framebuffer!");
+    }
+    pass.framebuffers.emplace_back(std::move(views), framebuffer);
+    return framebuffer;
+}
+
+} // namespace Vulkan
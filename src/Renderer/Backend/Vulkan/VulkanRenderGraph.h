@@ -0,0 +1,244 @@
+#ifndef VULKANPROJECT_VULKANRENDERGRAPH_H
+#define VULKANPROJECT_VULKANRENDERGRAPH_H
+
+#include "VulkanCommands.h"
+#include "VulkanMemoryBudget.h"
+#include "VulkanPipeline.h"
+#include "VulkanProfiler.h"
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Vulkan
+{
+
+/**
+ * How a pass uses a resource. Decides the pipeline stage, access mask and image layout the graph synchronizes with.
+ */
+enum class ResourceAccess
+{
+    TransferRead,
+    TransferWrite,
+    ComputeRead, // Storage buffer or image
+    ComputeWrite,
+    ComputeReadWrite,
+    ComputeSampled,
+    IndirectRead, // Buffers only
+    VertexShaderRead, // Storage buffers only
+    FragmentSampled,
+    ColorAttachment, // Added by RenderGraphPassDescription::colorAttachments
+    DepthAttachment, // Added by RenderGraphPassDescription::depthAttachment
+};
+
+struct RenderGraphResource
+{
+    uint32_t index;
+};
+
+struct RenderGraphResourceUse
+{
+    RenderGraphResource resource;
+    ResourceAccess access;
+};
+
+struct RenderGraphAttachment
+{
+    RenderGraphResource image;
+    std::optional<VkClearValue> clearValue; // Previous contents are loaded when empty
+};
+
+/**
+ * Handed to the execute function of a pass. Passes with attachments begin and end their render pass themselves, so
+ * that they can choose between inline and secondary command buffer contents.
+ */
+struct RenderGraphPassContext
+{
+    VkCommandBuffer commandBuffer;
+    bool hasAttachments;
+    VkExtent2D extent;
+
+    // Render pass objects
+    VkRenderPass renderPass;
+    VkFramebuffer framebuffer;
+    std::span<const VkClearValue> clearValues;
+
+    // Dynamic rendering, used when dynamicRendering is not null
+    const DynamicRenderingFunctions* dynamicRendering;
+    std::span<const VkRenderingAttachmentInfo> colorAttachments;
+    const VkRenderingAttachmentInfo* depthAttachment;
+    std::span<const VkFormat> colorAttachmentFormats;
+    VkFormat depthAttachmentFormat;
+
+    void beginRenderPass(VkSubpassContents contents) const;
+    void endRenderPass() const;
+
+    /**
+     * Begin a secondary command buffer that continues the render pass of this pass
+     */
+    void beginSecondaryCommandBuffer(VkCommandBuffer secondaryCommandBuffer) const;
+};
+
+struct RenderGraphPassDescription
+{
+    std::string name{};
+    std::vector<RenderGraphResourceUse> uses{};
+    std::vector<RenderGraphAttachment> colorAttachments{};
+    std::optional<RenderGraphAttachment> depthAttachment{};
+    bool hasSideEffects{false}; // Kept even if nothing reads what it writes
+    std::function<void(const RenderGraphPassContext&)> execute{};
+};
+
+/**
+ * Frame graph built once from passes that declare the resources they read and write, then executed every frame.
+ *
+ * compile() drops passes whose results never reach an imported resource, records the minimal barriers and layout
+ * transitions between the remaining passes and places the transient images whose lifetimes do not overlap in the same
+ * memory. Imported resources outlive the graph: images are rebound every frame with setImportedImage(), buffers are
+ * only tracked for synchronization and have to be made available to their first use by the caller.
+ *
+ * Passes render with dynamic rendering when its functions are given to compile(), otherwise with render pass and
+ * framebuffer objects.
+ */
+class RenderGraph
+{
+public:
+    /**
+     * Image owned by the graph. Its usage flags are collected from the passes using it.
+     */
+    RenderGraphResource createImage(const std::string& name, VkExtent2D extent, VkFormat format);
+
+    /**
+     * @param initialLayout Layout the image is in at the start of every execution, available at the stage of its first use
+     * @param finalLayout Layout the image is transitioned to at the end of every execution, VK_IMAGE_LAYOUT_UNDEFINED to keep the last one
+     */
+    RenderGraphResource importImage(const std::string& name, VkExtent2D extent, VkFormat format, VkImageLayout initialLayout, VkImageLayout finalLayout);
+    RenderGraphResource importBuffer(const std::string& name);
+
+    /**
+     * @return Index of the pass, for getRenderTarget()
+     */
+    uint32_t addPass(RenderGraphPassDescription pass);
+
+    void compile(VkPhysicalDevice physicalDevice, VkDevice device, const DynamicRenderingFunctions& dynamicRendering = {});
+    void destroy();
+
+    void setImportedImage(RenderGraphResource resource, VkImage image, VkImageView view);
+
+    /**
+     * Record the passes that were not culled with the barriers between them
+     * @param profiler Optional, measures every pass in a scope named after it. Barriers are not included.
+     */
+    void execute(VkCommandBuffer commandBuffer, GpuProfiler* profiler = nullptr);
+
+    /**
+     * Attachments of a pass, for creating pipelines that draw in it
+     */
+    PipelineRenderTarget getRenderTarget(uint32_t passIndex) const;
+    bool isPassCulled(uint32_t passIndex) const;
+
+    /**
+     * Device memory of the transient images with and without aliasing
+     */
+    VkDeviceSize getTransientMemorySize() const;
+    VkDeviceSize getUnaliasedTransientMemorySize() const;
+private:
+    struct Resource
+    {
+        std::string name;
+        bool isImage;
+        bool isImported;
+        VkExtent2D extent;
+        VkFormat format;
+        VkImageLayout initialLayout;
+        VkImageLayout finalLayout;
+        VkImageUsageFlags usage;
+
+        // Transient images, created by compile()
+        VkImage image;
+        VkImageView view;
+        VkDeviceSize memoryOffset;
+        VkDeviceSize memorySize;
+        uint32_t firstPass; // In execution order
+        uint32_t lastPass;
+    };
+
+    // Synchronization state of a resource while compiling
+    struct ResourceState
+    {
+        VkImageLayout layout;
+        VkPipelineStageFlags writeStages; // Last write, or layout transition
+        VkAccessFlags writeAccess;
+        VkPipelineStageFlags readStages; // Reads since the last write
+        VkPipelineStageFlags visibleStages; // Stages and accesses the last write has been made visible to
+        VkAccessFlags visibleAccess;
+        bool isUsed;
+    };
+
+    struct ImageBarrier
+    {
+        uint32_t resource;
+        VkImageLayout oldLayout;
+        VkImageLayout newLayout;
+        VkPipelineStageFlags sourceStages;
+        VkAccessFlags sourceAccess;
+        VkPipelineStageFlags destinationStages;
+        VkAccessFlags destinationAccess;
+    };
+
+    // Memory and image barriers recorded with one vkCmdPipelineBarrier
+    struct BarrierBatch
+    {
+        VkPipelineStageFlags memorySourceStages;
+        VkAccessFlags memorySourceAccess;
+        VkPipelineStageFlags memoryDestinationStages;
+        VkAccessFlags memoryDestinationAccess;
+        std::vector<ImageBarrier> imageBarriers;
+    };
+
+    struct CompiledPass
+    {
+        uint32_t passIndex;
+        BarrierBatch barriers;
+        std::vector<uint32_t> attachments; // Resource indices, colors then depth
+        bool hasDepthAttachment;
+        std::vector<RenderPassAttachment> attachmentInfos;
+        std::vector<VkClearValue> clearValues;
+        std::vector<VkFormat> colorAttachmentFormats;
+
+        VkRenderPass renderPass;
+        std::vector<std::pair<std::vector<VkImageView>, VkFramebuffer>> framebuffers; // Cached per set of imported views
+        std::vector<VkRenderingAttachmentInfo> renderingAttachments; // Views updated every execution
+    };
+
+    void cullPasses(std::vector<bool>& isPassKept) const;
+    void allocateTransientImages();
+    void recordBarriers();
+    void createRenderPasses();
+    void recordBarrierBatch(VkCommandBuffer commandBuffer, const BarrierBatch& batch) const;
+    VkFramebuffer getFramebuffer(CompiledPass& pass);
+
+    std::vector<Resource> m_resources;
+    std::vector<RenderGraphPassDescription> m_passes;
+    std::vector<CompiledPass> m_compiledPasses;
+    std::vector<uint32_t> m_compiledPassIndices; // Index in m_compiledPasses of every pass, ~0u if culled
+    BarrierBatch m_finalBarriers;
+
+    DynamicRenderingFunctions m_dynamicRendering;
+    VkPhysicalDevice m_physicalDevice{VK_NULL_HANDLE};
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkDeviceMemory m_transientMemory{VK_NULL_HANDLE};
+    VkDeviceSize m_transientMemorySize{0u};
+    TrackedAllocation m_transientAllocation;
+    VkDeviceSize m_unaliasedTransientMemorySize{0u};
+};
+
+} // namespace Vulkan
+
+
+#endif // VULKANPROJECT_VULKANRENDERGRAPH_H
@@ -0,0 +1,391 @@
+#include "CpuCulling.h"
+
+#include "../Utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CPU_CULLING_AVX2
+#define CPU_CULLING_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CPU_CULLING_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CPU_CULLING_NEON
+#endif
+
+namespace
+{
+
+constexpr size_t objectsPerTask = 16384; // Multiple of the widest SIMD width
+
+/**
+ * Planes split into components, with the absolute normals used by the box test
+ */
+struct FrustumPlanes
+{
+    float x[6];
+    float y[6];
+    float z[6];
+    float w[6];
+    float absX[6];
+    float absY[6];
+    float absZ[6];
+};
+
+FrustumPlanes splitPlanes(const Frustum& frustum)
+{
+    FrustumPlanes planes{};
+    for (size_t i = 0; i < frustum.planes.size(); ++i)
+    {
+        planes.x[i] = frustum.planes[i].x;
+        planes.y[i] = frustum.planes[i].y;
+        planes.z[i] = frustum.planes[i].z;
+        planes.w[i] = frustum.planes[i].w;
+        planes.absX[i] = std::abs(frustum.planes[i].x);
+        planes.absY[i] = std::abs(frustum.planes[i].y);
+        planes.absZ[i] = std::abs(frustum.planes[i].z);
+    }
+    return planes;
+}
+
+bool isSphereVisible(const FrustumPlanes& planes, const BoundingSpheres& spheres, size_t i)
+{
+    for (size_t plane = 0; plane < 6; ++plane)
+    {
+        const float distance = planes.x[plane] * spheres.centerX[i] + planes.y[plane] * spheres.centerY[i] + planes.z[plane] * spheres.centerZ[i] + planes.w[plane];
+        if (distance < -spheres.radius[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * A box is outside when the corner furthest along the plane normal is behind the plane
+ */
+bool isBoxVisible(const FrustumPlanes& planes, const BoundingBoxes& boxes, size_t i)
+{
+    for (size_t plane = 0; plane < 6; ++plane)
+    {
+        const float distance = planes.x[plane] * boxes.centerX[i] + planes.y[plane] * boxes.centerY[i] + planes.z[plane] * boxes.centerZ[i] + planes.w[plane];
+        const float projectedExtent = planes.absX[plane] * boxes.extentX[i] + planes.absY[plane] * boxes.extentY[i] + planes.absZ[plane] * boxes.extentZ[i];
+        if (distance + projectedExtent < 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeMask(uint32_t mask, uint8_t* visible, size_t count)
+{
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+        visible[lane] = static_cast<uint8_t>((mask >> lane) & 1u);
+    }
+}
+
+void cullSpheresRange(const FrustumPlanes& planes, const BoundingSpheres& spheres, uint8_t* visible, size_t begin, size_t end)
+{
+    const float* centerX = spheres.centerX.data();
+    const float* centerY = spheres.centerY.data();
+    const float* centerZ = spheres.centerZ.data();
+    const float* radius = spheres.radius.data();
+
+    size_t i = begin;
+#if defined(CPU_CULLING_AVX2)
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(centerX + i);
+        const __m256 y = _mm256_loadu_ps(centerY + i);
+        const __m256 z = _mm256_loadu_ps(centerZ + i);
+        const __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes.x[plane])), _mm256_set1_ps(planes.w[plane]));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(planes.y[plane])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(planes.z[plane])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+        writeMask(static_cast<uint32_t>(_mm256_movemask_ps(inside)), visible + i, 8);
+    }
+#endif
+#if defined(CPU_CULLING_SSE2)
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(centerX + i);
+        const __m128 y = _mm_loadu_ps(centerY + i);
+        const __m128 z = _mm_loadu_ps(centerZ + i);
+        const __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes.x[plane])), _mm_set1_ps(planes.w[plane]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(planes.y[plane])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(planes.z[plane])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+        writeMask(static_cast<uint32_t>(_mm_movemask_ps(inside)), visible + i, 4);
+    }
+#elif defined(CPU_CULLING_NEON)
+    for (; i + 4 <= end; i += 4)
+    {
+        const float32x4_t x = vld1q_f32(centerX + i);
+        const float32x4_t y = vld1q_f32(centerY + i);
+        const float32x4_t z = vld1q_f32(centerZ + i);
+        const float32x4_t negativeRadius = vnegq_f32(vld1q_f32(radius + i));
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            float32x4_t distance = vmlaq_n_f32(vdupq_n_f32(planes.w[plane]), x, planes.x[plane]);
+            distance = vmlaq_n_f32(distance, y, planes.y[plane]);
+            distance = vmlaq_n_f32(distance, z, planes.z[plane]);
+            inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+        }
+        visible[i] = static_cast<uint8_t>(vgetq_lane_u32(inside, 0) & 1u);
+        visible[i + 1] = static_cast<uint8_t>(vgetq_lane_u32(inside, 1) & 1u);
+        visible[i + 2] = static_cast<uint8_t>(vgetq_lane_u32(inside, 2) & 1u);
+        visible[i + 3] = static_cast<uint8_t>(vgetq_lane_u32(inside, 3) & 1u);
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        visible[i] = isSphereVisible(planes, spheres, i) ? 1u : 0u;
+    }
+}
+
+void cullBoxesRange(const FrustumPlanes& planes, const BoundingBoxes& boxes, uint8_t* visible, size_t begin, size_t end)
+{
+    const float* centerX = boxes.centerX.data();
+    const float* centerY = boxes.centerY.data();
+    const float* centerZ = boxes.centerZ.data();
+    const float* extentX = boxes.extentX.data();
+    const float* extentY = boxes.extentY.data();
+    const float* extentZ = boxes.extentZ.data();
+
+    size_t i = begin;
+#if defined(CPU_CULLING_AVX2)
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(centerX + i);
+        const __m256 y = _mm256_loadu_ps(centerY + i);
+        const __m256 z = _mm256_loadu_ps(centerZ + i);
+        const __m256 ex = _mm256_loadu_ps(extentX + i);
+        const __m256 ey = _mm256_loadu_ps(extentY + i);
+        const __m256 ez = _mm256_loadu_ps(extentZ + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(planes.x[plane])), _mm256_set1_ps(planes.w[plane]));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(y, _mm256_set1_ps(planes.y[plane])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(z, _mm256_set1_ps(planes.z[plane])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(ex, _mm256_set1_ps(planes.absX[plane])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(ey, _mm256_set1_ps(planes.absY[plane])));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(ez, _mm256_set1_ps(planes.absZ[plane])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        writeMask(static_cast<uint32_t>(_mm256_movemask_ps(inside)), visible + i, 8);
+    }
+#endif
+#if defined(CPU_CULLING_SSE2)
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 x = _mm_loadu_ps(centerX + i);
+        const __m128 y = _mm_loadu_ps(centerY + i);
+        const __m128 z = _mm_loadu_ps(centerZ + i);
+        const __m128 ex = _mm_loadu_ps(extentX + i);
+        const __m128 ey = _mm_loadu_ps(extentY + i);
+        const __m128 ez = _mm_loadu_ps(extentZ + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(planes.x[plane])), _mm_set1_ps(planes.w[plane]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(planes.y[plane])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(planes.z[plane])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ex, _mm_set1_ps(planes.absX[plane])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ey, _mm_set1_ps(planes.absY[plane])));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ez, _mm_set1_ps(planes.absZ[plane])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+        writeMask(static_cast<uint32_t>(_mm_movemask_ps(inside)), visible + i, 4);
+    }
+#elif defined(CPU_CULLING_NEON)
+    for (; i + 4 <= end; i += 4)
+    {
+        const float32x4_t x = vld1q_f32(centerX + i);
+        const float32x4_t y = vld1q_f32(centerY + i);
+        const float32x4_t z = vld1q_f32(centerZ + i);
+        const float32x4_t ex = vld1q_f32(extentX + i);
+        const float32x4_t ey = vld1q_f32(extentY + i);
+        const float32x4_t ez = vld1q_f32(extentZ + i);
+        uint32x4_t inside = vdupq_n_u32(~0u);
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            float32x4_t distance = vmlaq_n_f32(vdupq_n_f32(planes.w[plane]), x, planes.x[plane]);
+            distance = vmlaq_n_f32(distance, y, planes.y[plane]);
+            distance = vmlaq_n_f32(distance, z, planes.z[plane]);
+            distance = vmlaq_n_f32(distance, ex, planes.absX[plane]);
+            distance = vmlaq_n_f32(distance, ey, planes.absY[plane]);
+            distance = vmlaq_n_f32(distance, ez, planes.absZ[plane]);
+            inside = vandq_u32(inside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+        }
+        visible[i] = static_cast<uint8_t>(vgetq_lane_u32(inside, 0) & 1u);
+        visible[i + 1] = static_cast<uint8_t>(vgetq_lane_u32(inside, 1) & 1u);
+        visible[i + 2] = static_cast<uint8_t>(vgetq_lane_u32(inside, 2) & 1u);
+        visible[i + 3] = static_cast<uint8_t>(vgetq_lane_u32(inside, 3) & 1u);
+    }
+#endif
+    for (; i < end; ++i)
+    {
+        visible[i] = isBoxVisible(planes, boxes, i) ? 1u : 0u;
+    }
+}
+
+/**
+ * Split [0, count) into tasks of objectsPerTask objects over all hardware threads
+ */
+template<typename Function>
+void forEachObjectRange(size_t count, Function function)
+{
+    const size_t taskCount = (count + objectsPerTask - 1) / objectsPerTask;
+    if (taskCount <= 1)
+    {
+        function(size_t(0), count);
+        return;
+    }
+    Parallel::forEach(taskCount, [&](size_t task)
+                      {
+                          function(task * objectsPerTask, std::min(count, (task + 1) * objectsPerTask));
+                      });
+}
+
+void validateSpheres(const BoundingSpheres& spheres, std::span<uint8_t> visible)
+{
+    const size_t count = spheres.centerX.size();
+    if (spheres.centerY.size() != count || spheres.centerZ.size() != count || spheres.radius.size() != count || visible.size() < count)
+    {
+        throw std::runtime_error("Invalid bounding spheres given to the culling!");
+    }
+}
+
+void validateBoxes(const BoundingBoxes& boxes, std::span<uint8_t> visible)
+{
+    const size_t count = boxes.centerX.size();
+    if (boxes.centerY.size() != count || boxes.centerZ.size() != count || boxes.extentX.size() != count ||
+        boxes.extentY.size() != count || boxes.extentZ.size() != count || visible.size() < count)
+    {
+        throw std::runtime_error("Invalid bounding boxes given to the culling!");
+    }
+}
+
+} // namespace
+
+size_t BoundingSpheres::size() const
+{
+    return centerX.size();
+}
+
+void BoundingSpheres::reserve(size_t count)
+{
+    centerX.reserve(count);
+    centerY.reserve(count);
+    centerZ.reserve(count);
+    radius.reserve(count);
+}
+
+void BoundingSpheres::add(glm::vec3 center, float sphereRadius)
+{
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    radius.push_back(sphereRadius);
+}
+
+size_t BoundingBoxes::size() const
+{
+    return centerX.size();
+}
+
+void BoundingBoxes::reserve(size_t count)
+{
+    centerX.reserve(count);
+    centerY.reserve(count);
+    centerZ.reserve(count);
+    extentX.reserve(count);
+    extentY.reserve(count);
+    extentZ.reserve(count);
+}
+
+void BoundingBoxes::add(glm::vec3 boxMin, glm::vec3 boxMax)
+{
+    centerX.push_back(0.5f * (boxMin.x + boxMax.x));
+    centerY.push_back(0.5f * (boxMin.y + boxMax.y));
+    centerZ.push_back(0.5f * (boxMin.z + boxMax.z));
+    extentX.push_back(0.5f * (boxMax.x - boxMin.x));
+    extentY.push_back(0.5f * (boxMax.y - boxMin.y));
+    extentZ.push_back(0.5f * (boxMax.z - boxMin.z));
+}
+
+namespace CpuCulling
+{
+
+void cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::span<uint8_t> visible)
+{
+    validateSpheres(spheres, visible);
+    const FrustumPlanes planes = splitPlanes(frustum);
+    forEachObjectRange(spheres.size(), [&](size_t begin, size_t end)
+                       {
+                           cullSpheresRange(planes, spheres, visible.data(), begin, end);
+                       });
+}
+
+void cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, std::span<uint8_t> visible)
+{
+    validateBoxes(boxes, visible);
+    const FrustumPlanes planes = splitPlanes(frustum);
+    forEachObjectRange(boxes.size(), [&](size_t begin, size_t end)
+                       {
+                           cullBoxesRange(planes, boxes, visible.data(), begin, end);
+                       });
+}
+
+void cullSpheresReference(const Frustum& frustum, const BoundingSpheres& spheres, std::span<uint8_t> visible)
+{
+    validateSpheres(spheres, visible);
+    const FrustumPlanes planes = splitPlanes(frustum);
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+        visible[i] = isSphereVisible(planes, spheres, i) ? 1u : 0u;
+    }
+}
+
+void cullBoxesReference(const Frustum& frustum, const BoundingBoxes& boxes, std::span<uint8_t> visible)
+{
+    validateBoxes(boxes, visible);
+    const FrustumPlanes planes = splitPlanes(frustum);
+    for (size_t i = 0; i < boxes.size(); ++i)
+    {
+        visible[i] = isBoxVisible(planes, boxes, i) ? 1u : 0u;
+    }
+}
+
+void compactVisible(std::span<const uint8_t> visible, std::vector<uint32_t>& visibleIndices)
+{
+    visibleIndices.clear();
+    for (size_t i = 0; i < visible.size(); ++i)
+    {
+        if (visible[i])
+        {
+            visibleIndices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+}
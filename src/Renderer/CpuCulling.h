@@ -0,0 +1,69 @@
+#ifndef VULKANPROJECT_CPUCULLING_H
+#define VULKANPROJECT_CPUCULLING_H
+
+#include "Frustum.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * World space bounding spheres as structure of arrays, so that the culling loops load 4 or 8 objects per register
+ */
+struct BoundingSpheres
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+
+    size_t size() const;
+    void reserve(size_t count);
+    void add(glm::vec3 center, float sphereRadius);
+};
+
+/**
+ * World space axis aligned boxes as structure of arrays
+ */
+struct BoundingBoxes
+{
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> extentX; // Half size
+    std::vector<float> extentY;
+    std::vector<float> extentZ;
+
+    size_t size() const;
+    void reserve(size_t count);
+    void add(glm::vec3 boxMin, glm::vec3 boxMax);
+};
+
+/**
+ * Frustum culling of many objects on the CPU, for when GPU culling is not available or as a coarse first pass.
+ * Objects are tested 8 (AVX2) or 4 (SSE2, NEON) at a time and spread over all hardware threads. Results are one byte
+ * per object, 1 if visible.
+ */
+namespace CpuCulling
+{
+
+void cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, std::span<uint8_t> visible);
+void cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, std::span<uint8_t> visible);
+
+/**
+ * Single threaded scalar versions, kept as the baseline for benchmarks and for validating the SIMD paths
+ */
+void cullSpheresReference(const Frustum& frustum, const BoundingSpheres& spheres, std::span<uint8_t> visible);
+void cullBoxesReference(const Frustum& frustum, const BoundingBoxes& boxes, std::span<uint8_t> visible);
+
+/**
+ * Indices of the visible objects, in order
+ */
+void compactVisible(std::span<const uint8_t> visible, std::vector<uint32_t>& visibleIndices);
+
+}
+
+#endif // VULKANPROJECT_CPUCULLING_H
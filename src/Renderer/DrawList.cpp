@@ -0,0 +1,128 @@
+#include "DrawList.h"
+
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/Trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+
+// Sort key from the most to the least significant bits. There is no descriptor field: materials find their textures
+// through the bindless table, so the pipeline is the only state that changes between draws.
+constexpr uint32_t depthBits = 28u;
+constexpr uint32_t lodBits = 4u;
+constexpr uint32_t meshBits = 16u; // Handle ids are 16 bit
+constexpr uint64_t culledKey = ~0ull;
+
+constexpr size_t itemsPerJob = 4096u;
+
+uint64_t makeSortKey(Handle<HandleType::Pipeline> pipeline, Handle<HandleType::Mesh> mesh, uint32_t lod, float distance)
+{
+    // Non-negative floats order like their bits, the lowest ones are dropped
+    const uint64_t depth = std::bit_cast<uint32_t>(std::max(distance, 0.0f)) >> (32u - depthBits);
+    return (uint64_t(pipeline.getId()) << (depthBits + lodBits + meshBits)) | (uint64_t(mesh.getId()) << (depthBits + lodBits)) |
+           (uint64_t(std::min(lod, (1u << lodBits) - 1u)) << depthBits) | depth;
+}
+
+bool isSphereInFrustum(const Frustum& frustum, glm::vec3 center, float radius)
+{
+    for (const glm::vec4& plane : frustum.planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void DrawList::submit(Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> pipeline, const glm::mat4& transform)
+{
+    m_items.push_back(Item{transform, mesh, pipeline});
+}
+
+void DrawList::clear()
+{
+    m_items.clear();
+}
+
+size_t DrawList::size() const
+{
+    return m_items.size();
+}
+
+Vulkan::InstancedDrawList DrawList::build(const std::unordered_map<uint32_t, DrawListMesh>& meshes, const Frustum& frustum, glm::vec3 cameraPosition, const LodSelectionSettings& settings)
+{
+    TRACE_ZONE("DrawList::build");
+    const size_t itemCount = m_items.size();
+    m_keys.resize(itemCount);
+
+    JobSystem& jobSystem = JobSystem::get();
+    jobSystem.parallelFor(itemCount, itemsPerJob, [&](size_t begin, size_t end)
+                          {
+                              for (size_t i = begin; i < end; ++i)
+                              {
+                                  const Item& item = m_items[i];
+                                  const auto mesh = meshes.find(item.mesh.getId());
+                                  if (mesh == meshes.end())
+                                  {
+                                      throw std::runtime_error("Submitted draw of a mesh that has not been added!");
+                                  }
+
+                                  LodInstance instance{};
+                                  instance.center = glm::vec3(item.transform * glm::vec4(mesh->second.boundsCenter, 1.0f));
+                                  instance.scale = std::max(glm::length(glm::vec3(item.transform[0])), std::max(glm::length(glm::vec3(item.transform[1])), glm::length(glm::vec3(item.transform[2]))));
+                                  instance.radius = mesh->second.boundsRadius * instance.scale;
+                                  uint64_t key = culledKey;
+                                  if (isSphereInFrustum(frustum, instance.center, instance.radius))
+                                  {
+                                      const uint32_t lod = selectLod(mesh->second.lods, instance, cameraPosition, settings);
+                                      key = makeSortKey(item.pipeline, item.mesh, lod, glm::distance(instance.center, cameraPosition) - instance.radius);
+                                  }
+                                  m_keys[i] = RadixSort::KeyValue{key, static_cast<uint32_t>(i)};
+                              }
+                          });
+
+    m_sortedKeys.clear();
+    for (const RadixSort::KeyValue& key : m_keys)
+    {
+        if (key.key != culledKey)
+        {
+            m_sortedKeys.push_back(key);
+        }
+    }
+    RadixSort::sort(m_sortedKeys, m_sortScratch);
+
+    const size_t drawnCount = m_sortedKeys.size();
+    m_instances.resize(drawnCount);
+    jobSystem.parallelFor(drawnCount, itemsPerJob, [&](size_t begin, size_t end)
+                          {
+                              for (size_t i = begin; i < end; ++i)
+                              {
+                                  const Item& item = m_items[m_sortedKeys[i].value];
+                                  m_instances[i] = Vulkan::GpuInstance{item.transform, item.mesh.getId(), item.pipeline.getId(), Vulkan::instanceVisibleFlag, Vulkan::noTexture};
+                              }
+                          });
+
+    // Runs of equal keys above the depth are one instanced draw
+    m_draws.clear();
+    for (size_t i = 0; i < drawnCount; ++i)
+    {
+        const uint64_t stateKey = m_sortedKeys[i].key >> depthBits;
+        if (i > 0 && stateKey == (m_sortedKeys[i - 1].key >> depthBits))
+        {
+            ++m_draws.back().instanceCount;
+            continue;
+        }
+        const Item& item = m_items[m_sortedKeys[i].value];
+        const auto lod = static_cast<uint32_t>(stateKey & ((1u << lodBits) - 1u));
+        m_draws.push_back(Vulkan::InstancedDraw{item.pipeline, item.mesh, lod, static_cast<uint32_t>(i), 1u});
+    }
+    TRACE_COUNTER("Draw list draws", m_draws.size());
+    return Vulkan::InstancedDrawList{m_instances, m_draws};
+}
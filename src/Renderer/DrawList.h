@@ -0,0 +1,59 @@
+#ifndef VULKANPROJECT_DRAWLIST_H
+#define VULKANPROJECT_DRAWLIST_H
+
+#include "Frustum.h"
+#include "LodSelection.h"
+#include "Backend/Vulkan/VulkanBackend.h"
+#include "../Utilities/RadixSort.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Mesh bounds and LOD errors for culling and LOD selection on the CPU
+ */
+struct DrawListMesh
+{
+    glm::vec3 boundsCenter;
+    float boundsRadius;
+    std::vector<MeshLod> lods;
+};
+
+/**
+ * Draws submitted for one frame. build() culls them against the view, selects their LODs and sorts them by 64 bit
+ * keys of pipeline, mesh, LOD and depth, so that draws of the same mesh and LOD with the same pipeline end up next to
+ * each other and become one instanced draw. Pipelines are bound once per pipeline and each mesh is drawn once per
+ * pipeline and LOD, front to back within its draw.
+ */
+class DrawList
+{
+public:
+    void submit(Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> pipeline, const glm::mat4& transform);
+    void clear();
+    size_t size() const;
+
+    /**
+     * @param meshes Indexed by mesh handle id, every submitted mesh has to be present
+     * @return Valid until the next build()
+     */
+    Vulkan::InstancedDrawList build(const std::unordered_map<uint32_t, DrawListMesh>& meshes, const Frustum& frustum, glm::vec3 cameraPosition, const LodSelectionSettings& settings);
+private:
+    struct Item
+    {
+        glm::mat4 transform;
+        Handle<HandleType::Mesh> mesh;
+        Handle<HandleType::Pipeline> pipeline;
+    };
+
+    std::vector<Item> m_items;
+    std::vector<RadixSort::KeyValue> m_keys; // Of every item, ~0 for culled ones
+    std::vector<RadixSort::KeyValue> m_sortedKeys;
+    std::vector<RadixSort::KeyValue> m_sortScratch;
+    std::vector<Vulkan::GpuInstance> m_instances;
+    std::vector<Vulkan::InstancedDraw> m_draws;
+};
+
+#endif // VULKANPROJECT_DRAWLIST_H
@@ -0,0 +1,25 @@
+#include "Frustum.h"
+
+Frustum extractFrustum(const glm::mat4& viewProjection)
+{
+    // Rows of the matrix, glm stores columns
+    glm::vec4 rows[4];
+    for (int row = 0; row < 4; ++row)
+    {
+        rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+    }
+
+    Frustum frustum{};
+    frustum.planes[0] = rows[3] + rows[0];
+    frustum.planes[1] = rows[3] - rows[0];
+    frustum.planes[2] = rows[3] + rows[1];
+    frustum.planes[3] = rows[3] - rows[1];
+    frustum.planes[4] = rows[2];
+    frustum.planes[5] = rows[3] - rows[2];
+
+    for (glm::vec4& plane : frustum.planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    return frustum;
+}
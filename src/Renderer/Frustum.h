@@ -0,0 +1,23 @@
+#ifndef VULKANPROJECT_FRUSTUM_H
+#define VULKANPROJECT_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+/**
+ * Six normalized planes with inward pointing normals: dot(plane.xyz, point) + plane.w >= 0 inside.
+ * Ordered left, right, bottom, top, near, far.
+ */
+struct Frustum
+{
+    std::array<glm::vec4, 6> planes;
+};
+
+/**
+ * Extract the planes of a Vulkan clip space (depth from 0 to 1) projection. Passing viewProjection * model gives
+ * the planes in model space.
+ */
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+#endif // VULKANPROJECT_FRUSTUM_H
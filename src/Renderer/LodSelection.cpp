@@ -0,0 +1,39 @@
+#include "LodSelection.h"
+
+#include <cmath>
+#include <stdexcept>
+
+float computeLodProjectionScale(float verticalFov, float viewportHeight)
+{
+    return viewportHeight / (2.0f * std::tan(verticalFov * 0.5f));
+}
+
+uint32_t selectLod(std::span<const MeshLod> lods, const LodInstance& instance, glm::vec3 cameraPosition, const LodSelectionSettings& settings)
+{
+    const float distance = glm::distance(instance.center, cameraPosition) - instance.radius;
+    if (distance <= 0.0f || lods.empty())
+    {
+        return 0u;
+    }
+
+    // Compare in world units to avoid a division per level; errors grow with the level
+    const float maxWorldError = settings.maxPixelError * distance / (settings.projectionScale * instance.scale);
+    uint32_t selected = 0u;
+    while (selected + 1 < lods.size() && lods[selected + 1].error <= maxWorldError)
+    {
+        ++selected;
+    }
+    return selected;
+}
+
+void selectLods(std::span<const MeshLod> lods, std::span<const LodInstance> instances, glm::vec3 cameraPosition, const LodSelectionSettings& settings, std::span<uint32_t> selectedLods)
+{
+    if (selectedLods.size() < instances.size())
+    {
+        throw std::runtime_error("Not enough space for the selected LODs!");
+    }
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        selectedLods[i] = selectLod(lods, instances[i], cameraPosition, settings);
+    }
+}
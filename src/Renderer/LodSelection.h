@@ -0,0 +1,40 @@
+#ifndef VULKANPROJECT_LODSELECTION_H
+#define VULKANPROJECT_LODSELECTION_H
+
+#include "../Assets/MeshSimplifier.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+
+/**
+ * World space bounding sphere of one instance of a mesh
+ */
+struct LodInstance
+{
+    glm::vec3 center;
+    float radius;
+    float scale; // Largest scale of the model matrix, converts mesh space errors to world space
+};
+
+struct LodSelectionSettings
+{
+    float projectionScale; // Pixels per world unit at distance 1, see computeLodProjectionScale()
+    float maxPixelError = 1.0f; // Coarser levels are used while their error projects to at most this many pixels
+};
+
+/**
+ * Viewport height over the height of the view frustum at distance 1
+ */
+float computeLodProjectionScale(float verticalFov, float viewportHeight);
+
+/**
+ * Coarsest level whose error projects to at most maxPixelError pixels at the distance to the nearest point of the
+ * bounds. Cameras inside the bounds get level 0.
+ */
+uint32_t selectLod(std::span<const MeshLod> lods, const LodInstance& instance, glm::vec3 cameraPosition, const LodSelectionSettings& settings);
+
+void selectLods(std::span<const MeshLod> lods, std::span<const LodInstance> instances, glm::vec3 cameraPosition, const LodSelectionSettings& settings, std::span<uint32_t> selectedLods);
+
+#endif // VULKANPROJECT_LODSELECTION_H
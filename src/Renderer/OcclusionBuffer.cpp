@@ -0,0 +1,323 @@
+#include "OcclusionBuffer.h"
+
+#include "../Utilities/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_BUFFER_SSE2
+#endif
+
+namespace
+{
+
+constexpr int32_t rowsPerBand = 16;
+constexpr size_t boxesPerTask = 4096;
+constexpr float minClipW = 1e-5f;
+
+} // namespace
+
+OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+{
+    if (width == 0 || height == 0 || width % 4 != 0)
+    {
+        throw std::runtime_error("Occlusion buffer width must be a non zero multiple of 4!");
+    }
+
+    m_levels.push_back(Level{width, height, std::vector<float>(size_t(width) * height, 1.0f)});
+    while (width > 1 || height > 1)
+    {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        m_levels.push_back(Level{width, height, std::vector<float>(size_t(width) * height, 1.0f)});
+    }
+    m_bandTriangles.resize((m_levels[0].height + rowsPerBand - 1) / rowsPerBand);
+}
+
+void OcclusionBuffer::begin(const glm::mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    std::fill(m_levels[0].depth.begin(), m_levels[0].depth.end(), 1.0f);
+}
+
+void OcclusionBuffer::rasterizeOccluders(std::span<const glm::vec3> vertices, std::span<const uint32_t> indices)
+{
+    if (indices.size() % 3 != 0)
+    {
+        throw std::runtime_error("Occluder indices must be a list of triangles!");
+    }
+
+    const float width = static_cast<float>(m_levels[0].width);
+    const float height = static_cast<float>(m_levels[0].height);
+
+    m_triangles.clear();
+    for (std::vector<uint32_t>& band : m_bandTriangles)
+    {
+        band.clear();
+    }
+
+    for (size_t triangle = 0; triangle < indices.size(); triangle += 3)
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+        bool clipped = false;
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t index = indices[triangle + corner];
+            if (index >= vertices.size())
+            {
+                throw std::runtime_error("Occluder index out of range!");
+            }
+            const glm::vec4 clip = m_viewProjection * glm::vec4(vertices[index], 1.0f);
+            if (clip.w < minClipW || clip.z < 0.0f)
+            {
+                clipped = true;
+                break;
+            }
+            x[corner] = (clip.x / clip.w * 0.5f + 0.5f) * width;
+            y[corner] = (clip.y / clip.w * 0.5f + 0.5f) * height;
+            z[corner] = clip.z / clip.w;
+        }
+        if (clipped)
+        {
+            continue;
+        }
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (std::abs(area) < 1e-8f)
+        {
+            continue;
+        }
+        if (area < 0.0f)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(z[1], z[2]);
+            area = -area;
+        }
+
+        TriangleSetup setup{};
+        setup.minX = std::max(0, static_cast<int32_t>(std::floor(std::min({x[0], x[1], x[2]}))));
+        setup.maxX = std::min(static_cast<int32_t>(width) - 1, static_cast<int32_t>(std::ceil(std::max({x[0], x[1], x[2]}))));
+        setup.minY = std::max(0, static_cast<int32_t>(std::floor(std::min({y[0], y[1], y[2]}))));
+        setup.maxY = std::min(static_cast<int32_t>(height) - 1, static_cast<int32_t>(std::ceil(std::max({y[0], y[1], y[2]}))));
+        if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+        {
+            continue;
+        }
+
+        // Edge i is opposite to vertex i, depth is interpolated with the normalized edge functions as barycentrics
+        for (size_t edge = 0; edge < 3; ++edge)
+        {
+            const size_t j = (edge + 1) % 3;
+            const size_t k = (edge + 2) % 3;
+            setup.edgeA[edge] = y[j] - y[k];
+            setup.edgeB[edge] = x[k] - x[j];
+            setup.edgeC[edge] = x[j] * y[k] - x[k] * y[j];
+            setup.depthA += setup.edgeA[edge] * z[edge] / area;
+            setup.depthB += setup.edgeB[edge] * z[edge] / area;
+            setup.depthC += setup.edgeC[edge] * z[edge] / area;
+        }
+
+        const uint32_t triangleIndex = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(setup);
+        for (int32_t band = setup.minY / rowsPerBand; band <= setup.maxY / rowsPerBand; ++band)
+        {
+            m_bandTriangles[band].push_back(triangleIndex);
+        }
+    }
+
+    // Bands of rows are independent, so each task owns its rows of the depth buffer
+    Parallel::forEach(m_bandTriangles.size(), [&](size_t band)
+                      {
+                          const int32_t bandFirstRow = static_cast<int32_t>(band) * rowsPerBand;
+                          for (const uint32_t triangleIndex : m_bandTriangles[band])
+                          {
+                              const TriangleSetup& setup = m_triangles[triangleIndex];
+                              rasterizeRows(setup, std::max(setup.minY, bandFirstRow), std::min(setup.maxY + 1, bandFirstRow + rowsPerBand));
+                          }
+                      });
+}
+
+void OcclusionBuffer::rasterizeRows(const TriangleSetup& triangle, int32_t firstRow, int32_t endRow)
+{
+    const uint32_t width = m_levels[0].width;
+    const int32_t firstColumn = triangle.minX & ~3;
+
+    for (int32_t y = firstRow; y < endRow; ++y)
+    {
+        const float pixelY = static_cast<float>(y) + 0.5f;
+        float* row = &m_levels[0].depth[size_t(y) * width];
+
+#if defined(OCCLUSION_BUFFER_SSE2)
+        const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        __m128 rowEdges[3];
+        __m128 edgeA[3];
+        for (size_t edge = 0; edge < 3; ++edge)
+        {
+            rowEdges[edge] = _mm_set1_ps(triangle.edgeB[edge] * pixelY + triangle.edgeC[edge]);
+            edgeA[edge] = _mm_set1_ps(triangle.edgeA[edge]);
+        }
+        const __m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelY + triangle.depthC);
+        const __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+        for (int32_t x = firstColumn; x <= triangle.maxX; x += 4)
+        {
+            const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+            __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], pixelX), rowEdges[0]), _mm_setzero_ps());
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], pixelX), rowEdges[1]), _mm_setzero_ps()));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], pixelX), rowEdges[2]), _mm_setzero_ps()));
+            if (_mm_movemask_ps(inside) == 0)
+            {
+                continue;
+            }
+
+            const __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+            const __m128 previous = _mm_loadu_ps(row + x);
+            const __m128 nearest = _mm_min_ps(previous, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+        }
+#else
+        for (int32_t x = firstColumn; x <= triangle.maxX; ++x)
+        {
+            const float pixelX = static_cast<float>(x) + 0.5f;
+            bool inside = true;
+            for (size_t edge = 0; edge < 3; ++edge)
+            {
+                inside = inside && triangle.edgeA[edge] * pixelX + triangle.edgeB[edge] * pixelY + triangle.edgeC[edge] >= 0.0f;
+            }
+            if (inside)
+            {
+                row[x] = std::min(row[x], triangle.depthA * pixelX + triangle.depthB * pixelY + triangle.depthC);
+            }
+        }
+#endif
+    }
+}
+
+void OcclusionBuffer::buildHierarchy()
+{
+    for (size_t level = 1; level < m_levels.size(); ++level)
+    {
+        const Level& source = m_levels[level - 1];
+        Level& destination = m_levels[level];
+        for (uint32_t y = 0; y < destination.height; ++y)
+        {
+            const uint32_t y0 = 2 * y;
+            const uint32_t y1 = std::min(2 * y + 1, source.height - 1);
+            for (uint32_t x = 0; x < destination.width; ++x)
+            {
+                const uint32_t x0 = 2 * x;
+                const uint32_t x1 = std::min(2 * x + 1, source.width - 1);
+                destination.depth[size_t(y) * destination.width + x] = std::max({source.depth[size_t(y0) * source.width + x0],
+                                                                                 source.depth[size_t(y0) * source.width + x1],
+                                                                                 source.depth[size_t(y1) * source.width + x0],
+                                                                                 source.depth[size_t(y1) * source.width + x1]});
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::isBoxOccluded(glm::vec3 center, glm::vec3 extent) const
+{
+    const float width = static_cast<float>(m_levels[0].width);
+    const float height = static_cast<float>(m_levels[0].height);
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    float nearestDepth = std::numeric_limits<float>::max();
+    // Corners are the projected center plus or minus the projected half axes
+    const glm::vec4 clipCenter = m_viewProjection * glm::vec4(center, 1.0f);
+    const glm::vec4 clipAxisX = m_viewProjection[0] * extent.x;
+    const glm::vec4 clipAxisY = m_viewProjection[1] * extent.y;
+    const glm::vec4 clipAxisZ = m_viewProjection[2] * extent.z;
+    for (uint32_t corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec4 clip = clipCenter + ((corner & 1u) ? clipAxisX : -clipAxisX) + ((corner & 2u) ? clipAxisY : -clipAxisY) + ((corner & 4u) ? clipAxisZ : -clipAxisZ);
+        if (clip.w < minClipW || clip.z < 0.0f)
+        {
+            return false; // Crosses the near plane
+        }
+        const float x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+        const float y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearestDepth = std::min(nearestDepth, clip.z / clip.w);
+    }
+    if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+    {
+        return false; // Off screen, left to frustum culling
+    }
+
+    const int32_t x0 = std::max(0, static_cast<int32_t>(minX));
+    const int32_t y0 = std::max(0, static_cast<int32_t>(minY));
+    const int32_t x1 = std::min(static_cast<int32_t>(m_levels[0].width) - 1, static_cast<int32_t>(maxX));
+    const int32_t y1 = std::min(static_cast<int32_t>(m_levels[0].height) - 1, static_cast<int32_t>(maxY));
+
+    // Coarsest level where the rectangle spans at most 3x3 texels
+    const int32_t size = std::max(x1 - x0, y1 - y0);
+    size_t level = 0;
+    while ((size >> level) > 2 && level + 1 < m_levels.size())
+    {
+        ++level;
+    }
+
+    const Level& depth = m_levels[level];
+    for (int32_t y = y0 >> level; y <= (y1 >> level); ++y)
+    {
+        for (int32_t x = x0 >> level; x <= (x1 >> level); ++x)
+        {
+            if (depth.depth[size_t(y) * depth.width + x] >= nearestDepth)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void OcclusionBuffer::cullBoxes(const BoundingBoxes& boxes, std::span<uint8_t> visible) const
+{
+    const size_t count = boxes.size();
+    if (visible.size() < count)
+    {
+        throw std::runtime_error("Not enough space for the visibility of the boxes!");
+    }
+
+    Parallel::forEach((count + boxesPerTask - 1) / boxesPerTask, [&](size_t task)
+                      {
+                          const size_t end = std::min(count, (task + 1) * boxesPerTask);
+                          for (size_t i = task * boxesPerTask; i < end; ++i)
+                          {
+                              if (visible[i] && isBoxOccluded(glm::vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]),
+                                                              glm::vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i])))
+                              {
+                                  visible[i] = 0u;
+                              }
+                          }
+                      });
+}
+
+uint32_t OcclusionBuffer::getWidth() const
+{
+    return m_levels[0].width;
+}
+
+uint32_t OcclusionBuffer::getHeight() const
+{
+    return m_levels[0].height;
+}
+
+std::span<const float> OcclusionBuffer::getDepth() const
+{
+    return m_levels[0].depth;
+}
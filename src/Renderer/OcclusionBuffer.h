@@ -0,0 +1,76 @@
+#ifndef VULKANPROJECT_OCCLUSIONBUFFER_H
+#define VULKANPROJECT_OCCLUSIONBUFFER_H
+
+#include "CpuCulling.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Low resolution software depth buffer for CPU occlusion culling. A few large occluders are rasterized into it, then
+ * boxes are tested against a max depth hierarchy built from it. Depth goes from 0 at the near plane to 1 at the far
+ * plane, as in Vulkan.
+ *
+ * Usage per frame: begin(), rasterizeOccluders() for each occluder mesh, buildHierarchy(), then cullBoxes().
+ */
+class OcclusionBuffer
+{
+public:
+    /**
+     * @param width Multiple of 4, rows are rasterized 4 pixels at a time
+     */
+    OcclusionBuffer(uint32_t width, uint32_t height);
+
+    void begin(const glm::mat4& viewProjection);
+
+    /**
+     * Rasterize indexed world space triangles with both windings. Triangles crossing the near plane are skipped, which
+     * only makes the culling more conservative.
+     */
+    void rasterizeOccluders(std::span<const glm::vec3> vertices, std::span<const uint32_t> indices);
+    void buildHierarchy();
+
+    bool isBoxOccluded(glm::vec3 center, glm::vec3 extent) const;
+
+    /**
+     * Clear the visible flag of every visible box hidden behind the occluders, on all hardware threads
+     */
+    void cullBoxes(const BoundingBoxes& boxes, std::span<uint8_t> visible) const;
+
+    uint32_t getWidth() const;
+    uint32_t getHeight() const;
+    std::span<const float> getDepth() const;
+private:
+    struct Level
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<float> depth;
+    };
+
+    struct TriangleSetup
+    {
+        float edgeA[3]; // Edge functions A * x + B * y + C, positive inside
+        float edgeB[3];
+        float edgeC[3];
+        float depthA; // Depth plane A * x + B * y + C
+        float depthB;
+        float depthC;
+        int32_t minX;
+        int32_t maxX;
+        int32_t minY;
+        int32_t maxY;
+    };
+
+    void rasterizeRows(const TriangleSetup& triangle, int32_t firstRow, int32_t endRow);
+
+    glm::mat4 m_viewProjection{1.0f};
+    std::vector<Level> m_levels; // Level 0 is the rasterized depth, each next level the maximum of 2x2 texels
+    std::vector<TriangleSetup> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bandTriangles;
+};
+
+#endif // VULKANPROJECT_OCCLUSIONBUFFER_H
@@ -6,24 +6,591 @@ constexpr bool debug = false;
 constexpr bool debug = true;
 #endif
 
+#include "Frustum.h"
+#include "LodSelection.h"
 #include "ShaderCompiler.h"
+#include "../Utilities/FileWatcher.h"
+#include "../Utilities/JobSystem.h"
+#include "../Utilities/StartupTimer.h"
+#include "../Utilities/Trace.h"
+#include "../Assets/MeshletBuilder.h"
+#include "../Assets/TextureAsset.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
 
-Renderer::Renderer(Window& window, const CPUResourceManager& cpuResourceManager) :
+namespace
+{
+
+// Upper limit of resident streamed mips, lowered when the device runs low on memory
+constexpr uint64_t textureStreamingBudget = 512ull * 1024ull * 1024ull;
+constexpr uint64_t maxStreamedTextureBytesPerFrame = 16ull * 1024ull * 1024ull;
+
+// Mips at most this large are always resident so there is always something to sample
+constexpr uint32_t textureTailMipSize = 64u;
+
+// Share of the device memory budget kept free for allocations made before streaming can react, like staging buffers
+// and the render targets of a resize
+constexpr uint64_t deviceMemoryReservePercent = 10u;
+
+constexpr const char* shaderDirectory = "shaders";
+constexpr const char* clusterCullingShaderPath = "shaders/ClusterCulling.comp";
+constexpr const char* instanceCullingShaderPath = "shaders/InstanceCulling.comp";
+constexpr const char* instanceUploadShaderPath = "shaders/InstanceUpload.comp";
+
+Vulkan::GpuInstance toGpuInstance(const DrawInstance& instance)
+{
+    return Vulkan::GpuInstance{instance.model,
+                               instance.mesh.getId(),
+                               instance.pipeline.getId(),
+                               instance.isVisible ? Vulkan::instanceVisibleFlag : 0u,
+                               instance.texture ? instance.texture->getId() : Vulkan::noTexture};
+}
+
+DrawListMesh toDrawListMesh(const MeshLodChain& lodChain)
+{
+    return DrawListMesh{lodChain.boundsCenter, lodChain.boundsRadius, lodChain.lods};
+}
+
+/**
+ * With hot reload, shaders are read from the source tree so that edits take effect without a build copying them
+ */
+std::string resolveShaderPath(const std::string& path)
+{
+#ifdef VULKANPROJECT_SHADER_SOURCE_DIRECTORY
+    const std::filesystem::path relativePath = std::filesystem::path(path).lexically_relative(shaderDirectory);
+    if (!relativePath.empty() && *relativePath.begin() != "..")
+    {
+        return (std::filesystem::path(VULKANPROJECT_SHADER_SOURCE_DIRECTORY) / relativePath).lexically_normal().string();
+    }
+#endif
+    return path;
+}
+
+EShLanguage getShaderStage(const std::string& path)
+{
+    const std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".vert")
+    {
+        return EShLanguage::EShLangVertex;
+    }
+    if (extension == ".frag")
+    {
+        return EShLanguage::EShLangFragment;
+    }
+    if (extension == ".comp")
+    {
+        return EShLanguage::EShLangCompute;
+    }
+    throw std::runtime_error("Unknown shader stage of " + path + "!");
+}
+
+}
+
+struct ShaderCompilation
+{
+    ShaderCompiler compiler;
+    std::vector<std::string> paths;
+    std::vector<Shader> shaders; // Same order as paths, valid once compiled is done
+    std::vector<uint8_t> isFailed; // Same order as paths, only reloads keep going after errors
+    JobCounter compiled;
+
+    ~ShaderCompilation()
+    {
+        // The jobs write into this, so it outlives them even when startup fails before waiting
+        try
+        {
+            JobSystem::get().wait(compiled);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /**
+     * @return Null when the shader was not part of the compilation
+     */
+    const Shader* findShader(const std::string& path) const
+    {
+        const auto it = std::find(paths.begin(), paths.end(), path);
+        return it != paths.end() ? &shaders[it - paths.begin()] : nullptr;
+    }
+};
+
+struct ShaderHotReload
+{
+    struct RenderPipeline
+    {
+        Handle<HandleType::Pipeline> handle;
+        std::string vertexShaderPath;
+        std::string fragmentShaderPath;
+    };
+
+    FileWatcher watcher;
+    std::unordered_map<std::string, Shader> shaders; // Latest version that compiled, by shader path
+    std::vector<RenderPipeline> renderPipelines;
+    std::vector<std::string> changedShaders; // Waiting for the running compilation to finish
+    std::shared_ptr<ShaderCompilation> compilation; // Running in the background, if any
+
+    void watch(const std::string& path, const Shader& shader)
+    {
+        watcher.watch(resolveShaderPath(path));
+        for (const std::string& includedPath : shader.includedPaths)
+        {
+            watcher.watch(includedPath);
+        }
+        shaders.insert_or_assign(path, shader);
+    }
+
+    bool isAffected(const std::string& path, const std::string& changedPath) const
+    {
+        const std::vector<std::string>& includedPaths = shaders.at(path).includedPaths;
+        return resolveShaderPath(path) == changedPath || std::find(includedPaths.begin(), includedPaths.end(), changedPath) != includedPaths.end();
+    }
+};
+
+
+Renderer::Renderer(Window& window, CPUResourceManager& cpuResourceManager, std::shared_ptr<ShaderCompilation> shaderCompilation) :
+    m_cpuResourceManager(cpuResourceManager),
+    m_resolution(window.getResolution()),
+    m_shaderCompilation(shaderCompilation ? std::move(shaderCompilation) : compileShadersAsync({})),
     m_graphicsBackend(debug,
                       window.getResolution(),
                       std::bind(&Window::createVulkanSurface, &window, std::placeholders::_1),
-                      window.getRequiredVulkanExtensions(debug))
+                      window.getRequiredVulkanExtensions(debug)),
+    m_textureResidencyManager(textureStreamingBudget, maxStreamedTextureBytesPerFrame)
 {
+    {
+        StartupTimer::Phase phase("Wait for shader compilation");
+        JobSystem::get().wait(m_shaderCompilation->compiled);
+    }
+#ifdef VULKANPROJECT_SHADER_SOURCE_DIRECTORY
+    m_shaderHotReload = std::make_shared<ShaderHotReload>();
+#endif
+    createComputePipelines();
 };
 
-void Renderer::createRenderPipeline(std::string_view vertexShaderPath, std::string_view fragmentShaderPath)
+std::shared_ptr<ShaderCompilation> Renderer::compileShadersAsync(std::vector<std::string> shaderPaths)
+{
+    auto compilation = std::make_shared<ShaderCompilation>();
+    compilation->paths = {clusterCullingShaderPath, instanceCullingShaderPath, instanceUploadShaderPath};
+    for (std::string& path : shaderPaths)
+    {
+        if (!compilation->findShader(path))
+        {
+            compilation->paths.push_back(std::move(path));
+        }
+    }
+    compilation->shaders.resize(compilation->paths.size());
+    compilation->isFailed.resize(compilation->paths.size(), 0u);
+
+    // Every shader compiles in its own job, nothing waits until the renderer creates its pipelines
+    JobSystem& jobSystem = JobSystem::get();
+    for (size_t i = 0; i < compilation->paths.size(); ++i)
+    {
+        const EShLanguage stage = getShaderStage(compilation->paths[i]);
+        jobSystem.run([compilation = compilation.get(), i, stage]()
+                      {
+                          const std::string& path = compilation->paths[i];
+                          StartupTimer::Phase phase("Compile " + path);
+                          compilation->shaders[i] = compilation->compiler.compileShader(std::filesystem::path(path).stem().string(), resolveShaderPath(path), stage);
+                      },
+                      &compilation->compiled);
+    }
+    return compilation;
+}
+
+void Renderer::createComputePipelines()
+{
+    TRACE_ZONE("Renderer::createComputePipelines");
+    StartupTimer::Phase phase("Create compute pipelines");
+    m_graphicsBackend.createClusterCullingPipeline(m_shaderCompilation->findShader(clusterCullingShaderPath)->spirvCode);
+    m_graphicsBackend.createInstanceCullingPipeline(m_shaderCompilation->findShader(instanceCullingShaderPath)->spirvCode);
+    m_graphicsBackend.createInstanceUploadPipeline(m_shaderCompilation->findShader(instanceUploadShaderPath)->spirvCode);
+    if (m_shaderHotReload)
+    {
+        for (const char* path : {clusterCullingShaderPath, instanceCullingShaderPath, instanceUploadShaderPath})
+        {
+            m_shaderHotReload->watch(path, *m_shaderCompilation->findShader(path));
+        }
+    }
+}
+
+Handle<HandleType::Pipeline> Renderer::createRenderPipeline(const std::string& vertexShaderPath, const std::string& fragmentShaderPath)
 {
+    TRACE_ZONE("Renderer::createRenderPipeline");
     ShaderCompiler shaderCompiler;
+    JobSystem& jobSystem = JobSystem::get();
+
+    // Shaders compiled at startup are reused, the rest compile in parallel here
+    JobCounter compiled;
+    Shader vertexShader;
+    Shader fragmentShader;
+    if (const Shader* compiledShader = m_shaderCompilation->findShader(vertexShaderPath))
+    {
+        vertexShader = *compiledShader;
+    }
+    else
+    {
+        jobSystem.run([&]()
+                      { vertexShader = shaderCompiler.compileShader("vertexShader", resolveShaderPath(vertexShaderPath), EShLanguage::EShLangVertex); },
+                      &compiled);
+    }
+    if (const Shader* compiledShader = m_shaderCompilation->findShader(fragmentShaderPath))
+    {
+        fragmentShader = *compiledShader;
+    }
+    else
+    {
+        jobSystem.run([&]()
+                      { fragmentShader = shaderCompiler.compileShader("fragmentShader", resolveShaderPath(fragmentShaderPath), EShLanguage::EShLangFragment); },
+                      &compiled);
+    }
+    jobSystem.wait(compiled);
+
+    const Handle<HandleType::Pipeline> handle = m_graphicsBackend.createGraphicsPipeline(vertexShader.spirvCode, fragmentShader.spirvCode);
+    if (m_shaderHotReload)
+    {
+        m_shaderHotReload->watch(vertexShaderPath, vertexShader);
+        m_shaderHotReload->watch(fragmentShaderPath, fragmentShader);
+        m_shaderHotReload->renderPipelines.push_back(ShaderHotReload::RenderPipeline{handle, vertexShaderPath, fragmentShaderPath});
+    }
+    return handle;
+}
 
-    const Shader vertexShader = shaderCompiler.compileShader("vertexShader", "shaders/shader.vert", EShLanguage::EShLangVertex);
-    const Shader fragmentShader = shaderCompiler.compileShader("fragmentShader", "shaders/shader.frag", EShLanguage::EShLangFragment);
+void Renderer::destroyRenderPipeline(Handle<HandleType::Pipeline> handle)
+{
+    m_graphicsBackend.destroyGraphicsPipeline(handle);
+    if (m_shaderHotReload)
+    {
+        std::erase_if(m_shaderHotReload->renderPipelines, [handle](const ShaderHotReload::RenderPipeline& pipeline)
+                      { return pipeline.handle.getId() == handle.getId(); });
+    }
+}
+
+void Renderer::reloadChangedShaders()
+{
+    if (!m_shaderHotReload)
+    {
+        return;
+    }
+    TRACE_ZONE("Renderer::reloadChangedShaders");
+    ShaderHotReload& hotReload = *m_shaderHotReload;
+
+    for (const std::string& changedPath : hotReload.watcher.pollChanges())
+    {
+        for (const auto& [path, shader] : hotReload.shaders)
+        {
+            if (hotReload.isAffected(path, changedPath) && std::find(hotReload.changedShaders.begin(), hotReload.changedShaders.end(), path) == hotReload.changedShaders.end())
+            {
+                hotReload.changedShaders.push_back(path);
+            }
+        }
+    }
+
+    if (hotReload.compilation)
+    {
+        if (!hotReload.compilation->compiled.isDone())
+        {
+            return;
+        }
+
+        // Compilers print their errors, the previous versions stay in use
+        const ShaderCompilation& compilation = *hotReload.compilation;
+        std::vector<std::string> reloadedPaths;
+        for (size_t i = 0; i < compilation.paths.size(); ++i)
+        {
+            if (compilation.isFailed[i])
+            {
+                std::cerr << "Failed to reload " << compilation.paths[i] << ", keeping the previous version" << std::endl;
+                continue;
+            }
+            hotReload.watch(compilation.paths[i], compilation.shaders[i]);
+            reloadedPaths.push_back(compilation.paths[i]);
+        }
+        hotReload.compilation.reset();
 
-    m_graphicsBackend.createGraphicsPipeline(vertexShader.spirvCode, fragmentShader.spirvCode);
-    m_graphicsBackend.createFramebuffers();
+        auto isReloaded = [&reloadedPaths](const std::string& path)
+        { return std::find(reloadedPaths.begin(), reloadedPaths.end(), path) != reloadedPaths.end(); };
+        auto replacePipeline = [](const std::string& name, const std::function<void()>& replace)
+        {
+            try
+            {
+                replace();
+                std::cout << "Reloaded " << name << std::endl;
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Failed to rebuild the pipeline of " << name << ": " << e.what() << std::endl;
+            }
+        };
+        if (isReloaded(clusterCullingShaderPath))
+        {
+            replacePipeline(clusterCullingShaderPath, [&]()
+                            { m_graphicsBackend.createClusterCullingPipeline(hotReload.shaders.at(clusterCullingShaderPath).spirvCode); });
+        }
+        if (isReloaded(instanceCullingShaderPath))
+        {
+            replacePipeline(instanceCullingShaderPath, [&]()
+                            { m_graphicsBackend.createInstanceCullingPipeline(hotReload.shaders.at(instanceCullingShaderPath).spirvCode); });
+        }
+        if (isReloaded(instanceUploadShaderPath))
+        {
+            replacePipeline(instanceUploadShaderPath, [&]()
+                            { m_graphicsBackend.createInstanceUploadPipeline(hotReload.shaders.at(instanceUploadShaderPath).spirvCode); });
+        }
+        for (const ShaderHotReload::RenderPipeline& pipeline : hotReload.renderPipelines)
+        {
+            if (isReloaded(pipeline.vertexShaderPath) || isReloaded(pipeline.fragmentShaderPath))
+            {
+                replacePipeline(pipeline.vertexShaderPath + " and " + pipeline.fragmentShaderPath, [&]()
+                                { m_graphicsBackend.replaceGraphicsPipeline(pipeline.handle, hotReload.shaders.at(pipeline.vertexShaderPath).spirvCode, hotReload.shaders.at(pipeline.fragmentShaderPath).spirvCode); });
+            }
+        }
+    }
+
+    if (hotReload.changedShaders.empty())
+    {
+        return;
+    }
+
+    // Shaders changed while compiling are compiled again once this finishes
+    auto compilation = std::make_shared<ShaderCompilation>();
+    compilation->paths = std::move(hotReload.changedShaders);
+    hotReload.changedShaders.clear();
+    compilation->shaders.resize(compilation->paths.size());
+    compilation->isFailed.resize(compilation->paths.size(), 0u);
+    for (size_t i = 0; i < compilation->paths.size(); ++i)
+    {
+        const EShLanguage stage = getShaderStage(compilation->paths[i]);
+        JobSystem::get().run([compilation = compilation.get(), i, stage]()
+                             {
+                                 const std::string& path = compilation->paths[i];
+                                 try
+                                 {
+                                     compilation->shaders[i] = compilation->compiler.compileShader(std::filesystem::path(path).stem().string(), resolveShaderPath(path), stage);
+                                 }
+                                 catch (const std::exception&)
+                                 {
+                                     compilation->isFailed[i] = 1u;
+                                 }
+                             },
+                             &compilation->compiled);
+    }
+    hotReload.compilation = std::move(compilation);
+}
+
+Handle<HandleType::Mesh> Renderer::addMesh(const std::string& meshName)
+{
+    const LoadedMesh& loadedMesh = m_cpuResourceManager.loadMesh(meshName);
+    const Handle<HandleType::Mesh> handle = m_graphicsBackend.createMesh(loadedMesh.quantizedMesh.vertices, loadedMesh.lodChain);
+    m_drawListMeshes[handle.getId()] = toDrawListMesh(loadedMesh.lodChain);
+    return handle;
+}
+
+std::vector<Handle<HandleType::Mesh>> Renderer::addMeshes(std::span<const std::string> meshNames)
+{
+    TRACE_ZONE("Renderer::addMeshes");
+    const std::vector<const LoadedMesh*> loadedMeshes = m_cpuResourceManager.loadMeshes(meshNames);
+
+    std::vector<Handle<HandleType::Mesh>> handles;
+    handles.reserve(loadedMeshes.size());
+    for (const LoadedMesh* loadedMesh : loadedMeshes)
+    {
+        handles.push_back(m_graphicsBackend.createMesh(loadedMesh->quantizedMesh.vertices, loadedMesh->lodChain));
+        m_drawListMeshes[handles.back().getId()] = toDrawListMesh(loadedMesh->lodChain);
+    }
+    return handles;
+}
+
+void Renderer::removeMesh(Handle<HandleType::Mesh> handle)
+{
+    m_graphicsBackend.destroyMesh(handle);
+    m_drawListMeshes.erase(handle.getId());
+}
+
+Handle<HandleType::Instance> Renderer::addInstance(const DrawInstance& instance)
+{
+    // Handle ids are 16 bit
+    if (m_gpuInstances.size() > std::numeric_limits<uint16_t>::max())
+    {
+        throw std::runtime_error("Too many instances!");
+    }
+    const auto slot = static_cast<uint32_t>(m_gpuInstances.size());
+    const Handle<HandleType::Instance> handle = m_instanceSlots.insertElement(slot);
+    m_slotInstances.push_back(handle);
+    m_gpuInstances.push_back(toGpuInstance(instance));
+    m_isInstanceDirty.push_back(0u);
+    markInstanceDirty(slot);
+    return handle;
+}
+
+void Renderer::updateInstance(Handle<HandleType::Instance> handle, const DrawInstance& instance)
+{
+    const uint32_t slot = m_instanceSlots.getElement(handle);
+    m_gpuInstances[slot] = toGpuInstance(instance);
+    markInstanceDirty(slot);
+}
+
+void Renderer::removeInstance(Handle<HandleType::Instance> handle)
+{
+    const uint32_t slot = m_instanceSlots.popElement(handle);
+    const auto lastSlot = static_cast<uint32_t>(m_gpuInstances.size() - 1);
+    if (slot != lastSlot)
+    {
+        m_gpuInstances[slot] = m_gpuInstances[lastSlot];
+        m_slotInstances[slot] = m_slotInstances[lastSlot];
+        m_instanceSlots.getElement(m_slotInstances[slot]) = slot;
+        markInstanceDirty(slot);
+    }
+    m_gpuInstances.pop_back();
+    m_slotInstances.pop_back();
+    m_isInstanceDirty.pop_back();
+}
+
+size_t Renderer::getInstanceCount() const
+{
+    return m_gpuInstances.size();
+}
+
+void Renderer::submitDraw(Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> material, const glm::mat4& transform)
+{
+    m_drawList.submit(mesh, material, transform);
+}
+
+void Renderer::markInstanceDirty(uint32_t slot)
+{
+    if (!m_isInstanceDirty[slot])
+    {
+        m_isInstanceDirty[slot] = 1u;
+        m_dirtyInstances.push_back(slot);
+    }
+}
+
+void Renderer::drawFrame(const Camera& camera)
+{
+    TRACE_ZONE("Renderer::drawFrame");
+    reloadChangedShaders();
+
+    m_instanceUpdates.clear();
+    for (const uint32_t slot : m_dirtyInstances)
+    {
+        // Slots removed after being marked are past the end, repeated ones are no longer dirty
+        if (slot < m_gpuInstances.size() && m_isInstanceDirty[slot])
+        {
+            m_instanceUpdates.push_back(Vulkan::GpuInstanceUpdate{slot, {0u, 0u, 0u}, m_gpuInstances[slot]});
+            m_isInstanceDirty[slot] = 0u;
+        }
+    }
+    m_dirtyInstances.clear();
+
+    Vulkan::FrameView view{};
+    view.viewProjection = camera.projection * camera.view;
+    view.frustumPlanes = extractFrustum(view.viewProjection).planes;
+    view.cameraPosition = camera.position;
+    view.lodProjectionScale = computeLodProjectionScale(camera.verticalFov, static_cast<float>(m_resolution.y));
+    view.maxLodPixelError = m_maxLodPixelError;
+
+    const Vulkan::InstancedDrawList drawList = m_drawList.build(m_drawListMeshes, Frustum{view.frustumPlanes}, camera.position, LodSelectionSettings{view.lodProjectionScale, m_maxLodPixelError});
+    m_drawList.clear();
+    m_graphicsBackend.drawFrame(static_cast<uint32_t>(m_gpuInstances.size()), m_instanceUpdates, view, drawList, m_meshletDraws);
+    m_meshletDraws.clear();
+}
+
+void Renderer::setMaxLodPixelError(float pixels)
+{
+    m_maxLodPixelError = pixels;
+}
+
+std::vector<Vulkan::GpuScopeStatistics> Renderer::getGpuProfile() const
+{
+    return m_graphicsBackend.getGpuProfile();
+}
+
+Handle<HandleType::Texture> Renderer::addStreamedTexture(const std::string& assetName, uint32_t width, uint32_t height, uint32_t mipCount, VkFormat format)
+{
+    const Handle<HandleType::Texture> handle = m_graphicsBackend.createStreamedTexture(width, height, mipCount, format);
+
+    uint32_t tailMip = 0u;
+    while (tailMip + 1 < mipCount && std::max(width >> tailMip, height >> tailMip) > textureTailMipSize)
+    {
+        ++tailMip;
+    }
+
+    std::vector<uint64_t> mipSizes(mipCount);
+    for (uint32_t mip = 0; mip < mipCount; ++mip)
+    {
+        mipSizes[mip] = m_graphicsBackend.getStreamedTextureMipSize(handle, mip);
+    }
+
+    m_textureResidencyManager.addTexture(handle.getId(), std::move(mipSizes), tailMip);
+    m_streamedTextureSources.emplace(handle.getId(), StreamedTextureSource{handle, assetName});
+
+    // Mips load on the job system, so the name is copied
+    m_graphicsBackend.updateStreamedTexture(handle, tailMip, [this, assetName](uint32_t mip, std::span<std::byte> destination)
+                                            { loadStreamedTextureMip(assetName, mip, destination); });
+    return handle;
+}
+
+void Renderer::removeStreamedTexture(Handle<HandleType::Texture> handle)
+{
+    m_textureResidencyManager.removeTexture(handle.getId());
+    m_streamedTextureSources.erase(handle.getId());
+    m_graphicsBackend.destroyStreamedTexture(handle);
+}
+
+void Renderer::updateTextureStreaming()
+{
+    TRACE_ZONE("Renderer::updateTextureStreaming");
+    updateTextureStreamingBudget();
+    m_textureResidencyManager.processFeedback(m_graphicsBackend.readTextureFeedback(), m_frameIndex++);
+
+    for (const TextureResidencyChange& change : m_textureResidencyManager.update())
+    {
+        const StreamedTextureSource& source = m_streamedTextureSources.at(change.textureId);
+        m_graphicsBackend.updateStreamedTexture(source.handle, change.newResidentMip, [this, assetName = source.assetName](uint32_t mip, std::span<std::byte> destination)
+                                                { loadStreamedTextureMip(assetName, mip, destination); });
+    }
+}
+
+void Renderer::updateTextureStreamingBudget()
+{
+    // Streamed textures give memory back when other allocations, or other processes, push the device toward its
+    // budget. Resident texture memory is part of the usage, so streaming in or evicting mips does not move the limit.
+    const Vulkan::MemoryReport& memoryReport = m_graphicsBackend.getMemoryReport();
+    const int64_t reserve = static_cast<int64_t>(memoryReport.heaps[memoryReport.primaryHeapIndex].budget / 100u * deviceMemoryReservePercent);
+    const int64_t available = static_cast<int64_t>(m_textureResidencyManager.getResidentBytes()) + m_graphicsBackend.getDeviceMemoryHeadroom() - reserve;
+    m_textureResidencyManager.setMemoryBudget(static_cast<uint64_t>(std::clamp<int64_t>(available, 0, textureStreamingBudget)));
+}
+
+const Vulkan::MemoryReport& Renderer::getMemoryReport() const
+{
+    return m_graphicsBackend.getMemoryReport();
+}
+
+Handle<HandleType::Geometry> Renderer::addMeshletMesh(const std::string& meshName)
+{
+    TRACE_ZONE("Renderer::addMeshletMesh");
+    const LoadedMesh& loadedMesh = m_cpuResourceManager.loadMesh(meshName);
+    const MeshletMesh meshletMesh = MeshletGeneration::buildMeshlets(loadedMesh.mesh.vertices, loadedMesh.mesh.indices);
+    return m_graphicsBackend.createMeshletGeometry(loadedMesh.quantizedMesh.vertices, meshletMesh);
+}
+
+void Renderer::removeMeshletMesh(Handle<HandleType::Geometry> handle)
+{
+    m_graphicsBackend.destroyMeshletGeometry(handle);
+}
+
+void Renderer::submitMeshletDraw(Handle<HandleType::Geometry> mesh, Handle<HandleType::Pipeline> pipeline, const glm::mat4& transform)
+{
+    m_meshletDraws.push_back(Vulkan::MeshletDraw{mesh, pipeline, transform});
+}
+
+void Renderer::loadStreamedTextureMip(const std::string& assetName, uint32_t mip, std::span<std::byte> destination) const
+{
+    m_cpuResourceManager.loadAssetInto(getTextureMipAssetName(assetName, mip), destination);
 }
\ No newline at end of file
@@ -7,16 +7,186 @@
 
 #include "../CPUResourceManager.h"
 #include "../Window.h"
+#include "DrawList.h"
+#include "TextureResidencyManager.h"
 #include "Backend/Vulkan/VulkanBackend.h"
 
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Camera
+{
+    glm::mat4 view;
+    glm::mat4 projection; // Vulkan clip space, depth from 0 to 1
+    glm::vec3 position;
+    float verticalFov; // Radians
+};
+
+struct DrawInstance
+{
+    glm::mat4 model;
+    Handle<HandleType::Mesh> mesh;
+    Handle<HandleType::Pipeline> pipeline;
+    bool isVisible{true};
+    std::optional<Handle<HandleType::Texture>> texture; // From addStreamedTexture(), sampled by the fragment shader
+};
+
+/**
+ * Shaders compiling on the job system, see Renderer::compileShadersAsync()
+ */
+struct ShaderCompilation;
+
+/**
+ * Watched shaders and the pipelines using them, see Renderer::reloadChangedShaders()
+ */
+struct ShaderHotReload;
+
 class Renderer
 {
 public:
-    Renderer(Window& window, const CPUResourceManager& cpuResourceManager);
+    /**
+     * @param shaderCompilation From compileShadersAsync(), or null to compile the renderer's own shaders here. The
+     * backend is created while they compile.
+     */
+    Renderer(Window& window, CPUResourceManager& cpuResourceManager, std::shared_ptr<ShaderCompilation> shaderCompilation = nullptr);
+
+    /**
+     * Start compiling the renderer's own shaders and the given .vert, .frag and .comp shaders, so that compilation
+     * overlaps window and device creation. Render pipelines created from these paths reuse the compiled shaders.
+     *
+     * Built with VULKANPROJECT_ENABLE_SHADER_HOT_RELOAD, paths in the shaders directory are read from the source tree
+     * instead of the copy next to the executable, and drawFrame() reloads them when they change.
+     */
+    static std::shared_ptr<ShaderCompilation> compileShadersAsync(std::vector<std::string> shaderPaths);
+
+    /**
+     * Compile a pipeline for drawing meshes added with addMesh(). Draw cost on the CPU grows with the number of
+     * pipelines, not with the number of instances using them.
+     */
+    Handle<HandleType::Pipeline> createRenderPipeline(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
+    void destroyRenderPipeline(Handle<HandleType::Pipeline> handle);
+
+    /**
+     * Load a mesh with its LOD chain into the shared geometry buffers
+     */
+    Handle<HandleType::Mesh> addMesh(const std::string& meshName);
+
+    /**
+     * Like addMesh(), but loads and processes the meshes in parallel on the job system
+     */
+    std::vector<Handle<HandleType::Mesh>> addMeshes(std::span<const std::string> meshNames);
+    void removeMesh(Handle<HandleType::Mesh> handle);
 
-    void createRenderPipeline(std::string_view vertexShaderPath, std::string_view fragmentShaderPath);
+    /**
+     * Instances persist on the GPU until removed. Adding, updating and removing marks them dirty, and only dirty
+     * instances are uploaded by the next drawFrame().
+     */
+    Handle<HandleType::Instance> addInstance(const DrawInstance& instance);
+    void updateInstance(Handle<HandleType::Instance> handle, const DrawInstance& instance);
+    void removeInstance(Handle<HandleType::Instance> handle);
+    size_t getInstanceCount() const;
+
+    /**
+     * Draw a mesh with a pipeline from addMesh() and createRenderPipeline() in the next drawFrame() only. Submitted
+     * draws are culled and sorted on the CPU and draws of the same mesh, LOD and pipeline are merged into one
+     * instanced draw. For objects that stay in the scene, persistent instances are cheaper.
+     */
+    void submitDraw(Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> material, const glm::mat4& transform);
+
+    /**
+     * Swap in shaders that were edited and have finished recompiling, if hot reload is enabled.
+     * Upload the dirty instances, then cull all instances, pick their LODs and draw them, all on the GPU. Draws
+     * submitted since the last frame are drawn after them. Blocks only when the GPU is more than the frames in flight
+     * behind.
+     */
+    void drawFrame(const Camera& camera);
+
+    /**
+     * Coarser LODs are drawn while their geometric error projects to at most this many pixels
+     */
+    void setMaxLodPixelError(float pixels);
+
+    /**
+     * GPU time and pipeline statistics of every render pass, averaged over the last frames
+     */
+    std::vector<Vulkan::GpuScopeStatistics> getGpuProfile() const;
+
+    /**
+     * Register a texture whose mips are streamed from its cooked mip assets based on shader feedback
+     */
+    Handle<HandleType::Texture> addStreamedTexture(const std::string& assetName, uint32_t width, uint32_t height, uint32_t mipCount, VkFormat format);
+    void removeStreamedTexture(Handle<HandleType::Texture> handle);
+
+    /**
+     * Read the texture feedback of the frames the GPU has finished and stream in or evict mips. Call once per frame,
+     * the new mips are loaded on the job system and uploaded and swapped in by the first drawFrame() after they have
+     * loaded, without waiting for the loads or the GPU. Mips are also evicted when the device runs low on memory, down
+     * to the always resident tail mips.
+     */
+    void updateTextureStreaming();
+
+    /**
+     * GPU memory budget and usage per heap and per resource category
+     */
+    const Vulkan::MemoryReport& getMemoryReport() const;
+
+    /**
+     * Load a mesh, split it into meshlets and upload it for cluster culled drawing with submitMeshletDraw()
+     */
+    Handle<HandleType::Geometry> addMeshletMesh(const std::string& meshName);
+    void removeMeshletMesh(Handle<HandleType::Geometry> handle);
+
+    /**
+     * Draw a mesh from addMeshletMesh() in the next drawFrame() only. Its meshlets are culled against the view and by
+     * their normal cones on the GPU, then the visible ones are drawn with the pipeline. Each mesh can be submitted once
+     * per frame.
+     */
+    void submitMeshletDraw(Handle<HandleType::Geometry> mesh, Handle<HandleType::Pipeline> pipeline, const glm::mat4& transform);
 private:
+    void createComputePipelines();
+    void markInstanceDirty(uint32_t slot);
+
+    /**
+     * Start recompiling shaders whose source or includes changed in the background. Once they are compiled, rebuild
+     * the pipelines using them. Pipelines of shaders that fail to compile are kept as they are.
+     */
+    void reloadChangedShaders();
+    void updateTextureStreamingBudget();
+    void loadStreamedTextureMip(const std::string& assetName, uint32_t mip, std::span<std::byte> destination) const;
+
+    CPUResourceManager& m_cpuResourceManager;
+    glm::uvec2 m_resolution;
+    std::shared_ptr<ShaderCompilation> m_shaderCompilation; // Started before m_graphicsBackend is created
+    std::shared_ptr<ShaderHotReload> m_shaderHotReload; // Null without hot reload
     Vulkan::VulkanBackend m_graphicsBackend;
+
+    // Instances are packed in slots matching the GPU instance buffer, removal moves the last one into the hole
+    HandleStorage<HandleType::Instance, uint32_t> m_instanceSlots;
+    std::vector<Handle<HandleType::Instance>> m_slotInstances;
+    std::vector<Vulkan::GpuInstance> m_gpuInstances;
+    std::vector<uint8_t> m_isInstanceDirty; // Per slot
+    std::vector<uint32_t> m_dirtyInstances; // Slots, may contain removed or repeated ones
+    std::vector<Vulkan::GpuInstanceUpdate> m_instanceUpdates;
+    float m_maxLodPixelError{1.0f};
+
+    DrawList m_drawList;
+    std::unordered_map<uint32_t, DrawListMesh> m_drawListMeshes; // By mesh handle id
+    std::vector<Vulkan::MeshletDraw> m_meshletDraws;
+
+    struct StreamedTextureSource
+    {
+        Handle<HandleType::Texture> handle;
+        std::string assetName;
+    };
+    TextureResidencyManager m_textureResidencyManager;
+    std::unordered_map<uint32_t, StreamedTextureSource> m_streamedTextureSources;
+    uint64_t m_frameIndex{0u};
 };
 
 
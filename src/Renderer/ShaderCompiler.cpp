@@ -1,10 +1,13 @@
 #include "ShaderCompiler.h"
 
 #include "../Utilities/Filesystem.h"
+#include "../Utilities/Trace.h"
 
 #include <glslang/SPIRV/GlslangToSpv.h>
 #include <glslang/SPIRV/Logger.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
 
@@ -126,15 +129,56 @@ TBuiltInResource getDefaultResource()
 class Includer : public glslang::TShader::Includer
 {
 public:
-    Includer(){};
+    Includer(std::filesystem::path shaderDirectory) :
+        m_shaderDirectory(std::move(shaderDirectory))
+    {
+    }
+
+    // #include "file" is resolved relative to the including file
+    IncludeResult* includeLocal(const char* headerName, const char* includerName, size_t inclusionDepth) override
+    {
+        const std::filesystem::path includerDirectory = (includerName != nullptr && includerName[0] != '\0') ? std::filesystem::path(includerName).parent_path() : m_shaderDirectory;
+        return include(includerDirectory / headerName);
+    }
+
+    // #include <file> is resolved relative to the shared include directory
+    IncludeResult* includeSystem(const char* headerName, const char* includerName, size_t inclusionDepth) override
+    {
+        return include(m_shaderDirectory / "include" / headerName);
+    }
+
+    const std::vector<std::string>& getIncludedPaths() const
+    {
+        return m_includedPaths;
+    }
 
     void releaseInclude(IncludeResult* result) override
     {
         if (result != nullptr)
         {
-            throw std::runtime_error("Unimplemented!");
+            delete static_cast<std::vector<char>*>(result->userData);
+            delete result;
+        }
+    }
+
+private:
+    IncludeResult* include(const std::filesystem::path& path)
+    {
+        if (!std::filesystem::exists(path))
+        {
+            return nullptr;
+        }
+        auto* data = new std::vector<char>(FileSystem::loadTextFile(path.string()));
+        const std::string normalizedPath = path.lexically_normal().string();
+        if (std::find(m_includedPaths.begin(), m_includedPaths.end(), normalizedPath) == m_includedPaths.end())
+        {
+            m_includedPaths.push_back(normalizedPath);
         }
+        return new IncludeResult(path.string(), data->data(), data->size(), data);
     }
+
+    std::filesystem::path m_shaderDirectory;
+    std::vector<std::string> m_includedPaths;
 };
 
 }
@@ -151,12 +195,16 @@ ShaderCompiler::~ShaderCompiler()
 
 Shader ShaderCompiler::compileShader(std::string name, std::string path, EShLanguage stage)
 {
+    TRACE_ZONE("ShaderCompiler::compileShader");
     std::vector<char> data = FileSystem::loadTextFile(path);
     data.push_back('\0');
     const char* dataPointer = data.data();
 
+    const char* pathPointer = path.c_str();
+    const int dataLength = static_cast<int>(data.size() - 1);
+
     glslang::TShader shader(stage);
-    shader.setStrings(&dataPointer, 1);
+    shader.setStringsWithLengthsAndNames(&dataPointer, &dataLength, &pathPointer, 1);
 
     std::string preamble = "#extension GL_GOOGLE_include_directive : require\n";
     shader.setPreamble(preamble.c_str());
@@ -171,7 +219,7 @@ Shader ShaderCompiler::compileShader(std::string name, std::string path, EShLang
     EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgVulkanRules);
     constexpr int glslVersion = 450;
 
-    Includer includer{};
+    Includer includer(std::filesystem::path(path).parent_path());
     std::string processedShaderCode;
 
     if (!shader.preprocess(&resources, glslVersion, ENoProfile, false, false, messages, &processedShaderCode, includer))
@@ -204,7 +252,7 @@ Shader ShaderCompiler::compileShader(std::string name, std::string path, EShLang
         throw std::runtime_error("Failed to link shader code!");
     }
 
-    Shader output{.name = name, .stage = stage};
+    Shader output{.name = name, .stage = stage, .includedPaths = includer.getIncludedPaths()};
     spv::SpvBuildLogger logger;
     glslang::SpvOptions spvOptions;
     glslang::GlslangToSpv(*shaderProgram.getIntermediate(stage), output.spirvCode, &logger, &spvOptions);
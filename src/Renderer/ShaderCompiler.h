@@ -17,6 +17,7 @@ struct Shader
     std::string name;
     EShLanguage stage;
     std::vector<uint32_t> spirvCode;
+    std::vector<std::string> includedPaths; // Every file pulled in by #include, for recompiling when one changes
 };
 
 class ShaderCompiler
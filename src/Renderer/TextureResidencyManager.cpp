@@ -0,0 +1,188 @@
+#include "TextureResidencyManager.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+TextureResidencyManager::TextureResidencyManager(uint64_t memoryBudget, uint64_t maxStreamedBytesPerUpdate) :
+    m_memoryBudget(memoryBudget),
+    m_maxStreamedBytesPerUpdate(maxStreamedBytesPerUpdate)
+{
+}
+
+void TextureResidencyManager::addTexture(uint32_t textureId, std::vector<uint64_t> mipSizes, uint32_t tailMip)
+{
+    if (mipSizes.empty() || tailMip >= mipSizes.size())
+    {
+        throw std::runtime_error("Streamed texture needs at least one mip in its tail!");
+    }
+    if (m_textures.find(textureId) != m_textures.end())
+    {
+        throw std::runtime_error("Streamed texture is already registered!");
+    }
+
+    Texture texture{};
+    texture.mipSizes = std::move(mipSizes);
+    texture.tailMip = tailMip;
+    texture.residentMip = tailMip;
+    texture.requestedMip = tailMip;
+    texture.lastUsedFrame = m_currentFrame;
+
+    for (size_t mip = tailMip; mip < texture.mipSizes.size(); ++mip)
+    {
+        m_residentBytes += texture.mipSizes[mip];
+    }
+
+    m_lru.push_front(textureId);
+    texture.lruPosition = m_lru.begin();
+    m_textures.emplace(textureId, std::move(texture));
+}
+
+void TextureResidencyManager::removeTexture(uint32_t textureId)
+{
+    const auto it = m_textures.find(textureId);
+    if (it == m_textures.end())
+    {
+        return;
+    }
+    const Texture& texture = it->second;
+    for (size_t mip = texture.residentMip; mip < texture.mipSizes.size(); ++mip)
+    {
+        m_residentBytes -= texture.mipSizes[mip];
+    }
+    m_lru.erase(texture.lruPosition);
+    m_textures.erase(it);
+}
+
+void TextureResidencyManager::processFeedback(std::span<const uint32_t> feedback, uint64_t frameIndex)
+{
+    m_currentFrame = frameIndex;
+
+    for (auto& [textureId, texture] : m_textures)
+    {
+        if (textureId >= feedback.size() || feedback[textureId] == noFeedback)
+        {
+            continue;
+        }
+        texture.requestedMip = std::min<uint32_t>(feedback[textureId], texture.tailMip);
+        texture.lastUsedFrame = frameIndex;
+        m_lru.splice(m_lru.begin(), m_lru, texture.lruPosition);
+    }
+}
+
+bool TextureResidencyManager::evictOneMip(uint32_t protectedTextureId, std::unordered_map<uint32_t, uint32_t>& originalResidentMips)
+{
+    // Walk from the least recently used texture. Textures sampled this frame are only trimmed down to what they requested.
+    for (auto it = m_lru.rbegin(); it != m_lru.rend(); ++it)
+    {
+        const uint32_t textureId = *it;
+        Texture& texture = m_textures.at(textureId);
+
+        if (textureId == protectedTextureId || texture.residentMip >= texture.tailMip)
+        {
+            continue;
+        }
+        if (texture.lastUsedFrame == m_currentFrame && texture.residentMip >= texture.requestedMip)
+        {
+            continue;
+        }
+
+        originalResidentMips.try_emplace(textureId, texture.residentMip);
+        m_residentBytes -= texture.mipSizes[texture.residentMip];
+        ++texture.residentMip;
+        return true;
+    }
+    return false;
+}
+
+std::vector<TextureResidencyChange> TextureResidencyManager::update()
+{
+    std::unordered_map<uint32_t, uint32_t> originalResidentMips;
+
+    // Budget may have been lowered since the last update
+    while (m_residentBytes > m_memoryBudget && evictOneMip(noFeedback, originalResidentMips))
+    {
+    }
+
+    std::vector<uint32_t> wantedTextures;
+    for (const uint32_t textureId : m_lru)
+    {
+        const Texture& texture = m_textures.at(textureId);
+        if (texture.lastUsedFrame == m_currentFrame && texture.requestedMip < texture.residentMip)
+        {
+            wantedTextures.push_back(textureId);
+        }
+    }
+    std::stable_sort(wantedTextures.begin(), wantedTextures.end(), [this](uint32_t a, uint32_t b)
+                     {
+                         const Texture& textureA = m_textures.at(a);
+                         const Texture& textureB = m_textures.at(b);
+                         return textureA.residentMip - textureA.requestedMip > textureB.residentMip - textureB.requestedMip;
+                     });
+
+    // Stream in one mip level per texture per round so that the most needed textures get refined first
+    uint64_t streamedBytes = 0u;
+    bool streamingStopped = false;
+    bool progress = true;
+
+    while (progress && !streamingStopped)
+    {
+        progress = false;
+        for (const uint32_t textureId : wantedTextures)
+        {
+            Texture& texture = m_textures.at(textureId);
+            if (texture.requestedMip >= texture.residentMip)
+            {
+                continue;
+            }
+
+            const uint64_t mipSize = texture.mipSizes[texture.residentMip - 1];
+            if (streamedBytes + mipSize > m_maxStreamedBytesPerUpdate)
+            {
+                streamingStopped = true;
+                break;
+            }
+
+            bool fitsInBudget = true;
+            while (m_residentBytes + mipSize > m_memoryBudget)
+            {
+                if (!evictOneMip(textureId, originalResidentMips))
+                {
+                    fitsInBudget = false;
+                    break;
+                }
+            }
+            if (!fitsInBudget)
+            {
+                streamingStopped = true;
+                break;
+            }
+
+            originalResidentMips.try_emplace(textureId, texture.residentMip);
+            --texture.residentMip;
+            m_residentBytes += mipSize;
+            streamedBytes += mipSize;
+            progress = true;
+        }
+    }
+
+    std::vector<TextureResidencyChange> changes;
+    for (const auto& [textureId, originalResidentMip] : originalResidentMips)
+    {
+        const uint32_t residentMip = m_textures.at(textureId).residentMip;
+        if (residentMip != originalResidentMip)
+        {
+            changes.push_back(TextureResidencyChange{textureId, originalResidentMip, residentMip});
+        }
+    }
+    return changes;
+}
+
+void TextureResidencyManager::setMemoryBudget(uint64_t memoryBudget)
+{
+    m_memoryBudget = memoryBudget;
+}
+
+uint32_t TextureResidencyManager::getResidentMip(uint32_t textureId) const
+{
+    return m_textures.at(textureId).residentMip;
+}
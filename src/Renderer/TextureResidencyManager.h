@@ -0,0 +1,74 @@
+#ifndef VULKANPROJECT_TEXTURERESIDENCYMANAGER_H
+#define VULKANPROJECT_TEXTURERESIDENCYMANAGER_H
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+struct TextureResidencyChange
+{
+    uint32_t textureId;
+    uint32_t oldResidentMip;
+    uint32_t newResidentMip; // Smaller than oldResidentMip when mips have to be streamed in, larger when mips are evicted
+};
+
+/**
+ * Decides which mip levels of streamed textures are resident in GPU memory.
+ * Shaders write the finest mip they wanted to sample for each texture to a feedback buffer, which is fed to
+ * processFeedback(). update() then streams in missing mips one level at a time while staying under the memory budget,
+ * evicting the top mips of least recently used textures when needed. Mips from the tail mip onward are always resident.
+ */
+class TextureResidencyManager
+{
+public:
+    static constexpr uint32_t noFeedback = std::numeric_limits<uint32_t>::max();
+
+    TextureResidencyManager(uint64_t memoryBudget, uint64_t maxStreamedBytesPerUpdate);
+
+    /**
+     * Start tracking a texture. Mips [tailMip, mipSizes.size()) are counted as resident immediately.
+     */
+    void addTexture(uint32_t textureId, std::vector<uint64_t> mipSizes, uint32_t tailMip);
+    void removeTexture(uint32_t textureId);
+
+    /**
+     * @param feedback Finest requested mip per texture id, noFeedback if the texture was not sampled
+     */
+    void processFeedback(std::span<const uint32_t> feedback, uint64_t frameIndex);
+
+    /**
+     * Compute residency changes that the caller has to apply to the GPU textures
+     */
+    std::vector<TextureResidencyChange> update();
+
+    void setMemoryBudget(uint64_t memoryBudget);
+    uint64_t getMemoryBudget() const { return m_memoryBudget; }
+    uint64_t getResidentBytes() const { return m_residentBytes; }
+    uint32_t getResidentMip(uint32_t textureId) const;
+
+private:
+    struct Texture
+    {
+        std::vector<uint64_t> mipSizes;
+        uint32_t tailMip;
+        uint32_t residentMip;
+        uint32_t requestedMip;
+        uint64_t lastUsedFrame;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+
+    bool evictOneMip(uint32_t protectedTextureId, std::unordered_map<uint32_t, uint32_t>& originalResidentMips);
+
+    uint64_t m_memoryBudget;
+    uint64_t m_maxStreamedBytesPerUpdate;
+    uint64_t m_residentBytes{0u};
+    uint64_t m_currentFrame{0u};
+    std::unordered_map<uint32_t, Texture> m_textures;
+    std::list<uint32_t> m_lru; // Most recently used texture first
+};
+
+
+#endif // VULKANPROJECT_TEXTURERESIDENCYMANAGER_H
@@ -0,0 +1,50 @@
+#include "EntityRegistry.h"
+
+EntityRegistry::EntityRegistry() :
+    m_entities(1024u, 1024u)
+{
+}
+
+Entity EntityRegistry::createEntity()
+{
+    if (m_entityCount == maxEntities)
+    {
+        throw std::runtime_error("Too many entities!");
+    }
+    ++m_entityCount;
+    return m_entities.insertElement(m_version);
+}
+
+void EntityRegistry::destroyEntity(Entity entity)
+{
+    if (!isAlive(entity))
+    {
+        throw std::runtime_error("Destroying an entity that has already been destroyed!");
+    }
+    for (auto& [type, storage] : m_storages)
+    {
+        storage->remove(entity);
+    }
+    m_entities.popElement(entity);
+    --m_entityCount;
+}
+
+bool EntityRegistry::isAlive(Entity entity) const
+{
+    return m_entities.isValid(entity);
+}
+
+size_t EntityRegistry::getEntityCount() const
+{
+    return m_entityCount;
+}
+
+uint64_t EntityRegistry::getVersion() const
+{
+    return m_version;
+}
+
+void EntityRegistry::advanceVersion()
+{
+    ++m_version;
+}
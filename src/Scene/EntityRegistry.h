@@ -0,0 +1,351 @@
+#ifndef VULKANPROJECT_ENTITYREGISTRY_H
+#define VULKANPROJECT_ENTITYREGISTRY_H
+
+#include "../Renderer/Backend/Handle.h"
+#include "../Utilities/JobSystem.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+using Entity = Handle<HandleType::Entity>;
+
+class ComponentStorageBase
+{
+public:
+    virtual ~ComponentStorageBase() = default;
+
+    /**
+     * Remove the entity's component if it has one
+     */
+    virtual bool remove(Entity entity) = 0;
+};
+
+using EntityStorage = HandleStorage<HandleType::Entity, uint64_t>; // Version each entity was created in
+
+/**
+ * Sparse set of one component type. Components are packed in a dense array in no particular order, so systems iterate
+ * them linearly. The sparse array maps entity ids to dense indices, removal moves the last component into the hole.
+ *
+ * Every component remembers the registry version it was last added or marked changed in, which lets consumers such
+ * as renderer extraction process only what changed since they last ran.
+ */
+template<typename T>
+class ComponentStorage : public ComponentStorageBase
+{
+public:
+    static constexpr uint32_t notPresent = ~0u;
+
+    /**
+     * @param entities The registry's entities, which added components are checked against
+     */
+    explicit ComponentStorage(const EntityStorage& entities) :
+        m_aliveEntities(entities)
+    {
+    }
+
+    bool contains(Entity entity) const
+    {
+        return getDenseIndex(entity) != notPresent;
+    }
+
+    T& add(Entity entity, T component, uint64_t version)
+    {
+        // A stale handle would otherwise take over the sparse entry of the live entity reusing its id
+        if (!m_aliveEntities.isValid(entity))
+        {
+            throw std::runtime_error("Adding a component to an entity that has been destroyed!");
+        }
+
+        const uint32_t existingIndex = getDenseIndex(entity);
+        if (existingIndex != notPresent)
+        {
+            m_components[existingIndex] = std::move(component);
+            m_changedVersions[existingIndex] = version;
+            return m_components[existingIndex];
+        }
+
+        if (entity.getId() >= m_denseIndices.size())
+        {
+            m_denseIndices.resize(size_t(entity.getId()) + 1, notPresent);
+        }
+        m_denseIndices[entity.getId()] = static_cast<uint32_t>(m_components.size());
+        m_entities.push_back(entity);
+        m_components.push_back(std::move(component));
+        m_changedVersions.push_back(version);
+        return m_components.back();
+    }
+
+    bool remove(Entity entity) override
+    {
+        const uint32_t index = getDenseIndex(entity);
+        if (index == notPresent)
+        {
+            return false;
+        }
+        const uint32_t lastIndex = static_cast<uint32_t>(m_components.size() - 1);
+        if (index != lastIndex)
+        {
+            m_entities[index] = m_entities[lastIndex];
+            m_components[index] = std::move(m_components[lastIndex]);
+            m_changedVersions[index] = m_changedVersions[lastIndex];
+            m_denseIndices[m_entities[index].getId()] = index;
+        }
+        m_entities.pop_back();
+        m_components.pop_back();
+        m_changedVersions.pop_back();
+        m_denseIndices[entity.getId()] = notPresent;
+        return true;
+    }
+
+    /**
+     * @return Null when the entity does not have the component
+     */
+    T* find(Entity entity)
+    {
+        const uint32_t index = getDenseIndex(entity);
+        return index != notPresent ? &m_components[index] : nullptr;
+    }
+
+    const T* find(Entity entity) const
+    {
+        const uint32_t index = getDenseIndex(entity);
+        return index != notPresent ? &m_components[index] : nullptr;
+    }
+
+    /**
+     * Safe to call from parallel loops for distinct entities
+     */
+    void markChanged(Entity entity, uint64_t version)
+    {
+        const uint32_t index = getDenseIndex(entity);
+        if (index == notPresent)
+        {
+            throw std::runtime_error("Entity does not have the component!");
+        }
+        m_changedVersions[index] = version;
+    }
+
+    size_t size() const
+    {
+        return m_components.size();
+    }
+
+    // Dense arrays, all in the same order
+    std::span<const Entity> getEntities() const
+    {
+        return m_entities;
+    }
+    std::span<T> getComponents()
+    {
+        return m_components;
+    }
+    std::span<const T> getComponents() const
+    {
+        return m_components;
+    }
+    std::span<const uint64_t> getChangedVersions() const
+    {
+        return m_changedVersions;
+    }
+private:
+    uint32_t getDenseIndex(Entity entity) const
+    {
+        if (entity.getId() >= m_denseIndices.size())
+        {
+            return notPresent;
+        }
+        const uint32_t index = m_denseIndices[entity.getId()];
+        // A stale handle of a destroyed entity whose id has been reused does not see the new entity's component
+        if (index == notPresent || m_entities[index].getGeneration() != entity.getGeneration())
+        {
+            return notPresent;
+        }
+        return index;
+    }
+
+    const EntityStorage& m_aliveEntities;
+    std::vector<uint32_t> m_denseIndices; // Indexed by entity id
+    std::vector<Entity> m_entities;
+    std::vector<T> m_components;
+    std::vector<uint64_t> m_changedVersions;
+};
+
+/**
+ * Entities are generation checked handles, so handles of destroyed entities are detected instead of silently
+ * referring to whatever reuses their id. Components of each type live in their own ComponentStorage.
+ *
+ * Adding and removing components and entities is not thread safe. forEach() runs systems on the job system.
+ */
+class EntityRegistry
+{
+public:
+    static constexpr size_t maxEntities = size_t(std::numeric_limits<uint16_t>::max()) + 1; // Handle ids are 16 bit
+
+    EntityRegistry();
+    // Storages refer to m_entities, so the registry stays where it was created
+    EntityRegistry(const EntityRegistry&) = delete;
+    EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+    Entity createEntity();
+
+    /**
+     * Destroy the entity and all of its components
+     */
+    void destroyEntity(Entity entity);
+    bool isAlive(Entity entity) const;
+    size_t getEntityCount() const;
+
+    /**
+     * Add the component, or replace it if the entity already has one. Marks it changed.
+     */
+    template<typename T>
+    T& addComponent(Entity entity, T component)
+    {
+        return getStorage<T>().add(entity, std::move(component), m_version);
+    }
+
+    template<typename T>
+    void removeComponent(Entity entity)
+    {
+        getStorage<T>().remove(entity);
+    }
+
+    template<typename T>
+    bool hasComponent(Entity entity) const
+    {
+        const ComponentStorage<T>* storage = findStorage<T>();
+        return storage && storage->contains(entity);
+    }
+
+    template<typename T>
+    const T& getComponent(Entity entity) const
+    {
+        const ComponentStorage<T>* storage = findStorage<T>();
+        const T* component = storage ? storage->find(entity) : nullptr;
+        if (!component)
+        {
+            throw std::runtime_error("Entity does not have the component!");
+        }
+        return *component;
+    }
+
+    /**
+     * Mutable access that marks the component changed
+     */
+    template<typename T>
+    T& modifyComponent(Entity entity)
+    {
+        ComponentStorage<T>& storage = getStorage<T>();
+        storage.markChanged(entity, m_version);
+        return *storage.find(entity);
+    }
+
+    /**
+     * Mark a component written through forEach() changed. Safe to call from its function.
+     */
+    template<typename T>
+    void markChanged(Entity entity)
+    {
+        // Looked up with find() rather than getStorage(), which may insert and is not safe to call in parallel
+        const auto it = m_storages.find(std::type_index(typeid(T)));
+        if (it == m_storages.end())
+        {
+            throw std::runtime_error("Entity does not have the component!");
+        }
+        static_cast<ComponentStorage<T>&>(*it->second).markChanged(entity, m_version);
+    }
+
+    template<typename T>
+    ComponentStorage<T>& getStorage()
+    {
+        std::unique_ptr<ComponentStorageBase>& storage = m_storages[std::type_index(typeid(T))];
+        if (!storage)
+        {
+            storage = std::make_unique<ComponentStorage<T>>(m_entities);
+        }
+        return static_cast<ComponentStorage<T>&>(*storage);
+    }
+
+    /**
+     * @return Null when no component of the type has been added yet
+     */
+    template<typename T>
+    const ComponentStorage<T>* findStorage() const
+    {
+        const auto it = m_storages.find(std::type_index(typeid(T)));
+        return it != m_storages.end() ? static_cast<const ComponentStorage<T>*>(it->second.get()) : nullptr;
+    }
+
+    /**
+     * Version that components added or marked changed from now on get. Starts from 1.
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * Start a new version, typically once per frame. Components changed since a version v have a changed version
+     * greater than or equal to v.
+     */
+    void advanceVersion();
+
+    /**
+     * Call function(entity, T&, Others&...) for every entity that has all the components, in parallel on the job
+     * system. The dense array of T is walked linearly, so T should be the rarest of the components. The function must
+     * not add or remove components or entities.
+     */
+    template<typename T, typename... Others, typename Function>
+    void forEach(Function function)
+    {
+        forEachChanged<T, Others...>(0u, std::move(function));
+    }
+
+    /**
+     * Like forEach(), but only for entities whose T changed in sinceVersion or later
+     */
+    template<typename T, typename... Others, typename Function>
+    void forEachChanged(uint64_t sinceVersion, Function function)
+    {
+        ComponentStorage<T>& storage = getStorage<T>();
+        std::tuple<ComponentStorage<Others>&...> otherStorages(getStorage<Others>()...);
+        const std::span<const Entity> entities = storage.getEntities();
+        const std::span<T> components = storage.getComponents();
+        const std::span<const uint64_t> changedVersions = storage.getChangedVersions();
+
+        JobSystem::get().parallelFor(entities.size(), entitiesPerJob, [&](size_t begin, size_t end)
+                                     {
+                                         for (size_t i = begin; i < end; ++i)
+                                         {
+                                             if (changedVersions[i] < sinceVersion)
+                                             {
+                                                 continue;
+                                             }
+                                             const Entity entity = entities[i];
+                                             std::apply([&](ComponentStorage<Others>&... others)
+                                                        {
+                                                            if ((others.contains(entity) && ...))
+                                                            {
+                                                                function(entity, components[i], *others.find(entity)...);
+                                                            }
+                                                        },
+                                                        otherStorages);
+                                         }
+                                     });
+    }
+private:
+    static constexpr size_t entitiesPerJob = 4096u;
+
+    EntityStorage m_entities;
+    size_t m_entityCount{0u};
+    std::unordered_map<std::type_index, std::unique_ptr<ComponentStorageBase>> m_storages;
+    uint64_t m_version{1u};
+};
+
+
+#endif // VULKANPROJECT_ENTITYREGISTRY_H
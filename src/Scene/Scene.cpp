@@ -0,0 +1,117 @@
+#include "Scene.h"
+
+#include "../Utilities/Trace.h"
+
+Entity Scene::createObject(const LocalTransform& transform, std::optional<Entity> parent)
+{
+    const uint32_t parentNode = parent ? m_registry.getComponent<TransformComponent>(*parent).node : TransformHierarchy::noParent;
+    const Entity object = m_registry.createEntity();
+    const uint32_t node = m_transforms.addNode(parentNode, transform);
+    m_registry.addComponent(object, TransformComponent{node});
+    if (node >= m_nodeObjects.size())
+    {
+        m_nodeObjects.resize(size_t(node) + 1, object);
+    }
+    m_nodeObjects[node] = object;
+    return object;
+}
+
+void Scene::destroyObject(Entity object)
+{
+    // Objects whose nodes were removed with the subtree go too
+    const std::vector<uint32_t> removedNodes = m_transforms.removeNode(m_registry.getComponent<TransformComponent>(object).node);
+    for (const uint32_t node : removedNodes)
+    {
+        const Entity destroyedObject = m_nodeObjects[node];
+        destroyRenderInstance(destroyedObject);
+        m_registry.destroyEntity(destroyedObject);
+    }
+}
+
+void Scene::setLocalTransform(Entity object, const LocalTransform& transform)
+{
+    m_transforms.setLocalTransform(m_registry.getComponent<TransformComponent>(object).node, transform);
+}
+
+void Scene::setMesh(Entity object, Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> pipeline, std::optional<Handle<HandleType::Texture>> texture)
+{
+    m_registry.addComponent(object, MeshComponent{mesh, pipeline, true, texture});
+}
+
+void Scene::removeMesh(Entity object)
+{
+    destroyRenderInstance(object);
+    m_registry.removeComponent<MeshComponent>(object);
+}
+
+void Scene::setVisible(Entity object, bool isVisible)
+{
+    m_registry.modifyComponent<MeshComponent>(object).isVisible = isVisible;
+}
+
+void Scene::update()
+{
+    TRACE_ZONE("Scene::update");
+    m_transforms.update();
+}
+
+void Scene::extract(Renderer& renderer)
+{
+    TRACE_ZONE("Scene::extract");
+    for (const Handle<HandleType::Instance> instance : m_removedInstances)
+    {
+        renderer.removeInstance(instance);
+    }
+    m_removedInstances.clear();
+
+    // The mesh components' dense arrays are walked linearly. Objects are only sent to the renderer when they are new
+    // or changed, so the renderer uploads work proportional to the changes.
+    const ComponentStorage<MeshComponent>& meshes = m_registry.getStorage<MeshComponent>();
+    const ComponentStorage<TransformComponent>& transforms = m_registry.getStorage<TransformComponent>();
+    const ComponentStorage<RenderInstanceComponent>& renderInstances = m_registry.getStorage<RenderInstanceComponent>();
+    const std::span<const Entity> entities = meshes.getEntities();
+    const std::span<const MeshComponent> meshComponents = meshes.getComponents();
+    const std::span<const uint64_t> changedVersions = meshes.getChangedVersions();
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        const uint32_t node = transforms.find(entities[i])->node;
+        const RenderInstanceComponent* renderInstance = renderInstances.find(entities[i]);
+        const bool isChanged = changedVersions[i] > m_extractedVersion || m_transforms.hasWorldMatrixChanged(node);
+        if (renderInstance && !isChanged)
+        {
+            continue;
+        }
+
+        const DrawInstance instance{m_transforms.getWorldMatrix(node), meshComponents[i].mesh, meshComponents[i].pipeline, meshComponents[i].isVisible, meshComponents[i].texture};
+        if (renderInstance)
+        {
+            renderer.updateInstance(renderInstance->instance, instance);
+        }
+        else
+        {
+            m_registry.addComponent(entities[i], RenderInstanceComponent{renderer.addInstance(instance)});
+        }
+    }
+
+    m_extractedVersion = m_registry.getVersion();
+    m_registry.advanceVersion();
+}
+
+void Scene::destroyRenderInstance(Entity object)
+{
+    if (const RenderInstanceComponent* renderInstance = m_registry.getStorage<RenderInstanceComponent>().find(object))
+    {
+        m_removedInstances.push_back(renderInstance->instance);
+        m_registry.removeComponent<RenderInstanceComponent>(object);
+    }
+}
+
+EntityRegistry& Scene::getRegistry()
+{
+    return m_registry;
+}
+
+const TransformHierarchy& Scene::getTransforms() const
+{
+    return m_transforms;
+}
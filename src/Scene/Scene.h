@@ -0,0 +1,75 @@
+#ifndef VULKANPROJECT_SCENE_H
+#define VULKANPROJECT_SCENE_H
+
+#include "EntityRegistry.h"
+#include "TransformHierarchy.h"
+#include "../Renderer/Renderer.h"
+
+#include <optional>
+#include <vector>
+
+struct TransformComponent
+{
+    uint32_t node; // In the scene's TransformHierarchy
+};
+
+struct MeshComponent
+{
+    Handle<HandleType::Mesh> mesh;
+    Handle<HandleType::Pipeline> pipeline; // Stands in for the material
+    bool isVisible{true};
+    std::optional<Handle<HandleType::Texture>> texture; // Streamed texture sampled by the pipeline
+};
+
+/**
+ * Renderer instance of an object with a mesh, managed by Scene::extract()
+ */
+struct RenderInstanceComponent
+{
+    Handle<HandleType::Instance> instance;
+};
+
+/**
+ * Scene objects are entities. Every object has a TransformComponent, the nodes form a hierarchy so that destroying an
+ * object destroys its children too.
+ */
+class Scene
+{
+public:
+    Entity createObject(const LocalTransform& transform = {}, std::optional<Entity> parent = std::nullopt);
+
+    /**
+     * Destroy the object and its descendants
+     */
+    void destroyObject(Entity object);
+
+    void setLocalTransform(Entity object, const LocalTransform& transform);
+    void setMesh(Entity object, Handle<HandleType::Mesh> mesh, Handle<HandleType::Pipeline> pipeline, std::optional<Handle<HandleType::Texture>> texture = std::nullopt);
+    void removeMesh(Entity object);
+    void setVisible(Entity object, bool isVisible);
+
+    /**
+     * Recompute world matrices. Call once per frame before extracting.
+     */
+    void update();
+
+    /**
+     * Bring the renderer's instances up to date: add, update and remove the instances of objects whose mesh,
+     * visibility or world matrix changed since the last extraction. Call after every update().
+     */
+    void extract(Renderer& renderer);
+
+    EntityRegistry& getRegistry();
+    const TransformHierarchy& getTransforms() const;
+private:
+    void destroyRenderInstance(Entity object);
+
+    EntityRegistry m_registry;
+    TransformHierarchy m_transforms;
+    std::vector<Entity> m_nodeObjects; // Object owning each node, indexed by node id
+    std::vector<Handle<HandleType::Instance>> m_removedInstances; // Removed from the renderer by the next extract()
+    uint64_t m_extractedVersion{0u}; // Registry version of the last extraction
+};
+
+
+#endif // VULKANPROJECT_SCENE_H
@@ -0,0 +1,293 @@
+#include "TransformHierarchy.h"
+
+#include "../Utilities/Parallel.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRANSFORM_HIERARCHY_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_HIERARCHY_NEON
+#endif
+
+namespace
+{
+
+constexpr size_t nodesPerTask = 4096;
+constexpr uint32_t removed = TransformHierarchy::noParent;
+
+const glm::mat4 identity(1.0f);
+
+/**
+ * parent * translation * rotation * scale. Both matrices are affine, so every column of the result is three multiply
+ * adds of the parent's columns, plus the parent's translation for the last one.
+ */
+void computeWorldMatrix(const glm::mat4& parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& world)
+{
+    const glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+    const glm::vec3 localColumns[4] = {rotationMatrix[0] * scale.x, rotationMatrix[1] * scale.y, rotationMatrix[2] * scale.z, translation};
+#if defined(TRANSFORM_HIERARCHY_SSE2)
+    const __m128 parent0 = _mm_loadu_ps(&parent[0][0]);
+    const __m128 parent1 = _mm_loadu_ps(&parent[1][0]);
+    const __m128 parent2 = _mm_loadu_ps(&parent[2][0]);
+    for (int column = 0; column < 4; ++column)
+    {
+        const glm::vec3& local = localColumns[column];
+        __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(parent0, _mm_set1_ps(local.x)), _mm_mul_ps(parent1, _mm_set1_ps(local.y))),
+                                   _mm_mul_ps(parent2, _mm_set1_ps(local.z)));
+        if (column == 3)
+        {
+            result = _mm_add_ps(result, _mm_loadu_ps(&parent[3][0]));
+        }
+        _mm_storeu_ps(&world[column][0], result);
+    }
+#elif defined(TRANSFORM_HIERARCHY_NEON)
+    const float32x4_t parent0 = vld1q_f32(&parent[0][0]);
+    const float32x4_t parent1 = vld1q_f32(&parent[1][0]);
+    const float32x4_t parent2 = vld1q_f32(&parent[2][0]);
+    for (int column = 0; column < 4; ++column)
+    {
+        const glm::vec3& local = localColumns[column];
+        float32x4_t result = column == 3 ? vld1q_f32(&parent[3][0]) : vdupq_n_f32(0.0f);
+        result = vmlaq_n_f32(result, parent0, local.x);
+        result = vmlaq_n_f32(result, parent1, local.y);
+        result = vmlaq_n_f32(result, parent2, local.z);
+        vst1q_f32(&world[column][0], result);
+    }
+#else
+    for (int column = 0; column < 4; ++column)
+    {
+        const glm::vec3& local = localColumns[column];
+        world[column] = parent[0] * local.x + parent[1] * local.y + parent[2] * local.z + (column == 3 ? parent[3] : glm::vec4(0.0f));
+    }
+#endif
+}
+
+} // namespace
+
+uint32_t TransformHierarchy::addNode(uint32_t parent, const LocalTransform& transform)
+{
+    uint32_t levelIndex = 0u;
+    uint32_t parentSlot = noParent;
+    if (parent != noParent)
+    {
+        const NodeLocation parentLocation = getLocation(parent);
+        levelIndex = parentLocation.level + 1u;
+        parentSlot = parentLocation.slot;
+    }
+    if (levelIndex == m_levels.size())
+    {
+        m_levels.emplace_back();
+    }
+
+    uint32_t node;
+    if (m_freeNodes.empty())
+    {
+        node = static_cast<uint32_t>(m_locations.size());
+        m_locations.emplace_back();
+        m_links.emplace_back();
+    }
+    else
+    {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+    }
+
+    Level& level = m_levels[levelIndex];
+    uint32_t slot;
+    if (level.freeSlots.empty())
+    {
+        slot = static_cast<uint32_t>(level.nodes.size());
+        level.translations.push_back(transform.translation);
+        level.rotations.push_back(transform.rotation);
+        level.scales.push_back(transform.scale);
+        level.worldMatrices.emplace_back(1.0f);
+        level.parentSlots.push_back(parentSlot);
+        level.nodes.push_back(node);
+        level.isDirty.push_back(1u);
+        level.hasChanged.push_back(0u);
+    }
+    else
+    {
+        slot = level.freeSlots.back();
+        level.freeSlots.pop_back();
+        level.translations[slot] = transform.translation;
+        level.rotations[slot] = transform.rotation;
+        level.scales[slot] = transform.scale;
+        level.parentSlots[slot] = parentSlot;
+        level.nodes[slot] = node;
+        level.isDirty[slot] = 1u;
+    }
+    level.hasDirtyNodes = true;
+
+    m_locations[node] = NodeLocation{levelIndex, slot};
+    m_links[node] = NodeLinks{parent, noParent, noParent, noParent};
+    if (parent != noParent)
+    {
+        const uint32_t nextSibling = m_links[parent].firstChild;
+        if (nextSibling != noParent)
+        {
+            m_links[nextSibling].previousSibling = node;
+        }
+        m_links[node].nextSibling = nextSibling;
+        m_links[parent].firstChild = node;
+    }
+    ++m_nodeCount;
+    return node;
+}
+
+std::vector<uint32_t> TransformHierarchy::removeNode(uint32_t node)
+{
+    getLocation(node);
+
+    const NodeLinks& links = m_links[node];
+    if (links.previousSibling != noParent)
+    {
+        m_links[links.previousSibling].nextSibling = links.nextSibling;
+    }
+    else if (links.parent != noParent)
+    {
+        m_links[links.parent].firstChild = links.nextSibling;
+    }
+    if (links.nextSibling != noParent)
+    {
+        m_links[links.nextSibling].previousSibling = links.previousSibling;
+    }
+
+    // Descendants are found through the child lists, the removed nodes are visited parents first
+    std::vector<uint32_t> removedNodes = {node};
+    for (size_t i = 0; i < removedNodes.size(); ++i)
+    {
+        const uint32_t removedNode = removedNodes[i];
+        for (uint32_t child = m_links[removedNode].firstChild; child != noParent; child = m_links[child].nextSibling)
+        {
+            removedNodes.push_back(child);
+        }
+
+        const NodeLocation location = m_locations[removedNode];
+        Level& level = m_levels[location.level];
+        level.nodes[location.slot] = removed;
+        level.parentSlots[location.slot] = removed;
+        level.isDirty[location.slot] = 0u;
+        level.hasChanged[location.slot] = 0u;
+        level.freeSlots.push_back(location.slot);
+        m_locations[removedNode].slot = removed;
+        m_freeNodes.push_back(removedNode);
+        --m_nodeCount;
+    }
+    return removedNodes;
+}
+
+bool TransformHierarchy::contains(uint32_t node) const
+{
+    return node < m_locations.size() && m_locations[node].slot != removed;
+}
+
+void TransformHierarchy::setLocalTransform(uint32_t node, const LocalTransform& transform)
+{
+    const NodeLocation location = getLocation(node);
+    Level& level = m_levels[location.level];
+    level.translations[location.slot] = transform.translation;
+    level.rotations[location.slot] = transform.rotation;
+    level.scales[location.slot] = transform.scale;
+    level.isDirty[location.slot] = 1u;
+    level.hasDirtyNodes = true;
+}
+
+LocalTransform TransformHierarchy::getLocalTransform(uint32_t node) const
+{
+    const NodeLocation location = getLocation(node);
+    const Level& level = m_levels[location.level];
+    return LocalTransform{level.translations[location.slot], level.rotations[location.slot], level.scales[location.slot]};
+}
+
+const glm::mat4& TransformHierarchy::getWorldMatrix(uint32_t node) const
+{
+    const NodeLocation location = getLocation(node);
+    return m_levels[location.level].worldMatrices[location.slot];
+}
+
+bool TransformHierarchy::hasWorldMatrixChanged(uint32_t node) const
+{
+    const NodeLocation location = getLocation(node);
+    return m_levels[location.level].hasChanged[location.slot] != 0u;
+}
+
+uint32_t TransformHierarchy::getParent(uint32_t node) const
+{
+    const NodeLocation location = getLocation(node);
+    if (location.level == 0u)
+    {
+        return noParent;
+    }
+    return m_levels[location.level - 1].nodes[m_levels[location.level].parentSlots[location.slot]];
+}
+
+void TransformHierarchy::update()
+{
+    for (uint32_t levelIndex = 0; levelIndex < m_levels.size(); ++levelIndex)
+    {
+        updateLevel(levelIndex);
+    }
+}
+
+size_t TransformHierarchy::size() const
+{
+    return m_nodeCount;
+}
+
+TransformHierarchy::NodeLocation TransformHierarchy::getLocation(uint32_t node) const
+{
+    if (node >= m_locations.size() || m_locations[node].slot == removed)
+    {
+        throw std::runtime_error("Transform node does not exist!");
+    }
+    return m_locations[node];
+}
+
+void TransformHierarchy::updateLevel(uint32_t levelIndex)
+{
+    Level& level = m_levels[levelIndex];
+    const Level* parentLevel = levelIndex > 0 ? &m_levels[levelIndex - 1] : nullptr;
+    const bool hasChangedParents = parentLevel && parentLevel->hasChangedNodes;
+
+    // Levels without changes are skipped without touching their nodes
+    if (!level.hasDirtyNodes && !hasChangedParents)
+    {
+        if (level.hasChangedNodes)
+        {
+            std::fill(level.hasChanged.begin(), level.hasChanged.end(), uint8_t{0u});
+            level.hasChangedNodes = false;
+        }
+        return;
+    }
+
+    const size_t slotCount = level.nodes.size();
+    std::vector<uint8_t> taskHasChanges((slotCount + nodesPerTask - 1) / nodesPerTask, 0u);
+    Parallel::forEach(taskHasChanges.size(), [&](size_t task)
+                      {
+                          const size_t end = std::min(slotCount, (task + 1) * nodesPerTask);
+                          uint8_t hasChanges = 0u;
+                          for (size_t slot = task * nodesPerTask; slot < end; ++slot)
+                          {
+                              const uint32_t parentSlot = level.parentSlots[slot];
+                              const bool parentChanged = hasChangedParents && parentSlot != removed && parentLevel->hasChanged[parentSlot];
+                              const uint8_t changed = (level.isDirty[slot] || parentChanged) ? 1u : 0u;
+                              if (changed)
+                              {
+                                  const glm::mat4& parentMatrix = parentLevel ? parentLevel->worldMatrices[parentSlot] : identity;
+                                  computeWorldMatrix(parentMatrix, level.translations[slot], level.rotations[slot], level.scales[slot], level.worldMatrices[slot]);
+                                  level.isDirty[slot] = 0u;
+                              }
+                              level.hasChanged[slot] = changed;
+                              hasChanges |= changed;
+                          }
+                          taskHasChanges[task] = hasChanges;
+                      });
+
+    level.hasDirtyNodes = false;
+    level.hasChangedNodes = std::find(taskHasChanges.begin(), taskHasChanges.end(), uint8_t{1u}) != taskHasChanges.end();
+}
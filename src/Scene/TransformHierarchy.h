@@ -0,0 +1,106 @@
+#ifndef VULKANPROJECT_TRANSFORMHIERARCHY_H
+#define VULKANPROJECT_TRANSFORMHIERARCHY_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LocalTransform
+{
+    glm::vec3 translation{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+};
+
+/**
+ * Node hierarchy, like the nodes of a glTF scene, with local transforms and the world matrices computed from them.
+ *
+ * Nodes are stored as structure of arrays, one block per hierarchy depth, so update() walks memory linearly and
+ * computes a whole depth in parallel once the depth above it is done. Only nodes whose local transform changed and
+ * their descendants are recomputed. Node ids stay valid until the node is removed.
+ */
+class TransformHierarchy
+{
+public:
+    static constexpr uint32_t noParent = ~0u;
+
+    /**
+     * @param parent Node id or noParent for a root
+     */
+    uint32_t addNode(uint32_t parent, const LocalTransform& transform = {});
+
+    /**
+     * Remove a node and all of its descendants
+     * @return Ids of the removed nodes
+     */
+    std::vector<uint32_t> removeNode(uint32_t node);
+    bool contains(uint32_t node) const;
+
+    void setLocalTransform(uint32_t node, const LocalTransform& transform);
+    LocalTransform getLocalTransform(uint32_t node) const;
+
+    /**
+     * World matrix as of the last update()
+     */
+    const glm::mat4& getWorldMatrix(uint32_t node) const;
+
+    /**
+     * Whether the last update() recomputed the world matrix
+     */
+    bool hasWorldMatrixChanged(uint32_t node) const;
+    uint32_t getParent(uint32_t node) const;
+
+    /**
+     * Recompute the world matrices of changed nodes and their descendants
+     */
+    void update();
+
+    size_t size() const;
+private:
+    // Nodes of one depth. Slots of removed nodes are reused by nodes added at the same depth.
+    struct Level
+    {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<uint32_t> parentSlots; // In the level above, noParent for roots and removed slots
+        std::vector<uint32_t> nodes; // Node id of each slot, noParent for removed slots
+        std::vector<uint8_t> isDirty; // Local transform changed since the last update
+        std::vector<uint8_t> hasChanged; // World matrix was recomputed by the last update, read by the level below
+        std::vector<uint32_t> freeSlots;
+        bool hasDirtyNodes{false};
+        bool hasChangedNodes{false};
+    };
+
+    struct NodeLocation
+    {
+        uint32_t level;
+        uint32_t slot; // noParent for removed node ids
+    };
+
+    // Children of a node form a doubly linked list, so removal walks only the removed subtree. Node ids, noParent
+    // where there is none.
+    struct NodeLinks
+    {
+        uint32_t parent;
+        uint32_t firstChild;
+        uint32_t previousSibling;
+        uint32_t nextSibling;
+    };
+
+    NodeLocation getLocation(uint32_t node) const;
+    void updateLevel(uint32_t levelIndex);
+
+    std::vector<Level> m_levels;
+    std::vector<NodeLocation> m_locations; // Indexed by node id
+    std::vector<NodeLinks> m_links; // Indexed by node id
+    std::vector<uint32_t> m_freeNodes;
+    size_t m_nodeCount{0u};
+};
+
+
+#endif // VULKANPROJECT_TRANSFORMHIERARCHY_H
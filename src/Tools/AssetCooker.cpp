@@ -0,0 +1,208 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "../Assets/AssetPackage.h"
+#include "../Assets/MipGenerator.h"
+#include "../Assets/TextureAsset.h"
+#include "../Assets/TextureCompressor.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct CookerOptions
+{
+    std::string outputPath;
+    BlockCompressionFormat format{BlockCompressionFormat::BC7};
+    CompressionQuality quality{CompressionQuality::Normal};
+    AssetCompression compression{AssetCompression::Zstd};
+    bool generateMips{true};
+    MipFilter mipFilter{MipFilter::Kaiser};
+    bool srgb{true};
+    std::vector<std::string> inputPaths;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: AssetCooker <output package> [options] <images...>" << std::endl;
+    std::cout << "\t--format bc1|bc3|bc5|bc7 (default bc7)" << std::endl;
+    std::cout << "\t--quality fast|normal|high (default normal)" << std::endl;
+    std::cout << "\t--compression none|lz4|zstd (default zstd)" << std::endl;
+    std::cout << "\t--mips none|box|kaiser (default kaiser)" << std::endl;
+    std::cout << "\t--linear Texture holds linear data instead of sRGB colors" << std::endl;
+}
+
+CookerOptions parseOptions(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        throw std::runtime_error("Not enough arguments!");
+    }
+
+    CookerOptions options{};
+    options.outputPath = argv[1];
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (argument == "--format" && hasValue)
+        {
+            const std::string value = argv[++i];
+            if (value == "bc1")
+                options.format = BlockCompressionFormat::BC1;
+            else if (value == "bc3")
+                options.format = BlockCompressionFormat::BC3;
+            else if (value == "bc5")
+                options.format = BlockCompressionFormat::BC5;
+            else if (value == "bc7")
+                options.format = BlockCompressionFormat::BC7;
+            else
+                throw std::runtime_error("Unknown format " + value + "!");
+        }
+        else if (argument == "--quality" && hasValue)
+        {
+            const std::string value = argv[++i];
+            if (value == "fast")
+                options.quality = CompressionQuality::Fast;
+            else if (value == "normal")
+                options.quality = CompressionQuality::Normal;
+            else if (value == "high")
+                options.quality = CompressionQuality::High;
+            else
+                throw std::runtime_error("Unknown quality " + value + "!");
+        }
+        else if (argument == "--compression" && hasValue)
+        {
+            const std::string value = argv[++i];
+            if (value == "none")
+                options.compression = AssetCompression::None;
+            else if (value == "lz4")
+                options.compression = AssetCompression::LZ4;
+            else if (value == "zstd")
+                options.compression = AssetCompression::Zstd;
+            else
+                throw std::runtime_error("Unknown compression " + value + "!");
+        }
+        else if (argument == "--mips" && hasValue)
+        {
+            const std::string value = argv[++i];
+            if (value == "none")
+                options.generateMips = false;
+            else if (value == "box")
+                options.mipFilter = MipFilter::Box;
+            else if (value == "kaiser")
+                options.mipFilter = MipFilter::Kaiser;
+            else
+                throw std::runtime_error("Unknown mip filter " + value + "!");
+        }
+        else if (argument == "--linear")
+        {
+            options.srgb = false;
+        }
+        else
+        {
+            options.inputPaths.push_back(argument);
+        }
+    }
+    return options;
+}
+
+void cookTexture(const std::string& path, const CookerOptions& options, AssetPackageWriter& writer)
+{
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (pixels == nullptr)
+    {
+        throw std::runtime_error("Failed to load image " + path + ": " + stbi_failure_reason());
+    }
+    const std::vector<uint8_t> rgba(pixels, pixels + size_t(width) * height * 4);
+    stbi_image_free(pixels);
+
+    const std::string name = std::filesystem::path(path).stem().string();
+
+    // Mips are filtered in linear space, so sRGB textures are decoded before filtering
+    const std::span<const std::byte> imageBytes = std::as_bytes(std::span(rgba));
+    const auto mipStartTime = std::chrono::steady_clock::now();
+    std::vector<MipLevel> levels;
+    if (options.generateMips)
+    {
+        const MipImageFormat mipFormat = options.srgb ? MipImageFormat::RGBA8Srgb : MipImageFormat::RGBA8Unorm;
+        levels = MipGeneration::generateMipChain(imageBytes, width, height, mipFormat, options.mipFilter);
+    }
+    else
+    {
+        levels.push_back(MipLevel{static_cast<uint32_t>(width), static_cast<uint32_t>(height), std::vector<std::byte>(imageBytes.begin(), imageBytes.end())});
+    }
+    const double mipSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mipStartTime).count();
+
+    double psnr = 0.0;
+    double compressionSeconds = 0.0;
+    size_t compressedSize = 0u;
+    for (uint32_t mip = 0; mip < levels.size(); ++mip)
+    {
+        const MipLevel& level = levels[mip];
+        const std::span<const uint8_t> levelRgba(reinterpret_cast<const uint8_t*>(level.data.data()), level.data.size());
+        const TextureCompressionResult result = TextureCompression::compressImageWithReport(levelRgba, level.width, level.height, options.format, options.quality);
+        writer.addAsset(getTextureMipAssetName(name, mip), result.blocks, options.compression);
+
+        if (mip == 0)
+        {
+            psnr = result.psnr;
+        }
+        compressionSeconds += result.seconds;
+        compressedSize += result.blocks.size();
+    }
+
+    const TextureAssetHeader header{
+        .width = static_cast<uint32_t>(width),
+        .height = static_cast<uint32_t>(height),
+        .mipCount = static_cast<uint32_t>(levels.size()),
+        .format = options.format,
+        .isSrgb = options.srgb ? 1u : 0u};
+    writer.addAsset(getTextureInfoAssetName(name), std::as_bytes(std::span(&header, 1)), AssetCompression::None);
+
+    std::cout << name << ": " << width << "x" << height << ", " << levels.size() << " mips"
+              << ", mip 0 PSNR " << psnr << " dB"
+              << ", " << rgba.size() / 1024 << " KiB -> " << compressedSize / 1024 << " KiB"
+              << ", mips " << mipSeconds * 1000.0 << " ms"
+              << ", compression " << compressionSeconds * 1000.0 << " ms" << std::endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const CookerOptions options = parseOptions(argc, argv);
+        std::cout << "Compressing textures using " << TextureCompression::getSimdPathName() << " block encoders" << std::endl;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        AssetPackageWriter writer;
+        for (const std::string& path : options.inputPaths)
+        {
+            cookTexture(path, options, writer);
+        }
+        writer.write(options.outputPath);
+
+        const PackageCodecStatistics statistics = writer.getStatistics().total();
+        std::cout << "Wrote " << options.outputPath << ", compression ratio " << statistics.compressionRatio()
+                  << ", took " << std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() << " s" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
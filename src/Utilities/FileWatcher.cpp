@@ -0,0 +1,121 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+std::filesystem::path normalizePath(const std::string& path)
+{
+    return std::filesystem::absolute(path).lexically_normal();
+}
+
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher() :
+    m_inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if (m_inotify < 0)
+    {
+        throw std::runtime_error("Failed to initialize inotify!");
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    close(m_inotify);
+}
+
+void FileWatcher::watch(const std::string& path)
+{
+    const std::filesystem::path normalizedPath = normalizePath(path);
+    if (!m_files.emplace(normalizedPath.string(), path).second)
+    {
+        return;
+    }
+
+    // Watching a directory again returns its existing descriptor
+    const std::filesystem::path directory = normalizedPath.parent_path();
+    const int descriptor = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (descriptor < 0)
+    {
+        m_files.erase(normalizedPath.string());
+        throw std::runtime_error("Failed to watch " + directory.string() + "!");
+    }
+    m_directories[descriptor] = directory;
+}
+
+std::vector<std::string> FileWatcher::pollChanges()
+{
+    std::vector<std::string> changes;
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        // Fails with EAGAIN once every event has been read
+        const ssize_t size = read(m_inotify, buffer, sizeof(buffer));
+        if (size <= 0)
+        {
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < size;)
+        {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            const auto directory = m_directories.find(event->wd);
+            if (event->len == 0 || directory == m_directories.end())
+            {
+                continue;
+            }
+            const auto file = m_files.find((directory->second / event->name).string());
+            if (file != m_files.end() && std::find(changes.begin(), changes.end(), file->second) == changes.end())
+            {
+                changes.push_back(file->second);
+            }
+        }
+    }
+    return changes;
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+
+FileWatcher::~FileWatcher() = default;
+
+void FileWatcher::watch(const std::string& path)
+{
+    if (m_files.emplace(normalizePath(path).string(), path).second)
+    {
+        std::error_code error;
+        m_modificationTimes[path] = std::filesystem::last_write_time(path, error);
+    }
+}
+
+std::vector<std::string> FileWatcher::pollChanges()
+{
+    std::vector<std::string> changes;
+    for (auto& [path, modificationTime] : m_modificationTimes)
+    {
+        // Files being replaced may briefly not exist, they are picked up by a later poll
+        std::error_code error;
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+        if (!error && time != modificationTime)
+        {
+            modificationTime = time;
+            changes.push_back(path);
+        }
+    }
+    return changes;
+}
+
+#endif
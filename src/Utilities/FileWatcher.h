@@ -0,0 +1,43 @@
+#ifndef VULKANPROJECT_FILEWATCHER_H
+#define VULKANPROJECT_FILEWATCHER_H
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Reports watched files that were written or replaced. On Linux inotify watches their directories, so that editors
+ * saving through a temporary file and a rename are noticed too. Elsewhere modification times are compared on every
+ * poll.
+ */
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * Watching a file again does nothing
+     */
+    void watch(const std::string& path);
+
+    /**
+     * Never blocks
+     * @return Files changed since the last poll, as they were passed to watch()
+     */
+    std::vector<std::string> pollChanges();
+private:
+    std::unordered_map<std::string, std::string> m_files; // Watched path by normalized absolute path
+#ifdef __linux__
+    int m_inotify{-1};
+    std::unordered_map<int, std::filesystem::path> m_directories; // By inotify watch descriptor
+#else
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_modificationTimes; // By watched path
+#endif
+};
+
+#endif // VULKANPROJECT_FILEWATCHER_H
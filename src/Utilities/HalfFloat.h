@@ -0,0 +1,61 @@
+#ifndef VULKANPROJECT_HALFFLOAT_H
+#define VULKANPROJECT_HALFFLOAT_H
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * IEEE 754 binary16 conversions for vertex and instance data quantization
+ */
+namespace HalfFloat
+{
+
+/**
+ * Round to nearest even. Values too large for half precision become infinity.
+ */
+inline uint16_t fromFloat(float value)
+{
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t absoluteBits = bits & 0x7fffffffu;
+
+    if (absoluteBits >= 0x7f800000u)
+    {
+        return sign | (absoluteBits > 0x7f800000u ? 0x7e00u : 0x7c00u);
+    }
+    if (absoluteBits >= 0x477ff000u)
+    {
+        return sign | 0x7c00u;
+    }
+    if (absoluteBits < 0x38800000u)
+    {
+        // Subnormal, 2^-24 is the smallest step
+        return sign | static_cast<uint16_t>(std::nearbyint(std::bit_cast<float>(absoluteBits) * 16777216.0f));
+    }
+
+    const uint32_t rounded = absoluteBits + 0xfffu + ((absoluteBits >> 13) & 1u);
+    return sign | static_cast<uint16_t>((rounded - 0x38000000u) >> 13);
+}
+
+inline float toFloat(uint16_t half)
+{
+    const uint32_t sign = uint32_t(half & 0x8000u) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1fu;
+    const uint32_t mantissa = half & 0x3ffu;
+
+    if (exponent == 0)
+    {
+        const float subnormal = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        return std::bit_cast<float>(std::bit_cast<uint32_t>(subnormal) | sign);
+    }
+    if (exponent == 0x1fu)
+    {
+        return std::bit_cast<float>(sign | 0x7f800000u | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+}
+
+#endif // VULKANPROJECT_HALFFLOAT_H
@@ -0,0 +1,68 @@
+#include "Hash.h"
+
+#include <array>
+#include <cstring>
+
+namespace
+{
+
+constexpr uint32_t crcPolynomial = 0xEDB88320u;
+
+// Slicing-by-8 tables, table[0] is the classic byte-at-a-time table
+constexpr std::array<std::array<uint32_t, 256>, 8> createCrcTables()
+{
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1u) ? crcPolynomial : 0u);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        for (size_t slice = 1; slice < 8; ++slice)
+        {
+            const uint32_t previous = tables[slice - 1][i];
+            tables[slice][i] = (previous >> 8) ^ tables[0][previous & 0xFFu];
+        }
+    }
+    return tables;
+}
+
+constexpr auto crcTables = createCrcTables();
+
+}
+
+namespace Hash
+{
+
+uint32_t crc32(std::span<const std::byte> data, uint32_t seed)
+{
+    uint32_t crc = ~seed;
+    const std::byte* bytes = data.data();
+    size_t remaining = data.size();
+
+    while (remaining >= 8)
+    {
+        uint32_t low, high;
+        std::memcpy(&low, bytes, 4);
+        std::memcpy(&high, bytes + 4, 4);
+        low ^= crc;
+        crc = crcTables[7][low & 0xFFu] ^ crcTables[6][(low >> 8) & 0xFFu] ^ crcTables[5][(low >> 16) & 0xFFu] ^ crcTables[4][low >> 24] ^
+              crcTables[3][high & 0xFFu] ^ crcTables[2][(high >> 8) & 0xFFu] ^ crcTables[1][(high >> 16) & 0xFFu] ^ crcTables[0][high >> 24];
+        bytes += 8;
+        remaining -= 8;
+    }
+    while (remaining > 0)
+    {
+        crc = (crc >> 8) ^ crcTables[0][(crc ^ static_cast<uint32_t>(*bytes)) & 0xFFu];
+        ++bytes;
+        --remaining;
+    }
+    return ~crc;
+}
+
+}
@@ -0,0 +1,18 @@
+#ifndef VULKANPROJECT_HASH_H
+#define VULKANPROJECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Hash
+{
+
+/**
+ * CRC-32 (IEEE polynomial) of the data. Pass a previous result as seed to continue a running checksum.
+ */
+uint32_t crc32(std::span<const std::byte> data, uint32_t seed = 0u);
+
+}
+
+#endif // VULKANPROJECT_HASH_H
@@ -0,0 +1,239 @@
+#include "JobSystem.h"
+
+#include "Trace.h"
+
+namespace
+{
+
+struct WorkerIdentity
+{
+    const JobSystem* system;
+    uint32_t index;
+};
+
+// Lets push() and tryPop() find the deque of the calling worker
+thread_local WorkerIdentity currentWorker{nullptr, 0u};
+
+} // namespace
+
+bool JobCounter::isDone() const
+{
+    return m_pending.load(std::memory_order_acquire) == 0u;
+}
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    for (uint32_t i = 0; i <= workerCount; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem jobSystem(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+    return jobSystem;
+}
+
+void JobSystem::run(JobFunction job, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_pending.fetch_add(1u, std::memory_order_relaxed);
+    }
+    push(Job{std::move(job), counter});
+}
+
+void JobSystem::runAfter(JobCounter& dependency, JobFunction job, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_pending.fetch_add(1u, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard lock(dependency.m_mutex);
+        if (!dependency.isDone())
+        {
+            dependency.m_continuations.emplace_back(std::move(job), counter);
+            return;
+        }
+    }
+    push(Job{std::move(job), counter});
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    while (!counter.isDone())
+    {
+        Job job;
+        if (tryPop(job))
+        {
+            execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard lock(counter.m_mutex);
+        std::swap(exception, counter.m_exception);
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+uint32_t JobSystem::getWorkerCount() const
+{
+    return static_cast<uint32_t>(m_workers.size());
+}
+
+uint32_t JobSystem::getCurrentThreadIndex() const
+{
+    return currentWorker.system == this ? currentWorker.index : getWorkerCount();
+}
+
+void JobSystem::push(Job job)
+{
+    const bool isWorker = currentWorker.system == this;
+    Queue& queue = *m_queues[isWorker ? currentWorker.index : m_workers.size()];
+    // Counted before it is visible, so the count never drops below the jobs that can be popped
+    m_queuedJobCount.fetch_add(1u, std::memory_order_release);
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_wakeUp.notify_one();
+}
+
+bool JobSystem::tryPop(Job& job)
+{
+    if (m_queuedJobCount.load(std::memory_order_acquire) == 0u)
+    {
+        return false;
+    }
+
+    // Newest job of our own deque first, it is the most likely to still be in cache
+    const bool isWorker = currentWorker.system == this;
+    const size_t ownIndex = isWorker ? currentWorker.index : m_workers.size();
+    if (isWorker)
+    {
+        Queue& queue = *m_queues[ownIndex];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            m_queuedJobCount.fetch_sub(1u, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Then steal the oldest job of the others, starting from the next queue to spread the thieves
+    for (size_t offset = isWorker ? 1 : 0; offset < m_queues.size(); ++offset)
+    {
+        Queue& queue = *m_queues[(ownIndex + offset) % m_queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            m_queuedJobCount.fetch_sub(1u, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Job& job)
+{
+    if (!job.counter)
+    {
+        job.function();
+        return;
+    }
+
+    try
+    {
+        job.function();
+    }
+    catch (...)
+    {
+        std::lock_guard lock(job.counter->m_mutex);
+        if (!job.counter->m_exception)
+        {
+            job.counter->m_exception = std::current_exception();
+        }
+    }
+    finish(job.counter);
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+    std::vector<std::pair<JobFunction, JobCounter*>> continuations;
+    {
+        // Under the lock so that runAfter() either sees the counter as done or registers before it is taken
+        std::lock_guard lock(counter->m_mutex);
+        if (counter->m_pending.fetch_sub(1u, std::memory_order_acq_rel) != 1u)
+        {
+            return;
+        }
+        std::swap(continuations, counter->m_continuations);
+    }
+    for (auto& [function, continuationCounter] : continuations)
+    {
+        push(Job{std::move(function), continuationCounter});
+    }
+}
+
+void JobSystem::workerLoop(uint32_t workerIndex)
+{
+    currentWorker = WorkerIdentity{this, workerIndex};
+    if constexpr (Trace::enabled)
+    {
+        Trace::setThreadName("Worker " + std::to_string(workerIndex));
+    }
+
+    while (true)
+    {
+        Job job;
+        if (tryPop(job))
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        m_wakeUp.wait(lock, [this]()
+                      { return m_stopping || m_queuedJobCount.load(std::memory_order_acquire) > 0u; });
+        if (m_stopping)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef VULKANPROJECT_JOBSYSTEM_H
+#define VULKANPROJECT_JOBSYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using JobFunction = std::function<void()>;
+
+/**
+ * Counts unfinished jobs. Jobs can wait for a counter with JobSystem::wait() or be started once it reaches zero with
+ * JobSystem::runAfter(). The first exception thrown by a counted job is rethrown by JobSystem::wait().
+ */
+class JobCounter
+{
+public:
+    bool isDone() const;
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_pending{0u};
+    std::mutex m_mutex;
+    std::vector<std::pair<JobFunction, JobCounter*>> m_continuations;
+    std::exception_ptr m_exception;
+};
+
+/**
+ * Work stealing job scheduler. Every worker owns a deque: it pushes and pops its own jobs at the back, idle workers
+ * steal the oldest jobs from the front of the others. Jobs started from threads outside the system go to a shared
+ * queue that every worker steals from.
+ *
+ * Waiting runs other jobs instead of blocking, so jobs can start and wait for nested jobs without deadlocking.
+ */
+class JobSystem
+{
+public:
+    /**
+     * @param workerCount Threads besides the ones calling wait()
+     */
+    explicit JobSystem(uint32_t workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * Engine wide instance with a worker for every hardware thread except the main thread
+     */
+    static JobSystem& get();
+
+    /**
+     * Jobs without a counter must not throw
+     */
+    void run(JobFunction job, JobCounter* counter = nullptr);
+    void runAfter(JobCounter& dependency, JobFunction job, JobCounter* counter = nullptr);
+
+    /**
+     * Run jobs on the calling thread until the counter is done
+     */
+    void wait(JobCounter& counter);
+
+    /**
+     * Call function(begin, end) over [0, count) in ranges of at most grainSize and wait for all of them
+     */
+    template<typename Function>
+    void parallelFor(size_t count, size_t grainSize, Function function)
+    {
+        grainSize = std::max<size_t>(grainSize, 1);
+        const size_t rangeCount = (count + grainSize - 1) / grainSize;
+        if (rangeCount <= 1 || m_workers.empty())
+        {
+            if (count > 0)
+            {
+                function(size_t(0), count);
+            }
+            return;
+        }
+
+        JobCounter counter;
+        for (size_t range = 1; range < rangeCount; ++range)
+        {
+            run([&function, range, grainSize, count]()
+                { function(range * grainSize, std::min(count, (range + 1) * grainSize)); },
+                &counter);
+        }
+        // The first range runs on the calling thread, it would otherwise just wait
+        try
+        {
+            function(size_t(0), std::min(count, grainSize));
+        }
+        catch (...)
+        {
+            wait(counter);
+            throw;
+        }
+        wait(counter);
+    }
+
+    uint32_t getWorkerCount() const;
+
+    /**
+     * Index of the calling thread in [0, getWorkerCount()]: its worker index, or getWorkerCount() for threads outside
+     * the system. Lets jobs pick per thread resources such as command pools; only one outside thread may use them.
+     */
+    uint32_t getCurrentThreadIndex() const;
+private:
+    struct Job
+    {
+        JobFunction function;
+        JobCounter* counter;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    bool tryPop(Job& job);
+    void execute(Job& job);
+    void finish(JobCounter* counter);
+    void workerLoop(uint32_t workerIndex);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // One per worker, the last one for outside threads
+    std::vector<std::thread> m_workers;
+    std::atomic<uint32_t> m_queuedJobCount{0u};
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeUp;
+    bool m_stopping{false};
+};
+
+#endif // VULKANPROJECT_JOBSYSTEM_H
@@ -0,0 +1,69 @@
+#ifndef VULKANPROJECT_PARALLEL_H
+#define VULKANPROJECT_PARALLEL_H
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+namespace Parallel
+{
+
+/**
+ * Run function(index) for every index in [0, count) on the workers of the engine wide job system and wait for
+ * completion. Indices are handed out one at a time, so uneven work balances out. The first exception thrown by
+ * function is rethrown on the calling thread.
+ */
+template<typename Function>
+void forEach(size_t count, Function function)
+{
+    JobSystem& jobSystem = JobSystem::get();
+    const size_t jobCount = std::min<size_t>(count, size_t(jobSystem.getWorkerCount()) + 1);
+    if (jobCount <= 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            function(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{0};
+    std::atomic<bool> failed{false};
+    auto worker = [&]()
+    {
+        for (size_t i = nextIndex++; i < count && !failed; i = nextIndex++)
+        {
+            try
+            {
+                function(i);
+            }
+            catch (...)
+            {
+                failed = true;
+                throw;
+            }
+        }
+    };
+
+    JobCounter counter;
+    for (size_t i = 0; i < jobCount - 1; ++i)
+    {
+        jobSystem.run(worker, &counter);
+    }
+    try
+    {
+        worker();
+    }
+    catch (...)
+    {
+        jobSystem.wait(counter);
+        throw;
+    }
+    jobSystem.wait(counter);
+}
+
+}
+
+#endif // VULKANPROJECT_PARALLEL_H
@@ -0,0 +1,126 @@
+#include "RadixSort.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace
+{
+
+constexpr uint32_t digitBits = 8u;
+constexpr uint32_t bucketCount = 1u << digitBits;
+constexpr uint32_t passCount = 64u / digitBits;
+
+// Every chunk is counted and scattered by one job. Smaller inputs are sorted on the calling thread.
+constexpr size_t itemsPerChunk = 16384u;
+
+using Histogram = std::array<uint32_t, bucketCount>;
+
+uint32_t getDigit(uint64_t key, uint32_t pass)
+{
+    return static_cast<uint32_t>(key >> (pass * digitBits)) & (bucketCount - 1u);
+}
+
+}
+
+namespace RadixSort
+{
+
+void sort(std::vector<KeyValue>& items, std::vector<KeyValue>& scratch)
+{
+    const size_t count = items.size();
+    scratch.resize(count);
+    if (count < 2)
+    {
+        return;
+    }
+
+    const size_t chunkCount = (count + itemsPerChunk - 1) / itemsPerChunk;
+    JobSystem& jobSystem = JobSystem::get();
+
+    // Digit counts of every pass in one read of the keys. They do not depend on the order, so they tell up front
+    // which passes can be skipped.
+    std::vector<std::array<Histogram, passCount>> chunkPassHistograms(chunkCount);
+    jobSystem.parallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+                          {
+                              for (size_t chunk = begin; chunk < end; ++chunk)
+                              {
+                                  std::array<Histogram, passCount>& histograms = chunkPassHistograms[chunk];
+                                  for (Histogram& histogram : histograms)
+                                  {
+                                      histogram.fill(0u);
+                                  }
+                                  const size_t chunkEnd = std::min(count, (chunk + 1) * itemsPerChunk);
+                                  for (size_t i = chunk * itemsPerChunk; i < chunkEnd; ++i)
+                                  {
+                                      for (uint32_t pass = 0; pass < passCount; ++pass)
+                                      {
+                                          ++histograms[pass][getDigit(items[i].key, pass)];
+                                      }
+                                  }
+                              }
+                          });
+
+    std::vector<Histogram> chunkOffsets(chunkCount);
+    for (uint32_t pass = 0; pass < passCount; ++pass)
+    {
+        // A pass is needed unless one bucket holds every key
+        const uint32_t firstDigit = getDigit(items[0].key, pass);
+        size_t firstDigitCount = 0u;
+        for (const std::array<Histogram, passCount>& histograms : chunkPassHistograms)
+        {
+            firstDigitCount += histograms[pass][firstDigit];
+        }
+        if (firstDigitCount == count)
+        {
+            continue;
+        }
+
+        // Chunk histograms of this pass in the current order, the first one is reused
+        if (pass > 0)
+        {
+            jobSystem.parallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+                                  {
+                                      for (size_t chunk = begin; chunk < end; ++chunk)
+                                      {
+                                          Histogram& histogram = chunkPassHistograms[chunk][pass];
+                                          histogram.fill(0u);
+                                          const size_t chunkEnd = std::min(count, (chunk + 1) * itemsPerChunk);
+                                          for (size_t i = chunk * itemsPerChunk; i < chunkEnd; ++i)
+                                          {
+                                              ++histogram[getDigit(items[i].key, pass)];
+                                          }
+                                      }
+                                  });
+        }
+
+        // Each chunk writes a bucket after the same bucket of the chunks before it, which keeps the sort stable
+        uint32_t offset = 0u;
+        for (uint32_t digit = 0; digit < bucketCount; ++digit)
+        {
+            for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+            {
+                chunkOffsets[chunk][digit] = offset;
+                offset += chunkPassHistograms[chunk][pass][digit];
+            }
+        }
+
+        jobSystem.parallelFor(chunkCount, 1, [&](size_t begin, size_t end)
+                              {
+                                  for (size_t chunk = begin; chunk < end; ++chunk)
+                                  {
+                                      Histogram& offsets = chunkOffsets[chunk];
+                                      const size_t chunkEnd = std::min(count, (chunk + 1) * itemsPerChunk);
+                                      for (size_t i = chunk * itemsPerChunk; i < chunkEnd; ++i)
+                                      {
+                                          scratch[offsets[getDigit(items[i].key, pass)]++] = items[i];
+                                      }
+                                  }
+                              });
+        items.swap(scratch);
+    }
+}
+
+}
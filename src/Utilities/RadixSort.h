@@ -0,0 +1,26 @@
+#ifndef VULKANPROJECT_RADIXSORT_H
+#define VULKANPROJECT_RADIXSORT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace RadixSort
+{
+
+struct KeyValue
+{
+    uint64_t key;
+    uint32_t value; // For example the index of what the key was computed from
+};
+
+/**
+ * Stable least significant digit radix sort by key, 8 bits per pass. Passes where every key has the same digit are
+ * skipped, so keys that leave bits unused sort in fewer passes. Large inputs are counted and scattered in parallel on
+ * the job system.
+ * @param scratch Same size as items afterwards, reused between calls to avoid allocating
+ */
+void sort(std::vector<KeyValue>& items, std::vector<KeyValue>& scratch);
+
+}
+
+#endif // VULKANPROJECT_RADIXSORT_H
@@ -0,0 +1,78 @@
+#include "RangeAllocator.h"
+
+#include <iterator>
+#include <stdexcept>
+
+RangeAllocator::RangeAllocator(uint64_t capacity) :
+    m_capacity(capacity)
+{
+    if (capacity > 0)
+    {
+        m_freeRanges.emplace(0u, capacity);
+    }
+}
+
+uint64_t RangeAllocator::allocate(uint64_t size)
+{
+    if (size == 0)
+    {
+        throw std::runtime_error("Trying to allocate an empty range!");
+    }
+
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+    {
+        if (it->second < size)
+        {
+            continue;
+        }
+        const uint64_t offset = it->first;
+        const uint64_t remaining = it->second - size;
+        m_freeRanges.erase(it);
+        if (remaining > 0)
+        {
+            m_freeRanges.emplace(offset + size, remaining);
+        }
+        m_usedSize += size;
+        return offset;
+    }
+    return invalidOffset;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size)
+{
+    if (size == 0 || offset + size > m_capacity)
+    {
+        throw std::runtime_error("Trying to free a range outside of the allocator!");
+    }
+
+    auto next = m_freeRanges.lower_bound(offset);
+    const auto previous = next != m_freeRanges.begin() ? std::prev(next) : m_freeRanges.end();
+    if ((next != m_freeRanges.end() && next->first < offset + size) ||
+        (previous != m_freeRanges.end() && previous->first + previous->second > offset))
+    {
+        throw std::runtime_error("Trying to free a range that is already free!");
+    }
+    m_usedSize -= size;
+
+    if (next != m_freeRanges.end() && next->first == offset + size)
+    {
+        size += next->second;
+        m_freeRanges.erase(next);
+    }
+    if (previous != m_freeRanges.end() && previous->first + previous->second == offset)
+    {
+        previous->second += size;
+        return;
+    }
+    m_freeRanges.emplace(offset, size);
+}
+
+uint64_t RangeAllocator::getCapacity() const
+{
+    return m_capacity;
+}
+
+uint64_t RangeAllocator::getUsedSize() const
+{
+    return m_usedSize;
+}
@@ -0,0 +1,33 @@
+#ifndef VULKANPROJECT_RANGEALLOCATOR_H
+#define VULKANPROJECT_RANGEALLOCATOR_H
+
+#include <cstdint>
+#include <limits>
+#include <map>
+
+/**
+ * First fit allocator of ranges in [0, capacity), used to sub-allocate large GPU buffers. Units are up to the caller,
+ * for example vertices of a vertex buffer. Freed ranges are merged with free neighbours.
+ */
+class RangeAllocator
+{
+public:
+    static constexpr uint64_t invalidOffset = std::numeric_limits<uint64_t>::max();
+
+    explicit RangeAllocator(uint64_t capacity);
+
+    /**
+     * Return the offset of a free range of the given size, or invalidOffset when there is none
+     */
+    uint64_t allocate(uint64_t size);
+    void free(uint64_t offset, uint64_t size);
+
+    uint64_t getCapacity() const;
+    uint64_t getUsedSize() const;
+private:
+    std::map<uint64_t, uint64_t> m_freeRanges; // Offset to size
+    uint64_t m_capacity;
+    uint64_t m_usedSize{0u};
+};
+
+#endif // VULKANPROJECT_RANGEALLOCATOR_H
@@ -0,0 +1,92 @@
+#include "StartupTimer.h"
+
+#include "JobSystem.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+struct RecordedPhase
+{
+    std::string name;
+    uint64_t begin;
+    uint64_t end;
+    uint32_t threadIndex; // JobSystem::getCurrentThreadIndex()
+};
+
+std::mutex phasesMutex;
+std::vector<RecordedPhase> phases;
+
+double toMilliseconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+} // namespace
+
+namespace StartupTimer
+{
+
+Phase::Phase(std::string name) :
+    m_name(std::move(name)),
+    m_begin(Trace::now())
+{
+}
+
+Phase::~Phase()
+{
+    record(std::move(m_name), m_begin, Trace::now());
+}
+
+void record(std::string name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    const uint32_t threadIndex = JobSystem::get().getCurrentThreadIndex();
+    std::lock_guard lock(phasesMutex);
+    phases.push_back(RecordedPhase{std::move(name), beginNanoseconds, endNanoseconds, threadIndex});
+}
+
+void printReport(std::ostream& out)
+{
+    std::lock_guard lock(phasesMutex);
+    if (phases.empty())
+    {
+        return;
+    }
+
+    std::vector<RecordedPhase> sortedPhases = phases;
+    std::sort(sortedPhases.begin(), sortedPhases.end(), [](const RecordedPhase& a, const RecordedPhase& b)
+              { return a.begin < b.begin; });
+    const uint64_t startupBegin = sortedPhases.front().begin;
+    const uint64_t elapsed = Trace::now() - startupBegin;
+    uint64_t phaseSum = 0u;
+    for (const RecordedPhase& phase : sortedPhases)
+    {
+        phaseSum += phase.end - phase.begin;
+    }
+
+    const uint32_t outsideThreadIndex = JobSystem::get().getWorkerCount();
+    const std::ios_base::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "Startup took " << toMilliseconds(elapsed) << " ms, its phases sum to " << toMilliseconds(phaseSum) << " ms" << std::endl;
+    for (const RecordedPhase& phase : sortedPhases)
+    {
+        out << std::setw(9) << toMilliseconds(phase.begin - startupBegin) << " .. " << std::setw(9) << toMilliseconds(phase.end - startupBegin)
+            << " ms " << std::setw(9) << toMilliseconds(phase.end - phase.begin) << " ms  " << std::left << std::setw(40) << phase.name << std::right;
+        if (phase.threadIndex == outsideThreadIndex)
+        {
+            out << " main thread" << std::endl;
+        }
+        else
+        {
+            out << " worker " << phase.threadIndex << std::endl;
+        }
+    }
+    out.flags(flags);
+}
+
+}
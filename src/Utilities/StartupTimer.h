@@ -0,0 +1,41 @@
+#ifndef VULKANPROJECT_STARTUPTIMER_H
+#define VULKANPROJECT_STARTUPTIMER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * Wall clock phases of application startup. Phases can run concurrently on any thread, so the report compares the
+ * time from the first phase to the report with the sum of the phases: the difference is what running them in
+ * parallel saved.
+ */
+namespace StartupTimer
+{
+
+/**
+ * Measures a phase from construction to destruction
+ */
+class Phase
+{
+public:
+    explicit Phase(std::string name);
+    ~Phase();
+
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+private:
+    std::string m_name;
+    uint64_t m_begin;
+};
+
+void record(std::string name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+
+/**
+ * Print the phases recorded so far in the order they began, with the thread that ran them
+ */
+void printReport(std::ostream& out);
+
+}
+
+#endif // VULKANPROJECT_STARTUPTIMER_H
@@ -0,0 +1,278 @@
+#include "Trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+
+enum class EventType : uint8_t
+{
+    Zone,
+    GpuZone,
+    Counter,
+    Frame
+};
+
+struct Event
+{
+    const char* name;
+    uint64_t begin;
+    uint64_t end; // Equal to begin for counters and frames
+    double value; // Counter value or frame index
+    EventType type;
+};
+
+constexpr uint32_t eventsPerChunk = 4096u;
+constexpr uint32_t gpuThreadId = 0u; // Thread ids of the CPU threads start from 1
+
+/**
+ * Events are appended by the owning thread only. The count is published with release stores, so the exporting thread
+ * reads events up to the count it loads while the owner keeps appending.
+ */
+struct Chunk
+{
+    std::array<Event, eventsPerChunk> events;
+    std::atomic<uint32_t> count{0u};
+    std::atomic<Chunk*> next{nullptr};
+
+    ~Chunk()
+    {
+        delete next.load(std::memory_order_relaxed);
+    }
+};
+
+struct ThreadBuffer
+{
+    uint32_t threadId;
+    std::string name; // Guarded by Registry::mutex
+    Chunk firstChunk;
+    Chunk* currentChunk{&firstChunk}; // Owner only
+    std::atomic<uint64_t> capture{0u}; // Capture the events belong to
+};
+
+/**
+ * Buffers outlive their threads so that the events of exited threads are still exported
+ */
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::mutex captureMutex; // Held while beginning and ending captures
+    std::atomic<bool> isCapturing{false};
+    std::atomic<uint64_t> capture{0u};
+    uint64_t captureBegin{0u};
+};
+
+Registry& getRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+thread_local ThreadBuffer* currentThreadBuffer = nullptr;
+
+ThreadBuffer& getThreadBuffer()
+{
+    if (!currentThreadBuffer)
+    {
+        Registry& registry = getRegistry();
+        std::lock_guard lock(registry.mutex);
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->threadId = static_cast<uint32_t>(registry.buffers.size()) + 1u;
+        buffer->name = "Thread " + std::to_string(buffer->threadId);
+        currentThreadBuffer = buffer.get();
+        registry.buffers.push_back(std::move(buffer));
+    }
+    return *currentThreadBuffer;
+}
+
+void record(const Event& event)
+{
+    Registry& registry = getRegistry();
+    if (!registry.isCapturing.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    ThreadBuffer& buffer = getThreadBuffer();
+    const uint64_t capture = registry.capture.load(std::memory_order_acquire);
+    if (buffer.capture.load(std::memory_order_relaxed) != capture)
+    {
+        // First event of a new capture on this thread, the chunks of the previous one are reused
+        for (Chunk* chunk = &buffer.firstChunk; chunk; chunk = chunk->next.load(std::memory_order_relaxed))
+        {
+            chunk->count.store(0u, std::memory_order_relaxed);
+        }
+        buffer.currentChunk = &buffer.firstChunk;
+        buffer.capture.store(capture, std::memory_order_release);
+    }
+
+    Chunk* chunk = buffer.currentChunk;
+    uint32_t count = chunk->count.load(std::memory_order_relaxed);
+    if (count == eventsPerChunk)
+    {
+        Chunk* next = chunk->next.load(std::memory_order_relaxed);
+        if (!next)
+        {
+            next = new Chunk();
+            chunk->next.store(next, std::memory_order_release);
+        }
+        chunk = next;
+        buffer.currentChunk = chunk;
+        count = 0u;
+    }
+    chunk->events[count] = event;
+    chunk->count.store(count + 1u, std::memory_order_release);
+}
+
+void writeEscaped(std::ofstream& file, const std::string& text)
+{
+    file << '"';
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            file << '\\';
+        }
+        file << c;
+    }
+    file << '"';
+}
+
+} // namespace
+
+namespace Trace
+{
+
+uint64_t now()
+{
+    const auto time = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+}
+
+void beginCapture()
+{
+    Registry& registry = getRegistry();
+    std::lock_guard lock(registry.captureMutex);
+    if (registry.isCapturing.load(std::memory_order_relaxed))
+    {
+        throw std::runtime_error("A trace capture is already running!");
+    }
+    registry.captureBegin = now();
+    registry.capture.fetch_add(1u, std::memory_order_release);
+    registry.isCapturing.store(true, std::memory_order_release);
+}
+
+void endCapture(const std::string& path)
+{
+    Registry& registry = getRegistry();
+    std::lock_guard captureLock(registry.captureMutex);
+    if (!registry.isCapturing.load(std::memory_order_relaxed))
+    {
+        throw std::runtime_error("No trace capture is running!");
+    }
+    registry.isCapturing.store(false, std::memory_order_release);
+    const uint64_t capture = registry.capture.load(std::memory_order_relaxed);
+
+    std::ofstream file(path);
+    if (!file)
+    {
+        throw std::runtime_error("Failed to open " + path + " for writing!");
+    }
+    // Microseconds since the beginning of the capture
+    file << std::fixed << std::setprecision(3);
+    auto writeTime = [&file, &registry](uint64_t nanoseconds)
+    { file << static_cast<double>(nanoseconds - registry.captureBegin) / 1000.0; };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << R"({"ph":"M","pid":1,"tid":)" << gpuThreadId << R"(,"name":"thread_name","args":{"name":"GPU"}})";
+
+    std::lock_guard lock(registry.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+    {
+        file << ",\n" << R"({"ph":"M","pid":1,"tid":)" << buffer->threadId << R"(,"name":"thread_name","args":{"name":)";
+        writeEscaped(file, buffer->name);
+        file << "}}";
+        if (buffer->capture.load(std::memory_order_acquire) != capture)
+        {
+            continue;
+        }
+
+        for (const Chunk* chunk = &buffer->firstChunk; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            const uint32_t count = chunk->count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const Event& event = chunk->events[i];
+                // GPU zones of frames recorded before the capture are read back during it
+                if (event.begin < registry.captureBegin)
+                {
+                    continue;
+                }
+
+                file << ",\n{\"name\":";
+                writeEscaped(file, event.name);
+                file << ",\"pid\":1,\"tid\":" << (event.type == EventType::GpuZone ? gpuThreadId : buffer->threadId) << ",\"ts\":";
+                writeTime(event.begin);
+                switch (event.type)
+                {
+                case EventType::Zone:
+                case EventType::GpuZone:
+                    file << ",\"ph\":\"X\",\"dur\":" << static_cast<double>(event.end - event.begin) / 1000.0 << "}";
+                    break;
+                case EventType::Counter:
+                    file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+                    break;
+                case EventType::Frame:
+                    file << ",\"ph\":\"i\",\"s\":\"g\",\"args\":{\"frame\":" << static_cast<uint64_t>(event.value) << "}}";
+                    break;
+                }
+            }
+        }
+    }
+    file << "\n]}\n";
+}
+
+bool isCapturing()
+{
+    return getRegistry().isCapturing.load(std::memory_order_relaxed);
+}
+
+void setThreadName(const std::string& name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+    std::lock_guard lock(getRegistry().mutex);
+    buffer.name = name;
+}
+
+void recordZone(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    record(Event{name, beginNanoseconds, endNanoseconds, 0.0, EventType::Zone});
+}
+
+void recordGpuZone(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds)
+{
+    record(Event{name, beginNanoseconds, endNanoseconds, 0.0, EventType::GpuZone});
+}
+
+void recordCounter(const char* name, double value)
+{
+    const uint64_t time = now();
+    record(Event{name, time, time, value, EventType::Counter});
+}
+
+void markFrame(uint64_t frameIndex)
+{
+    const uint64_t time = now();
+    record(Event{"Frame", time, time, static_cast<double>(frameIndex), EventType::Frame});
+}
+
+}
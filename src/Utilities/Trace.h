@@ -0,0 +1,99 @@
+#ifndef VULKANPROJECT_TRACE_H
+#define VULKANPROJECT_TRACE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * CPU instrumentation exported as Chrome trace event JSON, which both chrome://tracing and the Perfetto UI open.
+ *
+ * Every thread appends to its own buffer without locking, so a zone costs two clock reads and one store. Events are
+ * only recorded between beginCapture() and endCapture(). Names are stored as pointers and have to outlive the capture,
+ * string literals in practice.
+ *
+ * Code is instrumented with the TRACE_ macros, which compile to nothing unless VULKANPROJECT_ENABLE_TRACING is defined.
+ */
+namespace Trace
+{
+
+#ifdef VULKANPROJECT_ENABLE_TRACING
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+/**
+ * Nanoseconds on the clock of all trace timestamps
+ */
+uint64_t now();
+
+/**
+ * Captures are begun and ended from one thread at a time
+ */
+void beginCapture();
+
+/**
+ * Stop capturing and write the events recorded since beginCapture() to a JSON file
+ */
+void endCapture(const std::string& path);
+bool isCapturing();
+
+/**
+ * Name of the calling thread's track
+ */
+void setThreadName(const std::string& name);
+
+void recordZone(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+
+/**
+ * Zone on the GPU track, with the GPU timestamps already converted to now() time
+ */
+void recordGpuZone(const char* name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+void recordCounter(const char* name, double value);
+void markFrame(uint64_t frameIndex);
+
+/**
+ * Records the time from construction to destruction. Zones begun before a capture are not recorded.
+ */
+class Zone
+{
+public:
+    explicit Zone(const char* name) :
+        m_name(name),
+        m_isRecording(isCapturing()),
+        m_begin(m_isRecording ? now() : 0u)
+    {
+    }
+
+    ~Zone()
+    {
+        if (m_isRecording)
+        {
+            recordZone(m_name, m_begin, now());
+        }
+    }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+private:
+    const char* m_name;
+    bool m_isRecording;
+    uint64_t m_begin;
+};
+
+}
+
+#define TRACE_CONCATENATE_IMPL(a, b) a##b
+#define TRACE_CONCATENATE(a, b) TRACE_CONCATENATE_IMPL(a, b)
+
+#ifdef VULKANPROJECT_ENABLE_TRACING
+#define TRACE_ZONE(name) const Trace::Zone TRACE_CONCATENATE(traceZone, __LINE__)(name)
+#define TRACE_COUNTER(name, value) Trace::recordCounter(name, static_cast<double>(value))
+#define TRACE_FRAME(frameIndex) Trace::markFrame(frameIndex)
+#else
+#define TRACE_ZONE(name)
+#define TRACE_COUNTER(name, value)
+#define TRACE_FRAME(frameIndex)
+#endif
+
+#endif // VULKANPROJECT_TRACE_H
@@ -1,5 +1,7 @@
 #include "Window.h"
 
+#include "Utilities/StartupTimer.h"
+
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
@@ -9,6 +11,7 @@
 
 Window::Window(size_t width, size_t height)
 {
+    StartupTimer::Phase phase("Create window");
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
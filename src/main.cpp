@@ -1,6 +1,7 @@
 #define GLFW_INCLUDE_VULKAN
 
 #include "HelloTriangleApplication.h"
+#include "Utilities/Trace.h"
 
 #include <cstdlib>
 #include <iostream>
@@ -8,16 +9,31 @@
 
 int main()
 {
-    HelloTriangleApplication app;
+    // Traces cover startup too, so the capture begins before the application is created
+    const char* tracePath = Trace::enabled ? std::getenv("VULKANPROJECT_TRACE") : nullptr;
+    if (tracePath)
+    {
+        Trace::beginCapture();
+    }
 
     try
     {
+        HelloTriangleApplication app;
         app.run();
     }
     catch (const std::exception& e)
     {
         std::cerr << e.what() << std::endl;
+        if (tracePath)
+        {
+            Trace::endCapture(tracePath);
+        }
         return EXIT_FAILURE;
     }
+
+    if (tracePath)
+    {
+        Trace::endCapture(tracePath);
+    }
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}